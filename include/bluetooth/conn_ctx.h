@@ -47,6 +47,12 @@ struct bt_conn_ctx {
 
 	 /** The connection that the data is associated with. */
 	struct bt_conn *conn;
+
+	/** Number of references to the context. The connection holds one
+	 *  reference until the context is freed. Every successful get
+	 *  holds one until the context is released.
+	 */
+	atomic_t ref;
 };
 
 /** @brief Bluetooth connection context library structure. */
@@ -54,8 +60,9 @@ struct bt_conn_ctx_lib {
 	/** Connection contexts. */
 	struct bt_conn_ctx ctx[CONFIG_BT_MAX_CONN];
 
-	/** Context data mutex that ensures that only one connection context is
-	  * manipulated at a time. */
+	/** Mutex that serializes allocating and freeing the contexts, and
+	  * releasing the last reference to a context. Getting a context does
+	  * not use it. */
 	struct k_mutex * const mutex;
 
 	/** Memory slab instance where the memory is allocated. */
@@ -124,7 +131,16 @@ void bt_conn_ctx_free_all(struct bt_conn_ctx_lib *ctx_lib);
  * @brief Get the context data of a connection from the memory pool.
  *
  * This function finds a connection's context data in the memory pool.
- * The link to find is identified by the connection object.
+ * The link to find is identified by the connection object. The lookup
+ * is lock-free and uses the connection index. The context data stays
+ * valid until it is released, even if the context is freed in the
+ * meantime.
+ *
+ * Access to the data itself is not serialized: several threads can hold
+ * the same context at once. Users that access the context data from
+ * several threads must serialize the access themselves. This includes
+ * initializing the data after @ref bt_conn_ctx_alloc, because the
+ * context can be found as soon as it is allocated.
  *
  * This function should be used in conjunction with
  * @ref bt_conn_ctx_release to ensure proper operation.
@@ -116,10 +116,17 @@ struct bt_mesh_light_ctrl_srv_reg_cfg {
 struct bt_mesh_light_ctrl_srv_reg {
 	/** Regulator step timer */
 	struct k_work_delayable timer;
+#if defined(CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_FIXED_POINT)
+	/** Internal integral sum, in Q16 fixed point. */
+	int64_t i;
+#else
 	/** Internal integral sum. */
 	float i;
+#endif
 	/** Previous output */
 	uint16_t prev;
+	/** Current step interval (in milliseconds) */
+	uint16_t interval;
 	/** Regulator configuration */
 	struct bt_mesh_light_ctrl_srv_reg_cfg cfg;
 };
@@ -85,6 +85,11 @@ struct bt_mesh_scene_srv {
 	uint8_t vndpages;
 	/** Largest number of pages used to store SIG model scene data. */
 	uint8_t sigpages;
+	/** Largest number of pages used to store packed scene data. */
+	uint8_t pages;
+
+	/** Whether each scene still has pages in the legacy format. */
+	bool legacy[CONFIG_BT_MESH_SCENES_MAX];
 
 	/** Linked list node for Scene Server list */
 	sys_snode_t n;
@@ -285,6 +285,62 @@ struct bt_mesh_sensor_column {
 	struct sensor_value end;
 };
 
+/** Aggregation of the samples in a sensor series store column. */
+enum bt_mesh_sensor_series_aggr {
+	/** Mean of the samples. */
+	BT_MESH_SENSOR_SERIES_AGGR_MEAN,
+	/** Smallest sample. */
+	BT_MESH_SENSOR_SERIES_AGGR_MIN,
+	/** Largest sample. */
+	BT_MESH_SENSOR_SERIES_AGGR_MAX,
+};
+
+/** Aggregated samples of a single sensor series column. */
+struct bt_mesh_sensor_series_entry {
+	/** Sum of the samples, in millionths. */
+	int64_t sum;
+	/** Smallest sample, in millionths. */
+	int64_t min;
+	/** Largest sample, in millionths. */
+	int64_t max;
+	/** Number of samples in the sum. */
+	uint32_t count;
+};
+
+/** Sensor series sample store.
+ *
+ *  Keeps aggregated samples for every column of a sensor series in
+ *  memory provided by the application, so that the Sensor Server can
+ *  respond to series messages without reading the sensor.
+ */
+struct bt_mesh_sensor_series_store {
+	/** Column aggregates. Must have one entry for each column of the
+	 *  sensor series.
+	 */
+	struct bt_mesh_sensor_series_entry *entries;
+	/** Aggregation reported for each column. */
+	enum bt_mesh_sensor_series_aggr aggr;
+	/** Averaging window. When a column has collected this many
+	 *  samples, each new sample replaces the mean of one sample, so
+	 *  the mean becomes an exponential moving average over the window.
+	 *  Zero disables the window.
+	 */
+	uint32_t window;
+};
+
+/** @def BT_MESH_SENSOR_SERIES_STORE_INIT
+ *
+ *  @brief Initialization parameters for a @ref bt_mesh_sensor_series_store.
+ *
+ *  @param[in] _entries Array of column aggregates.
+ *  @param[in] _aggr    Aggregation reported for each column.
+ *  @param[in] _window  Averaging window, or 0 to average all samples.
+ */
+#define BT_MESH_SENSOR_SERIES_STORE_INIT(_entries, _aggr, _window)             \
+	{                                                                      \
+		.entries = _entries, .aggr = _aggr, .window = _window,         \
+	}
+
 /** Sensor series specification. */
 struct bt_mesh_sensor_series {
 	/** Pointer to the list of columns.
@@ -319,6 +375,13 @@ struct bt_mesh_sensor_series {
 	int (*get)(struct bt_mesh_sensor *sensor, struct bt_mesh_msg_ctx *ctx,
 		   const struct bt_mesh_sensor_column *column,
 		   struct sensor_value *value);
+
+	/** Optional sample store.
+	 *
+	 *  If the @c get callback is not set, series messages are answered
+	 *  from the samples added with @ref bt_mesh_sensor_series_sample_add.
+	 */
+	struct bt_mesh_sensor_series_store *store;
 };
 
 /** Sensor instance. */
@@ -438,6 +501,29 @@ const struct bt_mesh_sensor_type *bt_mesh_sensor_type_get(uint16_t id);
 bool bt_mesh_sensor_value_in_column(const struct sensor_value *value,
 				    const struct bt_mesh_sensor_column *col);
 
+/** @brief Add a sample to the series store of a sensor.
+ *
+ *  The sample is aggregated in every column that @p x falls into.
+ *
+ *  @param[in] sensor Sensor with a series store.
+ *  @param[in] x      Position of the sample on the series axis, for
+ *                    instance the time of day.
+ *  @param[in] value  Sample value.
+ *
+ *  @retval 0         The sample was added.
+ *  @retval -ENOTSUP  The sensor has no series store.
+ *  @retval -ENOENT   @p x is not in any of the columns.
+ */
+int bt_mesh_sensor_series_sample_add(struct bt_mesh_sensor *sensor,
+				     const struct sensor_value *x,
+				     const struct sensor_value *value);
+
+/** @brief Clear all samples in the series store of a sensor.
+ *
+ *  @param[in] sensor Sensor with a series store.
+ */
+void bt_mesh_sensor_series_store_reset(struct bt_mesh_sensor *sensor);
+
 /** @brief Get the format of the sensor column data.
  *
  *  @param[in] type Sensor type.
@@ -416,6 +416,32 @@ struct bt_hids_init_param {
 	bool is_kb;
 };
 
+/** @brief Statistics of reports sent to all connected peers. */
+struct bt_hids_notify_stats {
+	/** Number of notifications queued in the host. */
+	uint32_t queued;
+
+	/** Number of Boot Mouse Input Reports merged into a later report. */
+	uint32_t merged;
+
+	/** Number of reports dropped for a peer. */
+	uint32_t dropped;
+};
+
+/** @brief Notification sent to all connected peers that is in flight. */
+struct bt_hids_notify_slot {
+	/** Completion callback of the notification. */
+	bt_gatt_complete_func_t cb;
+
+	/** Set while the notification is queued in the host. */
+	atomic_t in_use;
+
+	/** Sequence number of a notification queued on all peers with
+	 *  a single call, 0 if it was queued on this peer only.
+	 */
+	uint32_t seq;
+};
+
 /** @brief HID Service structure.
  */
 struct bt_hids {
@@ -460,6 +486,33 @@ struct bt_hids {
 
 	/** Bluetooth connection contexts. */
 	struct bt_conn_ctx_lib *conn_ctx;
+
+	/** Locks that serialize the access to the context data of each
+	 *  connection, indexed like the connection contexts.
+	 */
+	struct k_mutex conn_data_lock[CONFIG_BT_MAX_CONN];
+
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+	/** Notifications sent to all peers that are in flight, for every
+	 *  connection context.
+	 */
+	struct bt_hids_notify_slot
+		notify_slots[CONFIG_BT_MAX_CONN][CONFIG_BT_HIDS_NOTIFY_BATCH_LIMIT];
+
+	/** Sequence number of the last notification queued on all peers
+	 *  with a single call.
+	 */
+	atomic_t notify_seq;
+
+	/** Number of notifications queued in the host. */
+	atomic_t notify_queued;
+
+	/** Number of Boot Mouse Input Reports merged into a later report. */
+	atomic_t notify_merged;
+
+	/** Number of reports dropped for a peer. */
+	atomic_t notify_dropped;
+#endif /* CONFIG_BT_HIDS_NOTIFY_BATCH */
 };
 
 /** @brief HID Connection context data structure.
@@ -591,6 +644,19 @@ int bt_hids_boot_kb_inp_rep_send(struct bt_hids *hids_obj, struct bt_conn *conn,
 				 uint8_t const *rep, uint16_t len,
 				 bt_gatt_complete_func_t cb);
 
+/** @brief Get statistics of reports sent to all connected peers.
+ *
+ *  The statistics are collected only if
+ *  @kconfig{CONFIG_BT_HIDS_NOTIFY_BATCH} is enabled.
+ *
+ *  @param hids_obj Pointer to HIDS instance.
+ *  @param stats Pointer to the structure to fill with the statistics.
+ *
+ *  @return 0 If the operation was successful. Otherwise, a (negative) error
+ *	      code is returned.
+ */
+int bt_hids_notify_stats_get(struct bt_hids *hids_obj,
+			     struct bt_hids_notify_stats *stats);
 
 #ifdef __cplusplus
 }
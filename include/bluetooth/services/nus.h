@@ -79,6 +79,29 @@ struct bt_nus_cb {
 	 */
 	void (*send_enabled)(enum bt_nus_send_status status);
 
+	/** @brief Stream TX buffer high watermark callback.
+	 *
+	 * The number of bytes queued with @ref bt_nus_stream_send reached
+	 * @kconfig{CONFIG_BT_NUS_STREAM_HIGH_WATERMARK}. The application
+	 * should pause its data source until @ref low_watermark is called.
+	 *
+	 * Used only if @kconfig{CONFIG_BT_NUS_STREAM} is enabled.
+	 *
+	 * @param[in] conn Pointer to connection object.
+	 */
+	void (*high_watermark)(struct bt_conn *conn);
+
+	/** @brief Stream TX buffer low watermark callback.
+	 *
+	 * The number of bytes queued with @ref bt_nus_stream_send dropped to
+	 * @kconfig{CONFIG_BT_NUS_STREAM_LOW_WATERMARK} after the high
+	 * watermark was reached.
+	 *
+	 * Used only if @kconfig{CONFIG_BT_NUS_STREAM} is enabled.
+	 *
+	 * @param[in] conn Pointer to connection object.
+	 */
+	void (*low_watermark)(struct bt_conn *conn);
 };
 
 /**@brief Initialize the service.
@@ -113,6 +136,38 @@ int bt_nus_init(struct bt_nus_cb *callbacks);
  */
 int bt_nus_send(struct bt_conn *conn, const uint8_t *data, uint16_t len);
 
+/**@brief Queue data for streaming.
+ *
+ * @details The data is copied into the TX ring buffer of the connection and
+ *          sent as a sequence of notifications, each filled up to the
+ *          current ATT MTU. Notifications are queued from the system
+ *          workqueue as soon as the previously queued ones are sent.
+ *
+ *          If the ring buffer cannot hold all of the data, only the part
+ *          that fits is queued. Use the watermark callbacks of
+ *          @ref bt_nus_cb to throttle the data source.
+ *
+ *          Only available if @kconfig{CONFIG_BT_NUS_STREAM} is enabled.
+ *
+ * @param[in] conn Pointer to connection object.
+ * @param[in] data Pointer to a data buffer.
+ * @param[in] len  Length of the data in the buffer.
+ *
+ * @return Number of bytes queued, or a negative error code.
+ * @retval -EINVAL If the peer has not enabled notifications.
+ * @retval -ENOMEM If no stream context is available for the connection.
+ */
+int bt_nus_stream_send(struct bt_conn *conn, const uint8_t *data,
+		       uint32_t len);
+
+/**@brief Get free space in the stream TX buffer.
+ *
+ * @param[in] conn Pointer to connection object.
+ *
+ * @return Number of bytes that can be queued with @ref bt_nus_stream_send.
+ */
+uint32_t bt_nus_stream_space_get(struct bt_conn *conn);
+
 /**@brief Get maximum data length that can be used for @ref bt_nus_send.
  *
  * @param[in] conn Pointer to connection Object.
@@ -35,6 +35,38 @@ struct bt_throughput_metrics {
 	uint32_t write_rate;
 };
 
+/** @brief Number of buckets in the write interval histogram. */
+#define BT_THROUGHPUT_STATS_HIST_SIZE 16
+
+/** @brief Throughput statistics. */
+struct bt_throughput_stats {
+	/** Number of completed measurement periods. */
+	uint32_t period_count;
+
+	/** Lowest throughput in a measurement period, in bits per second. */
+	uint32_t rate_min;
+
+	/** Highest throughput in a measurement period, in bits per second. */
+	uint32_t rate_max;
+
+	/** Average throughput of all measurement periods, in bits per
+	 *  second.
+	 */
+	uint32_t rate_avg;
+
+	/** Longest time between two consecutive GATT writes, in
+	 *  microseconds.
+	 */
+	uint32_t write_gap_max;
+
+	/** Histogram of the time between consecutive GATT writes.
+	 *  Bucket 0 counts intervals shorter than 2 us. Bucket n counts
+	 *  intervals from 2^n to 2^(n+1) - 1 us. The last bucket also
+	 *  counts all longer intervals.
+	 */
+	uint32_t write_gap_hist[BT_THROUGHPUT_STATS_HIST_SIZE];
+};
+
 /** @brief Throughput callback structure. */
 struct bt_throughput_cb {
 	/** @brief Data read callback.
@@ -146,6 +178,17 @@ int bt_throughput_read(struct bt_throughput *throughput);
 int bt_throughput_write(struct bt_throughput *throughput,
 			const uint8_t *data, uint16_t len);
 
+/** @brief Get statistics of the received data.
+ *
+ *  Available if @kconfig{CONFIG_BT_THROUGHPUT_STATS} is enabled.
+ *
+ *  @param[out] stats Statistics collected since the last metrics reset.
+ *
+ *  @retval 0 If the operation was successful.
+ *            Otherwise, a negative error code is returned.
+ */
+int bt_throughput_stats_get(struct bt_throughput_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,7 +8,15 @@
 
 #include <errno.h>
 #include <sys/util.h>
+#if defined(CONFIG_ESB_RADIO_SIM)
+/* The simulated radio has no register definitions, so the enumerators below
+ * take the nRF52 values instead.
+ */
+#define ESB_RADIO_VALUE(reg, sim) (sim)
+#else
 #include <nrf.h>
+#define ESB_RADIO_VALUE(reg, sim) (reg)
+#endif
 #include <stdbool.h>
 #include <zephyr/types.h>
 
@@ -117,16 +125,16 @@ enum esb_mode {
 /** @brief Enhanced ShockBurst bitrate modes. */
 enum esb_bitrate {
 	/** 1 Mb radio mode. */
-	ESB_BITRATE_1MBPS = RADIO_MODE_MODE_Nrf_1Mbit,
+	ESB_BITRATE_1MBPS = ESB_RADIO_VALUE(RADIO_MODE_MODE_Nrf_1Mbit, 0),
 	/** 2 Mb radio mode. */
-	ESB_BITRATE_2MBPS = RADIO_MODE_MODE_Nrf_2Mbit,
+	ESB_BITRATE_2MBPS = ESB_RADIO_VALUE(RADIO_MODE_MODE_Nrf_2Mbit, 1),
 #if !(defined(CONFIG_SOC_NRF52840) || defined(CONFIG_SOC_NRF52810) ||          \
       defined(CONFIG_SOC_NRF52811) || defined(CONFIG_SOC_NRF5340_CPUNET))
 	/** 250 Kb radio mode. */
-	ESB_BITRATE_250KBPS = RADIO_MODE_MODE_Nrf_250Kbit,
+	ESB_BITRATE_250KBPS = ESB_RADIO_VALUE(RADIO_MODE_MODE_Nrf_250Kbit, 2),
 #endif
 	/** 1 Mb radio mode using @e Bluetooth low energy radio parameters. */
-	ESB_BITRATE_1MBPS_BLE = RADIO_MODE_MODE_Ble_1Mbit,
+	ESB_BITRATE_1MBPS_BLE = ESB_RADIO_VALUE(RADIO_MODE_MODE_Ble_1Mbit, 3),
 #if defined(CONFIG_SOC_SERIES_NRF52X) || defined(CONFIG_SOC_NRF5340_CPUNET)
 	/** 2 Mb radio mode using @e Bluetooth low energy radio parameters. */
 	ESB_BITRATE_2MBPS_BLE = 4,
@@ -135,39 +143,41 @@ enum esb_bitrate {
 
 /** @brief Enhanced ShockBurst CRC modes. */
 enum esb_crc {
-	ESB_CRC_16BIT = RADIO_CRCCNF_LEN_Two,	/**< Use two-byte CRC. */
-	ESB_CRC_8BIT = RADIO_CRCCNF_LEN_One,	/**< Use one-byte CRC. */
-	ESB_CRC_OFF = RADIO_CRCCNF_LEN_Disabled /**< Disable CRC. */
+	ESB_CRC_16BIT = ESB_RADIO_VALUE(RADIO_CRCCNF_LEN_Two, 2),	/**< Use two-byte CRC. */
+	ESB_CRC_8BIT = ESB_RADIO_VALUE(RADIO_CRCCNF_LEN_One, 1),	/**< Use one-byte CRC. */
+	ESB_CRC_OFF = ESB_RADIO_VALUE(RADIO_CRCCNF_LEN_Disabled, 0) /**< Disable CRC. */
 };
 
 /** @brief Enhanced ShockBurst radio transmission power modes. */
 enum esb_tx_power {
 	/** 4 dBm radio transmit power. */
 #if !defined(CONFIG_SOC_NRF5340_CPUNET)
-	ESB_TX_POWER_4DBM = RADIO_TXPOWER_TXPOWER_Pos4dBm,
+	ESB_TX_POWER_4DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_Pos4dBm, 0x04),
 #endif
 #if defined(CONFIG_SOC_SERIES_NRF52X)
 	/** 3 dBm radio transmit power. */
 	ESB_TX_POWER_3DBM = RADIO_TXPOWER_TXPOWER_Pos3dBm,
 #endif
 	/** 0 dBm radio transmit power. */
-	ESB_TX_POWER_0DBM = RADIO_TXPOWER_TXPOWER_0dBm,
+	ESB_TX_POWER_0DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_0dBm, 0x00),
 	/** -4 dBm radio transmit power. */
-	ESB_TX_POWER_NEG4DBM = RADIO_TXPOWER_TXPOWER_Neg4dBm,
+	ESB_TX_POWER_NEG4DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_Neg4dBm, 0xFC),
 	/** -8 dBm radio transmit power. */
-	ESB_TX_POWER_NEG8DBM = RADIO_TXPOWER_TXPOWER_Neg8dBm,
+	ESB_TX_POWER_NEG8DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_Neg8dBm, 0xF8),
 	/** -12 dBm radio transmit power. */
-	ESB_TX_POWER_NEG12DBM = RADIO_TXPOWER_TXPOWER_Neg12dBm,
+	ESB_TX_POWER_NEG12DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_Neg12dBm, 0xF4),
 	/** -16 dBm radio transmit power. */
-	ESB_TX_POWER_NEG16DBM = RADIO_TXPOWER_TXPOWER_Neg16dBm,
+	ESB_TX_POWER_NEG16DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_Neg16dBm, 0xF0),
 	/** -20 dBm radio transmit power. */
-	ESB_TX_POWER_NEG20DBM = RADIO_TXPOWER_TXPOWER_Neg20dBm,
+	ESB_TX_POWER_NEG20DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_Neg20dBm, 0xEC),
 	/** -30 dBm radio transmit power. */
-	ESB_TX_POWER_NEG30DBM = RADIO_TXPOWER_TXPOWER_Neg30dBm,
+	ESB_TX_POWER_NEG30DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_Neg30dBm, 0xE2),
 	/** -40 dBm radio transmit power. */
-	ESB_TX_POWER_NEG40DBM = RADIO_TXPOWER_TXPOWER_Neg40dBm
+	ESB_TX_POWER_NEG40DBM = ESB_RADIO_VALUE(RADIO_TXPOWER_TXPOWER_Neg40dBm, 0xD8)
 };
 
+#undef ESB_RADIO_VALUE
+
 /** @brief Enhanced ShockBurst transmission modes. */
 enum esb_tx_mode {
 	/** Automatic TX mode: When the TX FIFO contains packets and the
@@ -215,6 +225,38 @@ struct esb_evt {
 	uint32_t tx_attempts;	/**< Number of TX retransmission attempts. */
 };
 
+/** @brief Enhanced ShockBurst pipe statistics.
+ *
+ *  The byte counters can be sampled periodically to get the throughput of
+ *  each pipe.
+ */
+struct esb_pipe_stats {
+	/** Payloads sent successfully. In PRX mode, ACK payloads confirmed
+	 *  by the next packet on the pipe.
+	 */
+	uint32_t tx_success;
+	/** Payloads that failed after all retransmissions (PTX only). */
+	uint32_t tx_failed;
+	/** Payload bytes counted in @p tx_success. */
+	uint32_t tx_bytes;
+	/** Retransmissions (PTX only). */
+	uint32_t retransmits;
+	/** Lost ACKs. In PTX mode, attempts without a valid ACK. In PRX mode,
+	 *  retransmitted packets, sent because the PTX did not get the ACK.
+	 */
+	uint32_t ack_lost;
+	/** Payloads added to the RX FIFO. In PTX mode, ACK payloads. */
+	uint32_t rx_packets;
+	/** Payload bytes counted in @p rx_packets. */
+	uint32_t rx_bytes;
+	/** RSSI of the last packet received on the pipe. In PTX mode, of the
+	 *  last ACK.
+	 */
+	int8_t rssi;
+	/** Running average of the RSSI over about the last 8 packets. */
+	int8_t rssi_avg;
+};
+
 /** @brief Event handler prototype. */
 typedef void (*esb_event_handler)(const struct esb_evt *event);
 
@@ -274,7 +316,9 @@ int esb_suspend(void);
  *  Calling this function disables the Enhanced ShockBurst module immediately.
  *  Doing so might stop ongoing communications.
  *
- *  @note All queues are flushed by this function.
+ *  @note All queues are flushed by this function, and the payloads
+ *        borrowed with @ref esb_rx_payload_get or
+ *        @ref esb_tx_payload_alloc must not be accessed anymore.
  *
  */
 void esb_disable(void);
@@ -292,9 +336,13 @@ bool esb_is_idle(void);
  *  module is in PRX mode, the payload is queued for when a packet is received
  *  that requires an acknowledgement with payload.
  *
+ *  The payload is added to the TX queue of its pipe, see
+ *  @ref esb_set_pipe_weight.
+ *
  *  @param[in]   payload     The payload.
  *
  * @retval 0 If successful.
+ * @retval -ENOMEM If the TX FIFO or the TX queue of the pipe is full.
  *           Otherwise, a (negative) error code is returned.
  */
 int esb_write_payload(const struct esb_payload *payload);
@@ -308,6 +356,73 @@ int esb_write_payload(const struct esb_payload *payload);
  */
 int esb_read_rx_payload(struct esb_payload *payload);
 
+/** @brief Get the oldest received payload without copying it.
+ *
+ *  The payload stays in the RX FIFO until it is released with
+ *  @ref esb_rx_payload_release. Only one payload can be borrowed at a time,
+ *  and @ref esb_read_rx_payload and @ref esb_flush_rx fail while a payload
+ *  is borrowed.
+ *
+ *  @param[out] payload	Pointer to the payload in the RX FIFO.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If a payload is already borrowed.
+ * @retval -ENODATA If the RX FIFO is empty.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_rx_payload_get(struct esb_payload **payload);
+
+/** @brief Release a payload borrowed with @ref esb_rx_payload_get.
+ *
+ *  The payload is removed from the RX FIFO, and its memory can be used for
+ *  receiving again.
+ *
+ *  @param[in] payload	The borrowed payload.
+ *
+ * @retval 0 If successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_rx_payload_release(struct esb_payload *payload);
+
+/** @brief Allocate a payload in the TX FIFO.
+ *
+ *  The application fills in the length, pipe, noack, and data fields of the
+ *  payload, and queues it with @ref esb_tx_payload_submit, without copying
+ *  the payload data. Only one payload can be allocated at a time, and
+ *  @ref esb_write_payload, @ref esb_flush_tx and @ref esb_pop_tx fail while
+ *  a payload is allocated.
+ *
+ *  @param[out] payload	Pointer to the payload in the TX FIFO.
+ *
+ * @retval 0 If successful.
+ * @retval -EBUSY If a payload is already allocated.
+ * @retval -ENOMEM If the TX FIFO is full.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_tx_payload_alloc(struct esb_payload **payload);
+
+/** @brief Queue a payload allocated with @ref esb_tx_payload_alloc.
+ *
+ *  The payload is queued in the same way as with @ref esb_write_payload.
+ *  It must not be accessed after this call.
+ *
+ *  @param[in] payload	The allocated payload.
+ *
+ * @retval 0 If successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_tx_payload_submit(struct esb_payload *payload);
+
+/** @brief Return a payload allocated with @ref esb_tx_payload_alloc without
+ *         queuing it.
+ *
+ *  @param[in] payload	The allocated payload.
+ *
+ * @retval 0 If successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_tx_payload_discard(struct esb_payload *payload);
+
 /** @brief Start transmitting data.
  *
  * @retval 0 If successful.
@@ -334,13 +449,20 @@ int esb_stop_rx(void);
  * This function clears the TX FIFO buffer.
  *
  * @retval 0 If successful.
+ * @retval -EBUSY If the module is not idle, or a payload is allocated with
+ *                @ref esb_tx_payload_alloc.
  *           Otherwise, a (negative) error code is returned.
  */
 int esb_flush_tx(void);
 
 /** @brief Pop the first item from the TX buffer.
+ *
+ * This function removes the payload that would be sent next.
  *
  * @retval 0 If successful.
+ * @retval -EBUSY If the module is not idle, or a payload is allocated with
+ *                @ref esb_tx_payload_alloc.
+ * @retval -ENODATA If the TX FIFO is empty.
  *           Otherwise, a (negative) error code is returned.
  */
 int esb_pop_tx(void);
@@ -348,6 +470,7 @@ int esb_pop_tx(void);
 /** @brief Flush the RX buffer.
  *
  * @retval 0 If successful.
+ * @retval -EBUSY If a payload is borrowed with @ref esb_rx_payload_get.
  *           Otherwise, a (negative) error code is returned.
  */
 int esb_flush_rx(void);
@@ -491,6 +614,41 @@ int esb_set_bitrate(enum esb_bitrate bitrate);
  */
 int esb_reuse_pid(uint8_t pipe);
 
+/** @brief Set the transmission weight of a pipe.
+ *
+ *  Each pipe has its own TX queue. In PTX mode, the pipes with queued
+ *  payloads take turns, and a pipe sends up to its weight in payloads in its
+ *  turn. The default weight of all pipes is 1.
+ *
+ *  @param[in] pipe	Pipe.
+ *  @param[in] weight	Number of payloads sent in a turn, at least 1.
+ *
+ * @retval 0 If successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_set_pipe_weight(uint8_t pipe, uint8_t weight);
+
+/** @brief Get the statistics of a pipe.
+ *
+ *  The statistics are reset by @ref esb_init.
+ *
+ *  @param[in]  pipe	Pipe.
+ *  @param[out] stats	Statistics of the pipe.
+ *
+ * @retval 0 If successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_get_pipe_stats(uint8_t pipe, struct esb_pipe_stats *stats);
+
+/** @brief Reset the statistics of a pipe.
+ *
+ *  @param[in] pipe	Pipe.
+ *
+ * @retval 0 If successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int esb_reset_pipe_stats(uint8_t pipe);
+
 /** @} */
 
 #ifdef __cplusplus
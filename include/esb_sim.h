@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#ifndef __ESB_SIM_H
+#define __ESB_SIM_H
+
+#include <esb.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup esb_sim Enhanced ShockBurst radio simulator
+ * @{
+ * @ingroup esb
+ *
+ * @brief Simulated radio channel between the ESB module and a peer node.
+ *
+ * With @kconfig{CONFIG_ESB_RADIO_SIM}, the ESB module runs on a simulated
+ * radio instead of the RADIO peripheral. The simulated radio shares a
+ * channel with a peer node, which implements the other end of the
+ * protocol: a PRX that acknowledges the packets sent by the ESB module, or
+ * a PTX that sends packets to it.
+ *
+ * The simulation is deterministic and runs in simulated time. Nothing
+ * happens on the channel until @ref esb_sim_run is called, which processes
+ * the radio events and calls the ESB interrupt handlers, including the
+ * application event handler, from the calling thread.
+ */
+
+/** @brief Simulated channel configuration. */
+struct esb_sim_channel_config {
+	/** Probability that a packet is lost, in 1/1000. */
+	uint16_t loss_permille;
+	/** Probability that a packet is received with a CRC error,
+	 *  in 1/1000.
+	 */
+	uint16_t crc_error_permille;
+	/** Delay between sending and receiving a packet, in microseconds. */
+	uint32_t latency_us;
+	/** Seed of the random generator deciding the lost packets. */
+	uint32_t seed;
+	/** RSSI of the received packets, in -dBm. */
+	uint8_t rssi;
+};
+
+/** @brief Default channel: no losses, no latency and -60 dBm RSSI. */
+#define ESB_SIM_CHANNEL_DEFAULT_CONFIG                                         \
+	{                                                                      \
+		.loss_permille = 0,                                            \
+		.crc_error_permille = 0,                                       \
+		.latency_us = 0,                                               \
+		.seed = 1,                                                     \
+		.rssi = 60                                                     \
+	}
+
+/** @brief Peer node receive handler.
+ *
+ *  Called for each new packet that a PRX peer receives, and for each ACK
+ *  payload that a PTX peer receives.
+ *
+ *  @param[in] payload Received payload.
+ */
+typedef void (*esb_sim_peer_rx_handler)(const struct esb_payload *payload);
+
+/** @brief Peer node configuration.
+ *
+ *  The peer uses the addresses and the RF channel of the ESB module.
+ */
+struct esb_sim_peer_config {
+	/** Peer mode, the opposite of the ESB module mode. */
+	enum esb_mode mode;
+	/** Peer protocol. */
+	enum esb_protocol protocol;
+	/** Peer bitrate. */
+	enum esb_bitrate bitrate;
+	/** Static payload length, for ESB_PROTOCOL_ESB. */
+	uint8_t payload_length;
+	/** Do not acknowledge packets with the noack flag. */
+	bool selective_auto_ack;
+
+	/** PTX: pipe to send the packets on. */
+	uint8_t pipe;
+	/** PTX: number of packets to send. */
+	uint32_t packet_count;
+	/** PTX: length of the sent packets. */
+	uint8_t packet_length;
+	/** PTX: interval between the starts of two packets, in
+	 *  microseconds. The next packet is sent right away if the previous
+	 *  one took longer.
+	 */
+	uint32_t packet_interval_us;
+	/** PTX: delay between two attempts, in microseconds. */
+	uint16_t retransmit_delay;
+	/** PTX: number of retransmissions before a packet fails. */
+	uint16_t retransmit_count;
+
+	/** PRX: length of the payload sent with each ACK. */
+	uint8_t ack_payload_length;
+
+	/** Called with the received payloads, can be NULL. */
+	esb_sim_peer_rx_handler rx_handler;
+};
+
+/** @brief Default peer: a DPL PRX at 2 Mbps, without ACK payloads. */
+#define ESB_SIM_PEER_DEFAULT_CONFIG                                            \
+	{                                                                      \
+		.mode = ESB_MODE_PRX,                                          \
+		.protocol = ESB_PROTOCOL_ESB_DPL,                              \
+		.bitrate = ESB_BITRATE_2MBPS,                                  \
+		.payload_length = 32,                                          \
+		.selective_auto_ack = false,                                   \
+		.pipe = 0,                                                     \
+		.packet_count = 0,                                             \
+		.packet_length = 32,                                           \
+		.packet_interval_us = 0,                                       \
+		.retransmit_delay = 600,                                       \
+		.retransmit_count = 3,                                         \
+		.ack_payload_length = 0,                                       \
+		.rx_handler = NULL                                             \
+	}
+
+/** @brief Peer node statistics. */
+struct esb_sim_peer_stats {
+	/** PTX: packets sent, without retransmissions. */
+	uint32_t tx_packets;
+	/** PTX: packets acknowledged. */
+	uint32_t tx_success;
+	/** PTX: packets failed after all retransmissions. */
+	uint32_t tx_failed;
+	/** PTX: retransmissions. */
+	uint32_t tx_retransmits;
+	/** PTX: sum of the times from the first attempt to the ACK, in
+	 *  microseconds.
+	 */
+	uint64_t tx_latency_total_us;
+	/** PTX: longest time from the first attempt to the ACK, in
+	 *  microseconds.
+	 */
+	uint32_t tx_latency_max_us;
+	/** Packets received, without retransmissions. */
+	uint32_t rx_packets;
+	/** PRX: retransmitted packets received. */
+	uint32_t rx_retransmits;
+	/** Payload bytes received, without retransmissions. */
+	uint32_t rx_bytes;
+	/** PRX: ACKs sent with a payload. */
+	uint32_t ack_payloads;
+};
+
+/** @brief Configure the simulated channel.
+ *
+ *  Also restarts the random generator with the configured seed.
+ *
+ *  @param[in] config Channel configuration.
+ */
+void esb_sim_channel_set(const struct esb_sim_channel_config *config);
+
+/** @brief Reset the simulation.
+ *
+ *  Stops the peer, drops the pending radio events, and sets the simulated
+ *  time and the channel configuration back to their defaults. Call this
+ *  function with the ESB module disabled.
+ */
+void esb_sim_reset(void);
+
+/** @brief Run the simulation.
+ *
+ *  Processes the radio events and calls the ESB interrupt handlers until
+ *  the simulated time has advanced by the given duration.
+ *
+ *  @param[in] duration_us Duration to run, in microseconds.
+ */
+void esb_sim_run(uint32_t duration_us);
+
+/** @brief Get the simulated time.
+ *
+ *  @return Time since the last reset, in microseconds.
+ */
+uint64_t esb_sim_time_us(void);
+
+/** @brief Start the peer node.
+ *
+ *  Resets the peer statistics. A PTX peer sends its first packet right
+ *  away.
+ *
+ *  @param[in] config Peer configuration.
+ *
+ *  @retval 0       If the peer was started.
+ *  @retval -EINVAL If the configuration is invalid.
+ */
+int esb_sim_peer_start(const struct esb_sim_peer_config *config);
+
+/** @brief Stop the peer node. */
+void esb_sim_peer_stop(void);
+
+/** @brief Get the peer node statistics.
+ *
+ *  @param[out] stats Peer statistics.
+ */
+void esb_sim_peer_stats_get(struct esb_sim_peer_stats *stats);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ESB_SIM_H */
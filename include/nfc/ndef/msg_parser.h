@@ -15,6 +15,7 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <zephyr/types.h>
 #include <nfc/ndef/record_parser.h>
 #include <nfc/ndef/msg.h>
@@ -91,6 +92,108 @@ int nfc_ndef_msg_parse(const uint8_t  *result_buf,
  */
 void nfc_ndef_msg_printout(const struct nfc_ndef_msg_desc *msg_desc);
 
+struct nfc_ndef_msg_parser_stream;
+
+/** @brief Callback for the records parsed by the streaming NDEF message
+ *         parser.
+ *
+ *  The record descriptor and the record fields it points to are valid only
+ *  until the callback returns.
+ *
+ *  @param[in] parser Pointer to the streaming parser instance.
+ *  @param[in] index Index of the record in the NDEF message.
+ *  @param[in] rec_desc Pointer to the descriptor of the parsed record.
+ *  @param[in] last True if this is the last record of the NDEF message.
+ *
+ *  @retval 0 To continue parsing. Otherwise, parsing is stopped and the
+ *            (negative) error code is returned by
+ *            @ref nfc_ndef_msg_parser_stream_push.
+ */
+typedef int (*nfc_ndef_msg_parser_stream_cb_t)(
+	struct nfc_ndef_msg_parser_stream *parser,
+	uint32_t index,
+	const struct nfc_ndef_record_desc *rec_desc,
+	bool last);
+
+/** @brief Streaming NDEF message parser.
+ *
+ *  The fields of this structure are internal to the parser. Use
+ *  @ref nfc_ndef_msg_parser_stream_init to initialize it.
+ */
+struct nfc_ndef_msg_parser_stream {
+	/** Callback for the parsed records. */
+	nfc_ndef_msg_parser_stream_cb_t cb;
+
+	/** Buffer for the record that is being received. */
+	uint8_t *buf;
+
+	/** Size of the record buffer. */
+	uint32_t buf_size;
+
+	/** Number of bytes of the current record in the buffer. */
+	uint32_t buf_len;
+
+	/** Length of the current record, or 0 if its header is incomplete. */
+	uint32_t rec_len;
+
+	/** Number of records parsed. */
+	uint32_t record_count;
+
+	/** The last record of the NDEF message has been parsed. */
+	bool done;
+};
+
+/** @brief Initialize the streaming NDEF message parser.
+ *
+ *  The streaming parser consumes an NDEF message in chunks of any size,
+ *  and reports each record as soon as it is complete. Records that are
+ *  split between chunks are assembled in the record buffer, so the buffer
+ *  must be able to hold the largest expected record. Records that are
+ *  complete in a single chunk are parsed in place, without copying.
+ *
+ *  @param[out] parser Pointer to the streaming parser instance.
+ *  @param[in] buf Pointer to the record buffer.
+ *  @param[in] buf_size Size of the record buffer.
+ *  @param[in] cb Callback for the parsed records.
+ */
+void nfc_ndef_msg_parser_stream_init(struct nfc_ndef_msg_parser_stream *parser,
+				     uint8_t *buf,
+				     uint32_t buf_size,
+				     nfc_ndef_msg_parser_stream_cb_t cb);
+
+/** @brief Push a chunk of an NDEF message to the streaming parser.
+ *
+ *  The callback is called for every record that is completed by the chunk.
+ *  Data following the last record of the NDEF message is not consumed.
+ *  After an error, the parser must be initialized again.
+ *
+ *  @param[in,out] parser Pointer to the streaming parser instance.
+ *  @param[in] data Pointer to the chunk of the NDEF message.
+ *  @param[in,out] data_len As input: size of the chunk. As output: number
+ *                          of bytes consumed by the parser.
+ *
+ *  @retval 0 If the operation was successful.
+ *  @retval -ENOMEM If a record split between chunks does not fit in the
+ *                  record buffer.
+ *  @retval -EFAULT If the record location flags are invalid.
+ *            Otherwise, a (negative) error code is returned.
+ */
+int nfc_ndef_msg_parser_stream_push(struct nfc_ndef_msg_parser_stream *parser,
+				    const uint8_t *data,
+				    uint32_t *data_len);
+
+/** @brief Check if the streaming parser has parsed a whole NDEF message.
+ *
+ *  @param[in] parser Pointer to the streaming parser instance.
+ *
+ *  @retval true If the last record of the NDEF message has been parsed.
+ */
+static inline bool nfc_ndef_msg_parser_stream_done(
+	const struct nfc_ndef_msg_parser_stream *parser)
+{
+	return parser->done;
+}
+
 /**
  * @}
  */
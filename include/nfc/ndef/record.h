@@ -23,6 +23,14 @@ extern "C" {
  *
  */
 
+/** Mask of the MB flag. If set, this flag indicates the first record of
+ *  an NDEF message.
+ */
+#define NDEF_RECORD_MB_MASK                0x80
+/** Mask of the ME flag. If set, this flag indicates the last record of
+ *  an NDEF message.
+ */
+#define NDEF_RECORD_ME_MASK                0x40
 /** Mask of the ID field presence bit in the flags byte of an NDEF record. */
 #define NDEF_RECORD_IL_MASK                0x08
 /** Mask of the TNF value field in the first byte of an NDEF record. */
@@ -77,6 +77,25 @@ struct nfc_t4t_hl_procedure_cb {
 	 * @param[in] file id File Identifier.
 	 */
 	void (*ndef_updated)(uint16_t file_id);
+
+	/**@brief HL Procedure NDEF file chunk read callback.
+	 *
+	 * A chunk of the NDEF message is read. The chunks are reported in
+	 * order, without the NLEN field, as soon as they are received. They
+	 * can be passed to @ref nfc_ndef_msg_parser_stream_push to parse the
+	 * NDEF message while the rest of the NDEF file is being read.
+	 *
+	 * @param[in] file_id File Identifier.
+	 * @param[in] data Pointer to the chunk data. The data is valid only
+	 *                 until the callback returns.
+	 * @param[in] len Chunk length.
+	 *
+	 * @retval 0 To continue the NDEF Read Procedure. Otherwise, the
+	 *           procedure is stopped and the (negative) error code is
+	 *           returned by @ref nfc_t4t_hl_procedure_on_data_received.
+	 */
+	int (*ndef_chunk_read)(uint16_t file_id, const uint8_t *data,
+			       size_t len);
 };
 
 /**@brief Handle High Level Procedure received data.
@@ -142,8 +161,16 @@ int nfc_t4t_hl_procedure_ndef_file_select(uint16_t id);
  * @param[out] ndef_buff Pointer to buffer where the NDEF file will be stored.
  *                       The NDEF Read procedure is an asynchronous operation,
  *                       the data buffer have to be keep until this procedure
- *                       will be finished.
- * @param[in] ndef_len Length of NDEF file buffer.
+ *                       will be finished. Can be NULL if the
+ *                       nfc_t4t_hl_procedure_cb::ndef_chunk_read callback is
+ *                       registered. The NDEF file is then only passed to this
+ *                       callback, and the nfc_t4t_hl_procedure_cb::ndef_read
+ *                       callback is called with NULL data. If the buffer is
+ *                       provided, the next part of the NDEF file is
+ *                       requested before the current one is passed to the
+ *                       chunk callback.
+ * @param[in] ndef_len Length of NDEF file buffer. Ignored if @p ndef_buff
+ *                     is NULL.
  *
  * @retval 0 If the operation was successful.
  *           Otherwise, a (negative) error code is returned.
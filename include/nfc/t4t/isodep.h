@@ -175,6 +175,18 @@ struct nfc_t4t_isodep_cb {
  */
 int nfc_t4t_isodep_rats_send(enum nfc_t4t_isodep_fsd fsd, uint8_t did);
 
+/**@brief Get the largest frame size supported by the ISO-DEP buffers.
+ *
+ * The frame size is the largest one that fits both the TX and the RX buffer
+ * passed to @ref nfc_t4t_isodep_init. It can be passed to
+ * @ref nfc_t4t_isodep_rats_send to use the largest frames the Listener
+ * supports. Frames sent to the Listener are limited by its FSC, and by the
+ * TX buffer size.
+ *
+ * @return Largest supported frame size.
+ */
+enum nfc_t4t_isodep_fsd nfc_t4t_isodep_fsd_max_get(void);
+
 /**@brief Send a Deselect command.
  *
  * Function for sending S(DESELECT) frame according to NFC Forum
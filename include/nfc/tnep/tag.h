@@ -308,6 +308,53 @@ int nfc_tnep_tag_tx_msg_app_data(struct nfc_ndef_msg_desc *msg,
  */
 int nfc_tnep_tag_tx_msg_no_app_data(void);
 
+/**
+ * @brief Get the buffer for encoding the application data in place.
+ *
+ * Use this function instead of nfc_tnep_tag_tx_msg_app_data() to encode
+ * the application NDEF message straight into the next TX buffer, for
+ * example with nfc_ndef_msg_encode(). The message is provided to the
+ * NFC Polling Device by nfc_tnep_tag_tx_msg_buffer_swap().
+ *
+ * The buffer is one of the buffers registered with
+ * nfc_tnep_tag_tx_msg_buffer_register(), so it can also hold the last
+ * message received from the NFC Polling Device.
+ *
+ * While the buffer is taken, TNEP does not provide any messages of its own
+ * and reports -EBUSY through the error_detected callback of the service.
+ * Give the buffer back with nfc_tnep_tag_tx_msg_buffer_swap() as soon as
+ * possible. The buffer is also given back if the swap fails with a code
+ * other than -ENOMEM, or if the application data is provided with
+ * nfc_tnep_tag_tx_msg_app_data() or nfc_tnep_tag_tx_msg_no_app_data().
+ *
+ * @param[out] data Pointer to the start of the application NDEF message.
+ * @param[out] size Maximum size of the application NDEF message.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int nfc_tnep_tag_tx_msg_buffer_get(uint8_t **data, size_t *size);
+
+/**
+ * @brief Provide the application data encoded in place.
+ *
+ * This function adds the TNEP status record in front of the NDEF message
+ * encoded into the buffer from nfc_tnep_tag_tx_msg_buffer_get() and swaps
+ * the TX buffers, so that the message is provided to the NFC Polling Device.
+ *
+ * @param[in] len Length of the encoded application NDEF message. It can be
+ *                0 if the message only contains the TNEP status record.
+ * @param[in] status TNEP App data message status.
+ *
+ * @retval 0 If the operation was successful.
+ * @retval -EAGAIN If the buffer was not taken.
+ * @retval -ENOMEM If the message does not fit in the buffer. The buffer
+ *                 remains taken.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int nfc_tnep_tag_tx_msg_buffer_swap(size_t len,
+				    enum nfc_tnep_status_value status);
+
 /**
  * @brief Handle NFC Tag selected event.
  *
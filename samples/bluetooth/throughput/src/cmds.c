@@ -5,6 +5,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <bluetooth/conn.h>
 
@@ -12,6 +13,8 @@
 #include <shell/shell.h>
 #include <zephyr/types.h>
 
+#include "main.h"
+
 #define INTERVAL_MIN 0x140 /* 320 units, 400 ms */
 #define INTERVAL_MAX 0x140 /* 320 units, 400 ms */
 #define CONN_LATENCY 0
@@ -31,10 +34,23 @@ static struct test_params {
 	.data_len = BT_LE_DATA_LEN_PARAM_MAX
 };
 
-extern int test_run(const struct shell *shell,
-		    const struct bt_le_conn_param *conn_param,
-		    const struct bt_conn_le_phy_param *phy,
-		    const struct bt_conn_le_data_len_param *data_len);
+
+/* Parameter sets used by the sweep command */
+static const uint8_t sweep_phys[] = {
+	BT_GAP_LE_PHY_1M,
+	BT_GAP_LE_PHY_2M,
+};
+
+static const uint16_t sweep_data_lens[] = {
+	BT_GAP_DATA_LEN_DEFAULT,
+	BT_GAP_DATA_LEN_MAX,
+};
+
+static const uint16_t sweep_intervals[] = {
+	6,	/* 7.5 ms */
+	40,	/* 50 ms */
+	320,	/* 400 ms */
+};
 
 static const char *phy_str(const struct bt_conn_le_phy_param *phy)
 {
@@ -258,8 +274,79 @@ static int test_run_cmd(const struct shell *shell, size_t argc,
 			char **argv)
 {
 	return test_run(shell, test_params.conn_param, test_params.phy,
-			test_params.data_len);
+			test_params.data_len, NULL);
+}
+
+static int test_sweep_cmd(const struct shell *shell, size_t argc,
+			  char **argv)
+{
+	static struct test_result
+		results[ARRAY_SIZE(sweep_phys)][ARRAY_SIZE(sweep_data_lens)]
+		       [ARRAY_SIZE(sweep_intervals)];
+	struct bt_le_conn_param conn_param = {
+		.latency = CONN_LATENCY,
+		.timeout = SUPERVISION_TIMEOUT,
+	};
+	struct bt_conn_le_phy_param phy = {
+		.options = BT_CONN_LE_PHY_OPT_NONE,
+	};
+	struct bt_conn_le_data_len_param data_len = {
+		.tx_max_time = BT_GAP_DATA_TIME_MAX,
+	};
+	int err;
+
+	memset(results, 0, sizeof(results));
+
+	for (size_t i = 0; i < ARRAY_SIZE(sweep_phys); i++) {
+		phy.pref_tx_phy = sweep_phys[i];
+		phy.pref_rx_phy = sweep_phys[i];
+
+		for (size_t j = 0; j < ARRAY_SIZE(sweep_data_lens); j++) {
+			data_len.tx_max_len = sweep_data_lens[j];
+
+			for (size_t k = 0; k < ARRAY_SIZE(sweep_intervals);
+			     k++) {
+				conn_param.interval_min = sweep_intervals[k];
+				conn_param.interval_max = sweep_intervals[k];
+
+				err = test_run(shell, &conn_param, &phy,
+					       &data_len, &results[i][j][k]);
+				if (err) {
+					shell_error(shell,
+						    "Sweep aborted (err %d)",
+						    err);
+					return err;
+				}
+			}
+		}
+	}
+
+	/* Machine-readable summary */
+	shell_print(shell, "phy,data_len,conn_interval,att_mtu,bytes,"
+		    "time_ms,local_kbps,peer_kbps");
+
+	for (size_t i = 0; i < ARRAY_SIZE(sweep_phys); i++) {
+		for (size_t j = 0; j < ARRAY_SIZE(sweep_data_lens); j++) {
+			for (size_t k = 0; k < ARRAY_SIZE(sweep_intervals);
+			     k++) {
+				const struct test_result *res =
+					&results[i][j][k];
+
+				shell_print(shell, "%u,%u,%u,%u,%u,%u,%u,%u",
+					    sweep_phys[i], sweep_data_lens[j],
+					    sweep_intervals[k],
+					    CONFIG_BT_L2CAP_TX_MTU, res->bytes,
+					    res->time_ms, res->local_kbps,
+					    res->peer_kbps);
+			}
+		}
+	}
+
+	return 0;
 }
 
 SHELL_CMD_REGISTER(config, &sub_config, "Configure the example", default_cmd);
 SHELL_CMD_REGISTER(run, NULL, "Run the test", test_run_cmd);
+SHELL_CMD_REGISTER(sweep, NULL,
+		   "Run the test for all combinations of PHY, data length "
+		   "and connection interval", test_sweep_cmd);
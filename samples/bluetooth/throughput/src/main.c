@@ -25,6 +25,8 @@
 
 #include <dk_buttons_and_leds.h>
 
+#include "main.h"
+
 #define DEVICE_NAME	CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 #define INTERVAL_MIN	0x140	/* 320 units, 400 ms */
@@ -38,6 +40,7 @@ static volatile bool data_length_req;
 static volatile bool test_ready;
 static struct bt_conn *default_conn;
 static struct bt_throughput throughput;
+static uint32_t peer_write_rate;
 static struct bt_uuid *uuid128 = BT_UUID_THROUGHPUT;
 static struct bt_gatt_exchange_params exchange_params;
 static struct bt_le_conn_param *conn_param =
@@ -354,6 +357,7 @@ static uint8_t throughput_read(const struct bt_throughput_metrics *met)
 	       met->write_len, met->write_len / 1024, met->write_count,
 	       met->write_rate);
 
+	peer_write_rate = met->write_rate;
 	k_sem_give(&throughput_sem);
 
 	return BT_GATT_ITER_STOP;
@@ -382,6 +386,26 @@ static void throughput_send(const struct bt_throughput_metrics *met)
 		" in %u GATT writes at %u bps\n",
 		met->write_len, met->write_len / 1024,
 		met->write_count, met->write_rate);
+
+#if defined(CONFIG_BT_THROUGHPUT_STATS)
+	struct bt_throughput_stats stats;
+
+	if (bt_throughput_stats_get(&stats)) {
+		return;
+	}
+
+	printk("[local] %u periods: min %u bps, max %u bps, avg %u bps\n",
+	       stats.period_count, stats.rate_min, stats.rate_max,
+	       stats.rate_avg);
+	printk("[local] longest write interval %u us\n", stats.write_gap_max);
+
+	for (size_t i = 0; i < ARRAY_SIZE(stats.write_gap_hist); i++) {
+		if (stats.write_gap_hist[i]) {
+			printk("[local] write interval >= %u us: %u\n",
+			       (i == 0) ? 0U : (1U << i), stats.write_gap_hist[i]);
+		}
+	}
+#endif /* CONFIG_BT_THROUGHPUT_STATS */
 }
 
 static const struct bt_throughput_cb throughput_cb = {
@@ -506,7 +530,8 @@ static int connection_configuration_set(const struct shell *shell,
 int test_run(const struct shell *shell,
 	     const struct bt_le_conn_param *conn_param,
 	     const struct bt_conn_le_phy_param *phy,
-	     const struct bt_conn_le_data_len_param *data_len)
+	     const struct bt_conn_le_data_len_param *data_len,
+	     struct test_result *result)
 {
 	int err;
 	uint64_t stamp;
@@ -569,6 +594,7 @@ int test_run(const struct shell *shell,
 	       data, data / 1024, delta, ((uint64_t)data * 8 / delta));
 
 	/* read back char from peer */
+	peer_write_rate = 0;
 	err = bt_throughput_read(&throughput);
 	if (err) {
 		shell_error(shell, "GATT read failed (err %d)", err);
@@ -577,6 +603,13 @@ int test_run(const struct shell *shell,
 
 	k_sem_take(&throughput_sem, THROUGHPUT_CONFIG_TIMEOUT);
 
+	if (result) {
+		result->bytes = data;
+		result->time_ms = delta;
+		result->local_kbps = delta ? ((uint64_t)data * 8 / delta) : 0;
+		result->peer_kbps = peer_write_rate / 1000;
+	}
+
 	instruction_print();
 
 	return 0;
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef THROUGHPUT_MAIN_H_
+#define THROUGHPUT_MAIN_H_
+
+#include <shell/shell.h>
+#include <bluetooth/conn.h>
+
+/* Results of a single throughput test */
+struct test_result {
+	uint32_t bytes;
+	uint32_t time_ms;
+	uint32_t local_kbps;
+	uint32_t peer_kbps;
+};
+
+int test_run(const struct shell *shell,
+	     const struct bt_le_conn_param *conn_param,
+	     const struct bt_conn_le_phy_param *phy,
+	     const struct bt_conn_le_data_len_param *data_len,
+	     struct test_result *result);
+
+#endif /* THROUGHPUT_MAIN_H_ */
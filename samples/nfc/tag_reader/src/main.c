@@ -436,7 +436,7 @@ static void anticollision_completed(const struct st25r3911b_nfca_tag_info *tag_i
 		tag_type = NFC_TAG_TYPE_T4T;
 
 		/* Send RATS command */
-		err = nfc_t4t_isodep_rats_send(NFC_T4T_ISODEP_FSD_256, 0);
+		err = nfc_t4t_isodep_rats_send(nfc_t4t_isodep_fsd_max_get(), 0);
 		if (err) {
 			printk("Type 4 Tag RATS sending error %d.\n", err);
 		}
@@ -9,10 +9,62 @@
 
 LOG_MODULE_REGISTER(bt_conn_ctx, CONFIG_BT_CONN_CTX_LOG_LEVEL);
 
-static void bt_conn_ctx_mem_free(struct k_mem_slab *mem_slab, void **data)
+/* The context slot of a connection is selected by the connection index.
+ * A slot in use holds one reference owned by the connection and one
+ * reference for every user between get and release. The context data is
+ * freed when the last reference is dropped, so the lookup does not need
+ * any lock. Dropping the last reference is serialized with alloc and free
+ * by the mutex, so that alloc never sees a slot that is being freed.
+ */
+
+static bool ctx_ref_get(struct bt_conn_ctx *ctx)
 {
-	k_mem_slab_free(mem_slab, data);
-	*data = NULL;
+	atomic_val_t ref;
+
+	do {
+		ref = atomic_get(&ctx->ref);
+		if (ref == 0) {
+			return false;
+		}
+	} while (!atomic_cas(&ctx->ref, ref, ref + 1));
+
+	return true;
+}
+
+/* Must be called with the mutex locked. */
+static void ctx_ref_put(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn_ctx *ctx)
+{
+	__ASSERT_NO_MSG(atomic_get(&ctx->ref) > 0);
+
+	if (atomic_dec(&ctx->ref) == 1) {
+		void *data = ctx->data;
+
+		ctx->data = NULL;
+		k_mem_slab_free(ctx_lib->mem_slab, &data);
+
+		LOG_DBG("The context memory has been released, index: %u",
+			(unsigned int)(ctx - ctx_lib->ctx));
+	}
+}
+
+static void ctx_ref_release(struct bt_conn_ctx_lib *ctx_lib,
+			    struct bt_conn_ctx *ctx)
+{
+	atomic_val_t ref;
+
+	do {
+		ref = atomic_get(&ctx->ref);
+		__ASSERT_NO_MSG(ref > 0);
+
+		if (ref == 1) {
+			/* This may be the last reference. */
+			k_mutex_lock(ctx_lib->mutex, K_FOREVER);
+			ctx_ref_put(ctx_lib, ctx);
+			k_mutex_unlock(ctx_lib->mutex);
+
+			return;
+		}
+	} while (!atomic_cas(&ctx->ref, ref, ref - 1));
 }
 
 void *bt_conn_ctx_alloc(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
@@ -20,38 +72,45 @@ void *bt_conn_ctx_alloc(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
 	__ASSERT_NO_MSG(conn != NULL);
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 
-	int err = -ENOMEM;
-	struct bt_conn_ctx *ctx;
-
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
+	int err;
+	void *data;
+	uint8_t index = bt_conn_index(conn);
+	struct bt_conn_ctx *ctx = &ctx_lib->ctx[index];
 
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
-		ctx = &ctx_lib->ctx[i];
+	__ASSERT_NO_MSG(index < bt_conn_ctx_count(ctx_lib));
 
-		if (!ctx->conn && !ctx->data) {
-			err = k_mem_slab_alloc(ctx_lib->mem_slab,
-					       &ctx->data,
-					       K_NO_WAIT);
-			if (!err) {
-				ctx->conn = conn;
+	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
 
-				LOG_DBG("The memory for the connection context "
-					"has been allocated, conn %p, index: %u",
-					(void *)conn, i);
+	if (ctx->conn || ctx->data || atomic_get(&ctx->ref)) {
+		/* Context of the previous connection with the same index
+		 * is still in use.
+		 */
+		k_mutex_unlock(ctx_lib->mutex);
+		LOG_WRN("Context slot %u is busy", index);
 
-				return ctx->data;
+		return NULL;
+	}
 
-			} else {
-				break;
-			}
+	err = k_mem_slab_alloc(ctx_lib->mem_slab, &data, K_NO_WAIT);
+	if (err) {
+		k_mutex_unlock(ctx_lib->mutex);
+		LOG_WRN("Memory can not be allocated");
 
-		}
+		return NULL;
 	}
 
-	LOG_WRN("Memory can not be allocated");
+	ctx->data = data;
+	ctx->conn = conn;
+	/* One reference for the connection and one for the caller. */
+	atomic_set(&ctx->ref, 2);
+
 	k_mutex_unlock(ctx_lib->mutex);
 
-	return NULL;
+	LOG_DBG("The memory for the connection context "
+		"has been allocated, conn %p, index: %u",
+		(void *)conn, index);
+
+	return data;
 }
 
 int bt_conn_ctx_free(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
@@ -59,30 +118,29 @@ int bt_conn_ctx_free(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
 	__ASSERT_NO_MSG(conn != NULL);
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
+	struct bt_conn_ctx *ctx = &ctx_lib->ctx[bt_conn_index(conn)];
 
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
-		struct bt_conn_ctx *ctx = &ctx_lib->ctx[i];
-
-		if (ctx->conn == conn) {
-			bt_conn_ctx_mem_free(ctx_lib->mem_slab, &ctx->data);
-			ctx->conn = NULL;
-			ctx->data = NULL;
-
-			LOG_DBG("The context memory for the connection "
-				"has been released, conn %p index %u",
-				(void *)conn, i);
+	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
 
-			k_mutex_unlock(ctx_lib->mutex);
+	if (ctx->conn != conn) {
+		k_mutex_unlock(ctx_lib->mutex);
+		LOG_WRN("There is no allocated memory for this connection");
 
-			return 0;
-		}
+		return -EINVAL;
 	}
 
-	LOG_WRN("There is no allocated memory for this connection");
+	/* New lookups fail from now on. The memory is freed when
+	 * the last user releases the context.
+	 */
+	ctx->conn = NULL;
+	ctx_ref_put(ctx_lib, ctx);
+
 	k_mutex_unlock(ctx_lib->mutex);
 
-	return  -EINVAL;
+	LOG_DBG("The context for the connection has been freed, conn %p",
+		(void *)conn);
+
+	return 0;
 }
 
 void bt_conn_ctx_free_all(struct bt_conn_ctx_lib *ctx_lib)
@@ -91,13 +149,12 @@ void bt_conn_ctx_free_all(struct bt_conn_ctx_lib *ctx_lib)
 
 	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
 
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+	for (size_t i = 0; i < bt_conn_ctx_count(ctx_lib); i++) {
 		struct bt_conn_ctx *ctx = &ctx_lib->ctx[i];
 
-		if (ctx->data != NULL) {
-			k_mem_slab_free(ctx_lib->mem_slab, &ctx->data);
+		if (ctx->conn != NULL) {
 			ctx->conn = NULL;
-			ctx->data = NULL;
+			ctx_ref_put(ctx_lib, ctx);
 		}
 	}
 
@@ -111,23 +168,23 @@ void *bt_conn_ctx_get(struct bt_conn_ctx_lib *ctx_lib, struct bt_conn *conn)
 	__ASSERT_NO_MSG(conn != NULL);
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
-
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
-		struct bt_conn_ctx *ctx = &ctx_lib->ctx[i];
+	struct bt_conn_ctx *ctx = &ctx_lib->ctx[bt_conn_index(conn)];
 
-		if (ctx->conn == conn) {
-			LOG_DBG("Memory block found for the connection");
-
-			return ctx->data;
-		}
+	if (!ctx_ref_get(ctx)) {
+		LOG_WRN("No memory block for connection");
+		return NULL;
 	}
 
-	LOG_WRN("No memory block for connection");
+	if (ctx->conn != conn) {
+		/* The context is being freed. */
+		ctx_ref_release(ctx_lib, ctx);
+		LOG_WRN("No memory block for connection");
+		return NULL;
+	}
 
-	k_mutex_unlock(ctx_lib->mutex);
+	LOG_DBG("Memory block found for the connection");
 
-	return NULL;
+	return ctx->data;
 }
 
 const struct bt_conn_ctx *bt_conn_ctx_get_by_id(struct bt_conn_ctx_lib *ctx_lib, uint8_t id)
@@ -135,17 +192,18 @@ const struct bt_conn_ctx *bt_conn_ctx_get_by_id(struct bt_conn_ctx_lib *ctx_lib,
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 	__ASSERT_NO_MSG(id < bt_conn_ctx_count(ctx_lib));
 
-	k_mutex_lock(ctx_lib->mutex, K_FOREVER);
-
 	struct bt_conn_ctx *ctx = &ctx_lib->ctx[id];
 
-	if (ctx_lib->ctx[id].conn != NULL) {
-		return ctx;
+	if (!ctx_ref_get(ctx)) {
+		return NULL;
 	}
 
-	k_mutex_unlock(ctx_lib->mutex);
+	if (ctx->conn == NULL) {
+		ctx_ref_release(ctx_lib, ctx);
+		return NULL;
+	}
 
-	return NULL;
+	return ctx;
 }
 
 void bt_conn_ctx_release(struct bt_conn_ctx_lib *ctx_lib, void *ctx_data)
@@ -153,11 +211,11 @@ void bt_conn_ctx_release(struct bt_conn_ctx_lib *ctx_lib, void *ctx_data)
 	__ASSERT_NO_MSG(ctx_lib != NULL);
 	__ASSERT_NO_MSG(ctx_data != NULL);
 
-	for (size_t i = 0; i < CONFIG_BT_MAX_CONN; i++) {
+	for (size_t i = 0; i < bt_conn_ctx_count(ctx_lib); i++) {
 		struct bt_conn_ctx *ctx = &ctx_lib->ctx[i];
 
 		if (ctx->data == ctx_data) {
-			k_mutex_unlock(ctx_lib->mutex);
+			ctx_ref_release(ctx_lib, ctx);
 
 			return;
 		}
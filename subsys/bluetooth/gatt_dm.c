@@ -12,15 +12,17 @@
 
 LOG_MODULE_REGISTER(bt_gatt_dm, CONFIG_BT_GATT_DM_LOG_LEVEL);
 
-/* Available sizes: 128, 512, 2048... */
-#define CHUNK_DATA_SIZE (128 - sizeof(struct k_mem_block_id) \
-		- sizeof(struct data_chunk_item *))
-
 #define DATA_ALIGN 4U
 
-/* They are placed in data_chunk without padding, so they must be aligned */
+/* They are placed in the data arena without padding, so they must be aligned */
 BUILD_ASSERT(sizeof(struct bt_gatt_service_val) % DATA_ALIGN == 0);
 BUILD_ASSERT(sizeof(struct bt_gatt_chrc) % DATA_ALIGN == 0);
+BUILD_ASSERT(CONFIG_BT_GATT_DM_DATA_SIZE % DATA_ALIGN == 0);
+
+/* Hash index of the 128-bit UUIDs stored in the data arena. It is kept at
+ * most half full, so the probe sequences stay short.
+ */
+#define UUID_INDEX_SIZE (2 * CONFIG_BT_GATT_DM_MAX_ATTRS + 1)
 
 /* Flags for parsed attribute array state */
 enum {
@@ -29,14 +31,6 @@ enum {
 	STATE_NUM
 };
 
-/* One item in linked list containing dynamically allocated user data chunks */
-struct data_chunk_item {
-	/* Required by the sys_slist */
-	sys_snode_t node;
-	/* User data storage */
-	uint8_t data[CHUNK_DATA_SIZE];
-};
-
 /* The instance structure real declaration */
 struct bt_gatt_dm {
 	/* Connection object */
@@ -53,10 +47,14 @@ struct bt_gatt_dm {
 	/* Flags with the status of the attributes */
 	ATOMIC_DEFINE(state_flags, STATE_NUM);
 
-	/* Single-linked list of allocated chunks for user data */
-	sys_slist_t chunk_list;
-	/* The used length of the current chunk */
-	size_t cur_chunk_len;
+	/* Packed storage for attribute values and UUIDs */
+	uint8_t data[CONFIG_BT_GATT_DM_DATA_SIZE] __aligned(DATA_ALIGN);
+	/* The used length of the data arena */
+	size_t data_len;
+	/* Arena offsets of the stored 128-bit UUIDs plus one, 0 if unused */
+	uint16_t uuid_index[UUID_INDEX_SIZE];
+	/* The number of the used uuid_index entries */
+	size_t uuid_index_cnt;
 
 	/* The pointer to callback structure */
 	const struct bt_gatt_dm_cb *callback;
@@ -65,63 +63,39 @@ struct bt_gatt_dm {
 /* Currently only one instance is supported */
 static struct bt_gatt_dm bt_gatt_dm_inst;
 
-/* Returns pointer to newly allocated space in a dm->data_chunk */
+/* Returns pointer to newly allocated space in the dm->data arena */
 static void *user_data_alloc(struct bt_gatt_dm *dm,
 			     size_t len)
 {
 	uint8_t *user_data_loc;
-	struct data_chunk_item *item;
 
 	/* Round up len to 32 bits to make sure that return pointers are always
 	 * correctly aligned.
 	 */
 	len = ROUND_UP(len, DATA_ALIGN);
 
-	__ASSERT_NO_MSG(len <= CHUNK_DATA_SIZE);
-
-	if (sys_slist_is_empty(&dm->chunk_list) ||
-	    dm->cur_chunk_len + len > CHUNK_DATA_SIZE) {
-
-		item = k_calloc(1, sizeof(struct data_chunk_item));
-
-		if (!item) {
-			return NULL;
-		}
-
-		sys_slist_append(&dm->chunk_list, &item->node);
-		dm->cur_chunk_len = 0;
-
-	} else {
-
-		item = SYS_SLIST_PEEK_TAIL_CONTAINER(&dm->chunk_list, item,
-						     node);
-
+	if (dm->data_len + len > sizeof(dm->data)) {
+		return NULL;
 	}
 
-	user_data_loc = &item->data[dm->cur_chunk_len];
-	dm->cur_chunk_len += len;
+	user_data_loc = &dm->data[dm->data_len];
+	dm->data_len += len;
 
 	return user_data_loc;
 }
 
 static void svc_attr_memory_release(struct bt_gatt_dm *dm)
 {
-	sys_snode_t *node;
-	struct data_chunk_item *item;
-
-	LOG_DBG("Attr memory release");
+	LOG_DBG("Attr memory release, used %zu of %zu bytes",
+		dm->data_len, sizeof(dm->data));
 
 	/* Clear attributes */
 	dm->cur_attr_id = 0;
 
-	/* Release dynamic memory data chunks */
-	while (!sys_slist_is_empty(&dm->chunk_list)) {
-		node = sys_slist_get_not_empty(&dm->chunk_list);
-		item = CONTAINER_OF(node, struct data_chunk_item, node);
-		k_free(item);
-	}
-
-	dm->cur_chunk_len = 0;
+	/* The arena is reused from the beginning */
+	dm->data_len = 0;
+	memset(dm->uuid_index, 0, sizeof(dm->uuid_index));
+	dm->uuid_index_cnt = 0;
 }
 
 /* Returns size of UUID structure with padding for memory alignment */
@@ -140,14 +114,96 @@ static size_t get_uuid_size(const struct bt_uuid *uuid)
 	}
 }
 
+static size_t uuid_index_hash(const struct bt_uuid_128 *uuid)
+{
+	uint32_t hash = 2166136261U;
+
+	/* FNV-1a */
+	for (size_t i = 0; i < sizeof(uuid->val); i++) {
+		hash = (hash ^ uuid->val[i]) * 16777619U;
+	}
+
+	return hash % UUID_INDEX_SIZE;
+}
+
+/* Returns the index slot that holds the given UUID or the empty slot
+ * where it would be inserted.
+ */
+static uint16_t *uuid_index_slot(struct bt_gatt_dm *dm,
+				 const struct bt_uuid_128 *uuid)
+{
+	size_t i = uuid_index_hash(uuid);
+
+	/* The index is never full, so an empty slot ends every search */
+	while (dm->uuid_index[i]) {
+		const struct bt_uuid_128 *stored =
+			(const struct bt_uuid_128 *)&dm->data[dm->uuid_index[i] - 1];
+
+		if (!memcmp(stored->val, uuid->val, sizeof(uuid->val))) {
+			break;
+		}
+
+		i = (i + 1) % UUID_INDEX_SIZE;
+	}
+
+	return &dm->uuid_index[i];
+}
+
+/* Stores the UUID in the dm->data arena.
+ *
+ * Only 128-bit UUIDs are shared. A characteristic declaration, its value
+ * attribute and any later lookups all refer to the same UUID, so storing
+ * it once saves most of the arena space used by vendor services. They are
+ * found through a hash index, so each lookup takes constant time.
+ * Shorter UUIDs are not worth the lookup as they take 4 bytes only.
+ */
+static struct bt_uuid *uuid_store(struct bt_gatt_dm *dm,
+				  const struct bt_uuid *uuid)
+{
+	uint16_t *slot = NULL;
+
+	if (!uuid) {
+		LOG_ERR("Uninitialized UUID.");
+		return NULL;
+	}
+
+	if (uuid->type == BT_UUID_TYPE_128) {
+		slot = uuid_index_slot(dm, BT_UUID_128(uuid));
+		if (*slot) {
+			return (struct bt_uuid *)&dm->data[*slot - 1];
+		}
+	}
+
+	size_t size = get_uuid_size(uuid);
+	void *buffer = user_data_alloc(dm, size);
+
+	if (!buffer) {
+		LOG_ERR("No space for a UUID.");
+		return NULL;
+	}
+
+	memcpy(buffer, uuid, size);
+
+	/* Keep at least one slot empty. The UUID is stored anyway,
+	 * only without sharing.
+	 */
+	if (slot && (dm->uuid_index_cnt < UUID_INDEX_SIZE - 1)) {
+		*slot = (uint8_t *)buffer - dm->data + 1;
+		dm->uuid_index_cnt++;
+	}
+
+	return (struct bt_uuid *)buffer;
+}
+
 /** @brief Stores attribute in bt_gatt_dm instance.
  *
  * This function stores attr at dm->attrs array. Its UUID is stored in
- * dm->data_chunk. The Discovery Manager attribute does not contain
+ * the dm->data arena. The Discovery Manager attribute does not contain
  * a pointer to the context data. This data could be either
  * bt_gatt_service_val or bt_gatt_chrc. It is assumed that attribute context
  * data (if any) is always placed before its UUID data. For this purpose,
  * an additional buffer is allocated by this function and used later.
+ * Attributes without context data may share an already stored UUID.
  *
  * @param[in] dm             Discovery instance
  * @param[in] attr           Service attribute
@@ -169,45 +225,35 @@ static struct bt_gatt_dm_attr *attr_store(struct bt_gatt_dm *dm,
 		return NULL;
 	}
 
-	size_t uuid_size = get_uuid_size(attr->uuid);
-	uint8_t *attr_data = user_data_alloc(dm, additional_len + uuid_size);
+	struct bt_uuid *uuid;
 
-	if (!attr_data) {
-		LOG_ERR("No space for attribute data.");
-		return NULL;
+	if (additional_len) {
+		size_t uuid_size = get_uuid_size(attr->uuid);
+		uint8_t *attr_data = user_data_alloc(dm,
+						     additional_len + uuid_size);
+
+		if (!attr_data) {
+			LOG_ERR("No space for attribute data.");
+			return NULL;
+		}
+
+		uuid = (struct bt_uuid *)&attr_data[additional_len];
+		memcpy(uuid, attr->uuid, uuid_size);
+	} else {
+		uuid = uuid_store(dm, attr->uuid);
+		if (!uuid) {
+			return NULL;
+		}
 	}
 
 	cur_attr = &dm->attrs[(dm->cur_attr_id)++];
 	cur_attr->handle = attr->handle;
 	cur_attr->perm = attr->perm;
-	cur_attr->uuid = (struct bt_uuid *)&attr_data[additional_len];
-
-	memcpy(cur_attr->uuid, attr->uuid, uuid_size);
+	cur_attr->uuid = uuid;
 
 	return cur_attr;
 }
 
-static struct bt_uuid *uuid_store(struct bt_gatt_dm *dm,
-				  const struct bt_uuid *uuid)
-{
-	if (!uuid) {
-		LOG_ERR("Uninitialized UUID.");
-		return NULL;
-	}
-
-	size_t size = get_uuid_size(uuid);
-	void *buffer = user_data_alloc(dm, size);
-
-	if (!buffer) {
-		LOG_ERR("No space for a UUID.");
-		return NULL;
-	}
-
-	memcpy(buffer, uuid, size);
-
-	return (struct bt_uuid *)buffer;
-}
-
 static struct bt_gatt_dm_attr *attr_find_by_handle(
 	struct bt_gatt_dm *dm,
 	uint16_t handle)
@@ -358,14 +404,10 @@ static uint8_t discovery_process_attribute(struct bt_gatt_dm *dm,
 		return BT_GATT_ITER_STOP;
 	}
 
-	if (bt_uuid_cmp(attr->uuid, BT_UUID_GATT_CHRC) == 0) {
-		cur_attr = attr_store(dm, attr, sizeof(struct bt_gatt_chrc));
-		struct bt_gatt_chrc *cur_gatt_chrc = bt_gatt_dm_attr_chrc_val(cur_attr);
+	bool is_chrc = (bt_uuid_cmp(attr->uuid, BT_UUID_GATT_CHRC) == 0);
 
-		cur_gatt_chrc->uuid = cur_attr->uuid;
-	} else {
-		cur_attr = attr_store(dm, attr, 0);
-	}
+	cur_attr = attr_store(dm, attr,
+			      is_chrc ? sizeof(struct bt_gatt_chrc) : 0);
 
 	if (!cur_attr) {
 		LOG_ERR("Not enough memory for next attribute descriptor"
@@ -375,6 +417,12 @@ static uint8_t discovery_process_attribute(struct bt_gatt_dm *dm,
 		return BT_GATT_ITER_STOP;
 	}
 
+	if (is_chrc) {
+		struct bt_gatt_chrc *cur_gatt_chrc = bt_gatt_dm_attr_chrc_val(cur_attr);
+
+		cur_gatt_chrc->uuid = cur_attr->uuid;
+	}
+
 	return BT_GATT_ITER_CONTINUE;
 }
 
@@ -609,9 +657,7 @@ int bt_gatt_dm_start(struct bt_conn *conn,
 	dm->conn = conn;
 	dm->context = context;
 	dm->callback = cb;
-	dm->cur_attr_id = 0;
-	sys_slist_init(&dm->chunk_list);
-	dm->cur_chunk_len = 0;
+	svc_attr_memory_release(dm);
 
 	dm->discover_params.uuid = svc_uuid ? uuid_store(dm, svc_uuid) : NULL;
 	dm->discover_params.func = discovery_callback;
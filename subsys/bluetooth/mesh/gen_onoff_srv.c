@@ -221,5 +221,5 @@ int bt_mesh_onoff_srv_pub(struct bt_mesh_onoff_srv *srv,
 	BT_MESH_MODEL_BUF_DEFINE(msg, BT_MESH_ONOFF_OP_STATUS,
 				 BT_MESH_ONOFF_MSG_MAXLEN_STATUS);
 	encode_status(&msg, status);
-	return model_send(srv->model, ctx, &msg);
+	return model_status_send(srv->model, ctx, &msg);
 }
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <sys/util.h>
+#include <sys_clock.h>
+#include "light_ctrl_reg.h"
+
+/* IEEE 754 single precision layout: */
+#define FLOAT_MANT_BITS 23
+#define FLOAT_EXP_MASK 0xff
+#define FLOAT_EXP_BIAS 127
+#define FLOAT_SIGN BIT(31)
+
+/* Products beyond this saturate the 16-bit regulator output, even after the
+ * integral term has been scaled down by the regulator interval, so there's no
+ * need to represent them.
+ */
+#define Q16_LIMIT ((int64_t)UINT16_MAX << (LIGHT_CTRL_REG_Q16_SHIFT + 8))
+
+#define Q16_OUTPUT_MAX ((int64_t)UINT16_MAX << LIGHT_CTRL_REG_Q16_SHIFT)
+
+int64_t light_ctrl_reg_q16_from_sensor(const struct sensor_value *val)
+{
+	return ((int64_t)val->val1 * LIGHT_CTRL_REG_Q16_ONE) +
+	       ((int64_t)val->val2 * LIGHT_CTRL_REG_Q16_ONE) / 1000000LL;
+}
+
+int64_t light_ctrl_reg_q16_from_float(float value)
+{
+	uint32_t bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	int32_t exp = (int32_t)((bits >> FLOAT_MANT_BITS) & FLOAT_EXP_MASK);
+	uint32_t frac = bits & BIT_MASK(FLOAT_MANT_BITS);
+	int64_t mant = frac | BIT(FLOAT_MANT_BITS);
+	int64_t q16;
+
+	if (exp == FLOAT_EXP_MASK && frac) {
+		/* NaN */
+		return 0;
+	}
+
+	if (exp == 0) {
+		/* Zero or subnormal, both too small to be represented. */
+		return 0;
+	}
+
+	exp -= FLOAT_EXP_BIAS;
+
+	/* The mantissa is an integer scaled by 2^-FLOAT_MANT_BITS: */
+	int32_t shift = exp - FLOAT_MANT_BITS + LIGHT_CTRL_REG_Q16_SHIFT;
+
+	if (exp >= 31) {
+		q16 = (int64_t)INT32_MAX * LIGHT_CTRL_REG_Q16_ONE;
+	} else if (shift >= 0) {
+		q16 = mant << shift;
+	} else if (shift > -(FLOAT_MANT_BITS + 1)) {
+		q16 = mant >> -shift;
+	} else {
+		q16 = 0;
+	}
+
+	return (bits & FLOAT_SIGN) ? -q16 : q16;
+}
+
+static int64_t q16_mul(int64_t a, int64_t b)
+{
+	int64_t abs_a = (a < 0) ? -a : a;
+	int64_t abs_b = (b < 0) ? -b : b;
+
+	/* Both operands fit in 31 bits in all regular cases, and the
+	 * multiplication can't overflow. Otherwise, saturate the result
+	 * instead of wrapping around.
+	 */
+	if (((abs_a | abs_b) >> 31) && abs_a &&
+	    abs_b > (Q16_LIMIT * LIGHT_CTRL_REG_Q16_ONE) / abs_a) {
+		return ((a < 0) != (b < 0)) ? -Q16_LIMIT : Q16_LIMIT;
+	}
+
+	return CLAMP((a * b) / LIGHT_CTRL_REG_Q16_ONE, -Q16_LIMIT, Q16_LIMIT);
+}
+
+#if !defined(CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_FIXED_POINT)
+uint16_t light_ctrl_reg_step_float(
+	const struct bt_mesh_light_ctrl_srv_reg_cfg *cfg, float *i,
+	float target, float ambient, uint32_t interval, bool *idle)
+{
+	float error = target - ambient;
+
+	/* Accuracy should be in percent and both up and down: */
+	float accuracy = (cfg->accuracy * target) / (2 * 100.0f);
+
+	float input;
+	if (error > accuracy) {
+		input = error - accuracy;
+	} else if (error < -accuracy) {
+		input = error + accuracy;
+	} else {
+		input = 0.0f;
+	}
+
+	*idle = (input == 0.0f);
+
+	float kp, ki;
+	if (input >= 0) {
+		kp = cfg->kpu;
+		ki = cfg->kiu;
+	} else {
+		kp = cfg->kpd;
+		ki = cfg->kid;
+	}
+
+	*i += (input * ki) * ((float)interval / (float)MSEC_PER_SEC);
+	*i = CLAMP(*i, 0, UINT16_MAX);
+
+	float p = input * kp;
+
+	return CLAMP(*i + p, 0, UINT16_MAX);
+}
+#endif /* !defined(CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_FIXED_POINT) */
+
+uint16_t light_ctrl_reg_step_q16(
+	const struct bt_mesh_light_ctrl_srv_reg_cfg *cfg, int64_t *i,
+	int64_t target, int64_t ambient, uint32_t interval, bool *idle)
+{
+	int64_t error = target - ambient;
+
+	/* Accuracy should be in percent and both up and down: */
+	int64_t accuracy = (cfg->accuracy * target) / (2 * 100);
+
+	int64_t input;
+	if (error > accuracy) {
+		input = error - accuracy;
+	} else if (error < -accuracy) {
+		input = error + accuracy;
+	} else {
+		input = 0;
+	}
+
+	*idle = (input == 0);
+
+	int64_t kp, ki;
+	if (input >= 0) {
+		kp = light_ctrl_reg_q16_from_float(cfg->kpu);
+		ki = light_ctrl_reg_q16_from_float(cfg->kiu);
+	} else {
+		kp = light_ctrl_reg_q16_from_float(cfg->kpd);
+		ki = light_ctrl_reg_q16_from_float(cfg->kid);
+	}
+
+	*i += (q16_mul(input, ki) * interval) / MSEC_PER_SEC;
+	*i = CLAMP(*i, 0, Q16_OUTPUT_MAX);
+
+	int64_t p = q16_mul(input, kp);
+
+	return CLAMP(*i + p, 0, Q16_OUTPUT_MAX) >> LIGHT_CTRL_REG_Q16_SHIFT;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file
+ * @brief Light Lightness Control Server illuminance regulator math.
+ *
+ * The regulator step is kept free of any model state, so that the floating
+ * point and the fixed point implementations can be compared directly.
+ */
+
+#ifndef BT_MESH_LIGHT_CTRL_REG_H__
+#define BT_MESH_LIGHT_CTRL_REG_H__
+
+#include <stdbool.h>
+#include <zephyr/types.h>
+#include <sys/util.h>
+#include <bluetooth/mesh/light_ctrl_srv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of fractional bits in the fixed point regulator representation. */
+#define LIGHT_CTRL_REG_Q16_SHIFT 16
+
+/** The fixed point representation of 1.0. */
+#define LIGHT_CTRL_REG_Q16_ONE ((int64_t)1 << LIGHT_CTRL_REG_Q16_SHIFT)
+
+/** Convert an illuminance sensor value to Q16 fixed point.
+ *
+ *  @param[in] val Sensor value to convert.
+ *
+ *  @return The sensor value in Q16 fixed point.
+ */
+int64_t light_ctrl_reg_q16_from_sensor(const struct sensor_value *val);
+
+/** Convert a regulator coefficient to Q16 fixed point.
+ *
+ *  Only integer operations are used for the conversion, so this does not
+ *  require floating point support. Values outside the signed 32-bit integer
+ *  range are saturated, and NaN is treated as zero.
+ *
+ *  @param[in] value Floating point value to convert.
+ *
+ *  @return The value in Q16 fixed point.
+ */
+int64_t light_ctrl_reg_q16_from_float(float value);
+
+#if !defined(CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_FIXED_POINT)
+/** Run a single floating point regulator step.
+ *
+ *  Only available when the regulator runs in floating point.
+ *
+ *  @param[in] cfg Regulator configuration.
+ *  @param[in,out] i Integral sum.
+ *  @param[in] target Target illuminance, in lux.
+ *  @param[in] ambient Ambient illuminance, in lux.
+ *  @param[in] interval Time since the previous step, in milliseconds.
+ *  @param[out] idle Set to true if the error was within the configured
+ *  accuracy.
+ *
+ *  @return Regulator output as a linear lightness level.
+ */
+uint16_t light_ctrl_reg_step_float(
+	const struct bt_mesh_light_ctrl_srv_reg_cfg *cfg, float *i,
+	float target, float ambient, uint32_t interval, bool *idle);
+#endif
+
+/** Run a single fixed point regulator step.
+ *
+ *  Performs the same computation as @ref light_ctrl_reg_step_float, with
+ *  all illuminance values and the integral sum in Q16 fixed point.
+ *
+ *  @param[in] cfg Regulator configuration.
+ *  @param[in,out] i Integral sum, in Q16 fixed point.
+ *  @param[in] target Target illuminance, in Q16 fixed point lux.
+ *  @param[in] ambient Ambient illuminance, in Q16 fixed point lux.
+ *  @param[in] interval Time since the previous step, in milliseconds.
+ *  @param[out] idle Set to true if the error was within the configured
+ *  accuracy.
+ *
+ *  @return Regulator output as a linear lightness level.
+ */
+uint16_t light_ctrl_reg_step_q16(
+	const struct bt_mesh_light_ctrl_srv_reg_cfg *cfg, int64_t *i,
+	int64_t target, int64_t ambient, uint32_t interval, bool *idle);
+
+/** Check whether the ambient illuminance is within the regulator accuracy.
+ *
+ *  The regulator output does not change while the ambient illuminance
+ *  stays within this band around the target.
+ *
+ *  @param[in] accuracy Regulator accuracy, in percent.
+ *  @param[in] target Target illuminance.
+ *  @param[in] ambient Ambient illuminance, in the same unit as @c target.
+ *
+ *  @return true if the ambient illuminance is within the accuracy band.
+ */
+static inline bool light_ctrl_reg_in_band(uint8_t accuracy, int64_t target,
+					  int64_t ambient)
+{
+	int64_t band = (accuracy * target) / (2 * 100);
+	int64_t error = target - ambient;
+
+	return (error <= band) && (error >= -band);
+}
+
+/** Get the interval to the next regulator step.
+ *
+ *  The interval is doubled for every step where the error stays within the
+ *  configured accuracy, up to @c max, and falls back to @c min as soon as it
+ *  leaves it.
+ *
+ *  @param[in] interval Current interval, in milliseconds.
+ *  @param[in] idle Whether the error was within accuracy in the last step.
+ *  @param[in] min Regular step interval, in milliseconds.
+ *  @param[in] max Maximum step interval, in milliseconds.
+ *
+ *  @return The interval to the next step, in milliseconds.
+ */
+static inline uint32_t light_ctrl_reg_interval_next(uint32_t interval,
+						    bool idle, uint32_t min,
+						    uint32_t max)
+{
+	if (!idle) {
+		return min;
+	}
+
+	return CLAMP(interval * 2, min, max);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BT_MESH_LIGHT_CTRL_REG_H__ */
@@ -13,12 +13,14 @@
 #include "gen_onoff_internal.h"
 #include "sensor.h"
 #include "model_utils.h"
+#include "light_ctrl_reg.h"
 
 #define BT_DBG_ENABLED IS_ENABLED(CONFIG_BT_MESH_DEBUG_MODEL)
 #define LOG_MODULE_NAME bt_mesh_light_ctrl_srv
 #include "common/log.h"
 
 #define REG_INT CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_INTERVAL
+#define REG_INT_MAX CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_INTERVAL_MAX
 
 #define FLAGS_CONFIGURATION (BIT(FLAG_STARTED) | BIT(FLAG_OCC_MODE))
 
@@ -59,10 +61,24 @@ static void restart_timer(struct bt_mesh_light_ctrl_srv *srv, uint32_t delay)
 static void reg_start(struct bt_mesh_light_ctrl_srv *srv)
 {
 #if CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG
+	srv->reg.interval = REG_INT;
 	k_work_schedule(&srv->reg.timer, K_MSEC(REG_INT));
 #endif
 }
 
+static void reg_wake(struct bt_mesh_light_ctrl_srv *srv)
+{
+#if CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG
+	/* The regulator backs off while the error is within accuracy. Return
+	 * to the regular interval as soon as its inputs change.
+	 */
+	if (srv->reg.interval > REG_INT) {
+		srv->reg.interval = REG_INT;
+		k_work_reschedule(&srv->reg.timer, K_MSEC(REG_INT));
+	}
+#endif
+}
+
 static inline uint32_t to_centi_lux(const struct sensor_value *lux)
 {
 	return lux->val1 * 100L + lux->val2 / 10000L;
@@ -312,10 +328,12 @@ static uint16_t light_get(struct bt_mesh_light_ctrl_srv *srv)
 
 #if CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG
 
+#if !defined(CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_FIXED_POINT)
 static float sensor_to_float(struct sensor_value *val)
 {
 	return val->val1 + val->val2 / 1000000.0f;
 }
+#endif
 
 static void lux_get(struct bt_mesh_light_ctrl_srv *srv,
 		    struct sensor_value *lux)
@@ -339,6 +357,7 @@ static void lux_get(struct bt_mesh_light_ctrl_srv *srv,
 	from_centi_lux(centi_lux, lux);
 }
 
+#if !defined(CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_FIXED_POINT)
 static float lux_getf(struct bt_mesh_light_ctrl_srv *srv)
 {
 	if (!is_enabled(srv)) {
@@ -356,6 +375,7 @@ static float lux_getf(struct bt_mesh_light_ctrl_srv *srv)
 
 	return to_centi_lux(&srv->reg.cfg.lux[srv->state]) / 100.0f;
 }
+#endif
 
 #else
 
@@ -367,6 +387,24 @@ static void lux_get(struct bt_mesh_light_ctrl_srv *srv,
 
 #endif
 
+static void ambient_lux_set(struct bt_mesh_light_ctrl_srv *srv,
+			    const struct sensor_value *lux)
+{
+	srv->ambient_lux = *lux;
+
+#if CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG
+	struct sensor_value target;
+
+	/* Readings within the accuracy band do not move the output. */
+	lux_get(srv, &target);
+	if (!light_ctrl_reg_in_band(srv->reg.cfg.accuracy,
+				    to_centi_lux(&target),
+				    to_centi_lux(lux))) {
+		reg_wake(srv);
+	}
+#endif
+}
+
 static void transition_start(struct bt_mesh_light_ctrl_srv *srv,
 			     enum bt_mesh_light_ctrl_srv_state state,
 			     uint32_t fade_time)
@@ -375,6 +413,7 @@ static void transition_start(struct bt_mesh_light_ctrl_srv *srv,
 	srv->fade.initial_light = light_get(srv);
 	srv->fade.duration = fade_time;
 	lux_get(srv, &srv->fade.initial_lux);
+	reg_wake(srv);
 
 	atomic_set_bit(&srv->flags, FLAG_TRANSITION);
 	light_set(srv, srv->cfg.light[state], fade_time);
@@ -496,6 +535,7 @@ static void ctrl_disable(struct bt_mesh_light_ctrl_srv *srv)
 #if CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG
 	srv->reg.i = 0;
 	srv->reg.prev = 0;
+	srv->reg.interval = REG_INT;
 #endif
 
 	BT_DBG("Disable Light Control");
@@ -518,44 +558,32 @@ static void reg_step(struct k_work *work)
 	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
 	struct bt_mesh_light_ctrl_srv *srv = CONTAINER_OF(
 		dwork, struct bt_mesh_light_ctrl_srv, reg.timer);
+	bool idle;
 
 	if (!is_enabled(srv)) {
 		/* The server might be disabled asynchronously. */
 		return;
 	}
 
-	k_work_reschedule(&srv->reg.timer, K_MSEC(REG_INT));
+#if defined(CONFIG_BT_MESH_LIGHT_CTRL_SRV_REG_FIXED_POINT)
+	struct sensor_value lux;
 
-	float target = lux_getf(srv);
-	float ambient = sensor_to_float(&srv->ambient_lux);
-	float error = target - ambient;
+	lux_get(srv, &lux);
 
-	/* Accuracy should be in percent and both up and down: */
-	float accuracy = (srv->reg.cfg.accuracy * target) / (2 * 100.0f);
-
-	float input;
-	if (error > accuracy) {
-		input = error - accuracy;
-	} else if (error < -accuracy) {
-		input = error + accuracy;
-	} else {
-		input = 0.0f;
-	}
-
-	float kp, ki;
-	if (input >= 0) {
-		kp = srv->reg.cfg.kpu;
-		ki = srv->reg.cfg.kiu;
-	} else {
-		kp = srv->reg.cfg.kpd;
-		ki = srv->reg.cfg.kid;
-	}
-
-	srv->reg.i += (input * ki) * ((float)REG_INT / (float)MSEC_PER_SEC);
-	srv->reg.i = CLAMP(srv->reg.i, 0, UINT16_MAX);
+	uint16_t output = light_ctrl_reg_step_q16(
+		&srv->reg.cfg, &srv->reg.i, light_ctrl_reg_q16_from_sensor(&lux),
+		light_ctrl_reg_q16_from_sensor(&srv->ambient_lux),
+		srv->reg.interval, &idle);
+#else
+	uint16_t output = light_ctrl_reg_step_float(
+		&srv->reg.cfg, &srv->reg.i, lux_getf(srv),
+		sensor_to_float(&srv->ambient_lux), srv->reg.interval, &idle);
+#endif
 
-	float p = input * kp;
-	uint16_t output = CLAMP(srv->reg.i + p, 0, UINT16_MAX);
+	srv->reg.interval = light_ctrl_reg_interval_next(srv->reg.interval,
+							 idle, REG_INT,
+							 REG_INT_MAX);
+	k_work_reschedule(&srv->reg.timer, K_MSEC(srv->reg.interval));
 
 	/* The regulator output is always in linear format. We'll convert to
 	 * the configured representation again before calling the Lightness
@@ -985,7 +1013,7 @@ static int handle_sensor_status(struct bt_mesh_model *model, struct bt_mesh_msg_
 		BT_DBG("Sensor 0x%04x: %s", id, bt_mesh_sensor_ch_str(&value));
 
 		if (id == BT_MESH_PROP_ID_PRESENT_AMB_LIGHT_LEVEL) {
-			srv->ambient_lux = value;
+			ambient_lux_set(srv, &value);
 			continue;
 		}
 
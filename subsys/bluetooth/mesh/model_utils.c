@@ -119,6 +119,163 @@ int model_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
 	return bt_mesh_model_publish(model);
 }
 
+#if defined(CONFIG_BT_MESH_MODEL_PUB_COALESCE)
+/* Models with a pending status publication, sorted by element: */
+static struct bt_mesh_model
+	*pub_pending[CONFIG_BT_MESH_MODEL_PUB_COALESCE_COUNT];
+static uint8_t pub_pending_count;
+/* Protects the pending list and the publication buffers of the pending
+ * models. It is held while publishing, so the message can't change under
+ * bt_mesh_model_publish().
+ */
+static K_MUTEX_DEFINE(pub_lock);
+
+static void pub_pending_send(struct bt_mesh_model *model)
+{
+	int err;
+
+	err = bt_mesh_model_publish(model);
+	if (err) {
+		BT_WARN("Publishing %u:%u failed (err %d)", model->elem_idx,
+			model->mod_idx, err);
+	}
+}
+
+static void pub_flush(struct k_work *work)
+{
+	struct bt_mesh_model *model;
+
+	k_mutex_lock(&pub_lock, K_FOREVER);
+
+	while (pub_pending_count) {
+		model = pub_pending[0];
+		memmove(&pub_pending[0], &pub_pending[1],
+			--pub_pending_count * sizeof(pub_pending[0]));
+
+		pub_pending_send(model);
+	}
+
+	k_mutex_unlock(&pub_lock);
+}
+
+static K_WORK_DELAYABLE_DEFINE(pub_work, pub_flush);
+
+static size_t opcode_len(const struct net_buf_simple *buf)
+{
+	if (!buf->len) {
+		return 0;
+	}
+
+	switch (buf->data[0] >> 6) {
+	case 0:
+	case 1:
+		return 1;
+	case 2:
+		return 2;
+	default:
+		return 3;
+	}
+}
+
+static bool opcode_eq(const struct net_buf_simple *a,
+		      const struct net_buf_simple *b)
+{
+	size_t len = opcode_len(a);
+
+	return len == opcode_len(b) && len <= a->len && len <= b->len &&
+	       !memcmp(a->data, b->data, len);
+}
+
+static int pub_pending_find(const struct bt_mesh_model *model)
+{
+	for (int i = 0; i < pub_pending_count; ++i) {
+		if (pub_pending[i] == model) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static void pub_pending_insert(struct bt_mesh_model *model)
+{
+	int i = pub_pending_count;
+
+	/* Keep the publications of each element together: */
+	while (i > 0 && pub_pending[i - 1]->elem_idx > model->elem_idx) {
+		pub_pending[i] = pub_pending[i - 1];
+		i--;
+	}
+
+	pub_pending[i] = model;
+	pub_pending_count++;
+}
+
+static int pub_coalesce(struct bt_mesh_model *model,
+			struct net_buf_simple *buf)
+{
+	struct bt_mesh_model_pub *pub = model->pub;
+	int idx;
+
+	if (!pub) {
+		return -ENOTSUP;
+	}
+
+	if (pub->addr == BT_MESH_ADDR_UNASSIGNED) {
+		return -EADDRNOTAVAIL;
+	}
+
+	if (!bt_mesh_is_provisioned()) {
+		return -EAGAIN;
+	}
+
+	k_mutex_lock(&pub_lock, K_FOREVER);
+	idx = pub_pending_find(model);
+	if (idx >= 0 && !opcode_eq(pub->msg, buf)) {
+		/* The pending message shares the publication buffer with the
+		 * new one, and has to be sent before it gets overwritten:
+		 */
+		memmove(&pub_pending[idx], &pub_pending[idx + 1],
+			(--pub_pending_count - idx) * sizeof(pub_pending[0]));
+		pub_pending_send(model);
+		idx = -ENOENT;
+	}
+
+	if (idx < 0 && pub_pending_count == ARRAY_SIZE(pub_pending)) {
+		int err = model_send(model, NULL, buf);
+
+		k_mutex_unlock(&pub_lock);
+		return err;
+	}
+
+	net_buf_simple_reset(pub->msg);
+	net_buf_simple_add_mem(pub->msg, buf->data, buf->len);
+
+	if (idx < 0) {
+		pub_pending_insert(model);
+	}
+
+	k_mutex_unlock(&pub_lock);
+
+	/* Only starts the window if it isn't already running: */
+	k_work_schedule(&pub_work,
+			K_MSEC(CONFIG_BT_MESH_MODEL_PUB_COALESCE_WINDOW));
+	return 0;
+}
+#endif /* CONFIG_BT_MESH_MODEL_PUB_COALESCE */
+
+int model_status_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
+		      struct net_buf_simple *buf)
+{
+#if defined(CONFIG_BT_MESH_MODEL_PUB_COALESCE)
+	if (!ctx) {
+		return pub_coalesce(model, buf);
+	}
+#endif
+
+	return model_send(model, ctx, buf);
+}
+
 int model_ackd_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
 		    struct net_buf_simple *buf,
 		    struct bt_mesh_msg_ack_ctx *ack, uint32_t rsp_op,
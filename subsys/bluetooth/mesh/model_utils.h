@@ -42,6 +42,29 @@
 int model_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
 	       struct net_buf_simple *buf);
 
+/** @brief Send a model server status message.
+ *
+ * Works like @ref model_send, except that publications are deferred and
+ * coalesced if @kconfig{CONFIG_BT_MESH_MODEL_PUB_COALESCE} is enabled. All
+ * pending status publications are sent in element order once the coalescing
+ * window has passed, and a status published while another status of the same
+ * type is pending for the model replaces it.
+ *
+ * @param model Model to send on.
+ * @param ctx Context to send with, or NULL to publish on the configured
+ * publish parameters.
+ * @param buf Message to send.
+ *
+ * @retval 0 The message was sent or scheduled for publication successfully.
+ * @retval -ENOTSUP A message context was not provided and publishing is not
+ * supported.
+ * @retval -EADDRNOTAVAIL A message context was not provided and publishing is
+ * not configured.
+ * @retval -EAGAIN The device has not been provisioned.
+ */
+int model_status_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
+		      struct net_buf_simple *buf);
+
 /** @brief Send an acknowledged model message.
  *
  * If a message context is not provided, the message is published using the
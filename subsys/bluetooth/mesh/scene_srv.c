@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <bluetooth/mesh/access.h>
 #include <bluetooth/mesh/models.h>
 #include <sys/byteorder.h>
@@ -21,6 +22,15 @@
 /* Account for company ID in data: */
 #define VND_MODEL_SCENE_DATA_OVERHEAD sizeof(uint16_t)
 
+/* Scene page types, as stored in the settings path: */
+#define SCENE_PAGE_SIG 's'
+#define SCENE_PAGE_VND 'v'
+#define SCENE_PAGE_PACKED 'p'
+
+/* Vendor models are flagged in the model index of packed scene data: */
+#define SCENE_ENTRY_VND BIT(7)
+
+/* Scene data entry in the legacy SIG and vendor model pages. */
 struct __packed scene_data {
 	uint8_t len;
 	uint8_t elem_idx;
@@ -28,18 +38,30 @@ struct __packed scene_data {
 	uint8_t data[];
 };
 
+/* Scene data entry in the packed pages, which hold both SIG and vendor
+ * models.
+ */
+struct __packed scene_entry_data {
+	uint8_t len;
+	uint8_t elem_idx;
+	uint8_t mod;
+	uint8_t data[];
+};
+
 static sys_slist_t scene_servers;
 
-static char *scene_path(char *buf, uint16_t scene, bool vnd, uint8_t page)
+static char *scene_path(char *buf, uint16_t scene, char type, uint8_t page)
 {
-	sprintf(buf, "%x/%c%x", scene, vnd ? 'v' : 's', page);
+	sprintf(buf, "%x/%c%x", scene, type, page);
 	return buf;
 }
 
-static inline void update_page_count(struct bt_mesh_scene_srv *srv, bool vnd,
-			       uint8_t page)
+static inline void update_page_count(struct bt_mesh_scene_srv *srv, char type,
+				     uint8_t page)
 {
-	if (vnd) {
+	if (type == SCENE_PAGE_PACKED) {
+		srv->pages = MAX(page + 1, srv->pages);
+	} else if (type == SCENE_PAGE_VND) {
 		srv->vndpages = MAX(page + 1, srv->vndpages);
 	} else {
 		srv->sigpages = MAX(page + 1, srv->sigpages);
@@ -144,7 +166,7 @@ static int scene_status_send(struct bt_mesh_scene_srv *srv, struct bt_mesh_msg_c
 
 	scene_status_encode(srv, &buf, state);
 
-	return model_send(srv->model, ctx, &buf);
+	return model_status_send(srv->model, ctx, &buf);
 }
 
 static void curr_scene_state_get(struct bt_mesh_scene_srv *srv, struct bt_mesh_scene_state *state)
@@ -245,7 +267,7 @@ static int scene_register_status_send(struct bt_mesh_scene_srv *srv,
 		net_buf_simple_add_le16(&buf, srv->all[i]);
 	}
 
-	return model_send(srv->model, ctx, &buf);
+	return model_status_send(srv->model, ctx, &buf);
 }
 
 static int handle_register_get(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
@@ -293,12 +315,34 @@ static uint16_t *scene_find(struct bt_mesh_scene_srv *srv, uint16_t scene)
 	return NULL;
 }
 
+static void mod_recover(struct bt_mesh_scene_srv *srv, struct bt_mesh_model *mod,
+			bool vnd, const uint8_t data[], size_t len)
+{
+	const struct bt_mesh_scene_entry *entry;
+
+	/* MeshMDL1.0.1, section 5.1.3.1.1:
+	 * If a model is extending another model, the extending model shall determine
+	 * the Stored with Scene behavior of that model.
+	 */
+	if (bt_mesh_model_is_extended(mod)) {
+		return;
+	}
+
+	entry = entry_find(mod, vnd);
+	if (!entry) {
+		BT_WARN("No scene entry for %s:%u:%u", vnd ? "vnd" : "sig",
+			mod->elem_idx, mod->mod_idx);
+		return;
+	}
+
+	entry->recall(mod, data, len, &srv->transition);
+}
+
 static void entry_recover(struct bt_mesh_scene_srv *srv, bool vnd,
 			  const struct scene_data *data)
 {
 	const struct bt_mesh_elem *elem = &bt_mesh_comp_get()->elem[data->elem_idx];
 	const size_t overhead = vnd ? VND_MODEL_SCENE_DATA_OVERHEAD : 0;
-	const struct bt_mesh_scene_entry *entry;
 	struct bt_mesh_model *mod;
 
 	if (vnd) {
@@ -312,22 +356,7 @@ static void entry_recover(struct bt_mesh_scene_srv *srv, bool vnd,
 		return;
 	}
 
-	/* MeshMDL1.0.1, section 5.1.3.1.1:
-	 * If a model is extending another model, the extending model shall determine
-	 * the Stored with Scene behavior of that model.
-	 */
-	if (bt_mesh_model_is_extended(mod)) {
-		return;
-	}
-
-	entry = entry_find(mod, vnd);
-	if (!entry) {
-		BT_WARN("No scene entry for %s", bt_hex(&data->elem_idx, vnd ? 5 : 3));
-		return;
-	}
-
-	entry->recall(mod, &data->data[overhead], data->len - overhead,
-		      &srv->transition);
+	mod_recover(srv, mod, vnd, &data->data[overhead], data->len - overhead);
 }
 
 static void page_recover(struct bt_mesh_scene_srv *srv, bool vnd,
@@ -340,25 +369,65 @@ static void page_recover(struct bt_mesh_scene_srv *srv, bool vnd,
 	}
 }
 
+static void packed_entry_recover(struct bt_mesh_scene_srv *srv,
+				 const struct scene_entry_data *data)
+{
+	const struct bt_mesh_comp *comp = bt_mesh_comp_get();
+	const struct bt_mesh_elem *elem;
+	bool vnd = data->mod & SCENE_ENTRY_VND;
+	uint8_t mod_idx = data->mod & ~SCENE_ENTRY_VND;
+
+	if (data->elem_idx >= comp->elem_count) {
+		BT_WARN("No element %u", data->elem_idx);
+		return;
+	}
+
+	elem = &comp->elem[data->elem_idx];
+
+	if (mod_idx >= (vnd ? elem->vnd_model_count : elem->model_count)) {
+		BT_WARN("No model %s:%u:%u", vnd ? "vnd" : "sig",
+			data->elem_idx, mod_idx);
+		return;
+	}
+
+	mod_recover(srv, vnd ? &elem->vnd_models[mod_idx] : &elem->models[mod_idx],
+		    vnd, data->data, data->len);
+}
+
+static void packed_page_recover(struct bt_mesh_scene_srv *srv,
+				const uint8_t buf[], size_t len)
+{
+	size_t offset = 0;
+
+	while (offset + sizeof(struct scene_entry_data) <= len) {
+		const struct scene_entry_data *data =
+			(const struct scene_entry_data *)&buf[offset];
+
+		offset += sizeof(struct scene_entry_data) + data->len;
+		if (offset > len) {
+			BT_WARN("Truncated scene data");
+			return;
+		}
+
+		packed_entry_recover(srv, data);
+	}
+}
+
 static ssize_t entry_store(struct bt_mesh_model *mod,
 			   const struct bt_mesh_scene_entry *entry, bool vnd,
 			   uint8_t buf[])
 {
-	struct scene_data *data = (struct scene_data *)buf;
+	struct scene_entry_data *data = (struct scene_entry_data *)buf;
 	ssize_t size;
 
 	data->elem_idx = mod->elem_idx;
+	data->mod = mod->mod_idx | (vnd ? SCENE_ENTRY_VND : 0);
 
-	if (vnd) {
-		data->id = mod->vnd.id;
-		sys_put_le16(mod->vnd.company, data->data);
-		size = entry->store(mod,
-				    &data->data[VND_MODEL_SCENE_DATA_OVERHEAD]);
-		data->len = size + VND_MODEL_SCENE_DATA_OVERHEAD;
-	} else {
-		data->id = mod->id;
-		size = entry->store(mod, &data->data[0]);
-		data->len = size;
+	size = entry->store(mod, data->data);
+	if (size < 0) {
+		BT_WARN("Failed storing %s:%u:%u (%d)", vnd ? "vnd" : "sig",
+			mod->elem_idx, mod->mod_idx, size);
+		return size;
 	}
 
 	if (size > entry->maxlen) {
@@ -367,38 +436,125 @@ static ssize_t entry_store(struct bt_mesh_model *mod,
 		return -EINVAL;
 	}
 
-	if (size < 0) {
-		BT_WARN("Failed storing %s:%u:%u (%d)", vnd ? "vnd" : "sig",
-			mod->elem_idx, mod->mod_idx, size);
-		return size;
-	}
-
 	if (size == 0) {
 		/* Silently ignore this entry */
 		return 0;
 	}
 
-	return sizeof(struct scene_data) + data->len;
+	data->len = size;
+
+	return sizeof(struct scene_entry_data) + data->len;
+}
+
+struct page_cmp {
+	const uint8_t *buf;
+	size_t len;
+	bool equal;
+};
+
+static int page_cmp_load(const char *key, size_t len, settings_read_cb read_cb,
+			 void *cb_arg, void *param)
+{
+	struct page_cmp *cmp = param;
+	uint8_t stored[SCENE_PAGE_SIZE];
+	ssize_t size;
+
+	/* Entries below the page aren't part of it: */
+	if (key) {
+		return 0;
+	}
+
+	/* Some settings backends pass older versions of the entry first, so
+	 * the last call decides:
+	 */
+	cmp->equal = false;
+	if (len != cmp->len) {
+		return 0;
+	}
+
+	size = read_cb(cb_arg, stored, sizeof(stored));
+	cmp->equal = (size == (ssize_t)cmp->len &&
+		      !memcmp(stored, cmp->buf, cmp->len));
+
+	return 0;
+}
+
+/** Check whether a page is already stored with the same data. */
+static bool page_is_stored(struct bt_mesh_scene_srv *srv, const char *path,
+			   const uint8_t buf[], size_t len)
+{
+	struct page_cmp cmp = { .buf = buf, .len = len };
+	char key[32];
+
+	sprintf(key, "bt/mesh/s/%x/data/%s",
+		(srv->model->elem_idx << 8) | srv->model->mod_idx, path);
+	(void)settings_load_subtree_direct(key, page_cmp_load, &cmp);
+
+	return cmp.equal;
 }
 
 /** Store a single page of the Scene.
  *
  *  To accommodate large scene data, each scene is stored in pages of up to 256
- *  bytes.
+ *  bytes. Pages that are already stored with the same data are not written
+ *  again.
  */
-static void page_store(struct bt_mesh_scene_srv *srv, uint16_t scene,
-		       uint8_t page, bool vnd, uint8_t buf[], size_t len)
+static int page_store(struct bt_mesh_scene_srv *srv, uint16_t scene,
+		      uint8_t page, uint8_t buf[], size_t len)
 {
 	char path[9];
 	int err;
 
-	scene_path(path, scene, vnd, page);
-	update_page_count(srv, vnd, page);
+	scene_path(path, scene, SCENE_PAGE_PACKED, page);
+	update_page_count(srv, SCENE_PAGE_PACKED, page);
+
+	if (page_is_stored(srv, path, buf, len)) {
+		BT_DBG("%s unchanged", log_strdup(path));
+		return 0;
+	}
 
 	err = bt_mesh_model_data_store(srv->model, false, path, buf, len);
 	if (err) {
 		BT_ERR("Failed storing %s: %d", log_strdup(path), err);
 	}
+
+	return err;
+}
+
+static void pages_delete(struct bt_mesh_scene_srv *srv, uint16_t scene,
+			 char type, uint8_t start, uint8_t end)
+{
+	char path[9];
+
+	for (int i = start; i < end; i++) {
+		scene_path(path, scene, type, i);
+		(void)bt_mesh_model_data_store(srv->model, false, path, NULL, 0);
+	}
+}
+
+/** @brief Delete the legacy SIG and vendor model pages of a scene.
+ *
+ *  Once no scene has legacy pages left, the legacy page counts are reset, so
+ *  later stores and deletes don't touch the legacy entries anymore.
+ */
+static void legacy_pages_delete(struct bt_mesh_scene_srv *srv, uint16_t *scene)
+{
+	if (!srv->legacy[scene - srv->all]) {
+		return;
+	}
+
+	pages_delete(srv, *scene, SCENE_PAGE_SIG, 0, srv->sigpages);
+	pages_delete(srv, *scene, SCENE_PAGE_VND, 0, srv->vndpages);
+	srv->legacy[scene - srv->all] = false;
+
+	for (int i = 0; i < srv->count; i++) {
+		if (srv->legacy[i]) {
+			return;
+		}
+	}
+
+	srv->sigpages = 0;
+	srv->vndpages = 0;
 }
 
 /** @brief Get the end of the Scene server's controlled elements.
@@ -474,24 +630,36 @@ static void scene_recall_complete(struct bt_mesh_scene_srv *srv)
 	}
 }
 
-static void scene_store_mod(struct bt_mesh_scene_srv *srv, uint16_t scene,
-			    bool vnd)
+/** @brief Pack and store the scene data of all models controlled by the
+ *  Scene Server.
+ *
+ *  SIG and vendor models share the same pages, so a scene that fits in a
+ *  single page only takes a single settings entry.
+ *
+ *  @param[in] srv   Scene Server to pack the scene data of.
+ *  @param[in] scene Scene number.
+ *
+ *  @return The number of packed pages, or a negative error code if storing
+ *          failed.
+ */
+static int scene_pack(struct bt_mesh_scene_srv *srv, uint16_t scene)
 {
-	const size_t data_overhead = sizeof(struct scene_data) + (vnd ? 2 : 0);
 	const struct bt_mesh_comp *comp = bt_mesh_comp_get();
 	uint16_t elem_end = srv_elem_end(srv);
 	uint8_t buf[SCENE_PAGE_SIZE];
 	uint8_t page = 0;
 	size_t len = 0;
+	int err;
 
 	for (int i = srv->model->elem_idx; i < elem_end; i++) {
 		const struct bt_mesh_elem *elem = &comp->elem[i];
-		struct bt_mesh_model *models = vnd ? elem->vnd_models : elem->models;
-		int model_count = vnd ? elem->vnd_model_count : elem->model_count;
 
-		for (int j = 0; j < model_count; j++) {
+		for (int j = 0; j < elem->model_count + elem->vnd_model_count; j++) {
 			const struct bt_mesh_scene_entry *entry;
-			struct bt_mesh_model *mod = &models[j];
+			bool vnd = (j >= elem->model_count);
+			struct bt_mesh_model *mod = vnd ?
+				&elem->vnd_models[j - elem->model_count] :
+				&elem->models[j];
 			ssize_t size;
 
 			if (mod == srv->model) {
@@ -512,8 +680,22 @@ static void scene_store_mod(struct bt_mesh_scene_srv *srv, uint16_t scene,
 				continue;
 			}
 
-			if (len + data_overhead + entry->maxlen >= SCENE_PAGE_SIZE) {
-				page_store(srv, scene, page++, vnd, buf, len);
+			if ((mod->mod_idx & SCENE_ENTRY_VND) ||
+			    sizeof(struct scene_entry_data) + entry->maxlen >
+				    SCENE_PAGE_SIZE) {
+				BT_ERR("Entry %s:%u:%u: can't be stored",
+				       vnd ? "vnd" : "sig", mod->elem_idx,
+				       mod->mod_idx);
+				continue;
+			}
+
+			if (len + sizeof(struct scene_entry_data) + entry->maxlen >
+			    SCENE_PAGE_SIZE) {
+				err = page_store(srv, scene, page++, buf, len);
+				if (err) {
+					return err;
+				}
+
 				len = 0;
 			}
 
@@ -523,8 +705,29 @@ static void scene_store_mod(struct bt_mesh_scene_srv *srv, uint16_t scene,
 	}
 
 	if (len) {
-		page_store(srv, scene, page, vnd, buf, len);
+		err = page_store(srv, scene, page++, buf, len);
+		if (err) {
+			return err;
+		}
+	}
+
+	return page;
+}
+
+static void scene_data_store(struct bt_mesh_scene_srv *srv, uint16_t *scene)
+{
+	int pages;
+
+	pages = scene_pack(srv, *scene);
+	if (pages < 0) {
+		return;
 	}
+
+	/* Remove leftovers from larger versions of this scene, and from the
+	 * legacy storage format:
+	 */
+	pages_delete(srv, *scene, SCENE_PAGE_PACKED, pages, srv->pages);
+	legacy_pages_delete(srv, scene);
 }
 
 static enum bt_mesh_scene_status scene_store(struct bt_mesh_scene_srv *srv,
@@ -538,11 +741,12 @@ static enum bt_mesh_scene_status scene_store(struct bt_mesh_scene_srv *srv,
 			return BT_MESH_SCENE_REGISTER_FULL;
 		}
 
+		srv->legacy[srv->count] = false;
+		existing = &srv->all[srv->count];
 		srv->all[srv->count++] = scene;
 	}
 
-	scene_store_mod(srv, scene, false);
-	scene_store_mod(srv, scene, true);
+	scene_data_store(srv, existing);
 
 	srv->prev = scene;
 	srv->next = BT_MESH_SCENE_NONE;
@@ -554,19 +758,10 @@ static enum bt_mesh_scene_status scene_store(struct bt_mesh_scene_srv *srv,
 
 static void scene_delete(struct bt_mesh_scene_srv *srv, uint16_t *scene)
 {
-	uint8_t path[9];
-
 	BT_DBG("0x%x", *scene);
 
-	for (int i = 0; i < srv->sigpages; i++) {
-		scene_path(path, *scene, false, i);
-		(void)bt_mesh_model_data_store(srv->model, false, path, NULL, 0);
-	}
-
-	for (int i = 0; i < srv->vndpages; i++) {
-		scene_path(path, *scene, true, i);
-		(void)bt_mesh_model_data_store(srv->model, false, path, NULL, 0);
-	}
+	pages_delete(srv, *scene, SCENE_PAGE_PACKED, 0, srv->pages);
+	legacy_pages_delete(srv, scene);
 
 	uint16_t target = target_scene(srv);
 	uint16_t current = current_scene(srv);
@@ -582,7 +777,9 @@ static void scene_delete(struct bt_mesh_scene_srv *srv, uint16_t *scene)
 		srv->prev = BT_MESH_SCENE_NONE;
 	}
 
-	*scene = srv->all[--srv->count];
+	srv->count--;
+	srv->legacy[scene - srv->all] = srv->legacy[srv->count];
+	*scene = srv->all[srv->count];
 }
 
 static int handle_store(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
@@ -734,7 +931,7 @@ static int scene_srv_set(struct bt_mesh_model *model, const char *path,
 	uint16_t scene;
 	ssize_t size;
 	uint8_t page;
-	bool vnd;
+	char type;
 
 	BT_DBG("path: %s", log_strdup(path));
 
@@ -742,8 +939,9 @@ static int scene_srv_set(struct bt_mesh_model *model, const char *path,
 	 * the path and whether we have started the mesh, we'll handle the data
 	 * differently:
 	 *
-	 * - Path "XXXX/vYY": Scene XXXX vendor model page YY
-	 * - Path "XXXX/sYY": Scene XXXX sig model page YY
+	 * - Path "XXXX/pYY": Scene XXXX packed page YY
+	 * - Path "XXXX/vYY": Scene XXXX vendor model page YY (legacy)
+	 * - Path "XXXX/sYY": Scene XXXX sig model page YY (legacy)
 	 */
 	scene = strtol(path, NULL, 16);
 	if (scene == BT_MESH_SCENE_NONE) {
@@ -756,26 +954,33 @@ static int scene_srv_set(struct bt_mesh_model *model, const char *path,
 		return 0;
 	}
 
-	vnd = path[0] == 'v';
+	type = path[0];
 	page = strtol(&path[1], NULL, 16);
-	update_page_count(srv, vnd, page);
+	update_page_count(srv, type, page);
 
 	/* Before starting the mesh, we'll just register that the scene exists:
 	 * Once the mesh starts, we'll load the current scene, and end up in
 	 * this callback again, but bt_mesh_is_provisioned() will be true.
 	 */
 	if (!bt_mesh_is_provisioned()) {
-		if (scene_find(srv, scene)) {
-			return 0;
+		uint16_t *existing = scene_find(srv, scene);
+
+		if (!existing) {
+			if (srv->count == ARRAY_SIZE(srv->all)) {
+				BT_WARN("No room for scene 0x%x", scene);
+				return 0;
+			}
+
+			BT_DBG("Recovered scene 0x%x", scene);
+			srv->legacy[srv->count] = false;
+			existing = &srv->all[srv->count];
+			srv->all[srv->count++] = scene;
 		}
 
-		if (srv->count == ARRAY_SIZE(srv->all)) {
-			BT_WARN("No room for scene 0x%x", scene);
-			return 0;
+		if (type != SCENE_PAGE_PACKED) {
+			srv->legacy[existing - srv->all] = true;
 		}
 
-		BT_DBG("Recovered scene 0x%x", scene);
-		srv->all[srv->count++] = scene;
 		return 0;
 	}
 
@@ -786,7 +991,11 @@ static int scene_srv_set(struct bt_mesh_model *model, const char *path,
 	}
 
 	BT_DBG("0x%x: %s", scene, bt_hex(buf, size));
-	page_recover(srv, vnd, buf, size);
+	if (type == SCENE_PAGE_PACKED) {
+		packed_page_recover(srv, buf, size);
+	} else {
+		page_recover(srv, type == SCENE_PAGE_VND, buf, size);
+	}
 	return 0;
 }
 
@@ -805,6 +1014,7 @@ static void scene_srv_reset(struct bt_mesh_model *model)
 	(void)k_work_cancel_delayable(&srv->work);
 	srv->sigpages = 0;
 	srv->vndpages = 0;
+	srv->pages = 0;
 }
 
 const struct bt_mesh_model_cb _bt_mesh_scene_srv_cb = {
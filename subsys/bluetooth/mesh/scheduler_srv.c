@@ -187,24 +187,13 @@ static bool set_month(struct tm *sched_time,
 
 static int get_day_of_week(int year, int month, int day)
 {
-	int day_cnt = 0;
-
-	year += TM_START_YEAR;
-
-	for (int i = TM_START_YEAR; i < year; i++) {
-		day_cnt += is_leap_year(i) ? DAYS_LEAP_YEAR : DAYS_YEAR;
-	}
-
-	int days[12] = {31,
-		is_leap_year(year) ? 29 : 28,
-		31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-
-	for (int i = 0; i < month; i++) {
-		day_cnt += days[i];
-	}
+	/* 1900-01-01 was a Monday, which is the first day of the week in the
+	 * Schedule Register:
+	 */
+	int64_t day_cnt = days_from_civil(year + TM_START_YEAR, month + 1, day) -
+			  days_from_civil(TM_START_YEAR, 1, 1);
 
-	day_cnt += day;
-	return (day_cnt - 1) % WEEKDAY_CNT;
+	return day_cnt % WEEKDAY_CNT;
 }
 
 static bool set_day(struct tm *sched_time,
@@ -332,19 +321,99 @@ static bool set_second(struct tm *sched_time,
 	return true;
 }
 
-static uint8_t get_least_time_index(struct bt_mesh_scheduler_srv *srv)
+/* The active entries are kept in a binary min-heap, ordered by their
+ * calculated TAI-time. Entries with the same time are ordered by index.
+ */
+static bool sched_before(const struct bt_mesh_scheduler_srv *srv, uint8_t a,
+			 uint8_t b)
+{
+	if (srv->sched_tai[a].sec != srv->sched_tai[b].sec) {
+		return srv->sched_tai[a].sec < srv->sched_tai[b].sec;
+	}
+
+	return a < b;
+}
+
+static void heap_swap(struct bt_mesh_scheduler_srv *srv, uint8_t i, uint8_t j)
 {
-	uint8_t cnt = u32_count_trailing_zeros(srv->active_bitmap);
-	uint8_t idx = cnt;
+	uint8_t tmp = srv->heap[i];
+
+	srv->heap[i] = srv->heap[j];
+	srv->heap[j] = tmp;
+}
 
-	while (++cnt < BT_MESH_SCHEDULER_ACTION_ENTRY_COUNT) {
-		if (srv->active_bitmap & BIT(cnt)) {
-			idx = srv->sched_tai[idx].sec >
-				srv->sched_tai[cnt].sec ? cnt : idx;
+static void heap_sift_up(struct bt_mesh_scheduler_srv *srv, uint8_t pos)
+{
+	while (pos > 0) {
+		uint8_t parent = (pos - 1) / 2;
+
+		if (!sched_before(srv, srv->heap[pos], srv->heap[parent])) {
+			return;
 		}
+
+		heap_swap(srv, pos, parent);
+		pos = parent;
 	}
+}
+
+static void heap_sift_down(struct bt_mesh_scheduler_srv *srv, uint8_t pos)
+{
+	while (true) {
+		uint8_t least = pos;
+		uint8_t left = 2 * pos + 1;
+		uint8_t right = left + 1;
+
+		if (left < srv->heap_len &&
+		    sched_before(srv, srv->heap[left], srv->heap[least])) {
+			least = left;
+		}
+
+		if (right < srv->heap_len &&
+		    sched_before(srv, srv->heap[right], srv->heap[least])) {
+			least = right;
+		}
 
-	return MIN(BT_MESH_SCHEDULER_ACTION_ENTRY_COUNT, idx);
+		if (least == pos) {
+			return;
+		}
+
+		heap_swap(srv, pos, least);
+		pos = least;
+	}
+}
+
+static void heap_insert(struct bt_mesh_scheduler_srv *srv, uint8_t idx)
+{
+	srv->heap[srv->heap_len] = idx;
+	heap_sift_up(srv, srv->heap_len++);
+	WRITE_BIT(srv->active_bitmap, idx, 1);
+}
+
+static void heap_remove(struct bt_mesh_scheduler_srv *srv, uint8_t idx)
+{
+	uint8_t pos = 0;
+
+	if (!(srv->active_bitmap & BIT(idx))) {
+		return;
+	}
+
+	WRITE_BIT(srv->active_bitmap, idx, 0);
+
+	while (srv->heap[pos] != idx) {
+		pos++;
+	}
+
+	srv->heap[pos] = srv->heap[--srv->heap_len];
+	if (pos < srv->heap_len) {
+		heap_sift_down(srv, pos);
+		heap_sift_up(srv, pos);
+	}
+}
+
+static uint8_t get_least_time_index(struct bt_mesh_scheduler_srv *srv)
+{
+	return srv->heap_len ? srv->heap[0] :
+			       BT_MESH_SCHEDULER_ACTION_ENTRY_COUNT;
 }
 
 static void run_scheduler(struct bt_mesh_scheduler_srv *srv)
@@ -354,6 +423,11 @@ static void run_scheduler(struct bt_mesh_scheduler_srv *srv)
 	uint8_t planned_idx = get_least_time_index(srv);
 
 	if (planned_idx == BT_MESH_SCHEDULER_ACTION_ENTRY_COUNT) {
+		srv->idx = BT_MESH_SCHEDULER_ACTION_ENTRY_COUNT;
+		/* If this cancellation fails, we'll exit early from the timer
+		 * handler, as srv->idx is out of bounds.
+		 */
+		k_work_cancel_delayable(&srv->delayed_work);
 		return;
 	}
 
@@ -376,6 +450,9 @@ static void schedule_action(struct bt_mesh_scheduler_srv *srv,
 	struct tm *current_local = bt_mesh_time_srv_localtime(srv->time_srv,
 			current_uptime);
 
+	/* Remove the entry until its new time is known: */
+	heap_remove(srv, idx);
+
 	BT_DBG("Current uptime %lld", current_uptime);
 
 	BT_DBG("Current time:");
@@ -430,7 +507,7 @@ static void schedule_action(struct bt_mesh_scheduler_srv *srv,
 	BT_DBG("        minute: %d", sched_time.tm_min);
 	BT_DBG("        second: %d", sched_time.tm_sec);
 
-	WRITE_BIT(srv->active_bitmap, idx, 1);
+	heap_insert(srv, idx);
 }
 
 static void scheduled_action_handle(struct k_work *work)
@@ -445,7 +522,7 @@ static void scheduled_action_handle(struct k_work *work)
 		return;
 	}
 
-	WRITE_BIT(srv->active_bitmap, srv->idx, 0);
+	heap_remove(srv, srv->idx);
 
 	struct bt_mesh_model *next_sched_mod = NULL;
 	uint16_t model_id = srv->sch_reg[srv->idx].action ==
@@ -614,9 +691,12 @@ static int action_set(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
 	   (srv->sch_reg[idx].action == BT_MESH_SCHEDULER_SCENE_RECALL &&
 	    srv->sch_reg[idx].scene_number != 0)) {
 		schedule_action(srv, idx);
-		run_scheduler(srv);
+	} else {
+		heap_remove(srv, idx);
 	}
 
+	run_scheduler(srv);
+
 	if (srv->action_set_cb) {
 		srv->action_set_cb(srv, ctx, idx, &srv->sch_reg[idx]);
 	}
@@ -726,6 +806,7 @@ static int scheduler_srv_init(struct bt_mesh_model *model)
 	net_buf_simple_init_with_data(&srv->pub_buf, srv->pub_data,
 			sizeof(srv->pub_data));
 	srv->active_bitmap = 0;
+	srv->heap_len = 0;
 
 	srv->idx = BT_MESH_SCHEDULER_ACTION_ENTRY_COUNT;
 	k_work_init_delayable(&srv->delayed_work, scheduled_action_handle);
@@ -743,6 +824,7 @@ static void scheduler_srv_reset(struct bt_mesh_model *model)
 
 	srv->idx = BT_MESH_SCHEDULER_ACTION_ENTRY_COUNT;
 	srv->active_bitmap = 0;
+	srv->heap_len = 0;
 	/* If this cancellation fails, we'll exit early from the timer handler,
 	 * as srv->idx is out of bounds.
 	 */
@@ -287,7 +287,12 @@ int sensor_column_encode(struct net_buf_simple *buf,
 		return err;
 	}
 
-	err = sensor->series.get(sensor, ctx, col, values);
+	if (sensor->series.get) {
+		err = sensor->series.get(sensor, ctx, col, values);
+	} else {
+		err = sensor_series_store_get(sensor, col, values);
+	}
+
 	if (err) {
 		return err;
 	}
@@ -547,6 +552,103 @@ bool bt_mesh_sensor_value_in_column(const struct sensor_value *value,
 		(value->val1 == col->end.val1 && value->val2 <= col->end.val2));
 }
 
+int bt_mesh_sensor_series_sample_add(struct bt_mesh_sensor *sensor,
+				     const struct sensor_value *x,
+				     const struct sensor_value *value)
+{
+	struct bt_mesh_sensor_series_store *store = sensor->series.store;
+	int64_t mill = SENSOR_MILL(value);
+	int err = -ENOENT;
+
+	if (!store) {
+		return -ENOTSUP;
+	}
+
+	for (uint32_t i = 0; i < sensor->series.column_count; i++) {
+		struct bt_mesh_sensor_series_entry *entry = &store->entries[i];
+
+		if (!bt_mesh_sensor_value_in_column(x,
+						    &sensor->series.columns[i])) {
+			continue;
+		}
+
+		if (entry->count == 0) {
+			entry->min = mill;
+			entry->max = mill;
+		} else {
+			entry->min = MIN(entry->min, mill);
+			entry->max = MAX(entry->max, mill);
+		}
+
+		if (store->window && entry->count >= store->window) {
+			/* The new sample replaces one mean sample, so the
+			 * column keeps an exponential moving average.
+			 */
+			entry->sum -= entry->sum / entry->count;
+		} else {
+			entry->count++;
+		}
+
+		entry->sum += mill;
+
+		err = 0;
+	}
+
+	return err;
+}
+
+void bt_mesh_sensor_series_store_reset(struct bt_mesh_sensor *sensor)
+{
+	struct bt_mesh_sensor_series_store *store = sensor->series.store;
+
+	if (store) {
+		memset(store->entries, 0,
+		       sensor->series.column_count * sizeof(*store->entries));
+	}
+}
+
+static void sensor_value_from_mill(struct sensor_value *value, int64_t mill)
+{
+	value->val1 = mill / 1000000LL;
+	value->val2 = mill % 1000000LL;
+}
+
+int sensor_series_store_get(const struct bt_mesh_sensor *sensor,
+			    const struct bt_mesh_sensor_column *col,
+			    struct sensor_value *value)
+{
+	const struct bt_mesh_sensor_series_store *store = sensor->series.store;
+	const struct bt_mesh_sensor_series_entry *entry =
+		&store->entries[col - sensor->series.columns];
+	int64_t mill = 0;
+
+	memset(value, 0, sizeof(*value) * sensor->type->channel_count);
+
+	if (entry->count) {
+		switch (store->aggr) {
+		case BT_MESH_SENSOR_SERIES_AGGR_MIN:
+			mill = entry->min;
+			break;
+		case BT_MESH_SENSOR_SERIES_AGGR_MAX:
+			mill = entry->max;
+			break;
+		default:
+			mill = entry->sum / entry->count;
+			break;
+		}
+	}
+
+	sensor_value_from_mill(&value[0], mill);
+
+	/* The remaining channels of the series types are the column bounds. */
+	if (sensor->type->channel_count > 2) {
+		value[1] = col->start;
+		value[2] = col->end;
+	}
+
+	return 0;
+}
+
 void sensor_cadence_update(struct bt_mesh_sensor *sensor,
 			   const struct sensor_value *value)
 {
@@ -154,6 +154,9 @@ int sensor_ch_decode(struct net_buf_simple *buf,
 		     const struct bt_mesh_sensor_format *format,
 		     struct sensor_value *value);
 
+int sensor_series_store_get(const struct bt_mesh_sensor *sensor,
+			    const struct bt_mesh_sensor_column *col,
+			    struct sensor_value *value);
 int sensor_column_encode(struct net_buf_simple *buf,
 			 struct bt_mesh_sensor *sensor,
 			 struct bt_mesh_msg_ctx *ctx,
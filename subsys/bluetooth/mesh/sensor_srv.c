@@ -254,7 +254,8 @@ static int handle_column_get(struct bt_mesh_model *model, struct bt_mesh_msg_ctx
 	struct sensor_value col_x;
 
 	col_format = bt_mesh_sensor_column_format_get(sensor->type);
-	if (!col_format || !sensor->series.columns || !sensor->series.get) {
+	if (!col_format || !sensor->series.columns ||
+	    (!sensor->series.get && !sensor->series.store)) {
 		BT_WARN("No series support in 0x%04x", sensor->type->id);
 		goto respond;
 	}
@@ -308,7 +309,8 @@ static int handle_series_get(struct bt_mesh_model *model, struct bt_mesh_msg_ctx
 	}
 
 	col_format = bt_mesh_sensor_column_format_get(sensor->type);
-	if (!col_format || !sensor->series.columns || !sensor->series.get) {
+	if (!col_format || !sensor->series.columns ||
+	    (!sensor->series.get && !sensor->series.store)) {
 		BT_WARN("No series support in 0x%04x", sensor->type->id);
 		goto respond;
 	}
@@ -11,36 +11,56 @@
 #include <sys/util.h>
 #include "time_util.h"
 
-static const uint8_t month_cfg[12] = { 31, 28, 31, 30, 31, 30,
-				    31, 31, 30, 31, 30, 31 };
-static const uint8_t month_leap_cfg[12] = { 31, 29, 31, 30, 31, 30,
-					 31, 31, 30, 31, 30, 31 };
+/* Number of days in a 400 year Gregorian calendar cycle. */
+#define DAYS_PER_ERA 146097
+/* Days from 0000-03-01 to 1970-01-01. */
+#define DAYS_TO_EPOCH 719468
+
+/* The calendar computations below count years from March 1st, so that the
+ * leap day is the last day of the year. See
+ * http://howardhinnant.github.io/date_algorithms.html for the derivation.
+ */
+int64_t days_from_civil(int32_t year, uint32_t month, int32_t mday)
+{
+	int64_t y = (int64_t)year - (month <= 2);
+	int64_t era = (y >= 0 ? y : y - 399) / 400;
+	uint32_t yoe = y - era * 400;
+	uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5;
+	uint32_t doe = yoe * DAYS_YEAR + yoe / 4 - yoe / 100 + doy;
+
+	return era * DAYS_PER_ERA + doe - DAYS_TO_EPOCH + (mday - 1);
+}
+
+void civil_from_days(int64_t days, int32_t *year, uint32_t *month,
+		     uint32_t *mday)
+{
+	days += DAYS_TO_EPOCH;
+
+	int64_t era = (days >= 0 ? days : days - (DAYS_PER_ERA - 1)) /
+		      DAYS_PER_ERA;
+	uint32_t doe = days - era * DAYS_PER_ERA;
+	uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) /
+		       DAYS_YEAR;
+	uint32_t doy = doe - (yoe * DAYS_YEAR + yoe / 4 - yoe / 100);
+	uint32_t mp = (5 * doy + 2) / 153;
+
+	*mday = doy - (153 * mp + 2) / 5 + 1;
+	*month = mp < 10 ? mp + 3 : mp - 9;
+	*year = yoe + era * 400 + (*month <= 2);
+}
 
 int ts_to_tai(struct bt_mesh_time_tai *tai, struct tm *timeptr)
 {
 	uint32_t current_year = timeptr->tm_year + TM_START_YEAR;
-	uint32_t days = 0;
+	int64_t days;
 
 	if (current_year < TAI_START_YEAR) {
 		return -EAGAIN;
 	}
 
-	for (int year = TAI_START_YEAR; year < current_year; year++) {
-		if (is_leap_year(year)) {
-			days += DAYS_LEAP_YEAR;
-		} else {
-			days += DAYS_YEAR;
-		}
-	}
-
-	const uint8_t *months =
-		is_leap_year(current_year) ? month_leap_cfg : month_cfg;
-
-	for (int i = 0; i < timeptr->tm_mon; i++) {
-		days += months[i];
-	}
-
-	days += timeptr->tm_mday - 1;
+	days = days_from_civil(current_year, timeptr->tm_mon + 1,
+			       timeptr->tm_mday) -
+	       days_from_civil(TAI_START_YEAR, 1, 1);
 
 	tai->sec = (days * SEC_PER_DAY);
 	tai->sec += ((uint64_t)timeptr->tm_hour * SEC_PER_HOUR);
@@ -53,8 +73,10 @@ int ts_to_tai(struct bt_mesh_time_tai *tai, struct tm *timeptr)
 void tai_to_ts(const struct bt_mesh_time_tai *tai, struct tm *timeptr)
 {
 	uint64_t day_cnt = tai->sec / SEC_PER_DAY;
-	bool is_leap;
-	uint32_t year;
+	int64_t days = day_cnt + days_from_civil(TAI_START_YEAR, 1, 1);
+	uint32_t month;
+	uint32_t mday;
+	int32_t year;
 
 	timeptr->tm_hour = (tai->sec % SEC_PER_DAY) / SEC_PER_HOUR;
 	timeptr->tm_min = (tai->sec % SEC_PER_HOUR) / SEC_PER_MIN;
@@ -62,29 +84,10 @@ void tai_to_ts(const struct bt_mesh_time_tai *tai, struct tm *timeptr)
 	timeptr->tm_wday = (TAI_START_DAY + day_cnt) % WEEKDAY_CNT;
 	timeptr->tm_isdst = -1;
 
-	for (year = TAI_START_YEAR;; year++) {
-		is_leap = is_leap_year(year);
-
-		uint32_t days_in_year = is_leap ? DAYS_LEAP_YEAR : DAYS_YEAR;
-
-		if (days_in_year > day_cnt) {
-			break;
-		}
-
-		day_cnt -= days_in_year;
-	}
+	civil_from_days(days, &year, &month, &mday);
 
-	timeptr->tm_yday = day_cnt;
+	timeptr->tm_yday = days - days_from_civil(year, 1, 1);
 	timeptr->tm_year = year - TM_START_YEAR;
-
-	const uint8_t *months = is_leap ? month_leap_cfg : month_cfg;
-
-	for (timeptr->tm_mon = 0;
-	     timeptr->tm_mon < ARRAY_SIZE(month_cfg) &&
-	     months[timeptr->tm_mon] <= day_cnt;
-	     timeptr->tm_mon++) {
-		day_cnt -= months[timeptr->tm_mon];
-	}
-
-	timeptr->tm_mday = day_cnt + 1;
+	timeptr->tm_mon = month - 1;
+	timeptr->tm_mday = mday;
 }
@@ -35,6 +35,32 @@ static inline bool is_leap_year(uint32_t year)
 	       (((year % 100) != 0) || ((year % 400) == 0));
 }
 
+/** @brief Get the number of days between 1970-01-01 and the given date.
+ *
+ *  Uses the proleptic Gregorian calendar. The day of month is not checked
+ *  against the length of the month, so days past the end of the month
+ *  continue into the next month.
+ *
+ *  @param year  Year, e.g. 2021.
+ *  @param month Month, starting at 1 for January.
+ *  @param mday  Day of month, starting at 1.
+ *
+ *  @return Number of days since 1970-01-01, negative for earlier dates.
+ */
+int64_t days_from_civil(int32_t year, uint32_t month, int32_t mday);
+
+/** @brief Get the date that is the given number of days after 1970-01-01.
+ *
+ *  Inverse of @ref days_from_civil.
+ *
+ *  @param days       Number of days since 1970-01-01.
+ *  @param[out] year  Year, e.g. 2021.
+ *  @param[out] month Month, starting at 1 for January.
+ *  @param[out] mday  Day of month, starting at 1.
+ */
+void civil_from_days(int64_t days, int32_t *year, uint32_t *month,
+		     uint32_t *mday);
+
 void tai_to_ts(const struct bt_mesh_time_tai *tai, struct tm *timeptr);
 int ts_to_tai(struct bt_mesh_time_tai *tai, struct tm *timeptr);
 
@@ -28,7 +28,12 @@ static void bt_rand_rpc_rsp(CborValue *value, void *handler_data)
 	ser_decode_buffer(value, res->buf, sizeof(uint8_t) * res->len);
 }
 
-int bt_rand(void *buf, size_t len)
+/* The host keeps the random data in the scratchpad and in the response,
+ * both on the stack of its decoding thread, so it is requested in chunks.
+ */
+#define BT_RAND_CHUNK_SIZE_MAX (CONFIG_BT_RPC_SCRATCHPAD_SIZE_MAX / 2)
+
+static int bt_rand_chunk(void *buf, size_t len)
 {
 	struct nrf_rpc_cbor_ctx ctx;
 	struct bt_rand_rpc_res result;
@@ -50,6 +55,27 @@ int bt_rand(void *buf, size_t len)
 	return result.result;
 }
 
+int bt_rand(void *buf, size_t len)
+{
+	uint8_t *chunk = buf;
+	size_t chunk_len;
+	int err;
+
+	do {
+		chunk_len = MIN(len, BT_RAND_CHUNK_SIZE_MAX);
+
+		err = bt_rand_chunk(chunk, chunk_len);
+		if (err) {
+			return err;
+		}
+
+		chunk += chunk_len;
+		len -= chunk_len;
+	} while (len > 0);
+
+	return 0;
+}
+
 int bt_encrypt_le(const uint8_t key[16], const uint8_t plaintext[16],
 		  uint8_t enc_data[16])
 {
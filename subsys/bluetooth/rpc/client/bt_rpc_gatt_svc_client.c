@@ -186,6 +186,10 @@ static void bt_rpc_gatt_attr_read_cb_rpc_handler(CborValue *value, void *handler
 	service_index = ser_decode_uint(value);
 	len = ser_decode_uint(value);
 	offset = ser_decode_uint(value);
+	buf = ser_scratchpad_add(&scratchpad, len);
+	if (buf == NULL) {
+		goto decoding_error;
+	}
 
 	if (!ser_decoding_done_and_check(value)) {
 		goto decoding_error;
@@ -196,8 +200,6 @@ static void bt_rpc_gatt_attr_read_cb_rpc_handler(CborValue *value, void *handler
 		LOG_WRN("Service database may not be synchronized with client");
 		read_len = BT_GATT_ERR(BT_ATT_ERR_ATTRIBUTE_NOT_FOUND);
 	} else {
-		buf = ser_scratchpad_add(&scratchpad, len);
-
 		if (attr->read) {
 			read_len = attr->read(conn, attr, buf, len, offset);
 		}
@@ -616,11 +618,13 @@ int bt_gatt_service_unregister(struct bt_gatt_service *svc)
 size_t bt_gatt_notify_params_buf_size(const struct bt_gatt_notify_params *data)
 {
 
-	size_t buffer_size_max = 23;
+	size_t buffer_size_max = SER_UINT32_SIZE_MAX + SER_UINT16_SIZE_MAX +
+				 SER_CALLBACK_SIZE_MAX + SER_UINT32_SIZE_MAX;
 
-	buffer_size_max += sizeof(uint8_t) * data->len;
+	buffer_size_max += SER_BUFFER_SIZE(sizeof(uint8_t) * data->len);
 
-	buffer_size_max += data->len;
+	buffer_size_max += data->uuid ? SER_BUFFER_SIZE(bt_uuid_buf_size(data->uuid)) :
+					SER_SIMPLE_SIZE;
 
 	return buffer_size_max;
 
@@ -633,7 +637,7 @@ size_t bt_gatt_notify_params_sp_size(const struct bt_gatt_notify_params *data)
 
 	scratchpad_size += SCRATCHPAD_ALIGN(sizeof(uint8_t) * data->len);
 
-	scratchpad_size += data->len;
+	scratchpad_size += data->uuid ? SCRATCHPAD_ALIGN(bt_uuid_buf_size(data->uuid)) : 0;
 
 	return scratchpad_size;
 
@@ -656,13 +660,163 @@ void bt_gatt_notify_params_enc(CborEncoder *encoder, const struct bt_gatt_notify
 
 }
 
+#if defined(CONFIG_BT_RPC_GATT_NOTIFY_BATCH)
+struct notify_batch_entry {
+	struct bt_conn *conn;
+	struct bt_gatt_notify_params params;
+	struct bt_uuid_128 uuid;
+};
+
+static struct {
+	struct notify_batch_entry entries[CONFIG_BT_RPC_GATT_NOTIFY_BATCH_COUNT];
+	uint8_t data[CONFIG_BT_RPC_GATT_NOTIFY_BATCH_DATA_SIZE];
+	size_t count;
+	size_t data_len;
+	size_t buffer_size;
+	size_t scratchpad_size;
+} notify_batch;
+
+static K_MUTEX_DEFINE(notify_batch_lock);
+/* The host grants the credits after bt_enable(). */
+static K_SEM_DEFINE(notify_credits, 0, CONFIG_BT_RPC_GATT_NOTIFY_CREDITS);
+
+/* Must be called with notify_batch_lock held. */
+static void notify_batch_flush(void)
+{
+	struct nrf_rpc_cbor_ctx ctx;
+	size_t buffer_size_max = 2 * SER_UINT32_SIZE_MAX + notify_batch.buffer_size;
+
+	if (notify_batch.count == 0) {
+		return;
+	}
+
+	NRF_RPC_CBOR_ALLOC(ctx, buffer_size_max);
+
+	ser_encode_uint(&ctx.encoder, notify_batch.scratchpad_size);
+	ser_encode_uint(&ctx.encoder, notify_batch.count);
+
+	for (size_t i = 0; i < notify_batch.count; i++) {
+		struct notify_batch_entry *entry = &notify_batch.entries[i];
+
+		bt_rpc_encode_bt_conn(&ctx.encoder, entry->conn);
+		bt_gatt_notify_params_enc(&ctx.encoder, &entry->params);
+	}
+
+	nrf_rpc_cbor_evt_no_err(&bt_rpc_grp, BT_GATT_NOTIFY_BATCH_RPC_EVT, &ctx);
+
+	for (size_t i = 0; i < notify_batch.count; i++) {
+		if (notify_batch.entries[i].conn) {
+			bt_conn_unref(notify_batch.entries[i].conn);
+		}
+	}
+
+	notify_batch.count = 0;
+	notify_batch.data_len = 0;
+	notify_batch.buffer_size = 0;
+	notify_batch.scratchpad_size = 0;
+}
+
+static void notify_batch_send(void)
+{
+	k_mutex_lock(&notify_batch_lock, K_FOREVER);
+	notify_batch_flush();
+	k_mutex_unlock(&notify_batch_lock);
+}
+
+static void notify_batch_work_handler(struct k_work *work)
+{
+	notify_batch_send();
+}
+
+static K_WORK_DEFINE(notify_batch_work, notify_batch_work_handler);
+
+static int notify_batch_add(struct bt_conn *conn,
+			    const struct bt_gatt_notify_params *params)
+{
+	struct notify_batch_entry *entry;
+
+	/* Each notification takes one ACL buffer on the host. */
+	if (k_sem_take(&notify_credits, K_NO_WAIT)) {
+		return -ENOMEM;
+	}
+
+	k_mutex_lock(&notify_batch_lock, K_FOREVER);
+
+	if ((notify_batch.data_len + params->len > sizeof(notify_batch.data)) ||
+	    (notify_batch.scratchpad_size + bt_gatt_notify_params_sp_size(params) >
+	     CONFIG_BT_RPC_SCRATCHPAD_SIZE_MAX)) {
+		notify_batch_flush();
+	}
+
+	entry = &notify_batch.entries[notify_batch.count];
+
+	/* Keep the connection object valid until the batch is encoded. */
+	entry->conn = conn ? bt_conn_ref(conn) : NULL;
+	entry->params = *params;
+	entry->params.data = &notify_batch.data[notify_batch.data_len];
+	memcpy(&notify_batch.data[notify_batch.data_len], params->data, params->len);
+
+	if (params->uuid) {
+		memcpy(&entry->uuid, params->uuid, bt_uuid_buf_size(params->uuid));
+		entry->params.uuid = &entry->uuid.uuid;
+	}
+
+	notify_batch.count++;
+	notify_batch.data_len += params->len;
+	notify_batch.buffer_size += SER_UINT8_SIZE_MAX + bt_gatt_notify_params_buf_size(params);
+	notify_batch.scratchpad_size += bt_gatt_notify_params_sp_size(params);
+
+	if (notify_batch.count == ARRAY_SIZE(notify_batch.entries)) {
+		notify_batch_flush();
+	} else {
+		/* Notifications queued before the work runs share the event. */
+		k_work_submit(&notify_batch_work);
+	}
+
+	k_mutex_unlock(&notify_batch_lock);
+
+	return 0;
+}
+
+static void bt_gatt_notify_credits_rpc_handler(CborValue *value, void *handler_data)
+{
+	uint32_t credits;
+
+	credits = ser_decode_uint(value);
+
+	if (!ser_decoding_done_and_check(value)) {
+		goto decoding_error;
+	}
+
+	while (credits--) {
+		k_sem_give(&notify_credits);
+	}
+
+	return;
+decoding_error:
+	report_decoding_error(BT_GATT_NOTIFY_CREDITS_RPC_EVT, handler_data);
+}
+
+NRF_RPC_CBOR_EVT_DECODER(bt_rpc_grp, bt_gatt_notify_credits, BT_GATT_NOTIFY_CREDITS_RPC_EVT,
+			 bt_gatt_notify_credits_rpc_handler, NULL);
+#endif /* defined(CONFIG_BT_RPC_GATT_NOTIFY_BATCH) */
+
 int bt_gatt_notify_cb(struct bt_conn *conn,
 		      struct bt_gatt_notify_params *params)
 {
 	struct nrf_rpc_cbor_ctx ctx;
 	int result;
 	size_t scratchpad_size = 0;
-	size_t buffer_size_max = 8;
+	size_t buffer_size_max = SER_UINT32_SIZE_MAX + SER_UINT8_SIZE_MAX;
+
+#if defined(CONFIG_BT_RPC_GATT_NOTIFY_BATCH)
+	if (params->len <= sizeof(notify_batch.data)) {
+		return notify_batch_add(conn, params);
+	}
+
+	/* Keep the order of the notifications. */
+	notify_batch_send();
+#endif
 
 	buffer_size_max += bt_gatt_notify_params_buf_size(params);
 
@@ -708,7 +862,7 @@ size_t bt_gatt_indicate_params_sp_size(const struct bt_gatt_indicate_params *dat
 
 	scratchpad_size += SCRATCHPAD_ALIGN(sizeof(uint8_t) * data->len);
 
-	scratchpad_size += data->uuid ? bt_uuid_buf_size(data->uuid) : 0;
+	scratchpad_size += data->uuid ? SCRATCHPAD_ALIGN(bt_uuid_buf_size(data->uuid)) : 0;
 
 	return scratchpad_size;
 
@@ -717,11 +871,12 @@ size_t bt_gatt_indicate_params_sp_size(const struct bt_gatt_indicate_params *dat
 size_t bt_gatt_indicate_params_buf_size(const struct bt_gatt_indicate_params *data)
 {
 
-	size_t buffer_size_max = 15;
+	size_t buffer_size_max = SER_UINT32_SIZE_MAX + SER_UINT16_SIZE_MAX + SER_UINT8_SIZE_MAX;
 
-	buffer_size_max += sizeof(uint8_t) * data->len;
+	buffer_size_max += SER_BUFFER_SIZE(sizeof(uint8_t) * data->len);
 
-	buffer_size_max += data->uuid ? bt_uuid_buf_size(data->uuid) : 1;
+	buffer_size_max += data->uuid ? SER_BUFFER_SIZE(bt_uuid_buf_size(data->uuid)) :
+					SER_SIMPLE_SIZE;
 
 	return buffer_size_max;
 
@@ -751,6 +906,11 @@ int bt_gatt_indicate(struct bt_conn *conn, struct bt_gatt_indicate_params *param
 	size_t buffer_size_max = 13;
 	uintptr_t params_addr = (uintptr_t)params;
 
+#if defined(CONFIG_BT_RPC_GATT_NOTIFY_BATCH)
+	/* Queued notifications must not be overtaken by the indication. */
+	notify_batch_send();
+#endif
+
 	buffer_size_max += bt_gatt_indicate_params_buf_size(params);
 	scratchpad_size += bt_gatt_indicate_params_sp_size(params);
 
@@ -192,6 +192,7 @@ struct check_list_entry {
 #define DEF_CONFIG_BT_EXT_ADV_MAX_ADV_SET 0xFF,
 #define DEF_CONFIG_BT_DEVICE_NAME_MAX 0xFF,
 #define DEF_CONFIG_BT_PER_ADV_SYNC_MAX 0xFF,
+#define DEF_CONFIG_BT_RPC_GATT_NOTIFY_BATCH_COUNT 0xFF,
 
 static const CHECK_LIST_ENTRY_TYPE check_table[] = {
 	CHECK_FLAGS(
@@ -220,12 +221,13 @@ static const CHECK_LIST_ENTRY_TYPE check_table[] = {
 		CONFIG_BT_PER_ADV_SYNC,
 		CONFIG_BT_MAX_PAIRED,
 		CONFIG_BT_SETTINGS_CCC_LAZY_LOADING,
-		0),
+		CONFIG_BT_RPC_GATT_NOTIFY_BATCH),
 	CHECK_UINT8(CONFIG_BT_MAX_CONN),
 	CHECK_UINT8(CONFIG_BT_ID_MAX),
 	CHECK_UINT8(CONFIG_BT_EXT_ADV_MAX_ADV_SET),
 	CHECK_UINT8(CONFIG_BT_DEVICE_NAME_MAX),
 	CHECK_UINT8(CONFIG_BT_PER_ADV_SYNC_MAX),
+	CHECK_UINT8(CONFIG_BT_RPC_GATT_NOTIFY_BATCH_COUNT),
 	CHECK_UINT16_PAIR(CONFIG_CBKPROXY_OUT_SLOTS, CONFIG_CBKPROXY_IN_SLOTS),
 };
 
@@ -174,12 +174,22 @@ enum bt_rpc_cmd_from_host_to_cli {
 	BT_GATT_CB_ATT_MTU_UPDATE_CALL_RPC_CMD
 };
 
+/** @brief Client events IDs used in bluetooth API serialization.
+ *         Those events are sent from the client to the host.
+ */
+enum bt_rpc_evt_from_cli_to_host {
+	/* gatt.h API */
+	BT_GATT_NOTIFY_BATCH_RPC_EVT,
+};
+
 /** @brief Host events IDs used in bluetooth API serialization.
  *         Those events are sent from the host to the client.
  */
 enum bt_rpc_evt_from_host_to_cli {
 	/* bluetooth.h API */
 	BT_READY_CB_T_CALLBACK_RPC_EVT,
+	/* gatt.h API */
+	BT_GATT_NOTIFY_CREDITS_RPC_EVT,
 };
 
 /** @brief Pairing flags IDs. Those flags are used to setup valid callback sets on
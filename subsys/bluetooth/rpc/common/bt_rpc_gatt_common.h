@@ -135,4 +135,14 @@ void bt_rpc_encode_gatt_attr(CborEncoder *encoder, const struct bt_gatt_attr *at
  */
 const struct bt_gatt_attr *bt_rpc_decode_gatt_attr(CborValue *value);
 
+#if defined(CONFIG_BT_RPC_HOST) && defined(CONFIG_BT_RPC_GATT_NOTIFY_BATCH)
+/**@brief Grant the initial GATT notification credits to the client.
+ *
+ * The client gets one credit for each ACL TX buffer of the host that a
+ * notification can take, up to CONFIG_BT_RPC_GATT_NOTIFY_CREDITS. Only the
+ * first call grants credits.
+ */
+void bt_rpc_gatt_notify_credits_init(void);
+#endif
+
 #endif /* BT_RPC_GATT_COMMON_H_ */
@@ -11,6 +11,10 @@
 
 #define ENCODER_FLAGS_INVALID 0x7FFFFFFF
 
+/* The scratchpad is allocated on the stack of the decoding thread. */
+BUILD_ASSERT(CONFIG_BT_RPC_SCRATCHPAD_SIZE_MAX <= CONFIG_NRF_RPC_THREAD_STACK_SIZE / 2,
+	     "The scratchpad does not fit the nRF RPC thread stack");
+
 static inline bool is_decoder_invalid(CborValue *value)
 {
 	return !value->parser;
@@ -46,6 +50,16 @@ bool ser_decode_valid(CborValue *value)
 	return !is_decoder_invalid(value);
 }
 
+void *ser_scratchpad_add(struct ser_scratchpad *scratchpad, size_t size)
+{
+	if (net_buf_simple_tailroom(&scratchpad->buf) < SCRATCHPAD_ALIGN(size)) {
+		ser_decoder_invalid(scratchpad->value, CborErrorOutOfMemory);
+		return NULL;
+	}
+
+	return net_buf_simple_add(&scratchpad->buf, SCRATCHPAD_ALIGN(size));
+}
+
 static void check_final_decode_valid(CborValue *value)
 {
 	if (is_decoder_invalid(value)) {
@@ -294,6 +308,18 @@ error_exit:
 	return 0;
 }
 
+uint32_t ser_decode_scratchpad_size(CborValue *value)
+{
+	uint32_t size = ser_decode_uint(value);
+
+	if (size > CONFIG_BT_RPC_SCRATCHPAD_SIZE_MAX) {
+		ser_decoder_invalid(value, CborErrorDataTooLarge);
+		return 0;
+	}
+
+	return size;
+}
+
 int32_t ser_decode_int(CborValue *value)
 {
 	CborError err = CborErrorIllegalType;
@@ -601,7 +627,7 @@ void ser_rsp_send_int(int32_t response)
 {
 	struct nrf_rpc_cbor_ctx ctx;
 
-	NRF_RPC_CBOR_ALLOC(ctx, 1 + sizeof(int32_t));
+	NRF_RPC_CBOR_ALLOC(ctx, SER_UINT32_SIZE_MAX);
 	ser_encode_int(&ctx.encoder, response);
 
 	nrf_rpc_cbor_rsp_no_err(&ctx);
@@ -611,7 +637,7 @@ void ser_rsp_send_uint(uint32_t response)
 {
 	struct nrf_rpc_cbor_ctx ctx;
 
-	NRF_RPC_CBOR_ALLOC(ctx, 1 + sizeof(uint32_t));
+	NRF_RPC_CBOR_ALLOC(ctx, SER_UINT32_SIZE_MAX);
 	ser_encode_uint(&ctx.encoder, response);
 
 	nrf_rpc_cbor_rsp_no_err(&ctx);
@@ -621,7 +647,7 @@ void ser_rsp_send_bool(bool response)
 {
 	struct nrf_rpc_cbor_ctx ctx;
 
-	NRF_RPC_CBOR_ALLOC(ctx, 1);
+	NRF_RPC_CBOR_ALLOC(ctx, SER_SIMPLE_SIZE);
 	ser_encode_bool(&ctx.encoder, response);
 
 	nrf_rpc_cbor_rsp_no_err(&ctx);
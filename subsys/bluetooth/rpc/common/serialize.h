@@ -27,18 +27,54 @@
  */
 #define SCRATCHPAD_ALIGN(size) WB_UP(size)
 
+/** @brief Get the encoded size of an unsigned integer.
+ *
+ * The result is a compile-time constant if the value is constant.
+ *
+ * @param[in] value Unsigned integer value.
+ *
+ * @retval The number of bytes that the value takes in the CBOR stream.
+ */
+#define SER_UINT_SIZE(value)                                                                      \
+	((uint64_t)(value) < 24 ? 1 :                                                           \
+	 (uint64_t)(value) <= UINT8_MAX ? 2 :                                                   \
+	 (uint64_t)(value) <= UINT16_MAX ? 3 :                                                  \
+	 (uint64_t)(value) <= UINT32_MAX ? 5 : 9)
+
+/** @brief Maximum encoded size of a null, undefined or boolean value. */
+#define SER_SIMPLE_SIZE 1
+
+/** @brief Maximum encoded size of an 8-bit unsigned integer. */
+#define SER_UINT8_SIZE_MAX SER_UINT_SIZE(UINT8_MAX)
+
+/** @brief Maximum encoded size of a 16-bit unsigned integer. */
+#define SER_UINT16_SIZE_MAX SER_UINT_SIZE(UINT16_MAX)
+
+/** @brief Maximum encoded size of a 32-bit signed or unsigned integer. */
+#define SER_UINT32_SIZE_MAX SER_UINT_SIZE(UINT32_MAX)
+
+/** @brief Maximum encoded size of a callback. */
+#define SER_CALLBACK_SIZE_MAX SER_UINT32_SIZE_MAX
+
+/** @brief Get the encoded size of a buffer or a string.
+ *
+ * @param[in] len Buffer length.
+ *
+ * @retval The number of bytes that the buffer takes in the CBOR stream.
+ */
+#define SER_BUFFER_SIZE(len) (SER_UINT_SIZE(len) + (len))
+
 /** @brief Alloc the scratchpad. Scratchpad is used to store a data when decoding serialized data.
+ *
+ *  The scratchpad is allocated on the stack with the size received from the peer.
+ *  If the size is bigger than @kconfig{CONFIG_BT_RPC_SCRATCHPAD_SIZE_MAX}, the decoder
+ *  is marked as invalid and an empty scratchpad is allocated.
  *
  *  @param[in] _scratchpad Scratchpad name.
  *  @param[in] _value Cbor value to decode. One unsigned integer will be decoded
  *                    from this value that contains scratchpad buffer size.
  */
-#define SER_SCRATCHPAD_DECLARE(_scratchpad, _value)                                               \
-	(_scratchpad)->value = _value;                                                          \
-	uint32_t _scratchpad_size = ser_decode_uint(_value);                                    \
-	uint32_t _scratchpad_data[SCRATCHPAD_ALIGN(_scratchpad_size) / sizeof(uint32_t)];       \
-	net_buf_simple_init_with_data(&(_scratchpad)->buf, _scratchpad_data, _scratchpad_size); \
-	net_buf_simple_reset(&(_scratchpad)->buf)
+#define SER_SCRATCHPAD_DECLARE(_scratchpad, _value)                                               	(_scratchpad)->value = _value;                                                          	uint32_t _scratchpad_size = SCRATCHPAD_ALIGN(ser_decode_scratchpad_size(_value));       	uint32_t _scratchpad_data[_scratchpad_size / sizeof(uint32_t) + 1];                     	net_buf_simple_init_with_data(&(_scratchpad)->buf, _scratchpad_data, _scratchpad_size); 	net_buf_simple_reset(&(_scratchpad)->buf)
 
 
 /** @brief Scratchpad structure. */
@@ -53,15 +89,14 @@ struct ser_scratchpad {
 /** @brief Get the scratchpad item of a given size.
  *         The scratchpad item size will be round up to multiple of 4.
  *
+ *  If the scratchpad is too small, the decoder is marked as invalid.
+ *
  * @param[in] scratchpad Scratchpad.
  * @param[in] size Scratchpad item size.
  *
- * @retval Pointer to the scratchpad item data.
+ * @retval Pointer to the scratchpad item data or NULL if the scratchpad is full.
  */
-static inline void *ser_scratchpad_add(struct ser_scratchpad *scratchpad, size_t size)
-{
-	return net_buf_simple_add(&scratchpad->buf, SCRATCHPAD_ALIGN(size));
-}
+void *ser_scratchpad_add(struct ser_scratchpad *scratchpad, size_t size);
 
 /** @brief Encode a null value.
  *
@@ -292,6 +327,24 @@ void *ser_decode_callback_call(CborValue *value);
  */
 void ser_decoder_invalid(CborValue *value, CborError err);
 
+/** @brief Check if the decoder is in a valid state.
+ *
+ * @param[in] value Value parsed from the CBOR stream.
+ *
+ * @retval true if no decoding error has occurred so far.
+ */
+bool ser_decode_valid(CborValue *value);
+
+/** @brief Decode the scratchpad size.
+ *
+ * @param[in] value Value parsed from the CBOR stream.
+ *
+ * @retval Decoded scratchpad size. If the size exceeds
+ *         @kconfig{CONFIG_BT_RPC_SCRATCHPAD_SIZE_MAX}, the decoder is marked
+ *         as invalid and 0 is returned.
+ */
+uint32_t ser_decode_scratchpad_size(CborValue *value);
+
 /** @brief Signalize that decoding is done. Use this function when you finish decoding of the
  *         received serialized packet.
  *
@@ -97,6 +97,9 @@ static void bt_rand_rpc_handler(CborValue *value, void *handler_data)
 
 	len = ser_decode_uint(value);
 	buf = ser_scratchpad_add(&scratchpad, sizeof(uint8_t) * len);
+	if (buf == NULL) {
+		goto decoding_error;
+	}
 
 	if (!ser_decoding_done_and_check(value)) {
 		goto decoding_error;
@@ -11,6 +11,7 @@
 #include <nrf_rpc_cbor.h>
 
 #include "bt_rpc_common.h"
+#include "bt_rpc_gatt_common.h"
 #include "serialize.h"
 #include "cbkproxy.h"
 #include <settings/settings.h>
@@ -33,6 +34,9 @@ static void bt_rpc_get_check_list_rpc_handler(CborValue *value, void *handler_da
 
 	size = ser_decode_uint(value);
 	data = ser_scratchpad_add(&scratchpad, sizeof(uint8_t) * size);
+	if (data == NULL) {
+		goto decoding_error;
+	}
 
 	if (!ser_decoding_done_and_check(value)) {
 		goto decoding_error;
@@ -90,6 +94,12 @@ static void bt_enable_rpc_handler(CborValue *value, void *handler_data)
 
 	result = bt_enable(cb);
 
+#if defined(CONFIG_BT_RPC_GATT_NOTIFY_BATCH)
+	if (result == 0) {
+		bt_rpc_gatt_notify_credits_init();
+	}
+#endif
+
 	ser_rsp_send_int(result);
 
 	return;
@@ -158,13 +168,15 @@ static void bt_get_name_out_rpc_handler(CborValue *value, void *handler_data)
 	SER_SCRATCHPAD_DECLARE(&scratchpad, value);
 
 	size = ser_decode_uint(value);
+	name = ser_scratchpad_add(&scratchpad, size);
+	if (name == NULL) {
+		goto decoding_error;
+	}
 
 	if (!ser_decoding_done_and_check(value)) {
 		goto decoding_error;
 	}
 
-	name = ser_scratchpad_add(&scratchpad, size);
-
 	result = bt_get_name_out(name, size);
 
 	name_strlen = strlen(name);
@@ -200,13 +212,15 @@ static void bt_id_get_rpc_handler(CborValue *value, void *handler_data)
 	SER_SCRATCHPAD_DECLARE(&scratchpad, value);
 
 	*count = ser_decode_uint(value);
+	addrs = ser_scratchpad_add(&scratchpad, *count * sizeof(bt_addr_le_t));
+	if (addrs == NULL) {
+		goto decoding_error;
+	}
 
 	if (!ser_decoding_done_and_check(value)) {
 		goto decoding_error;
 	}
 
-	addrs = ser_scratchpad_add(&scratchpad, *count * sizeof(bt_addr_le_t));
-
 	bt_id_get(addrs, count);
 
 	buffer_size_max += *count * sizeof(bt_addr_le_t);
@@ -729,6 +729,227 @@ decoding_error:
 NRF_RPC_CBOR_CMD_DECODER(bt_rpc_grp, bt_gatt_notify_cb, BT_GATT_NOTIFY_CB_RPC_CMD,
 	bt_gatt_notify_cb_rpc_handler, NULL);
 
+#if defined(CONFIG_BT_RPC_GATT_NOTIFY_BATCH)
+struct notify_ctx {
+	bt_gatt_complete_func_t func;
+	void *user_data;
+};
+
+/* A notification with a completion callback takes an ACL TX buffer and
+ * a connection TX context until it is sent.
+ */
+#define NOTIFY_CREDITS MIN(CONFIG_BT_RPC_GATT_NOTIFY_CREDITS,                \
+			   MIN(CONFIG_BT_L2CAP_TX_BUF_COUNT, CONFIG_BT_CONN_TX_MAX))
+
+K_MEM_SLAB_DEFINE(notify_ctx_slab, sizeof(struct notify_ctx),
+		  NOTIFY_CREDITS, 4);
+
+static atomic_t notify_credits_returned;
+
+/* A notification to all connections takes one credit of the client, but
+ * each connection it is sent to returns a credit when it completes. The
+ * credits that the client did not give are not returned.
+ */
+static atomic_t notify_credits_debt;
+
+static void notify_credits_work_handler(struct k_work *work)
+{
+	struct nrf_rpc_cbor_ctx ctx;
+	size_t buffer_size_max = 5;
+	atomic_val_t credits;
+
+	credits = atomic_set(&notify_credits_returned, 0);
+	if (credits == 0) {
+		return;
+	}
+
+	NRF_RPC_CBOR_ALLOC(ctx, buffer_size_max);
+
+	ser_encode_uint(&ctx.encoder, credits);
+
+	nrf_rpc_cbor_evt_no_err(&bt_rpc_grp, BT_GATT_NOTIFY_CREDITS_RPC_EVT, &ctx);
+}
+
+static K_WORK_DEFINE(notify_credits_work, notify_credits_work_handler);
+
+static void notify_credit_return(void)
+{
+	atomic_val_t debt;
+
+	do {
+		debt = atomic_get(&notify_credits_debt);
+		if (debt == 0) {
+			atomic_inc(&notify_credits_returned);
+			k_work_submit(&notify_credits_work);
+			return;
+		}
+	} while (!atomic_cas(&notify_credits_debt, debt, debt - 1));
+}
+
+void bt_rpc_gatt_notify_credits_init(void)
+{
+	static atomic_t granted;
+
+	if (atomic_set(&granted, true)) {
+		return;
+	}
+
+	atomic_add(&notify_credits_returned, NOTIFY_CREDITS);
+	k_work_submit(&notify_credits_work);
+}
+
+static void notify_complete(struct bt_conn *conn, void *user_data)
+{
+	struct notify_ctx *ctx = user_data;
+
+	if (ctx->func) {
+		ctx->func(conn, ctx->user_data);
+	}
+
+	k_mem_slab_free(&notify_ctx_slab, (void **)&ctx);
+	notify_credit_return();
+}
+
+/* Returns 0 if the notification was queued. It returns a credit when
+ * it completes.
+ */
+static int notify_conn_send(struct bt_conn *conn,
+			    const struct bt_gatt_notify_params *params)
+{
+	struct bt_gatt_notify_params conn_params = *params;
+	struct notify_ctx *ctx;
+	int err;
+
+	/* Notifications to all connections may take more contexts than
+	 * the client has credits, so the slab can be empty.
+	 */
+	err = k_mem_slab_alloc(&notify_ctx_slab, (void **)&ctx, K_NO_WAIT);
+	if (err) {
+		return -ENOMEM;
+	}
+
+	ctx->func = params->func;
+	ctx->user_data = params->user_data;
+
+	conn_params.func = notify_complete;
+	conn_params.user_data = ctx;
+
+	err = bt_gatt_notify_cb(conn, &conn_params);
+	if (err) {
+		k_mem_slab_free(&notify_ctx_slab, (void **)&ctx);
+	}
+
+	return err;
+}
+
+struct notify_all_data {
+	const struct bt_gatt_notify_params *params;
+	size_t sent;
+};
+
+static void notify_all_conn(struct bt_conn *conn, void *data)
+{
+	struct notify_all_data *all = data;
+
+	if (!all->params->uuid &&
+	    !bt_gatt_is_subscribed(conn, all->params->attr, BT_GATT_CCC_NOTIFY)) {
+		return;
+	}
+
+	/* Only the first notification uses the credit of the client. */
+	if (all->sent > 0) {
+		atomic_inc(&notify_credits_debt);
+	}
+
+	if (notify_conn_send(conn, all->params)) {
+		LOG_DBG("Notification failed");
+
+		if (all->sent > 0) {
+			notify_credit_return();
+		}
+
+		return;
+	}
+
+	all->sent++;
+}
+
+static void notify_batch_entry_send(struct bt_conn *conn, struct bt_gatt_notify_params *params)
+{
+	if (!conn) {
+		struct notify_all_data all = {
+			.params = params,
+		};
+
+		/* Each connection gets its own notification context, so
+		 * every notification in flight is counted against the
+		 * credits of the client.
+		 */
+		bt_conn_foreach(BT_CONN_TYPE_LE, notify_all_conn, &all);
+
+		if (all.sent == 0) {
+			notify_credit_return();
+		}
+
+		return;
+	}
+
+	if (notify_conn_send(conn, params)) {
+		LOG_DBG("Notification failed");
+		notify_credit_return();
+	}
+}
+
+static void notify_credits_return(size_t credits)
+{
+	while (credits--) {
+		notify_credit_return();
+	}
+}
+
+static void bt_gatt_notify_batch_rpc_handler(CborValue *value, void *handler_data)
+{
+	struct bt_conn *conn[CONFIG_BT_RPC_GATT_NOTIFY_BATCH_COUNT];
+	struct bt_gatt_notify_params params[CONFIG_BT_RPC_GATT_NOTIFY_BATCH_COUNT];
+	struct ser_scratchpad scratchpad;
+	size_t credits;
+	size_t count;
+
+	SER_SCRATCHPAD_DECLARE(&scratchpad, value);
+
+	count = ser_decode_uint(value);
+
+	/* Each notification of the event took a credit of the client. */
+	credits = MIN(count, NOTIFY_CREDITS);
+
+	if (count > ARRAY_SIZE(params)) {
+		ser_decoder_invalid(value, CborErrorIO);
+		count = 0;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		conn[i] = bt_rpc_decode_bt_conn(value);
+		bt_gatt_notify_params_dec(&scratchpad, &params[i]);
+	}
+
+	if (!ser_decoding_done_and_check(value)) {
+		goto decoding_error;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		notify_batch_entry_send(conn[i], &params[i]);
+	}
+
+	return;
+decoding_error:
+	notify_credits_return(credits);
+	report_decoding_error(BT_GATT_NOTIFY_BATCH_RPC_EVT, handler_data);
+}
+
+NRF_RPC_CBOR_EVT_DECODER(bt_rpc_grp, bt_gatt_notify_batch, BT_GATT_NOTIFY_BATCH_RPC_EVT,
+			 bt_gatt_notify_batch_rpc_handler, NULL);
+#endif /* defined(CONFIG_BT_RPC_GATT_NOTIFY_BATCH) */
+
 void bt_gatt_indicate_params_dec(struct ser_scratchpad *scratchpad,
 				 struct bt_gatt_indicate_params *data)
 {
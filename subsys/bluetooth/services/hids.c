@@ -52,15 +52,69 @@
 
 LOG_MODULE_REGISTER(bt_hids, CONFIG_BT_HIDS_LOG_LEVEL);
 
+/* The connection context library does not serialize the access to the
+ * context data. The report data is written by the application and read and
+ * written by the peers from the Bluetooth thread, so the access to the data
+ * of each connection is serialized by its own lock. The lock is held only
+ * while the data is accessed, never while a notification is sent.
+ */
+static struct bt_hids_conn_data *conn_data_get(struct bt_hids *hids_obj,
+					       struct bt_conn *conn)
+{
+	struct bt_hids_conn_data *conn_data;
+
+	conn_data = bt_conn_ctx_get(hids_obj->conn_ctx, conn);
+	if (conn_data) {
+		k_mutex_lock(&hids_obj->conn_data_lock[bt_conn_index(conn)],
+			     K_FOREVER);
+	}
+
+	return conn_data;
+}
+
+static void conn_data_release(struct bt_hids *hids_obj, struct bt_conn *conn,
+			      void *conn_data)
+{
+	k_mutex_unlock(&hids_obj->conn_data_lock[bt_conn_index(conn)]);
+	bt_conn_ctx_release(hids_obj->conn_ctx, conn_data);
+}
+
+static const struct bt_conn_ctx *conn_ctx_get_by_id(struct bt_hids *hids_obj,
+						    uint8_t id)
+{
+	const struct bt_conn_ctx *ctx;
+
+	ctx = bt_conn_ctx_get_by_id(hids_obj->conn_ctx, id);
+	if (ctx) {
+		k_mutex_lock(&hids_obj->conn_data_lock[id], K_FOREVER);
+	}
+
+	return ctx;
+}
+
+static void conn_ctx_release_by_id(struct bt_hids *hids_obj, uint8_t id,
+				   const struct bt_conn_ctx *ctx)
+{
+	k_mutex_unlock(&hids_obj->conn_data_lock[id]);
+	bt_conn_ctx_release(hids_obj->conn_ctx, ctx->data);
+}
+
 int bt_hids_connected(struct bt_hids *hids_obj, struct bt_conn *conn)
 {
 	__ASSERT_NO_MSG(conn != NULL);
 	__ASSERT_NO_MSG(hids_obj != NULL);
 
+	/* The context can be found as soon as it is allocated, so it is
+	 * initialized with the lock of the connection held.
+	 */
+	k_mutex_lock(&hids_obj->conn_data_lock[bt_conn_index(conn)],
+		     K_FOREVER);
+
 	struct bt_hids_conn_data *conn_data =
 		bt_conn_ctx_alloc(hids_obj->conn_ctx, conn);
 
 	if (!conn_data) {
+		k_mutex_unlock(&hids_obj->conn_data_lock[bt_conn_index(conn)]);
 		LOG_WRN("There is no free memory to "
 			"allocate the connection context");
 		return -ENOMEM;
@@ -93,7 +147,7 @@ int bt_hids_connected(struct bt_hids *hids_obj, struct bt_conn *conn)
 		    hids_obj->outp_rep_group.reports[i].size;
 	}
 
-	bt_conn_ctx_release(hids_obj->conn_ctx, (void *)conn_data);
+	conn_data_release(hids_obj, conn, conn_data);
 
 	return 0;
 }
@@ -127,7 +181,7 @@ static ssize_t hids_protocol_mode_write(struct bt_conn *conn,
 	uint8_t const *new_pm = (uint8_t const *)buf;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -137,6 +191,7 @@ static ssize_t hids_protocol_mode_write(struct bt_conn *conn,
 	uint8_t *cur_pm = &conn_data->pm_ctx_value;
 
 	if (offset + len > sizeof(uint8_t)) {
+		conn_data_release(hids, conn, conn_data);
 		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
 	}
 
@@ -154,12 +209,13 @@ static ssize_t hids_protocol_mode_write(struct bt_conn *conn,
 		}
 		break;
 	default:
+		conn_data_release(hids, conn, conn_data);
 		return BT_GATT_ERR(BT_ATT_ERR_NOT_SUPPORTED);
 	}
 
 	memcpy(cur_pm + offset, new_pm, len);
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return len;
 }
@@ -175,7 +231,7 @@ static ssize_t hids_protocol_mode_read(struct bt_conn *conn,
 	ssize_t ret_len;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -187,7 +243,7 @@ static ssize_t hids_protocol_mode_read(struct bt_conn *conn,
 	ret_len = bt_gatt_attr_read(conn, attr, buf, len, offset, protocol_mode,
 				    sizeof(*protocol_mode));
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return ret_len;
 }
@@ -219,7 +275,7 @@ static ssize_t hids_inp_rep_read(struct bt_conn *conn,
 	ssize_t ret_len;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -231,7 +287,7 @@ static ssize_t hids_inp_rep_read(struct bt_conn *conn,
 	ret_len = bt_gatt_attr_read(conn, attr, buf, len, offset, rep_data,
 				    rep->size);
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return ret_len;
 }
@@ -266,7 +322,7 @@ static ssize_t hids_outp_rep_read(struct bt_conn *conn,
 	ssize_t ret_len;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -286,7 +342,7 @@ static ssize_t hids_outp_rep_read(struct bt_conn *conn,
 		rep->handler(&report, conn, false);
 	}
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return ret_len;
 }
@@ -306,7 +362,7 @@ static ssize_t hids_outp_rep_write(struct bt_conn *conn,
 	uint8_t *rep_data;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -316,6 +372,7 @@ static ssize_t hids_outp_rep_write(struct bt_conn *conn,
 	rep_data = conn_data->outp_rep_ctx + rep->offset;
 
 	if (offset + len > rep->size) {
+		conn_data_release(hids, conn, conn_data);
 		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
 	}
 	memcpy(rep_data + offset, buf, len);
@@ -328,7 +385,7 @@ static ssize_t hids_outp_rep_write(struct bt_conn *conn,
 		rep->handler(&report, conn, true);
 	}
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return len;
 }
@@ -363,7 +420,7 @@ static ssize_t hids_feat_rep_read(struct bt_conn *conn,
 	ssize_t ret_len;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -383,7 +440,7 @@ static ssize_t hids_feat_rep_read(struct bt_conn *conn,
 		rep->handler(&report, conn, false);
 	}
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return ret_len;
 }
@@ -409,7 +466,7 @@ static ssize_t hids_feat_rep_write(struct bt_conn *conn,
 	uint8_t *rep_data;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -419,6 +476,7 @@ static ssize_t hids_feat_rep_write(struct bt_conn *conn,
 	rep_data = conn_data->feat_rep_ctx + rep->offset;
 
 	if (offset + len > rep->size) {
+		conn_data_release(hids, conn, conn_data);
 		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
 	}
 	memcpy(rep_data + offset, buf, len);
@@ -431,7 +489,7 @@ static ssize_t hids_feat_rep_write(struct bt_conn *conn,
 		rep->handler(&report, conn, true);
 	}
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return len;
 }
@@ -487,7 +545,7 @@ static ssize_t hids_boot_mouse_inp_report_read(struct bt_conn *conn,
 	ssize_t ret_len;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -500,7 +558,7 @@ static ssize_t hids_boot_mouse_inp_report_read(struct bt_conn *conn,
 	ret_len =
 	    bt_gatt_attr_read(conn, attr, buf, len, offset, rep_data,
 			      sizeof(conn_data->hids_boot_mouse_inp_rep_ctx));
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return ret_len;
 }
@@ -543,7 +601,7 @@ static ssize_t hids_boot_kb_inp_report_read(struct bt_conn *conn,
 	ssize_t ret_len;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -555,7 +613,7 @@ static ssize_t hids_boot_kb_inp_report_read(struct bt_conn *conn,
 	ret_len =
 	    bt_gatt_attr_read(conn, attr, buf, len, offset, rep_data,
 			      sizeof(conn_data->hids_boot_kb_inp_rep_ctx));
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return ret_len;
 }
@@ -600,7 +658,7 @@ static ssize_t hids_boot_kb_outp_report_read(struct bt_conn *conn,
 	ssize_t ret_len;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -620,7 +678,7 @@ static ssize_t hids_boot_kb_outp_report_read(struct bt_conn *conn,
 		rep->handler(&report, conn, false);
 	}
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return ret_len;
 }
@@ -638,7 +696,7 @@ static ssize_t hids_boot_kb_outp_report_write(struct bt_conn *conn,
 	uint8_t *rep_data;
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids->conn_ctx, conn);
+		conn_data_get(hids, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -648,6 +706,7 @@ static ssize_t hids_boot_kb_outp_report_write(struct bt_conn *conn,
 	rep_data = conn_data->hids_boot_kb_outp_rep_ctx;
 
 	if (offset + len > sizeof(uint8_t)) {
+		conn_data_release(hids, conn, conn_data);
 		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
 	}
 	memcpy(rep_data + offset, buf, len);
@@ -661,7 +720,7 @@ static ssize_t hids_boot_kb_outp_report_write(struct bt_conn *conn,
 		rep->handler(&report, conn, true);
 	}
 
-	bt_conn_ctx_release(hids->conn_ctx, (void *)conn_data);
+	conn_data_release(hids, conn, conn_data);
 
 	return len;
 }
@@ -873,6 +932,10 @@ int bt_hids_init(struct bt_hids *hids_obj,
 	hids_obj->pm.evt_handler = init_param->pm_evt_handler;
 	hids_obj->cp.evt_handler = init_param->cp_evt_handler;
 
+	for (size_t i = 0; i < ARRAY_SIZE(hids_obj->conn_data_lock); i++) {
+		k_mutex_init(&hids_obj->conn_data_lock[i]);
+	}
+
 	/* Register primary service. */
 	BT_GATT_POOL_SVC(&hids_obj->gp, BT_UUID_HIDS);
 
@@ -1031,6 +1094,160 @@ static void store_input_report(struct bt_hids_inp_rep *hids_inp_rep,
 	}
 }
 
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+static void notify_slot_free(struct bt_hids_notify_slot *slot)
+{
+	slot->seq = 0;
+	atomic_clear(&slot->in_use);
+}
+
+static void notify_conn_complete(struct bt_conn *conn, void *user_data)
+{
+	struct bt_hids_notify_slot *slot = user_data;
+	bt_gatt_complete_func_t cb = slot->cb;
+
+	notify_slot_free(slot);
+
+	if (cb) {
+		cb(conn, NULL);
+	}
+}
+
+/* Notifications to a peer complete in the order in which they were queued,
+ * so a notification queued on all peers at once frees the oldest slot
+ * of the peer that was taken for such a notification.
+ */
+static void notify_all_complete(struct bt_conn *conn, void *user_data)
+{
+	struct bt_hids *hids_obj = user_data;
+	struct bt_hids_notify_slot *slots =
+		hids_obj->notify_slots[bt_conn_index(conn)];
+	struct bt_hids_notify_slot *oldest = NULL;
+	bt_gatt_complete_func_t cb;
+
+	for (size_t i = 0; i < CONFIG_BT_HIDS_NOTIFY_BATCH_LIMIT; i++) {
+		if (!atomic_get(&slots[i].in_use) || !slots[i].seq) {
+			continue;
+		}
+
+		if (!oldest || ((int32_t)(slots[i].seq - oldest->seq) < 0)) {
+			oldest = &slots[i];
+		}
+	}
+
+	if (!oldest) {
+		/* A subscribed peer without a connection context. */
+		return;
+	}
+
+	cb = oldest->cb;
+	notify_slot_free(oldest);
+
+	if (cb) {
+		cb(conn, NULL);
+	}
+}
+
+/* Reserve a notification slot of the connection with the given connection
+ * context index. The slots stay reserved until the notification completes,
+ * even if the connection is terminated in the meantime. Can be called from
+ * several threads at once.
+ */
+static struct bt_hids_notify_slot *notify_slot_get(struct bt_hids *hids_obj,
+						   size_t ctx_id,
+						   bt_gatt_complete_func_t cb)
+{
+	struct bt_hids_notify_slot *slots = hids_obj->notify_slots[ctx_id];
+
+	for (size_t i = 0; i < CONFIG_BT_HIDS_NOTIFY_BATCH_LIMIT; i++) {
+		if (atomic_cas(&slots[i].in_use, false, true)) {
+			slots[i].cb = cb;
+
+			return &slots[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Queue the same notification on every connection in the list, each with
+ * its own notification slot, and release the connection references.
+ *
+ * If no subscribed peer was skipped, the notification is queued on all of
+ * them with a single call, so the host builds the notification once.
+ */
+static int notify_conns(struct bt_hids *hids_obj,
+			struct bt_gatt_notify_params *params,
+			struct bt_conn **conns,
+			struct bt_hids_notify_slot **slots, size_t conn_cnt,
+			bool all_peers)
+{
+	int ret = 0;
+
+	if (all_peers && (conn_cnt > 1)) {
+		uint32_t seq = atomic_inc(&hids_obj->notify_seq) + 1;
+
+		if (!seq) {
+			/* 0 marks a notification queued on a single peer. */
+			seq = atomic_inc(&hids_obj->notify_seq) + 1;
+		}
+
+		for (size_t i = 0; i < conn_cnt; i++) {
+			slots[i]->seq = seq;
+		}
+
+		params->func = notify_all_complete;
+		params->user_data = hids_obj;
+
+		ret = bt_gatt_notify_cb(NULL, params);
+		if (ret) {
+			/* It is not known which peers got the notification
+			 * before the error, so all its slots are freed.
+			 * A peer may exceed the notification limit once.
+			 */
+			for (size_t i = 0; i < conn_cnt; i++) {
+				if (slots[i]->seq == seq) {
+					notify_slot_free(slots[i]);
+				}
+			}
+		} else {
+			atomic_add(&hids_obj->notify_queued, conn_cnt);
+		}
+
+		for (size_t i = 0; i < conn_cnt; i++) {
+			bt_conn_unref(conns[i]);
+		}
+
+		return ret;
+	}
+
+	params->func = notify_conn_complete;
+
+	for (size_t i = 0; i < conn_cnt; i++) {
+		int err;
+
+		params->user_data = slots[i];
+		err = bt_gatt_notify_cb(conns[i], params);
+
+		if (err) {
+			notify_slot_free(slots[i]);
+			ret = ret ? ret : err;
+		} else {
+			atomic_inc(&hids_obj->notify_queued);
+		}
+
+		bt_conn_unref(conns[i]);
+	}
+
+	return ret;
+}
+
+static int8_t motion_merge(int8_t acc, int8_t delta)
+{
+	return CLAMP((int16_t)acc + delta, INT8_MIN, INT8_MAX);
+}
+#endif /* CONFIG_BT_HIDS_NOTIFY_BATCH */
+
 static int inp_rep_notify_all(struct bt_hids *hids_obj,
 			      struct bt_hids_inp_rep *hids_inp_rep,
 			      uint8_t const *rep, uint8_t len,
@@ -1040,13 +1257,19 @@ static int inp_rep_notify_all(struct bt_hids *hids_obj,
 	uint8_t *rep_data = NULL;
 	struct bt_gatt_attr *rep_attr =
 		&hids_obj->gp.svc.attrs[hids_inp_rep->att_ind];
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+	struct bt_conn *conns[CONFIG_BT_MAX_CONN];
+	struct bt_hids_notify_slot *slots[CONFIG_BT_MAX_CONN];
+	size_t conn_cnt = 0;
+	bool all_peers = true;
+#endif
 
 	const size_t contexts =
 	    bt_conn_ctx_count(hids_obj->conn_ctx);
 
 	for (size_t i = 0; i < contexts; i++) {
 		const struct bt_conn_ctx *ctx =
-			bt_conn_ctx_get_by_id(hids_obj->conn_ctx, i);
+			conn_ctx_get_by_id(hids_obj, i);
 
 		if (ctx) {
 			bool notification_enabled = bt_gatt_is_subscribed(
@@ -1059,10 +1282,21 @@ static int inp_rep_notify_all(struct bt_hids *hids_obj,
 
 				store_input_report(hids_inp_rep, rep_data, rep,
 						   len);
+
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+				slots[conn_cnt] = notify_slot_get(hids_obj, i,
+								  cb);
+				if (slots[conn_cnt]) {
+					conns[conn_cnt++] =
+						bt_conn_ref(ctx->conn);
+				} else {
+					atomic_inc(&hids_obj->notify_dropped);
+					all_peers = false;
+				}
+#endif
 			}
 
-			bt_conn_ctx_release(hids_obj->conn_ctx,
-					    (void *)ctx->data);
+			conn_ctx_release_by_id(hids_obj, i, ctx);
 		}
 	}
 
@@ -1074,7 +1308,12 @@ static int inp_rep_notify_all(struct bt_hids *hids_obj,
 		params.len = hids_inp_rep->size;
 		params.func = cb;
 
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+		return notify_conns(hids_obj, &params, conns, slots,
+				    conn_cnt, all_peers);
+#else
 		return bt_gatt_notify_cb(NULL, &params);
+#endif
 	} else {
 		return -ENODATA;
 	}
@@ -1104,7 +1343,7 @@ int bt_hids_inp_rep_send(struct bt_hids *hids_obj,
 	}
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids_obj->conn_ctx, conn);
+		conn_data_get(hids_obj, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -1115,6 +1354,8 @@ int bt_hids_inp_rep_send(struct bt_hids *hids_obj,
 
 	store_input_report(hids_inp_rep, rep_data, rep, len);
 
+	conn_data_release(hids_obj, conn, conn_data);
+
 	struct bt_gatt_notify_params params = {0};
 
 	params.attr = &hids_obj->gp.svc.attrs[hids_inp_rep->att_ind];
@@ -1122,11 +1363,7 @@ int bt_hids_inp_rep_send(struct bt_hids *hids_obj,
 	params.len = hids_inp_rep->size;
 	params.func = cb;
 
-	int err = bt_gatt_notify_cb(conn, &params);
-
-	bt_conn_ctx_release(hids_obj->conn_ctx, (void *)conn_data);
-
-	return err;
+	return bt_gatt_notify_cb(conn, &params);
 }
 
 static int boot_mouse_inp_report_notify_all(
@@ -1138,16 +1375,85 @@ static int boot_mouse_inp_report_notify_all(
 	uint8_t rep_ind = hids_obj->boot_mouse_inp_rep.att_ind;
 	struct bt_gatt_attr *rep_attr = &hids_obj->gp.svc.attrs[rep_ind];
 	uint8_t *rep_data = NULL;
+	const size_t contexts = bt_conn_ctx_count(hids_obj->conn_ctx);
+
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+	struct bt_conn *conns[CONFIG_BT_MAX_CONN];
+	struct bt_hids_notify_slot *slots[CONFIG_BT_MAX_CONN];
+	uint8_t conn_reps[CONFIG_BT_MAX_CONN][BT_HIDS_BOOT_MOUSE_REP_LEN];
+	size_t conn_cnt = 0;
+	int ret = 0;
+
+	for (size_t i = 0; i < contexts; i++) {
+		const struct bt_conn_ctx *ctx =
+			conn_ctx_get_by_id(hids_obj, i);
+
+		if (!ctx) {
+			continue;
+		}
+
+		if (bt_gatt_is_subscribed(ctx->conn, rep_attr,
+					  BT_GATT_CCC_NOTIFY)) {
+			conn_data = ctx->data;
+			rep_data = conn_data->hids_boot_mouse_inp_rep_ctx;
+
+			if (buttons) {
+				rep_data[0] = *buttons;
+			}
+
+			/* Motion that could not be sent to this peer is
+			 * accumulated in the connection context.
+			 */
+			rep_data[1] = (uint8_t)motion_merge((int8_t)rep_data[1],
+							    x_delta);
+			rep_data[2] = (uint8_t)motion_merge((int8_t)rep_data[2],
+							    y_delta);
+
+			slots[conn_cnt] = notify_slot_get(hids_obj, i, cb);
+			if (slots[conn_cnt]) {
+				memcpy(conn_reps[conn_cnt], rep_data,
+				       BT_HIDS_BOOT_MOUSE_REP_LEN);
+				rep_data[1] = 0;
+				rep_data[2] = 0;
+				conns[conn_cnt++] = bt_conn_ref(ctx->conn);
+			} else {
+				atomic_inc(&hids_obj->notify_merged);
+			}
+		}
+
+		conn_ctx_release_by_id(hids_obj, i, ctx);
+	}
+
+	if (rep_data == NULL) {
+		return -ENODATA;
+	}
+
+	for (size_t i = 0; i < conn_cnt; i++) {
+		struct bt_gatt_notify_params params = {0};
+		int err;
+
+		params.attr = rep_attr;
+		params.data = conn_reps[i];
+		params.len = BT_HIDS_BOOT_MOUSE_REP_LEN;
+
+		/* The report of each peer may contain different merged
+		 * motion, so it is sent separately.
+		 */
+		err = notify_conns(hids_obj, &params, &conns[i], &slots[i], 1,
+				   false);
+		ret = ret ? ret : err;
+	}
+
+	return ret;
+#else
 	uint8_t rep_buff[BT_HIDS_BOOT_MOUSE_REP_LEN] = {0};
 
 	rep_buff[1] = (uint8_t)x_delta;
 	rep_buff[2] = (uint8_t)y_delta;
 
-	const size_t contexts = bt_conn_ctx_count(hids_obj->conn_ctx);
-
 	for (size_t i = 0; i < contexts; i++) {
 		const struct bt_conn_ctx *ctx =
-			bt_conn_ctx_get_by_id(hids_obj->conn_ctx, i);
+			conn_ctx_get_by_id(hids_obj, i);
 
 		if (ctx) {
 			bool notification_enabled = bt_gatt_is_subscribed(
@@ -1168,8 +1474,7 @@ static int boot_mouse_inp_report_notify_all(
 				rep_buff[0] = rep_data[0];
 			}
 
-			bt_conn_ctx_release(hids_obj->conn_ctx,
-					    (void *)ctx->data);
+			conn_ctx_release_by_id(hids_obj, i, ctx);
 		}
 	}
 
@@ -1185,6 +1490,7 @@ static int boot_mouse_inp_report_notify_all(
 	} else {
 		return -ENODATA;
 	}
+#endif /* CONFIG_BT_HIDS_NOTIFY_BATCH */
 }
 
 int bt_hids_boot_mouse_inp_rep_send(struct bt_hids *hids_obj,
@@ -1197,6 +1503,7 @@ int bt_hids_boot_mouse_inp_rep_send(struct bt_hids *hids_obj,
 	struct bt_hids_boot_mouse_inp_rep *boot_mouse_inp_rep =
 	    &hids_obj->boot_mouse_inp_rep;
 	struct bt_gatt_attr *rep_attr = &hids_obj->gp.svc.attrs[rep_ind];
+	uint8_t rep_buff[BT_HIDS_BOOT_MOUSE_REP_LEN] = {0};
 	uint8_t *rep_data;
 
 	if (!conn) {
@@ -1210,7 +1517,7 @@ int bt_hids_boot_mouse_inp_rep_send(struct bt_hids *hids_obj,
 	}
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids_obj->conn_ctx, conn);
+		conn_data_get(hids_obj, conn);
 
 	BUILD_ASSERT(sizeof(conn_data->hids_boot_mouse_inp_rep_ctx) >= 3,
 			 "buffer is too short");
@@ -1226,24 +1533,20 @@ int bt_hids_boot_mouse_inp_rep_send(struct bt_hids *hids_obj,
 		/* If buttons data is not given use old values. */
 		rep_data[0] = *buttons;
 	}
-	rep_data[1] = (uint8_t)x_delta;
-	rep_data[2] = (uint8_t)y_delta;
+	rep_buff[0] = rep_data[0];
+	rep_buff[1] = (uint8_t)x_delta;
+	rep_buff[2] = (uint8_t)y_delta;
+
+	conn_data_release(hids_obj, conn, conn_data);
 
 	struct bt_gatt_notify_params params = {0};
 
 	params.attr = &hids_obj->gp.svc.attrs[rep_ind];
-	params.data = rep_data;
-	params.len = sizeof(conn_data->hids_boot_mouse_inp_rep_ctx);
+	params.data = rep_buff;
+	params.len = sizeof(rep_buff);
 	params.func = cb;
 
-	int err = bt_gatt_notify_cb(conn, &params);
-
-	rep_data[1] = 0;
-	rep_data[2] = 0;
-
-	bt_conn_ctx_release(hids_obj->conn_ctx, (void *)conn_data);
-
-	return err;
+	return bt_gatt_notify_cb(conn, &params);
 }
 
 static int
@@ -1256,12 +1559,22 @@ boot_kb_inp_notify_all(struct bt_hids *hids_obj, uint8_t const *rep,
 	uint8_t rep_ind = hids_obj->boot_kb_inp_rep.att_ind;
 	struct bt_gatt_attr *rep_attr = &hids_obj->gp.svc.attrs[rep_ind];
 	uint8_t *rep_data = NULL;
+	uint8_t rep_buff[BT_HIDS_BOOT_KB_INPUT_REP_LEN] = {0};
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+	struct bt_conn *conns[CONFIG_BT_MAX_CONN];
+	struct bt_hids_notify_slot *slots[CONFIG_BT_MAX_CONN];
+	size_t conn_cnt = 0;
+	bool all_peers = true;
+#endif
+
+	/* The report is built once and copied to every connection context. */
+	memcpy(rep_buff, rep, len);
 
 	const size_t contexts = bt_conn_ctx_count(hids_obj->conn_ctx);
 
 	for (size_t i = 0; i < contexts; i++) {
 		const struct bt_conn_ctx *ctx =
-		    bt_conn_ctx_get_by_id(hids_obj->conn_ctx, i);
+		    conn_ctx_get_by_id(hids_obj, i);
 
 		if (ctx) {
 			bool notification_enabled = bt_gatt_is_subscribed(
@@ -1271,13 +1584,22 @@ boot_kb_inp_notify_all(struct bt_hids *hids_obj, uint8_t const *rep,
 				conn_data = ctx->data;
 				rep_data = conn_data->hids_boot_kb_inp_rep_ctx;
 
-				memcpy(rep_data, rep, len);
-				memset(&rep_data[len], 0,
-				       (BT_HIDS_BOOT_KB_INPUT_REP_LEN - len));
+				memcpy(rep_data, rep_buff, sizeof(rep_buff));
+
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+				slots[conn_cnt] = notify_slot_get(hids_obj, i,
+								  cb);
+				if (slots[conn_cnt]) {
+					conns[conn_cnt++] =
+						bt_conn_ref(ctx->conn);
+				} else {
+					atomic_inc(&hids_obj->notify_dropped);
+					all_peers = false;
+				}
+#endif
 			}
 
-			bt_conn_ctx_release(hids_obj->conn_ctx,
-					    (void *)ctx->data);
+			conn_ctx_release_by_id(hids_obj, i, ctx);
 		}
 	}
 
@@ -1285,11 +1607,16 @@ boot_kb_inp_notify_all(struct bt_hids *hids_obj, uint8_t const *rep,
 		struct bt_gatt_notify_params params = {0};
 
 		params.attr = rep_attr;
-		params.data = rep_data;
-		params.len = sizeof(conn_data->hids_boot_kb_inp_rep_ctx);
+		params.data = rep_buff;
+		params.len = sizeof(rep_buff);
 		params.func = cb;
 
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+		return notify_conns(hids_obj, &params, conns, slots,
+				    conn_cnt, all_peers);
+#else
 		return bt_gatt_notify_cb(NULL, &params);
+#endif
 	} else {
 		return -ENODATA;
 	}
@@ -1303,8 +1630,13 @@ int bt_hids_boot_kb_inp_rep_send(struct bt_hids *hids_obj,
 	struct bt_hids_boot_kb_inp_rep *boot_kb_input_report =
 		&hids_obj->boot_kb_inp_rep;
 	struct bt_gatt_attr *rep_attr = &hids_obj->gp.svc.attrs[rep_ind];
+	uint8_t rep_buff[BT_HIDS_BOOT_KB_INPUT_REP_LEN] = {0};
 	uint8_t *rep_data = NULL;
 
+	if (len > BT_HIDS_BOOT_KB_INPUT_REP_LEN) {
+		return -EINVAL;
+	}
+
 	if (!conn) {
 		return boot_kb_inp_notify_all(hids_obj, rep, len,
 					      boot_kb_input_report, cb);
@@ -1315,11 +1647,7 @@ int bt_hids_boot_kb_inp_rep_send(struct bt_hids *hids_obj,
 	}
 
 	struct bt_hids_conn_data *conn_data =
-		bt_conn_ctx_get(hids_obj->conn_ctx, conn);
-
-	if (len > sizeof(conn_data->hids_boot_kb_inp_rep_ctx)) {
-		return -EINVAL;
-	}
+		conn_data_get(hids_obj, conn);
 
 	if (!conn_data) {
 		LOG_WRN("The context was not found");
@@ -1328,20 +1656,35 @@ int bt_hids_boot_kb_inp_rep_send(struct bt_hids *hids_obj,
 
 	rep_data = conn_data->hids_boot_kb_inp_rep_ctx;
 
-	memcpy(rep_data, rep, len);
-	memset(&rep_data[len], 0,
-	       (sizeof(conn_data->hids_boot_kb_inp_rep_ctx) - len));
+	memcpy(rep_buff, rep, len);
+	memcpy(rep_data, rep_buff, sizeof(rep_buff));
+
+	conn_data_release(hids_obj, conn, conn_data);
 
 	struct bt_gatt_notify_params params = {0};
 
 	params.attr = rep_attr;
-	params.data = rep_data;
-	params.len = sizeof(conn_data->hids_boot_kb_inp_rep_ctx);
+	params.data = rep_buff;
+	params.len = sizeof(rep_buff);
 	params.func = cb;
 
-	int err = bt_gatt_notify_cb(conn, &params);
+	return bt_gatt_notify_cb(conn, &params);
+}
 
-	bt_conn_ctx_release(hids_obj->conn_ctx, (void *)conn_data);
+int bt_hids_notify_stats_get(struct bt_hids *hids_obj,
+			     struct bt_hids_notify_stats *stats)
+{
+	if (!hids_obj || !stats) {
+		return -EINVAL;
+	}
 
-	return err;
+#if defined(CONFIG_BT_HIDS_NOTIFY_BATCH)
+	stats->queued = atomic_get(&hids_obj->notify_queued);
+	stats->merged = atomic_get(&hids_obj->notify_merged);
+	stats->dropped = atomic_get(&hids_obj->notify_dropped);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif /* CONFIG_BT_HIDS_NOTIFY_BATCH */
 }
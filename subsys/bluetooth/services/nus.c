@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <zephyr.h>
+#include <sys/ring_buffer.h>
 #include <bluetooth/conn.h>
 #include <bluetooth/uuid.h>
 #include <bluetooth/gatt.h>
@@ -15,6 +17,38 @@ LOG_MODULE_REGISTER(bt_nus, CONFIG_BT_NUS_LOG_LEVEL);
 
 static struct bt_nus_cb nus_cb;
 
+#if defined(CONFIG_BT_NUS_STREAM)
+BUILD_ASSERT(CONFIG_BT_NUS_STREAM_LOW_WATERMARK <
+	     CONFIG_BT_NUS_STREAM_HIGH_WATERMARK);
+BUILD_ASSERT(CONFIG_BT_NUS_STREAM_HIGH_WATERMARK <=
+	     CONFIG_BT_NUS_STREAM_BUF_SIZE);
+
+/* Delay before retrying when the host is out of TX buffers and no
+ * notification is in flight to trigger the next attempt.
+ */
+#define STREAM_RETRY_DELAY K_MSEC(10)
+
+struct nus_stream {
+	/* Connection object, NULL if the context is unused */
+	struct bt_conn *conn;
+	/* Data waiting to be sent */
+	struct ring_buf rb;
+	uint8_t rb_data[CONFIG_BT_NUS_STREAM_BUF_SIZE];
+	/* Serializes adding data with dropping all the data */
+	struct k_spinlock rb_lock;
+	/* Work that queues notifications */
+	struct k_work_delayable tx_work;
+	/* Number of notifications queued in the host */
+	atomic_t in_flight;
+	/* Set when the high watermark was reached */
+	atomic_t throttled;
+};
+
+static struct nus_stream streams[CONFIG_BT_MAX_CONN];
+/* Serializes claiming and releasing the stream contexts */
+static struct k_spinlock streams_lock;
+#endif /* CONFIG_BT_NUS_STREAM */
+
 static void nus_ccc_cfg_changed(const struct bt_gatt_attr *attr,
 				  uint16_t value)
 {
@@ -53,6 +87,25 @@ static void on_sent(struct bt_conn *conn, void *user_data)
 	}
 }
 
+#if defined(CONFIG_BT_NUS_STREAM)
+static void on_stream_sent(struct bt_conn *conn, void *user_data)
+{
+	struct nus_stream *stream = user_data;
+
+	/* Notifications that complete after the disconnection must not
+	 * change a context that is reused for another connection.
+	 */
+	if (stream->conn != conn) {
+		return;
+	}
+
+	atomic_dec(&stream->in_flight);
+	k_work_reschedule(&stream->tx_work, K_NO_WAIT);
+
+	on_sent(conn, NULL);
+}
+#endif /* CONFIG_BT_NUS_STREAM */
+
 /* UART Service Declaration */
 BT_GATT_SERVICE_DEFINE(nus_svc,
 BT_GATT_PRIMARY_SERVICE(BT_UUID_NUS_SERVICE),
@@ -68,13 +121,223 @@ BT_GATT_PRIMARY_SERVICE(BT_UUID_NUS_SERVICE),
 			       NULL, on_receive, NULL),
 );
 
+#if defined(CONFIG_BT_NUS_STREAM)
+static struct nus_stream *stream_find(struct bt_conn *conn)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(streams); i++) {
+		if (streams[i].conn == conn) {
+			return &streams[i];
+		}
+	}
+
+	return NULL;
+}
+
+static struct nus_stream *stream_get(struct bt_conn *conn)
+{
+	struct nus_stream *stream;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&streams_lock);
+
+	stream = stream_find(conn);
+	if (stream) {
+		k_spin_unlock(&streams_lock, key);
+		return stream;
+	}
+
+	stream = stream_find(NULL);
+	if (stream) {
+		ring_buf_init(&stream->rb, sizeof(stream->rb_data),
+			      stream->rb_data);
+		atomic_set(&stream->in_flight, 0);
+		atomic_set(&stream->throttled, false);
+		stream->conn = bt_conn_ref(conn);
+	}
+
+	k_spin_unlock(&streams_lock, key);
+
+	if (stream) {
+		LOG_DBG("Stream context allocated, conn %p", (void *)conn);
+	}
+
+	return stream;
+}
+
+static void stream_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	struct nus_stream *stream = stream_find(conn);
+	struct k_work_sync sync;
+	k_spinlock_key_t key;
+
+	if (!stream) {
+		return;
+	}
+
+	/* The work handler must be done with the connection before it is
+	 * released.
+	 */
+	k_work_cancel_delayable_sync(&stream->tx_work, &sync);
+
+	key = k_spin_lock(&streams_lock);
+	stream->conn = NULL;
+	k_spin_unlock(&streams_lock, key);
+
+	bt_conn_unref(conn);
+
+	LOG_DBG("Stream context released, conn %p", (void *)conn);
+}
+
+static uint32_t stream_used_get(struct nus_stream *stream)
+{
+	return ring_buf_capacity_get(&stream->rb) -
+	       ring_buf_space_get(&stream->rb);
+}
+
+static void stream_tx_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct nus_stream *stream = CONTAINER_OF(dwork, struct nus_stream,
+						 tx_work);
+	struct bt_gatt_notify_params params = {
+		.attr = &nus_svc.attrs[2],
+		.func = on_stream_sent,
+		.user_data = stream,
+	};
+	struct bt_conn *conn = stream->conn;
+	uint32_t mtu;
+	uint8_t *data;
+	int err;
+
+	if (!conn) {
+		return;
+	}
+
+	mtu = bt_nus_get_mtu(conn);
+
+	while (atomic_get(&stream->in_flight) < CONFIG_BT_NUS_STREAM_TX_COUNT) {
+		/* At most one shorter notification is sent when the
+		 * data wraps around the end of the ring buffer.
+		 */
+		params.len = ring_buf_get_claim(&stream->rb, &data, mtu);
+		if (!params.len) {
+			break;
+		}
+
+		params.data = data;
+
+		atomic_inc(&stream->in_flight);
+		err = bt_gatt_notify_cb(conn, &params);
+		if (err) {
+			atomic_dec(&stream->in_flight);
+			ring_buf_get_finish(&stream->rb, 0);
+
+			if (err == -ENOMEM) {
+				if (!atomic_get(&stream->in_flight)) {
+					k_work_reschedule(&stream->tx_work,
+							  STREAM_RETRY_DELAY);
+				}
+			} else {
+				/* Peer unsubscribed or the link is being
+				 * terminated: drop the queued data.
+				 */
+				k_spinlock_key_t key;
+
+				LOG_WRN("Stream notification failed (err %d)",
+					err);
+
+				key = k_spin_lock(&stream->rb_lock);
+				ring_buf_reset(&stream->rb);
+				k_spin_unlock(&stream->rb_lock, key);
+			}
+			break;
+		}
+
+		/* The notification data is copied by the host */
+		ring_buf_get_finish(&stream->rb, params.len);
+	}
+
+	if (atomic_get(&stream->throttled) &&
+	    (stream_used_get(stream) <= CONFIG_BT_NUS_STREAM_LOW_WATERMARK)) {
+		atomic_set(&stream->throttled, false);
+		if (nus_cb.low_watermark) {
+			nus_cb.low_watermark(conn);
+		}
+	}
+}
+
+int bt_nus_stream_send(struct bt_conn *conn, const uint8_t *data,
+		       uint32_t len)
+{
+	struct nus_stream *stream;
+	k_spinlock_key_t key;
+	uint32_t written;
+
+	if (!conn || !bt_gatt_is_subscribed(conn, &nus_svc.attrs[2],
+					    BT_GATT_CCC_NOTIFY)) {
+		return -EINVAL;
+	}
+
+	stream = stream_get(conn);
+	if (!stream) {
+		LOG_WRN("No stream context available");
+		return -ENOMEM;
+	}
+
+	key = k_spin_lock(&stream->rb_lock);
+	written = ring_buf_put(&stream->rb, data, len);
+	k_spin_unlock(&stream->rb_lock, key);
+
+	if ((stream_used_get(stream) >= CONFIG_BT_NUS_STREAM_HIGH_WATERMARK) &&
+	    !atomic_set(&stream->throttled, true)) {
+		if (nus_cb.high_watermark) {
+			nus_cb.high_watermark(conn);
+		}
+	}
+
+	k_work_reschedule(&stream->tx_work, K_NO_WAIT);
+
+	return written;
+}
+
+uint32_t bt_nus_stream_space_get(struct bt_conn *conn)
+{
+	struct nus_stream *stream = stream_find(conn);
+
+	if (!stream) {
+		return stream_find(NULL) ? CONFIG_BT_NUS_STREAM_BUF_SIZE : 0;
+	}
+
+	return ring_buf_space_get(&stream->rb);
+}
+#endif /* CONFIG_BT_NUS_STREAM */
+
 int bt_nus_init(struct bt_nus_cb *callbacks)
 {
 	if (callbacks) {
 		nus_cb.received = callbacks->received;
 		nus_cb.sent = callbacks->sent;
 		nus_cb.send_enabled = callbacks->send_enabled;
+		nus_cb.high_watermark = callbacks->high_watermark;
+		nus_cb.low_watermark = callbacks->low_watermark;
+	}
+
+#if defined(CONFIG_BT_NUS_STREAM)
+	static struct bt_conn_cb conn_callbacks = {
+		.disconnected = stream_disconnected,
+	};
+	static bool conn_cb_registered;
+
+	if (!conn_cb_registered) {
+		for (size_t i = 0; i < ARRAY_SIZE(streams); i++) {
+			k_work_init_delayable(&streams[i].tx_work,
+					      stream_tx_work_handler);
+		}
+
+		bt_conn_cb_register(&conn_callbacks);
+		conn_cb_registered = true;
 	}
+#endif /* CONFIG_BT_NUS_STREAM */
 
 	return 0;
 }
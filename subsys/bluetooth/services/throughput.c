@@ -24,6 +24,61 @@ LOG_MODULE_REGISTER(bt_throughput, CONFIG_BT_THROUGHPUT_LOG_LEVEL);
 static struct bt_throughput_metrics met;
 static const struct bt_throughput_cb *callbacks;
 
+#if defined(CONFIG_BT_THROUGHPUT_STATS)
+static struct {
+	struct bt_throughput_stats stats;
+	/* Sum of the throughput of all measurement periods */
+	uint64_t rate_sum;
+	/* Bytes received in the current measurement period */
+	uint32_t period_len;
+	/* Start of the current measurement period */
+	uint32_t period_start;
+	/* Time of the last write */
+	uint32_t last_write;
+} stats_ctx;
+
+static void stats_reset(uint32_t now)
+{
+	memset(&stats_ctx, 0, sizeof(stats_ctx));
+	stats_ctx.period_start = now;
+	stats_ctx.last_write = now;
+}
+
+static void stats_update(uint32_t now, uint16_t len)
+{
+	struct bt_throughput_stats *stats = &stats_ctx.stats;
+	uint32_t gap = k_cyc_to_us_floor32(now - stats_ctx.last_write);
+	uint32_t period = k_cyc_to_ms_floor32(now - stats_ctx.period_start);
+	size_t bucket;
+
+	stats_ctx.last_write = now;
+	stats_ctx.period_len += len;
+
+	bucket = (gap < 2) ? 0 : (31 - __builtin_clz(gap));
+	bucket = MIN(bucket, BT_THROUGHPUT_STATS_HIST_SIZE - 1);
+	stats->write_gap_hist[bucket]++;
+	stats->write_gap_max = MAX(stats->write_gap_max, gap);
+
+	if (period < CONFIG_BT_THROUGHPUT_STATS_PERIOD_MS) {
+		return;
+	}
+
+	uint32_t rate = ((uint64_t)stats_ctx.period_len << 3) * 1000 / period;
+
+	if (!stats->period_count || (rate < stats->rate_min)) {
+		stats->rate_min = rate;
+	}
+
+	stats->rate_max = MAX(stats->rate_max, rate);
+	stats->period_count++;
+	stats_ctx.rate_sum += rate;
+	stats->rate_avg = stats_ctx.rate_sum / stats->period_count;
+
+	stats_ctx.period_len = 0;
+	stats_ctx.period_start = now;
+}
+#endif /* CONFIG_BT_THROUGHPUT_STATS */
+
 static uint8_t read_fn(struct bt_conn *conn, uint8_t err,
 		    struct bt_gatt_read_params *params, const void *data,
 		    uint16_t len)
@@ -52,10 +107,11 @@ static ssize_t write_callback(struct bt_conn *conn,
 	static uint32_t kb;
 
 	uint64_t delta;
+	uint32_t now = k_cycle_get_32();
 
 	struct bt_throughput_metrics *met_data = attr->user_data;
 
-	delta = k_cycle_get_32() - clock_cycles;
+	delta = now - clock_cycles;
 	delta = k_cyc_to_ns_floor64(delta);
 
 	if (len == 1) {
@@ -64,12 +120,20 @@ static ssize_t write_callback(struct bt_conn *conn,
 		met_data->write_count = 0;
 		met_data->write_len = 0;
 		met_data->write_rate = 0;
-		clock_cycles = k_cycle_get_32();
+		clock_cycles = now;
+
+#if defined(CONFIG_BT_THROUGHPUT_STATS)
+		stats_reset(now);
+#endif
 	} else {
 		met_data->write_count++;
 		met_data->write_len += len;
 		met_data->write_rate =
 		    ((uint64_t)met_data->write_len << 3) * 1000000000 / delta;
+
+#if defined(CONFIG_BT_THROUGHPUT_STATS)
+		stats_update(now, len);
+#endif
 	}
 
 	LOG_DBG("Received data.");
@@ -181,3 +245,16 @@ int bt_throughput_write(struct bt_throughput *throughput,
 					      throughput->char_handle,
 					      data, len, false);
 }
+
+#if defined(CONFIG_BT_THROUGHPUT_STATS)
+int bt_throughput_stats_get(struct bt_throughput_stats *stats)
+{
+	if (!stats) {
+		return -EINVAL;
+	}
+
+	*stats = stats_ctx.stats;
+
+	return 0;
+}
+#endif /* CONFIG_BT_THROUGHPUT_STATS */
@@ -5,18 +5,11 @@
  */
 #include <errno.h>
 #include <irq.h>
-#include <sys/byteorder.h>
-#include <nrf.h>
 #include <esb.h>
-#ifdef DPPI_PRESENT
-#include <nrfx_dppi.h>
-#else
-#include <nrfx_ppi.h>
-#endif
-#include <helpers/nrfx_gppi.h>
 #include <stddef.h>
 #include <string.h>
-#include <nrf_erratas.h>
+
+#include "esb_radio.h"
 
 /* Constants */
 
@@ -42,43 +35,24 @@
 /* Interrupt mask value for RX_DR. */
 #define INT_RX_DATA_RECEIVED_MSK 0x04
 
-/* Mask value to signal updating BASE0 radio address. */
-#define ADDR_UPDATE_MASK_BASE0 (1 << 0)
-/* Mask value to signal updating BASE1 radio address. */
-#define ADDR_UPDATE_MASK_BASE1 (1 << 1)
-/* Mask value to signal updating radio prefixes. */
-#define ADDR_UPDATE_MASK_PREFIX (1 << 2)
-
  /* The maximum value for PID. */
 #define PID_MAX 3
 
 #define BIT_MASK_UINT_8(x) (0xFF >> (8 - (x)))
 
-#define RADIO_SHORTS_COMMON                                                    \
-	(RADIO_SHORTS_READY_START_Msk | RADIO_SHORTS_END_DISABLE_Msk |         \
-	 RADIO_SHORTS_ADDRESS_RSSISTART_Msk |                                  \
-	 RADIO_SHORTS_DISABLED_RSSISTOP_Msk)
+/* Length of the S0 or LENGTH field and the S1 field in RAM. */
+#define PACKET_HEADER_LENGTH 2
 
-#ifdef CONFIG_ESB_SYS_TIMER0
-#define ESB_SYS_TIMER NRF_TIMER0
-#define ESB_SYS_TIMER_IRQn TIMER0_IRQn
-#endif
-#ifdef CONFIG_ESB_SYS_TIMER1
-#define ESB_SYS_TIMER NRF_TIMER1
-#define ESB_SYS_TIMER_IRQn TIMER1_IRQn
-#endif
-#ifdef CONFIG_ESB_SYS_TIMER2
-#define ESB_SYS_TIMER NRF_TIMER2
-#define ESB_SYS_TIMER_IRQn TIMER2_IRQn
-#endif
-#ifdef CONFIG_ESB_SYS_TIMER3
-#define ESB_SYS_TIMER NRF_TIMER3
-#define ESB_SYS_TIMER_IRQn TIMER3_IRQn
-#endif
-#ifdef CONFIG_ESB_SYS_TIMER4
-#define ESB_SYS_TIMER NRF_TIMER4
-#define ESB_SYS_TIMER_IRQn TIMER4_IRQn
-#endif
+/* The radio transfers the packet header and data straight to and from the
+ * payloads in the FIFOs. The header overlays the noack and pid fields,
+ * which are decoded after reception and encoded before transmission.
+ */
+BUILD_ASSERT(offsetof(struct esb_payload, noack) + 1 ==
+	     offsetof(struct esb_payload, pid),
+	     "The packet header must overlay the noack and pid fields");
+BUILD_ASSERT(offsetof(struct esb_payload, pid) + 1 ==
+	     offsetof(struct esb_payload, data),
+	     "The packet header must overlay the noack and pid fields");
 
 /* Internal Enhanced ShockBurst module state. */
 enum esb_state {
@@ -104,24 +78,44 @@ struct pipe_info {
 	bool ack_payload; /* State of the transmission of ACK payloads. */
 };
 
-/* Structure used by the PRX to organize ACK payloads for multiple pipes. */
+/* Structure used to queue the TX payloads on their pipe. */
 struct payload_wrap {
-	/* Pointer to the ACK payload. */
+	/* Pointer to the payload. */
 	struct esb_payload  *p_payload;
 	/* Value used to determine if the current payload pointer is used. */
 	bool in_use;
-	/* Pointer to the next ACK payload queued on the same pipe. */
+	/* Pointer to the next payload queued on the same pipe. */
 	struct payload_wrap *p_next;
 };
 
-/* First-in, first-out queue of payloads to be transmitted. */
+/* First-in, first-out queue of payloads to be transmitted on a pipe. */
+struct payload_tx_queue {
+	struct payload_wrap *front;	/* Front of the queue (first out). */
+	struct payload_wrap *back;	/* Back of the queue (last in). */
+	uint32_t count;			/* Number of elements in the queue. */
+	uint32_t weight;		/* Payloads sent in a round-robin turn. */
+};
+
+/* Payloads to be transmitted, queued per pipe.
+ *
+ * In PTX mode, the pipes take turns with weighted round-robin: a pipe sends
+ * up to its weight in payloads before the next pipe with queued payloads
+ * gets its turn. In PRX mode, the payloads of a pipe are sent with the ACKs
+ * on that pipe.
+ */
 struct payload_tx_fifo {
-	 /* Payload queue */
-	struct esb_payload *payload[CONFIG_ESB_TX_FIFO_SIZE];
+	struct payload_tx_queue queue[CONFIG_ESB_PIPE_COUNT];
 
-	uint32_t back;	/* Back of the queue (last in). */
-	uint32_t front;	/* Front of queue (first out). */
-	uint32_t count;	/* Number of elements in the queue. */
+	uint32_t count;		/* Number of elements in all queues. */
+	uint32_t pipe;		/* Pipe of the current round-robin turn. */
+	uint32_t credit;	/* Payloads left in the current turn. */
+};
+
+/* Pipe statistics, with the RSSI average in 1/16 dBm. */
+struct pipe_stats {
+	struct esb_pipe_stats stats;
+	int32_t rssi_avg_q4;
+	bool rssi_valid;
 };
 
 /* First-in, first-out queue of received payloads. */
@@ -134,22 +128,6 @@ struct payload_rx_fifo {
 	uint32_t count;	/* Number of elements in the queue. */
 };
 
-/* Enhanced ShockBurst address.
- *
- * Enhanced ShockBurst addresses consist of a base address and a prefix
- * that is unique for each pipe. See @ref esb_addressing in the ESB user
- * guide for more information.
- */
-struct esb_address {
-	uint8_t base_addr_p0[4];	/* Base address for pipe 0, in big endian. */
-	uint8_t base_addr_p1[4];   /* Base address for pipe 1-7, in big endian. */
-	uint8_t pipe_prefixes[8];	/* Address prefix for pipe 0 to 7. */
-	uint8_t num_pipes;		/* Number of pipes available. */
-	uint8_t addr_length;	/* Length of the address plus the prefix. */
-	uint8_t rx_pipes_enabled;	/* Bitfield for enabled pipes. */
-	uint8_t rf_channel;        /* Channel to use (between 0 and 100). */
-};
-
 
 static bool esb_initialized;
 static struct esb_config esb_cfg;
@@ -159,7 +137,6 @@ static volatile enum esb_state esb_state = ESB_STATE_IDLE;
  * Roughly equal to the nRF24Lxx defaults, except for the number of pipes,
  * because more pipes are supported.
  */
-__ALIGN(4)
 static struct esb_address esb_addr = {
 	.base_addr_p0 = {0xE7, 0xE7, 0xE7, 0xE7},
 	.base_addr_p1 = {0xC2, 0xC2, 0xC2, 0xC2},
@@ -176,183 +153,71 @@ static struct esb_payload *current_payload;
 /* FIFOs and buffers */
 static struct payload_tx_fifo tx_fifo;
 static struct payload_rx_fifo rx_fifo;
-static uint8_t tx_payload_buffer[CONFIG_ESB_MAX_PAYLOAD_LENGTH + 2];
-static uint8_t rx_payload_buffer[CONFIG_ESB_MAX_PAYLOAD_LENGTH + 2];
+/* Payload the radio receives to, either the back of the RX FIFO or the
+ * scratch payload, when the RX FIFO is full.
+ */
+static struct esb_payload *rx_payload;
+static struct esb_payload rx_payload_scratch;
+/* Header of the ACK packets without payload. */
+static uint8_t ack_packet[PACKET_HEADER_LENGTH];
 
-/* Random access buffer variables for ACK payload handling */
-struct payload_wrap ack_pl_wrap[CONFIG_ESB_TX_FIFO_SIZE];
-struct payload_wrap *ack_pl_wrap_pipe[CONFIG_ESB_PIPE_COUNT];
+/* Payloads borrowed by the application. */
+static struct esb_payload *rx_payload_borrowed;
+static struct esb_payload *tx_payload_borrowed;
+
+/* TX payloads and their queue entries. */
+static struct esb_payload tx_payloads[CONFIG_ESB_TX_FIFO_SIZE];
+static struct payload_wrap tx_wraps[CONFIG_ESB_TX_FIFO_SIZE];
 
 /* Run time variables */
 static uint8_t pids[CONFIG_ESB_PIPE_COUNT];
 static struct pipe_info rx_pipe_info[CONFIG_ESB_PIPE_COUNT];
+static struct pipe_stats pipe_stats[CONFIG_ESB_PIPE_COUNT];
 static volatile uint32_t interrupt_flags;
 static volatile uint32_t retransmits_remaining;
 static volatile uint32_t last_tx_attempts;
 static volatile uint32_t wait_for_ack_timeout_us;
 
-static uint32_t radio_shorts_common = RADIO_SHORTS_COMMON;
-
-/* PPI or DPPI instances */
-#ifdef DPPI_PRESENT
-typedef uint8_t ppi_channel_t;
-#else
-typedef nrf_ppi_channel_t ppi_channel_t;
-#endif
-
-static ppi_channel_t ppi_ch_radio_ready_timer_start;
-static ppi_channel_t ppi_ch_radio_address_timer_stop;
-static ppi_channel_t ppi_ch_timer_compare0_radio_disable;
-static ppi_channel_t ppi_ch_timer_compare1_radio_txen;
-
-static uint32_t ppi_all_channels_mask;
-
-/* These function pointers are changed dynamically, depending on protocol
- * configuration and state. Note that they will be 0 initialized.
+/* This function pointer is changed dynamically, depending on the state.
+ * Note that it will be 0 initialized.
  */
 static void (*on_radio_disabled)(void);
-static void (*on_radio_end)(void);
-static void (*update_rf_payload_format)(uint32_t payload_length);
 
-/*  The following functions are assigned to the function pointers above. */
+/*  The following functions are assigned to the function pointer above. */
 static void on_radio_disabled_tx_noack(void);
 static void on_radio_disabled_tx(void);
 static void on_radio_disabled_tx_wait_for_ack(void);
 static void on_radio_disabled_rx(void);
 static void on_radio_disabled_rx_ack(void);
 
-/*  Function to do bytewise bit-swap on an unsigned 32-bit value */
-static uint32_t bytewise_bit_swap(const uint8_t *input)
+/* Get the packet, starting with the header, that the radio transfers for
+ * the payload.
+ */
+static uint8_t *payload_packet(struct esb_payload *payload)
 {
-#if __CORTEX_M == (0x04U)
-	uint32_t inp = (*(uint32_t *)input);
-
-	return sys_cpu_to_be32((uint32_t)__RBIT(inp));
-#else
-	uint32_t inp = sys_cpu_to_le32(*(uint32_t *)input);
-
-	inp = (inp & 0xF0F0F0F0) >> 4 | (inp & 0x0F0F0F0F) << 4;
-	inp = (inp & 0xCCCCCCCC) >> 2 | (inp & 0x33333333) << 2;
-	inp = (inp & 0xAAAAAAAA) >> 1 | (inp & 0x55555555) << 1;
-	return inp;
-#endif
+	return (uint8_t *)payload + offsetof(struct esb_payload, data) -
+	       PACKET_HEADER_LENGTH;
 }
 
-/* Convert a base address from nRF24L format to nRF5 format */
-static uint32_t addr_conv(const uint8_t *addr)
+static void update_rf_payload_format(uint32_t payload_length)
 {
-	return __REV(bytewise_bit_swap(addr));
+	esb_radio_packet_format_set(esb_cfg.protocol, esb_addr.addr_length,
+				    payload_length);
 }
 
-static inline void apply_errata143_workaround(void)
+static void update_radio_addresses(void)
 {
-	/* Workaround for Errata 143
-	 * Check if the most significant bytes of address 0 (including
-	 * prefix) match those of another address. It's recommended to
-	 * use a unique address 0 since this will avoid the 3dBm penalty
-	 * incurred from the workaround.
-	 */
-	uint32_t base_address_mask =
-		esb_addr.addr_length == 5 ? 0xFFFF0000 : 0xFF000000;
-
-	/* Load the two addresses before comparing them to ensure
-	 * defined ordering of volatile accesses.
-	 */
-	uint32_t addr0 = NRF_RADIO->BASE0 & base_address_mask;
-	uint32_t addr1 = NRF_RADIO->BASE1 & base_address_mask;
-
-	if (addr0 == addr1) {
-		uint32_t prefix0 = NRF_RADIO->PREFIX0 & 0x000000FF;
-		uint32_t prefix1 = (NRF_RADIO->PREFIX0 & 0x0000FF00) >> 8;
-		uint32_t prefix2 = (NRF_RADIO->PREFIX0 & 0x00FF0000) >> 16;
-		uint32_t prefix3 = (NRF_RADIO->PREFIX0 & 0xFF000000) >> 24;
-		uint32_t prefix4 = NRF_RADIO->PREFIX1 & 0x000000FF;
-		uint32_t prefix5 = (NRF_RADIO->PREFIX1 & 0x0000FF00) >> 8;
-		uint32_t prefix6 = (NRF_RADIO->PREFIX1 & 0x00FF0000) >> 16;
-		uint32_t prefix7 = (NRF_RADIO->PREFIX1 & 0xFF000000) >> 24;
-
-		if (prefix0 == prefix1 || prefix0 == prefix2 ||
-			prefix0 == prefix3 || prefix0 == prefix4 ||
-			prefix0 == prefix5 || prefix0 == prefix6 ||
-			prefix0 == prefix7) {
-			/* This will cause a 3dBm sensitivity loss,
-			 * avoid using such address combinations if possible.
-			 */
-			*(volatile uint32_t *)0x40001774 =
-				((*(volatile uint32_t *)0x40001774) & 0xfffffffe) | 0x01000000;
-		}
-	}
-}
-
-static void update_rf_payload_format_esb_dpl(uint32_t payload_length)
-{
-#if (CONFIG_ESB_MAX_PAYLOAD_LENGTH <= 32)
-	/* Using 6 bits for length */
-	NRF_RADIO->PCNF0 = (0 << RADIO_PCNF0_S0LEN_Pos) |
-			   (6 << RADIO_PCNF0_LFLEN_Pos) |
-			   (3 << RADIO_PCNF0_S1LEN_Pos);
-#else
-	/* Using 8 bits for length */
-	NRF_RADIO->PCNF0 = (0 << RADIO_PCNF0_S0LEN_Pos) |
-			   (8 << RADIO_PCNF0_LFLEN_Pos) |
-			   (3 << RADIO_PCNF0_S1LEN_Pos);
-#endif
-	NRF_RADIO->PCNF1 =
-		(RADIO_PCNF1_WHITEEN_Disabled << RADIO_PCNF1_WHITEEN_Pos) |
-		(RADIO_PCNF1_ENDIAN_Big << RADIO_PCNF1_ENDIAN_Pos) |
-		((esb_addr.addr_length - 1) << RADIO_PCNF1_BALEN_Pos) |
-		(0 << RADIO_PCNF1_STATLEN_Pos) |
-		(CONFIG_ESB_MAX_PAYLOAD_LENGTH << RADIO_PCNF1_MAXLEN_Pos);
-}
-
-static void update_rf_payload_format_esb(uint32_t payload_length)
-{
-	NRF_RADIO->PCNF0 = (1 << RADIO_PCNF0_S0LEN_Pos) |
-			   (0 << RADIO_PCNF0_LFLEN_Pos) |
-			   (1 << RADIO_PCNF0_S1LEN_Pos);
-
-	NRF_RADIO->PCNF1 =
-		(RADIO_PCNF1_WHITEEN_Disabled << RADIO_PCNF1_WHITEEN_Pos) |
-		(RADIO_PCNF1_ENDIAN_Big << RADIO_PCNF1_ENDIAN_Pos) |
-		((esb_addr.addr_length - 1) << RADIO_PCNF1_BALEN_Pos) |
-		(payload_length << RADIO_PCNF1_STATLEN_Pos) |
-		(payload_length << RADIO_PCNF1_MAXLEN_Pos);
-}
-
-static void update_radio_addresses(uint8_t update_mask)
-{
-	if ((update_mask & ADDR_UPDATE_MASK_BASE0) != 0) {
-		NRF_RADIO->BASE0 = addr_conv(esb_addr.base_addr_p0);
-	}
-
-	if ((update_mask & ADDR_UPDATE_MASK_BASE1) != 0) {
-		NRF_RADIO->BASE1 = addr_conv(esb_addr.base_addr_p1);
-	}
-
-	if ((update_mask & ADDR_UPDATE_MASK_PREFIX) != 0) {
-		NRF_RADIO->PREFIX0 =
-			bytewise_bit_swap(&esb_addr.pipe_prefixes[0]);
-		NRF_RADIO->PREFIX1 =
-			bytewise_bit_swap(&esb_addr.pipe_prefixes[4]);
-	}
-
-	/* Workaround for Errata 143 */
-#if NRF52_ERRATA_143_ENABLE_WORKAROUND
-	if (nrf52_errata_143()) {
-		apply_errata143_workaround();
-	}
-#endif
+	esb_radio_addresses_set(&esb_addr);
 }
 
 static void update_radio_tx_power(void)
 {
-	NRF_RADIO->TXPOWER = esb_cfg.tx_output_power
-			     << RADIO_TXPOWER_TXPOWER_Pos;
+	esb_radio_tx_power_set(esb_cfg.tx_output_power);
 }
 
 static bool update_radio_bitrate(void)
 {
-	NRF_RADIO->MODE = esb_cfg.bitrate << RADIO_MODE_MODE_Pos;
+	esb_radio_bitrate_set(esb_cfg.bitrate);
 
 	switch (esb_cfg.bitrate) {
 	case ESB_BITRATE_2MBPS:
@@ -388,11 +253,7 @@ static bool update_radio_protocol(void)
 {
 	switch (esb_cfg.protocol) {
 	case ESB_PROTOCOL_ESB_DPL:
-		update_rf_payload_format = update_rf_payload_format_esb_dpl;
-		break;
-
 	case ESB_PROTOCOL_ESB:
-		update_rf_payload_format = update_rf_payload_format_esb;
 		break;
 
 	default:
@@ -404,29 +265,7 @@ static bool update_radio_protocol(void)
 
 static bool update_radio_crc(void)
 {
-	switch (esb_cfg.crc) {
-	case ESB_CRC_16BIT:
-		NRF_RADIO->CRCINIT = 0xFFFFUL;  /* Initial value */
-		NRF_RADIO->CRCPOLY = 0x11021UL; /* CRC poly: x^16+x^12^x^5+1 */
-		break;
-
-	case ESB_CRC_8BIT:
-		NRF_RADIO->CRCINIT = 0xFFUL;  /* Initial value */
-		NRF_RADIO->CRCPOLY = 0x107UL; /* CRC poly: x^8+x^2^x^1+1 */
-		break;
-
-	case ESB_CRC_OFF:
-		break;
-
-	default:
-		return false;
-	}
-
-	NRF_RADIO->CRCINIT = 0xFFFFUL;  /* Initial value */
-	NRF_RADIO->CRCPOLY = 0x11021UL; /* CRC poly: x^16+x^12^x^5+1 */
-	NRF_RADIO->CRCCNF = ESB_CRC_16BIT << RADIO_CRCCNF_LEN_Pos;
-
-	return true;
+	return esb_radio_crc_set(esb_cfg.crc);
 }
 
 static bool update_radio_parameters(void)
@@ -444,41 +283,124 @@ static bool update_radio_parameters(void)
 	return params_valid;
 }
 
-static void reset_fifos(void)
+static void reset_tx_fifo(void)
 {
-	tx_fifo.back = 0;
-	tx_fifo.front = 0;
+	for (size_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
+		tx_wraps[i].in_use = false;
+		tx_wraps[i].p_next = NULL;
+	}
+
+	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
+		tx_fifo.queue[i].front = NULL;
+		tx_fifo.queue[i].back = NULL;
+		tx_fifo.queue[i].count = 0;
+
+		/* ACK payloads that were sent are not reported when the next
+		 * packet arrives.
+		 */
+		rx_pipe_info[i].ack_payload = false;
+	}
+
 	tx_fifo.count = 0;
+	tx_fifo.credit = tx_fifo.queue[tx_fifo.pipe].weight;
+	tx_payload_borrowed = NULL;
+}
+
+static void reset_fifos(void)
+{
+	reset_tx_fifo();
 
 	rx_fifo.back = 0;
 	rx_fifo.front = 0;
 	rx_fifo.count = 0;
+
+	rx_payload_borrowed = NULL;
 }
 
 static void initialize_fifos(void)
 {
-	static struct esb_payload rx_payload[CONFIG_ESB_RX_FIFO_SIZE];
-	static struct esb_payload tx_payload[CONFIG_ESB_TX_FIFO_SIZE];
+	static struct esb_payload rx_payloads[CONFIG_ESB_RX_FIFO_SIZE];
+
+	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
+		tx_fifo.queue[i].weight = 1;
+	}
+	tx_fifo.pipe = 0;
 
 	reset_fifos();
 
 	for (size_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
-		tx_fifo.payload[i] = &tx_payload[i];
+		tx_wraps[i].p_payload = &tx_payloads[i];
 	}
 
 	for (size_t i = 0; i < CONFIG_ESB_RX_FIFO_SIZE; i++) {
-		rx_fifo.payload[i] = &rx_payload[i];
+		rx_fifo.payload[i] = &rx_payloads[i];
 	}
+}
 
-	for (size_t i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
-		ack_pl_wrap[i].p_payload = &tx_payload[i];
-		ack_pl_wrap[i].in_use = false;
-		ack_pl_wrap[i].p_next = 0;
+/*  Function to remove the payload at the front of the TX queue of a pipe.
+ *  Must be called with interrupts locked.
+ */
+static void tx_queue_pop(uint8_t pipe)
+{
+	struct payload_tx_queue *queue = &tx_fifo.queue[pipe];
+	struct payload_wrap *wrap = queue->front;
+
+	queue->front = wrap->p_next;
+	if (queue->front == NULL) {
+		queue->back = NULL;
 	}
+	queue->count--;
+	tx_fifo.count--;
+
+	wrap->in_use = false;
+	wrap->p_next = NULL;
+}
+
+/*  Function to get the pipe of the next payload to send in PTX mode, with
+ *  weighted round-robin between the pipes, without changing the current
+ *  turn. Returns CONFIG_ESB_PIPE_COUNT if the TX FIFO is empty.
+ */
+static uint32_t tx_fifo_next_pipe(void)
+{
+	uint32_t pipe = tx_fifo.pipe;
 
+	if (tx_fifo.queue[pipe].count > 0 && tx_fifo.credit > 0) {
+		return pipe;
+	}
+
+	/* Every pipe starts its turn with some credit. The current pipe is
+	 * checked last, for a new turn.
+	 */
 	for (size_t i = 0; i < CONFIG_ESB_PIPE_COUNT; i++) {
-		ack_pl_wrap_pipe[i] = 0;
+		if (++pipe >= CONFIG_ESB_PIPE_COUNT) {
+			pipe = 0;
+		}
+
+		if (tx_fifo.queue[pipe].count > 0) {
+			return pipe;
+		}
 	}
+
+	return CONFIG_ESB_PIPE_COUNT;
+}
+
+/*  Function to get the next payload to send in PTX mode, and start the turn
+ *  of its pipe if needed.
+ */
+static struct esb_payload *tx_fifo_front(void)
+{
+	uint32_t pipe = tx_fifo_next_pipe();
+
+	if (pipe >= CONFIG_ESB_PIPE_COUNT) {
+		return NULL;
+	}
+
+	if (pipe != tx_fifo.pipe || tx_fifo.credit == 0) {
+		tx_fifo.pipe = pipe;
+		tx_fifo.credit = tx_fifo.queue[pipe].weight;
+	}
+
+	return tx_fifo.queue[pipe].front->p_payload;
 }
 
 static void tx_fifo_remove_last(void)
@@ -489,19 +411,51 @@ static void tx_fifo_remove_last(void)
 
 	uint32_t key = irq_lock();
 
-	tx_fifo.count--;
-	if (++tx_fifo.front >= CONFIG_ESB_TX_FIFO_SIZE) {
-		tx_fifo.front = 0;
+	tx_queue_pop(current_payload->pipe);
+	if (tx_fifo.credit > 0) {
+		tx_fifo.credit--;
 	}
 
 	irq_unlock(key);
 }
 
-/*  Function to push the content of the rx_buffer to the RX FIFO.
+static void pipe_stats_rssi_update(uint8_t pipe, int8_t rssi)
+{
+	struct pipe_stats *stats = &pipe_stats[pipe];
+
+	/* Exponential moving average over 8 packets */
+	if (!stats->rssi_valid) {
+		stats->rssi_avg_q4 = rssi * 16;
+		stats->rssi_valid = true;
+	} else {
+		stats->rssi_avg_q4 += (rssi * 16 - stats->rssi_avg_q4) / 8;
+	}
+
+	stats->stats.rssi = rssi;
+	stats->stats.rssi_avg = stats->rssi_avg_q4 / 16;
+}
+
+/*  Function to set the radio packet pointer for receiving a packet.
+ *
+ *  The packet is received straight to the back of the RX FIFO, or to the
+ *  scratch payload if the RX FIFO is full.
+ */
+static void rx_packet_ptr_set(void)
+{
+	if (rx_fifo.count < CONFIG_ESB_RX_FIFO_SIZE) {
+		rx_payload = rx_fifo.payload[rx_fifo.back];
+	} else {
+		rx_payload = &rx_payload_scratch;
+	}
+
+	esb_radio_packet_set(payload_packet(rx_payload));
+}
+
+/*  Function to push the received payload to the RX FIFO.
  *
- *  The module will point the register NRF_RADIO->PACKETPTR to a buffer for
- *  receiving packets. After receiving a packet the module will call this
- *  function to copy the received data to the RX FIFO.
+ *  The radio receives the packet to the back of the RX FIFO. After receiving
+ *  a packet the module will call this function to decode the packet header
+ *  and add the payload to the RX FIFO.
  *
  *  @param  pipe Pipe number to set for the packet.
  *  @param  pid  Packet ID.
@@ -511,29 +465,37 @@ static void tx_fifo_remove_last(void)
  */
 static bool rx_fifo_push_rfbuf(uint8_t pipe, uint8_t pid)
 {
-	if (rx_fifo.count >= CONFIG_ESB_RX_FIFO_SIZE) {
+	const uint8_t *packet = payload_packet(rx_payload);
+	uint8_t length = packet[0];
+	uint8_t s1 = packet[1];
+
+	/* The packet went to the scratch payload, or the RX FIFO was flushed
+	 * while it was received.
+	 */
+	if (rx_fifo.count >= CONFIG_ESB_RX_FIFO_SIZE ||
+	    rx_payload != rx_fifo.payload[rx_fifo.back]) {
 		return false;
 	}
 
 	if (esb_cfg.protocol == ESB_PROTOCOL_ESB_DPL) {
-		if (rx_payload_buffer[0] > CONFIG_ESB_MAX_PAYLOAD_LENGTH) {
+		if (length > CONFIG_ESB_MAX_PAYLOAD_LENGTH) {
 			return false;
 		}
-		rx_fifo.payload[rx_fifo.back]->length = rx_payload_buffer[0];
+		rx_payload->length = length;
 	} else if (esb_cfg.mode == ESB_MODE_PTX) {
 		/* Received packet is an acknowledgment */
-		rx_fifo.payload[rx_fifo.back]->length = 0;
+		rx_payload->length = 0;
 	} else {
-		rx_fifo.payload[rx_fifo.back]->length = esb_cfg.payload_length;
+		rx_payload->length = esb_cfg.payload_length;
 	}
 
-	memcpy(rx_fifo.payload[rx_fifo.back]->data, &rx_payload_buffer[2],
-	       rx_fifo.payload[rx_fifo.back]->length);
+	rx_payload->pipe = pipe;
+	rx_payload->rssi = esb_radio_rssi();
+	rx_payload->pid = pid;
+	rx_payload->noack = !(s1 & 0x01);
 
-	rx_fifo.payload[rx_fifo.back]->pipe = pipe;
-	rx_fifo.payload[rx_fifo.back]->rssi = NRF_RADIO->RSSISAMPLE;
-	rx_fifo.payload[rx_fifo.back]->pid = pid;
-	rx_fifo.payload[rx_fifo.back]->noack = !(rx_payload_buffer[1] & 0x01);
+	pipe_stats[pipe].stats.rx_packets++;
+	pipe_stats[pipe].stats.rx_bytes += rx_payload->length;
 
 	if (++rx_fifo.back >= CONFIG_ESB_RX_FIFO_SIZE) {
 		rx_fifo.back = 0;
@@ -543,70 +505,22 @@ static bool rx_fifo_push_rfbuf(uint8_t pipe, uint8_t pid)
 	return true;
 }
 
-static void sys_timer_init(void)
-{
-	/* Configure the system timer with a 1 MHz base frequency */
-	ESB_SYS_TIMER->PRESCALER = 4;
-	ESB_SYS_TIMER->BITMODE = TIMER_BITMODE_BITMODE_16Bit;
-	ESB_SYS_TIMER->SHORTS = TIMER_SHORTS_COMPARE1_CLEAR_Msk |
-				TIMER_SHORTS_COMPARE1_STOP_Msk;
-}
-
-static void ppi_init(void)
-{
-#ifdef DPPI_PRESENT
-	nrfx_dppi_channel_alloc(&ppi_ch_radio_ready_timer_start);
-	nrfx_dppi_channel_alloc(&ppi_ch_radio_address_timer_stop);
-	nrfx_dppi_channel_alloc(&ppi_ch_timer_compare0_radio_disable);
-	nrfx_dppi_channel_alloc(&ppi_ch_timer_compare1_radio_txen);
-
-	NRF_RADIO->PUBLISH_READY          = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_radio_ready_timer_start;
-	ESB_SYS_TIMER->SUBSCRIBE_START    = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_radio_ready_timer_start;
-	NRF_RADIO->PUBLISH_ADDRESS        = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_radio_address_timer_stop;
-	ESB_SYS_TIMER->SUBSCRIBE_SHUTDOWN = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_radio_address_timer_stop;
-	ESB_SYS_TIMER->PUBLISH_COMPARE[0] = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_timer_compare0_radio_disable;
-	NRF_RADIO->SUBSCRIBE_DISABLE      = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_timer_compare0_radio_disable;
-	ESB_SYS_TIMER->PUBLISH_COMPARE[1] = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_timer_compare1_radio_txen;
-	NRF_RADIO->SUBSCRIBE_TXEN         = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_timer_compare1_radio_txen;
-#else
-	nrfx_ppi_channel_alloc(&ppi_ch_radio_ready_timer_start);
-	nrfx_ppi_channel_alloc(&ppi_ch_radio_address_timer_stop);
-	nrfx_ppi_channel_alloc(&ppi_ch_timer_compare0_radio_disable);
-	nrfx_ppi_channel_alloc(&ppi_ch_timer_compare1_radio_txen);
-
-	nrfx_ppi_channel_assign(ppi_ch_radio_ready_timer_start,
-		(uint32_t)&NRF_RADIO->EVENTS_READY, (uint32_t)&ESB_SYS_TIMER->TASKS_START);
-	nrfx_ppi_channel_assign(ppi_ch_radio_address_timer_stop,
-		(uint32_t)&NRF_RADIO->EVENTS_ADDRESS, (uint32_t)&ESB_SYS_TIMER->TASKS_SHUTDOWN);
-	nrfx_ppi_channel_assign(ppi_ch_timer_compare0_radio_disable,
-		(uint32_t)&ESB_SYS_TIMER->EVENTS_COMPARE[0], (uint32_t)&NRF_RADIO->TASKS_DISABLE);
-	nrfx_ppi_channel_assign(ppi_ch_timer_compare1_radio_txen,
-		(uint32_t)&ESB_SYS_TIMER->EVENTS_COMPARE[1], (uint32_t)&NRF_RADIO->TASKS_TXEN);
-#endif
-	ppi_all_channels_mask = (1 << ppi_ch_radio_ready_timer_start) | (1 << ppi_ch_radio_address_timer_stop) |
-							(1 << ppi_ch_timer_compare0_radio_disable) | (1 << ppi_ch_timer_compare1_radio_txen);
-}
-
 static void start_tx_transaction(void)
 {
 	bool ack;
+	uint8_t *packet;
 
 	last_tx_attempts = 1;
 	/* Prepare the payload */
-	current_payload = tx_fifo.payload[tx_fifo.front];
+	current_payload = tx_fifo_front();
+	/* The packet header was written when the payload was queued. */
+	packet = payload_packet(current_payload);
 
 	switch (esb_cfg.protocol) {
 	case ESB_PROTOCOL_ESB:
 		update_rf_payload_format(current_payload->length);
-		tx_payload_buffer[0] = current_payload->pid;
-		tx_payload_buffer[1] = 0;
-		memcpy(&tx_payload_buffer[2], current_payload->data,
-		       current_payload->length);
 
-		NRF_RADIO->SHORTS = radio_shorts_common |
-				    RADIO_SHORTS_DISABLED_RXEN_Msk;
-		NRF_RADIO->INTENSET = RADIO_INTENSET_DISABLED_Msk |
-				      RADIO_INTENSET_READY_Msk;
+		esb_radio_next_set(ESB_RADIO_NEXT_RX);
 
 		/* Configure the retransmit counter */
 		retransmits_remaining = esb_cfg.retransmit_count;
@@ -615,29 +529,20 @@ static void start_tx_transaction(void)
 		break;
 
 	case ESB_PROTOCOL_ESB_DPL:
-		ack = !current_payload->noack || !esb_cfg.selective_auto_ack;
-		tx_payload_buffer[0] = current_payload->length;
-		tx_payload_buffer[1] = current_payload->pid << 1;
-		tx_payload_buffer[1] |= current_payload->noack ? 0x00 : 0x01;
-		memcpy(&tx_payload_buffer[2], current_payload->data,
-		       current_payload->length);
+		ack = (packet[1] & 0x01) || !esb_cfg.selective_auto_ack;
 
 		/* Handling ack if noack is set to false or if
 		 * selective auto ack is turned off
 		 */
 		if (ack) {
-			NRF_RADIO->SHORTS = radio_shorts_common |
-					    RADIO_SHORTS_DISABLED_RXEN_Msk;
-			NRF_RADIO->INTENSET = RADIO_INTENSET_DISABLED_Msk |
-					      RADIO_INTENSET_READY_Msk;
+			esb_radio_next_set(ESB_RADIO_NEXT_RX);
 
 			/* Configure the retransmit counter */
 			retransmits_remaining = esb_cfg.retransmit_count;
 			on_radio_disabled = on_radio_disabled_tx;
 			esb_state = ESB_STATE_PTX_TX_ACK;
 		} else {
-			NRF_RADIO->SHORTS = radio_shorts_common;
-			NRF_RADIO->INTENSET = RADIO_INTENSET_DISABLED_Msk;
+			esb_radio_next_set(ESB_RADIO_NEXT_NONE);
 			on_radio_disabled = on_radio_disabled_tx_noack;
 			esb_state = ESB_STATE_PTX_TX;
 		}
@@ -648,32 +553,25 @@ static void start_tx_transaction(void)
 		break;
 	}
 
-	NRF_RADIO->TXADDRESS = current_payload->pipe;
-	NRF_RADIO->RXADDRESSES = 1 << current_payload->pipe;
-	NRF_RADIO->FREQUENCY = esb_addr.rf_channel;
-
-	NRF_RADIO->PACKETPTR = (uint32_t)tx_payload_buffer;
-
-	NVIC_ClearPendingIRQ(RADIO_IRQn);
-	irq_enable(RADIO_IRQn);
-
-	NRF_RADIO->EVENTS_ADDRESS = 0;
-	NRF_RADIO->EVENTS_PAYLOAD = 0;
-	NRF_RADIO->EVENTS_DISABLED = 0;
-
-	NRF_RADIO->TASKS_TXEN = 1;
+	esb_radio_packet_set(packet);
+	esb_radio_tx_start(current_payload->pipe, esb_addr.rf_channel);
 }
 
 static void on_radio_disabled_tx_noack(void)
 {
+	struct esb_pipe_stats *stats = &pipe_stats[current_payload->pipe].stats;
+
+	stats->tx_success++;
+	stats->tx_bytes += current_payload->length;
+
 	interrupt_flags |= INT_TX_SUCCESS_MSK;
 	tx_fifo_remove_last();
 
 	if (tx_fifo.count == 0) {
 		esb_state = ESB_STATE_IDLE;
-		NVIC_SetPendingIRQ(ESB_EVT_IRQ);
+		esb_radio_evt_trigger();
 	} else {
-		NVIC_SetPendingIRQ(ESB_EVT_IRQ);
+		esb_radio_evt_trigger();
 		start_tx_transaction();
 	}
 }
@@ -683,47 +581,42 @@ static void on_radio_disabled_tx(void)
 	/* Remove the DISABLED -> RXEN shortcut, to make sure the radio stays
 	 * disabled after the RX window
 	 */
-	NRF_RADIO->SHORTS = radio_shorts_common;
+	esb_radio_next_set(ESB_RADIO_NEXT_NONE);
 
 	/* Make sure the timer is started the next time the radio is ready,
 	 * and that it will disable the radio automatically if no packet is
 	 * received by the time defined in wait_for_ack_timeout_us
 	 */
-	ESB_SYS_TIMER->CC[0] = wait_for_ack_timeout_us;
-	ESB_SYS_TIMER->CC[1] = esb_cfg.retransmit_delay - 130;
-	ESB_SYS_TIMER->TASKS_CLEAR = 1;
-	ESB_SYS_TIMER->EVENTS_COMPARE[0] = 0;
-	ESB_SYS_TIMER->EVENTS_COMPARE[1] = 0;
-
-	/* Remove */
-	ESB_SYS_TIMER->TASKS_START = 1;
-
-	nrfx_gppi_channels_enable(ppi_all_channels_mask);
-	nrfx_gppi_channels_disable(1 << ppi_ch_timer_compare1_radio_txen);
-
-	NRF_RADIO->EVENTS_END = 0;
+	esb_radio_ack_timer_start(wait_for_ack_timeout_us,
+				  esb_cfg.retransmit_delay);
 
 	if (esb_cfg.protocol == ESB_PROTOCOL_ESB) {
 		update_rf_payload_format(0);
 	}
 
-	NRF_RADIO->PACKETPTR = (uint32_t)rx_payload_buffer;
+	rx_packet_ptr_set();
 	on_radio_disabled = on_radio_disabled_tx_wait_for_ack;
 	esb_state = ESB_STATE_PTX_RX_ACK;
 }
 
 static void on_radio_disabled_tx_wait_for_ack(void)
 {
+	struct esb_pipe_stats *stats = &pipe_stats[current_payload->pipe].stats;
+
 	/* This marks the completion of a TX_RX sequence (TX with ACK) */
 
 	/* Make sure the timer will not deactivate the radio if a packet is
 	 * received.
 	 */
-	nrfx_gppi_channels_disable(ppi_all_channels_mask);
+	esb_radio_ack_timer_disable();
 
 	/* If the radio has received a packet and the CRC status is OK */
-	if (NRF_RADIO->EVENTS_END && NRF_RADIO->CRCSTATUS != 0) {
-		ESB_SYS_TIMER->TASKS_SHUTDOWN = 1;
+	if (esb_radio_rx_done() && esb_radio_crc_ok()) {
+		esb_radio_ack_timer_stop();
+
+		pipe_stats_rssi_update(current_payload->pipe, esb_radio_rssi());
+		stats->tx_success++;
+		stats->tx_bytes += current_payload->length;
 
 		interrupt_flags |= INT_TX_SUCCESS_MSK;
 		last_tx_attempts = esb_cfg.retransmit_count -
@@ -732,9 +625,9 @@ static void on_radio_disabled_tx_wait_for_ack(void)
 		tx_fifo_remove_last();
 
 		if (esb_cfg.protocol != ESB_PROTOCOL_ESB &&
-		    rx_payload_buffer[0] > 0) {
-			if (rx_fifo_push_rfbuf((uint8_t)NRF_RADIO->TXADDRESS,
-					       rx_payload_buffer[1] >> 1)) {
+		    payload_packet(rx_payload)[0] > 0) {
+			if (rx_fifo_push_rfbuf(esb_radio_tx_pipe(),
+					       payload_packet(rx_payload)[1] >> 1)) {
 				interrupt_flags |=
 					INT_RX_DATA_RECEIVED_MSK;
 			}
@@ -743,14 +636,18 @@ static void on_radio_disabled_tx_wait_for_ack(void)
 		if ((tx_fifo.count == 0) ||
 		    (esb_cfg.tx_mode == ESB_TXMODE_MANUAL)) {
 			esb_state = ESB_STATE_IDLE;
-			NVIC_SetPendingIRQ(ESB_EVT_IRQ);
+			esb_radio_evt_trigger();
 		} else {
-			NVIC_SetPendingIRQ(ESB_EVT_IRQ);
+			esb_radio_evt_trigger();
 			start_tx_transaction();
 		}
 	} else {
+		stats->ack_lost++;
+
 		if (retransmits_remaining-- == 0) {
-			ESB_SYS_TIMER->TASKS_SHUTDOWN = 1;
+			esb_radio_ack_timer_stop();
+
+			stats->tx_failed++;
 
 			/* All retransmits are expended, and the TX operation is
 			 * suspended
@@ -759,62 +656,54 @@ static void on_radio_disabled_tx_wait_for_ack(void)
 			interrupt_flags |= INT_TX_FAILED_MSK;
 
 			esb_state = ESB_STATE_IDLE;
-			NVIC_SetPendingIRQ(ESB_EVT_IRQ);
+			esb_radio_evt_trigger();
 		} else {
 			/* There are still more retransmits left, TX mode should
 			 * be entered again as soon as the system timer reaches
 			 * CC[1].
 			 */
-			NRF_RADIO->SHORTS = radio_shorts_common |
-					    RADIO_SHORTS_DISABLED_RXEN_Msk;
+			stats->retransmits++;
+
+			esb_radio_next_set(ESB_RADIO_NEXT_RX);
 			update_rf_payload_format(current_payload->length);
-			NRF_RADIO->PACKETPTR = (uint32_t)tx_payload_buffer;
+			esb_radio_packet_set(payload_packet(current_payload));
 			on_radio_disabled = on_radio_disabled_tx;
 			esb_state = ESB_STATE_PTX_TX_ACK;
-			ESB_SYS_TIMER->TASKS_START = 1;
-			nrfx_gppi_channels_enable(1 << ppi_ch_timer_compare1_radio_txen);
-			if (ESB_SYS_TIMER->EVENTS_COMPARE[1]) {
-				NRF_RADIO->TASKS_TXEN = 1;
-			}
+			esb_radio_retransmit_start();
 		}
 	}
 }
 
 static void clear_events_restart_rx(void)
 {
-	NRF_RADIO->SHORTS = radio_shorts_common;
+	esb_radio_next_set(ESB_RADIO_NEXT_NONE);
 	update_rf_payload_format(esb_cfg.payload_length);
-	NRF_RADIO->PACKETPTR = (uint32_t)rx_payload_buffer;
-	NRF_RADIO->EVENTS_DISABLED = 0;
-	NRF_RADIO->TASKS_DISABLE = 1;
+	rx_packet_ptr_set();
+	esb_radio_disable();
 
-	while (NRF_RADIO->EVENTS_DISABLED == 0) {
-		/* wait for register to settle */
-	}
-
-	NRF_RADIO->EVENTS_DISABLED = 0;
-	NRF_RADIO->SHORTS = radio_shorts_common |
-			    RADIO_SHORTS_DISABLED_TXEN_Msk;
+	esb_radio_next_set(ESB_RADIO_NEXT_TX);
 
-	NRF_RADIO->TASKS_RXEN = 1;
+	esb_radio_rx_enable();
 }
 
-static void on_radio_disabled_rx_dpl(bool retransmit_payload,
-				     struct pipe_info *pipe_info)
+static uint8_t *on_radio_disabled_rx_dpl(bool retransmit_payload,
+					 struct pipe_info *pipe_info)
 {
-	uint32_t pipe = NRF_RADIO->RXMATCH;
+	uint32_t pipe = esb_radio_rx_pipe();
+	struct payload_tx_queue *queue = &tx_fifo.queue[pipe];
 
-	if (tx_fifo.count > 0 && ack_pl_wrap_pipe[pipe] != 0) {
-		current_payload = ack_pl_wrap_pipe[pipe]->p_payload;
+	if (queue->count > 0) {
+		current_payload = queue->front->p_payload;
 
-		/* Pipe stays in ACK with payload until TX FIFO is empty */
+		/* Pipe stays in ACK with payload until its queue is empty */
 		/* Do not report TX success on first ack payload or retransmit */
 		if (pipe_info->ack_payload == true && !retransmit_payload) {
-			ack_pl_wrap_pipe[pipe]->in_use = false;
-			ack_pl_wrap_pipe[pipe] = ack_pl_wrap_pipe[pipe]->p_next;
-			tx_fifo.count--;
-			if (tx_fifo.count > 0 && ack_pl_wrap_pipe[pipe] != 0) {
-				current_payload = ack_pl_wrap_pipe[pipe]->p_payload;
+			pipe_stats[pipe].stats.tx_success++;
+			pipe_stats[pipe].stats.tx_bytes += current_payload->length;
+
+			tx_queue_pop(pipe);
+			if (queue->count > 0) {
+				current_payload = queue->front->p_payload;
 			} else {
 				current_payload = 0;
 			}
@@ -825,77 +714,84 @@ static void on_radio_disabled_rx_dpl(bool retransmit_payload,
 		}
 
 		if (current_payload != 0) {
+			uint8_t *packet = payload_packet(current_payload);
+
 			pipe_info->ack_payload = true;
 			update_rf_payload_format(current_payload->length);
-			tx_payload_buffer[0] = current_payload->length;
-			memcpy(&tx_payload_buffer[2],
-					current_payload->data,
-					current_payload->length);
-		} else {
-			pipe_info->ack_payload = false;
-			update_rf_payload_format(0);
-			tx_payload_buffer[0] = 0;
+			packet[0] = current_payload->length;
+			return packet;
 		}
-	} else {
-		pipe_info->ack_payload = false;
-		update_rf_payload_format(0);
-		tx_payload_buffer[0] = 0;
 	}
 
-	tx_payload_buffer[1] = rx_payload_buffer[1];
+	pipe_info->ack_payload = false;
+	update_rf_payload_format(0);
+	ack_packet[0] = 0;
+	return ack_packet;
 }
 
 static void on_radio_disabled_rx(void)
 {
 	bool retransmit_payload = false;
 	bool send_rx_event = true;
+	bool send_ack;
 	struct pipe_info *pipe_info;
+	const uint8_t *rx_packet = payload_packet(rx_payload);
+	uint8_t s0 = rx_packet[0];
+	uint8_t s1 = rx_packet[1];
+	uint8_t *packet;
 
-	if (NRF_RADIO->CRCSTATUS == 0) {
+	if (!esb_radio_crc_ok()) {
 		clear_events_restart_rx();
 		return;
 	}
 
-	if (rx_fifo.count >= CONFIG_ESB_RX_FIFO_SIZE) {
+	/* The RX FIFO was full, so the packet went to the scratch payload. */
+	if (rx_payload == &rx_payload_scratch) {
 		clear_events_restart_rx();
 		return;
 	}
 
-	pipe_info = &rx_pipe_info[NRF_RADIO->RXMATCH];
-	if (NRF_RADIO->RXCRC == pipe_info->crc &&
-	    (rx_payload_buffer[1] >> 1) == pipe_info->pid) {
+	pipe_info = &rx_pipe_info[esb_radio_rx_pipe()];
+	if (esb_radio_rx_crc() == pipe_info->crc &&
+	    (s1 >> 1) == pipe_info->pid) {
 		retransmit_payload = true;
 		send_rx_event = false;
+
+		/* The PTX did not get the ACK of the previous packet. */
+		pipe_stats[esb_radio_rx_pipe()].stats.ack_lost++;
 	}
 
-	pipe_info->pid = rx_payload_buffer[1] >> 1;
-	pipe_info->crc = NRF_RADIO->RXCRC;
+	pipe_stats_rssi_update(esb_radio_rx_pipe(), esb_radio_rssi());
+
+	pipe_info->pid = s1 >> 1;
+	pipe_info->crc = esb_radio_rx_crc();
 
 	/* Check if an ack should be sent */
-	if ((esb_cfg.selective_auto_ack == false) ||
-	    ((rx_payload_buffer[1] & 0x01) == 1)) {
-		NRF_RADIO->SHORTS = radio_shorts_common |
-				    RADIO_SHORTS_DISABLED_RXEN_Msk;
+	send_ack = (esb_cfg.selective_auto_ack == false) || ((s1 & 0x01) == 1);
+	if (send_ack) {
+		esb_radio_next_set(ESB_RADIO_NEXT_RX);
 
 		switch (esb_cfg.protocol) {
 		case ESB_PROTOCOL_ESB_DPL:
-			on_radio_disabled_rx_dpl(retransmit_payload, pipe_info);
+			packet = on_radio_disabled_rx_dpl(retransmit_payload,
+							  pipe_info);
+			packet[1] = s1;
 			break;
 
 		case ESB_PROTOCOL_ESB:
+		default:
 			update_rf_payload_format(0);
-			tx_payload_buffer[0] = rx_payload_buffer[0];
-			tx_payload_buffer[1] = 0;
+			packet = ack_packet;
+			packet[0] = s0;
+			packet[1] = 0;
 			break;
 		}
 
 		esb_state = ESB_STATE_PRX_SEND_ACK;
-		NRF_RADIO->TXADDRESS = NRF_RADIO->RXMATCH;
+		esb_radio_tx_pipe_set(esb_radio_rx_pipe());
 
-		NRF_RADIO->PACKETPTR = (uint32_t)tx_payload_buffer;
+		esb_radio_packet_set(packet);
 		on_radio_disabled = on_radio_disabled_rx_ack;
-	} else {
-		clear_events_restart_rx();
 	}
 
 	if (send_rx_event) {
@@ -903,20 +799,26 @@ static void on_radio_disabled_rx(void)
 		 * event if the operation was
 		 * successful.
 		 */
-		if (rx_fifo_push_rfbuf(NRF_RADIO->RXMATCH, pipe_info->pid)) {
+		if (rx_fifo_push_rfbuf(esb_radio_rx_pipe(), pipe_info->pid)) {
 			interrupt_flags |= INT_RX_DATA_RECEIVED_MSK;
-			NVIC_SetPendingIRQ(ESB_EVT_IRQ);
+			esb_radio_evt_trigger();
 		}
 	}
+
+	/* The packet must be in the RX FIFO before the radio can receive
+	 * to the next slot.
+	 */
+	if (!send_ack) {
+		clear_events_restart_rx();
+	}
 }
 
 static void on_radio_disabled_rx_ack(void)
 {
-	NRF_RADIO->SHORTS = radio_shorts_common |
-			    RADIO_SHORTS_DISABLED_TXEN_Msk;
+	esb_radio_next_set(ESB_RADIO_NEXT_TX);
 	update_rf_payload_format(esb_cfg.payload_length);
 
-	NRF_RADIO->PACKETPTR = (uint32_t)rx_payload_buffer;
+	rx_packet_ptr_set();
 	on_radio_disabled = on_radio_disabled_rx;
 
 	esb_state = ESB_STATE_PRX;
@@ -938,37 +840,6 @@ static void get_and_clear_irqs(uint32_t *interrupts)
 	irq_unlock(key);
 }
 
-static void radio_irq_handler(void)
-{
-	if (NRF_RADIO->EVENTS_READY &&
-	    (NRF_RADIO->INTENSET & RADIO_INTENSET_READY_Msk)) {
-		NRF_RADIO->EVENTS_READY = 0;
-		ESB_SYS_TIMER->TASKS_START;
-	}
-
-	if (NRF_RADIO->EVENTS_END &&
-	    (NRF_RADIO->INTENSET & RADIO_INTENSET_END_Msk)) {
-		NRF_RADIO->EVENTS_END = 0;
-		/* Call the correct on_radio_end function, depending on the
-		 * current protocol state.
-		 */
-		if (on_radio_end) {
-			on_radio_end();
-		}
-	}
-
-	if (NRF_RADIO->EVENTS_DISABLED &&
-	    (NRF_RADIO->INTENSET & RADIO_INTENSET_DISABLED_Msk)) {
-		NRF_RADIO->EVENTS_DISABLED = 0;
-		/* Call the correct on_radio_disable function, depending on the
-		 * current protocol state.
-		 */
-		if (on_radio_disabled) {
-			on_radio_disabled();
-		}
-	}
-}
-
 static void esb_evt_irq_handler(void)
 {
 	uint32_t interrupts;
@@ -993,30 +864,14 @@ static void esb_evt_irq_handler(void)
 	}
 }
 
-ISR_DIRECT_DECLARE(RADIO_IRQHandler)
+static void radio_disabled_handler(void)
 {
-	radio_irq_handler();
-
-	ISR_DIRECT_PM();
-
-	return 1;
-}
-
-
-ISR_DIRECT_DECLARE(ESB_EVT_IRQHandler)
-{
-	esb_evt_irq_handler();
-
-	ISR_DIRECT_PM();
-
-	return 1;
-}
-
-ISR_DIRECT_DECLARE(ESB_SYS_TIMER_IRQHandler)
-{
-	ISR_DIRECT_PM();
-
-	return 1;
+	/* Call the correct on_radio_disable function, depending on the
+	 * current protocol state.
+	 */
+	if (on_radio_disabled) {
+		on_radio_disabled();
+	}
 }
 
 int esb_init(const struct esb_config *config)
@@ -1037,41 +892,23 @@ int esb_init(const struct esb_config *config)
 
 	memset(rx_pipe_info, 0, sizeof(rx_pipe_info));
 	memset(pids, 0, sizeof(pids));
+	memset(pipe_stats, 0, sizeof(pipe_stats));
 
 	update_radio_parameters();
 
-	/* Configure radio address registers according to ESB default values */
-	NRF_RADIO->BASE0 = 0xE7E7E7E7;
-	NRF_RADIO->BASE1 = 0x43434343;
-	NRF_RADIO->PREFIX0 = 0x23C343E7;
-	NRF_RADIO->PREFIX1 = 0x13E363A3;
+	/* Configure the radio addresses according to the current address
+	 * configuration, which starts with the ESB default values.
+	 */
+	update_radio_addresses();
 
 	initialize_fifos();
-	sys_timer_init();
-	ppi_init();
 
-	IRQ_DIRECT_CONNECT(RADIO_IRQn, config->radio_irq_priority,
-			   RADIO_IRQHandler, 0);
-	IRQ_DIRECT_CONNECT(ESB_EVT_IRQ, config->event_irq_priority,
-			   ESB_EVT_IRQHandler, 0);
-	IRQ_DIRECT_CONNECT(ESB_SYS_TIMER_IRQn, config->event_irq_priority,
-			   ESB_SYS_TIMER_IRQHandler, 0);
-
-	irq_enable(RADIO_IRQn);
-	irq_enable(ESB_EVT_IRQ);
-	irq_enable(ESB_SYS_TIMER_IRQn);
+	esb_radio_init(radio_disabled_handler, esb_evt_irq_handler,
+		       config->radio_irq_priority, config->event_irq_priority);
 
 	esb_state = ESB_STATE_IDLE;
 	esb_initialized = true;
 
-#ifdef CONFIG_SOC_NRF52832
-	if ((NRF_FICR->INFO.VARIANT & 0x0000FF00) == 0x00004500) {
-		/* Check if the device is an nRF52832 Rev. 2. */
-		/* Workaround for nRF52832 rev 2 errata 182 */
-		*(volatile uint32_t *)0x4000173C |= (1 << 10);
-	}
-#endif
-
 	return 0;
 }
 
@@ -1082,7 +919,7 @@ int esb_suspend(void)
 	}
 
 	/*  Clear PPI */
-	nrfx_gppi_channels_disable(ppi_all_channels_mask);
+	esb_radio_ack_timer_disable();
 
 	esb_state = ESB_STATE_IDLE;
 
@@ -1092,7 +929,7 @@ int esb_suspend(void)
 void esb_disable(void)
 {
 	/*  Clear PPI */
-	nrfx_gppi_channels_disable(ppi_all_channels_mask);
+	esb_radio_ack_timer_disable();
 
 	esb_state = ESB_STATE_IDLE;
 	esb_initialized = false;
@@ -1103,11 +940,7 @@ void esb_disable(void)
 	memset(pids, 0, sizeof(pids));
 
 	/*  Disable the radio */
-	irq_disable(ESB_EVT_IRQ);
-
-	NRF_RADIO->SHORTS =
-	    RADIO_SHORTS_READY_START_Enabled << RADIO_SHORTS_READY_START_Pos |
-	    RADIO_SHORTS_END_DISABLE_Enabled << RADIO_SHORTS_END_DISABLE_Pos;
+	esb_radio_deinit();
 }
 
 bool esb_is_idle(void)
@@ -1118,85 +951,242 @@ bool esb_is_idle(void)
 static struct payload_wrap *find_free_payload_cont(void)
 {
 	for (int i = 0; i < CONFIG_ESB_TX_FIFO_SIZE; i++) {
-		if (!ack_pl_wrap[i].in_use)
-			return &ack_pl_wrap[i];
+		if (!tx_wraps[i].in_use)
+			return &tx_wraps[i];
 	}
 	return 0;
 }
 
-int esb_write_payload(const struct esb_payload *payload)
+/*  Function to check a payload before it is queued for transmission. */
+static int tx_payload_check(const struct esb_payload *payload)
 {
-	if (!esb_initialized) {
-		return -EACCES;
-	}
-	if (payload == NULL) {
-		return -EINVAL;
-	}
 	if (payload->length == 0 ||
 	    payload->length > CONFIG_ESB_MAX_PAYLOAD_LENGTH ||
 	    (esb_cfg.protocol == ESB_PROTOCOL_ESB &&
 	     payload->length > esb_cfg.payload_length)) {
 		return -EMSGSIZE;
 	}
-	if (tx_fifo.count >= CONFIG_ESB_TX_FIFO_SIZE) {
-		return -ENOMEM;
-	}
 	if (payload->pipe >= CONFIG_ESB_PIPE_COUNT) {
 		return -EINVAL;
 	}
 
-	uint32_t key = irq_lock();
+	return 0;
+}
 
-	if (esb_cfg.mode == ESB_MODE_PTX) {
-		memcpy(tx_fifo.payload[tx_fifo.back], payload,
-			sizeof(struct esb_payload));
+/*  Function to get a free TX payload slot. Must be called with interrupts
+ *  locked.
+ */
+static struct esb_payload *tx_slot_get(void)
+{
+	struct payload_wrap *wrap;
 
-		pids[payload->pipe] = (pids[payload->pipe] + 1) % (PID_MAX + 1);
-		tx_fifo.payload[tx_fifo.back]->pid = pids[payload->pipe];
+	wrap = find_free_payload_cont();
+	if (wrap == NULL) {
+		return NULL;
+	}
 
-		if (++tx_fifo.back >= CONFIG_ESB_TX_FIFO_SIZE) {
-			tx_fifo.back = 0;
-		}
+	wrap->in_use = true;
+	wrap->p_next = 0;
 
-		tx_fifo.count++;
-	} else {
-		struct payload_wrap *new_ack_payload = find_free_payload_cont();
+	return wrap->p_payload;
+}
 
-		if (new_ack_payload != 0) {
-			new_ack_payload->in_use = true;
-			new_ack_payload->p_next = 0;
-			memcpy(new_ack_payload->p_payload, payload, sizeof(struct esb_payload));
+/*  Function to return a TX payload slot that was not queued. Must be called
+ *  with interrupts locked.
+ */
+static void tx_slot_put(struct esb_payload *slot)
+{
+	tx_wraps[slot - tx_payloads].in_use = false;
+}
 
-			pids[payload->pipe] = (pids[payload->pipe] + 1) % (PID_MAX + 1);
-			new_ack_payload->p_payload->pid = pids[payload->pipe];
+/*  Function to check if the TX queue of a pipe has room for a payload. */
+static bool tx_queue_full(uint8_t pipe)
+{
+	return tx_fifo.queue[pipe].count >= CONFIG_ESB_TX_PIPE_QUEUE_SIZE;
+}
 
-			if (ack_pl_wrap_pipe[payload->pipe] == 0) {
-				ack_pl_wrap_pipe[payload->pipe] = new_ack_payload;
-			} else {
-				struct payload_wrap *pl = ack_pl_wrap_pipe[payload->pipe];
+/*  Function to queue a filled TX payload slot on its pipe. Must be called
+ *  with interrupts locked.
+ *
+ *  In PTX mode, the packet header is written here, so that the radio can
+ *  send the payload straight from the TX FIFO. The header overwrites the
+ *  noack and pid fields of the payload.
+ */
+static void tx_slot_push(struct esb_payload *slot)
+{
+	struct payload_tx_queue *queue = &tx_fifo.queue[slot->pipe];
+	struct payload_wrap *wrap = &tx_wraps[slot - tx_payloads];
+	uint8_t *packet = payload_packet(slot);
 
-				while (pl->p_next != 0) {
-					pl = (struct payload_wrap *)pl->p_next;
-				}
-				pl->p_next = (struct payload_wrap *)new_ack_payload;
-			}
-			tx_fifo.count++;
+	pids[slot->pipe] = (pids[slot->pipe] + 1) % (PID_MAX + 1);
+	slot->pid = pids[slot->pipe];
+
+	if (esb_cfg.mode == ESB_MODE_PTX) {
+		if (esb_cfg.protocol == ESB_PROTOCOL_ESB_DPL) {
+			packet[1] = slot->pid << 1;
+			packet[1] |= slot->noack ? 0x00 : 0x01;
+			packet[0] = slot->length;
+		} else {
+			packet[0] = slot->pid;
+			packet[1] = 0;
 		}
 	}
 
-	irq_unlock(key);
+	wrap->p_next = NULL;
+	if (queue->back) {
+		queue->back->p_next = wrap;
+	} else {
+		queue->front = wrap;
+	}
+	queue->back = wrap;
+	queue->count++;
+	tx_fifo.count++;
+}
 
+static void tx_auto_start(void)
+{
 	if (esb_cfg.mode == ESB_MODE_PTX &&
 	    esb_cfg.tx_mode == ESB_TXMODE_AUTO &&
 	    esb_state == ESB_STATE_IDLE) {
 		start_tx_transaction();
 	}
+}
+
+int esb_write_payload(const struct esb_payload *payload)
+{
+	struct esb_payload *slot;
+	int err;
+
+	if (!esb_initialized) {
+		return -EACCES;
+	}
+	if (payload == NULL) {
+		return -EINVAL;
+	}
+
+	err = tx_payload_check(payload);
+	if (err) {
+		return err;
+	}
+
+	uint32_t key = irq_lock();
+
+	if (tx_payload_borrowed) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	slot = tx_queue_full(payload->pipe) ? NULL : tx_slot_get();
+	if (!slot) {
+		irq_unlock(key);
+		return -ENOMEM;
+	}
+
+	slot->length = payload->length;
+	slot->pipe = payload->pipe;
+	slot->noack = payload->noack;
+	memcpy(slot->data, payload->data, payload->length);
+
+	tx_slot_push(slot);
+
+	irq_unlock(key);
+
+	tx_auto_start();
+
+	return 0;
+}
+
+int esb_tx_payload_alloc(struct esb_payload **payload)
+{
+	uint32_t key;
+
+	if (!esb_initialized) {
+		return -EACCES;
+	}
+	if (payload == NULL) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (tx_payload_borrowed) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	tx_payload_borrowed = tx_slot_get();
+
+	irq_unlock(key);
+
+	if (!tx_payload_borrowed) {
+		return -ENOMEM;
+	}
+
+	tx_payload_borrowed->noack = false;
+	*payload = tx_payload_borrowed;
+
+	return 0;
+}
+
+int esb_tx_payload_submit(struct esb_payload *payload)
+{
+	uint32_t key;
+	int err;
+
+	if (!esb_initialized) {
+		return -EACCES;
+	}
+	if (payload == NULL || payload != tx_payload_borrowed) {
+		return -EINVAL;
+	}
+
+	err = tx_payload_check(payload);
+	if (err) {
+		return err;
+	}
+
+	key = irq_lock();
+
+	if (tx_queue_full(payload->pipe)) {
+		irq_unlock(key);
+		return -ENOMEM;
+	}
+
+	tx_slot_push(payload);
+	tx_payload_borrowed = NULL;
+
+	irq_unlock(key);
+
+	tx_auto_start();
+
+	return 0;
+}
+
+int esb_tx_payload_discard(struct esb_payload *payload)
+{
+	uint32_t key;
+
+	if (!esb_initialized) {
+		return -EACCES;
+	}
+	if (payload == NULL || payload != tx_payload_borrowed) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	tx_slot_put(payload);
+	tx_payload_borrowed = NULL;
+
+	irq_unlock(key);
 
 	return 0;
 }
 
 int esb_read_rx_payload(struct esb_payload *payload)
 {
+	const struct esb_payload *front;
+
 	if (!esb_initialized) {
 		return -EACCES;
 	}
@@ -1204,19 +1194,24 @@ int esb_read_rx_payload(struct esb_payload *payload)
 		return -EINVAL;
 	}
 
+	if (rx_payload_borrowed) {
+		return -EBUSY;
+	}
+
 	if (rx_fifo.count == 0) {
 		return -ENODATA;
 	}
 
 	uint32_t key = irq_lock();
 
-	payload->length = rx_fifo.payload[rx_fifo.front]->length;
-	payload->pipe = rx_fifo.payload[rx_fifo.front]->pipe;
-	payload->rssi = rx_fifo.payload[rx_fifo.front]->rssi;
-	payload->pid = rx_fifo.payload[rx_fifo.front]->pid;
-	payload->noack = rx_fifo.payload[rx_fifo.front]->noack;
-	memcpy(payload->data, rx_fifo.payload[rx_fifo.front]->data,
-	       payload->length);
+	front = rx_fifo.payload[rx_fifo.front];
+
+	payload->length = front->length;
+	payload->pipe = front->pipe;
+	payload->rssi = front->rssi;
+	payload->pid = front->pid;
+	payload->noack = front->noack;
+	memcpy(payload->data, front->data, payload->length);
 
 	if (++rx_fifo.front >= CONFIG_ESB_RX_FIFO_SIZE) {
 		rx_fifo.front = 0;
@@ -1229,6 +1224,55 @@ int esb_read_rx_payload(struct esb_payload *payload)
 	return 0;
 }
 
+int esb_rx_payload_get(struct esb_payload **payload)
+{
+	if (!esb_initialized) {
+		return -EACCES;
+	}
+	if (payload == NULL) {
+		return -EINVAL;
+	}
+
+	if (rx_payload_borrowed) {
+		return -EBUSY;
+	}
+
+	if (rx_fifo.count == 0) {
+		return -ENODATA;
+	}
+
+	/* The radio only writes to the back of the RX FIFO, so the front
+	 * payload stays untouched until it is released.
+	 */
+	rx_payload_borrowed = rx_fifo.payload[rx_fifo.front];
+	*payload = rx_payload_borrowed;
+
+	return 0;
+}
+
+int esb_rx_payload_release(struct esb_payload *payload)
+{
+	if (!esb_initialized) {
+		return -EACCES;
+	}
+	if (payload == NULL || payload != rx_payload_borrowed) {
+		return -EINVAL;
+	}
+
+	uint32_t key = irq_lock();
+
+	if (++rx_fifo.front >= CONFIG_ESB_RX_FIFO_SIZE) {
+		rx_fifo.front = 0;
+	}
+
+	rx_fifo.count--;
+	rx_payload_borrowed = NULL;
+
+	irq_unlock(key);
+
+	return 0;
+}
+
 int esb_start_tx(void)
 {
 	if (esb_state != ESB_STATE_IDLE) {
@@ -1250,27 +1294,13 @@ int esb_start_rx(void)
 		return -EBUSY;
 	}
 
-	NRF_RADIO->INTENCLR = 0xFFFFFFFF;
-	NRF_RADIO->EVENTS_DISABLED = 0;
 	on_radio_disabled = on_radio_disabled_rx;
 
-	NRF_RADIO->SHORTS = radio_shorts_common |
-			    RADIO_SHORTS_DISABLED_TXEN_Msk;
-	NRF_RADIO->INTENSET = RADIO_INTENSET_DISABLED_Msk;
+	esb_radio_next_set(ESB_RADIO_NEXT_TX);
 	esb_state = ESB_STATE_PRX;
 
-	NRF_RADIO->RXADDRESSES = esb_addr.rx_pipes_enabled;
-	NRF_RADIO->FREQUENCY = esb_addr.rf_channel;
-	NRF_RADIO->PACKETPTR = (uint32_t)rx_payload_buffer;
-
-	NVIC_ClearPendingIRQ(RADIO_IRQn);
-	irq_enable(RADIO_IRQn);
-
-	NRF_RADIO->EVENTS_ADDRESS = 0;
-	NRF_RADIO->EVENTS_PAYLOAD = 0;
-	NRF_RADIO->EVENTS_DISABLED = 0;
-
-	NRF_RADIO->TASKS_RXEN = 1;
+	rx_packet_ptr_set();
+	esb_radio_rx_start(esb_addr.rx_pipes_enabled, esb_addr.rf_channel);
 
 	return 0;
 }
@@ -1281,14 +1311,8 @@ int esb_stop_rx(void)
 		return -EINVAL;
 	}
 
-	NRF_RADIO->SHORTS = 0;
-	NRF_RADIO->INTENCLR = 0xFFFFFFFF;
 	on_radio_disabled = NULL;
-	NRF_RADIO->EVENTS_DISABLED = 0;
-	NRF_RADIO->TASKS_DISABLE = 1;
-	while (NRF_RADIO->EVENTS_DISABLED == 0) {
-		/* wait for register to settle */
-	}
+	esb_radio_stop();
 
 	esb_state = ESB_STATE_IDLE;
 
@@ -1303,9 +1327,15 @@ int esb_flush_tx(void)
 
 	uint32_t key = irq_lock();
 
-	tx_fifo.count = 0;
-	tx_fifo.back = 0;
-	tx_fifo.front = 0;
+	/* The radio sends straight from the TX FIFO, so the payload in flight
+	 * must not be freed.
+	 */
+	if (esb_state != ESB_STATE_IDLE || tx_payload_borrowed) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
+	reset_tx_fifo();
 
 	irq_unlock(key);
 
@@ -1314,19 +1344,26 @@ int esb_flush_tx(void)
 
 int esb_pop_tx(void)
 {
+	uint32_t pipe;
+
 	if (!esb_initialized) {
 		return -EACCES;
 	}
-	if (tx_fifo.count == 0) {
-		return -ENODATA;
+	/* The payload that would be sent next may be in flight. */
+	if (esb_state != ESB_STATE_IDLE || tx_payload_borrowed) {
+		return -EBUSY;
 	}
 
 	uint32_t key = irq_lock();
 
-	if (++tx_fifo.back >= CONFIG_ESB_TX_FIFO_SIZE) {
-		tx_fifo.back = 0;
+	/* Remove the payload that would be sent next. */
+	pipe = tx_fifo_next_pipe();
+	if (pipe >= CONFIG_ESB_PIPE_COUNT) {
+		irq_unlock(key);
+		return -ENODATA;
 	}
-	tx_fifo.count--;
+
+	tx_queue_pop(pipe);
 
 	irq_unlock(key);
 
@@ -1341,6 +1378,11 @@ int esb_flush_rx(void)
 
 	uint32_t key = irq_lock();
 
+	if (rx_payload_borrowed) {
+		irq_unlock(key);
+		return -EBUSY;
+	}
+
 	rx_fifo.count = 0;
 	rx_fifo.back = 0;
 	rx_fifo.front = 0;
@@ -1379,7 +1421,7 @@ int esb_set_base_address_0(const uint8_t *addr)
 
 	memcpy(esb_addr.base_addr_p0, addr, sizeof(esb_addr.base_addr_p0));
 
-	update_radio_addresses(ADDR_UPDATE_MASK_BASE0);
+	update_radio_addresses();
 
 	return 0;
 }
@@ -1395,7 +1437,7 @@ int esb_set_base_address_1(const uint8_t *addr)
 
 	memcpy(esb_addr.base_addr_p1, addr, sizeof(esb_addr.base_addr_p1));
 
-	update_radio_addresses(ADDR_UPDATE_MASK_BASE1);
+	update_radio_addresses();
 
 	return 0;
 }
@@ -1416,7 +1458,7 @@ int esb_set_prefixes(const uint8_t *prefixes, uint8_t num_pipes)
 	esb_addr.num_pipes = num_pipes;
 	esb_addr.rx_pipes_enabled = BIT_MASK_UINT_8(num_pipes);
 
-	update_radio_addresses(ADDR_UPDATE_MASK_PREFIX);
+	update_radio_addresses();
 
 	return 0;
 }
@@ -1432,7 +1474,7 @@ int esb_update_prefix(uint8_t pipe, uint8_t prefix)
 
 	esb_addr.pipe_prefixes[pipe] = prefix;
 
-	update_radio_addresses(ADDR_UPDATE_MASK_PREFIX);
+	update_radio_addresses();
 
 	return 0;
 }
@@ -1540,3 +1582,48 @@ int esb_reuse_pid(uint8_t pipe)
 
 	return 0;
 }
+
+int esb_set_pipe_weight(uint8_t pipe, uint8_t weight)
+{
+	if (!(pipe < CONFIG_ESB_PIPE_COUNT) || weight == 0) {
+		return -EINVAL;
+	}
+
+	uint32_t key = irq_lock();
+
+	tx_fifo.queue[pipe].weight = weight;
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+int esb_get_pipe_stats(uint8_t pipe, struct esb_pipe_stats *stats)
+{
+	if (!(pipe < CONFIG_ESB_PIPE_COUNT) || stats == NULL) {
+		return -EINVAL;
+	}
+
+	uint32_t key = irq_lock();
+
+	*stats = pipe_stats[pipe].stats;
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+int esb_reset_pipe_stats(uint8_t pipe)
+{
+	if (!(pipe < CONFIG_ESB_PIPE_COUNT)) {
+		return -EINVAL;
+	}
+
+	uint32_t key = irq_lock();
+
+	memset(&pipe_stats[pipe], 0, sizeof(pipe_stats[pipe]));
+
+	irq_unlock(key);
+
+	return 0;
+}
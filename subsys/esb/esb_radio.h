@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/* Radio abstraction of the Enhanced ShockBurst module.
+ *
+ * The protocol state machine in esb.c controls the radio only through these
+ * functions. esb_radio_nrf.c implements them with the RADIO peripheral, a
+ * TIMER and (D)PPI. esb_radio_sim.c implements them with a simulated radio,
+ * so that the state machine can run on native_posix.
+ *
+ * The functions are thin wrappers around the radio tasks, events and
+ * shortcuts, and keep the semantics of the nRF RADIO peripheral: the radio
+ * is disabled after every packet, and the disabled handler is called from the
+ * radio interrupt each time.
+ */
+
+#ifndef ESB_RADIO_H__
+#define ESB_RADIO_H__
+
+#include <stdbool.h>
+#include <toolchain.h>
+#include <zephyr/types.h>
+#include <esb.h>
+
+/* Enhanced ShockBurst address.
+ *
+ * Enhanced ShockBurst addresses consist of a base address and a prefix
+ * that is unique for each pipe. See @ref esb_addressing in the ESB user
+ * guide for more information. The base addresses are word aligned, for
+ * the conversion to the radio register format.
+ */
+struct esb_address {
+	uint8_t base_addr_p0[4];	/* Base address for pipe 0, in big endian. */
+	uint8_t base_addr_p1[4];   /* Base address for pipe 1-7, in big endian. */
+	uint8_t pipe_prefixes[8];	/* Address prefix for pipe 0 to 7. */
+	uint8_t num_pipes;		/* Number of pipes available. */
+	uint8_t addr_length;	/* Length of the address plus the prefix. */
+	uint8_t rx_pipes_enabled;	/* Bitfield for enabled pipes. */
+	uint8_t rf_channel;        /* Channel to use (between 0 and 100). */
+} __aligned(4);
+
+/* What the radio starts after it is disabled. */
+enum esb_radio_next {
+	ESB_RADIO_NEXT_NONE,	/* Stay disabled. */
+	ESB_RADIO_NEXT_RX,	/* Start receiving, like the DISABLED_RXEN short. */
+	ESB_RADIO_NEXT_TX,	/* Start sending, like the DISABLED_TXEN short. */
+};
+
+/* Handler called from the radio or the ESB event interrupt. */
+typedef void (*esb_radio_handler_t)(void);
+
+/* Initialize the radio and connect the interrupts.
+ *
+ * disabled_handler is called from the radio interrupt every time the radio
+ * gets disabled. evt_handler is called from the ESB event interrupt, when
+ * triggered with esb_radio_evt_trigger().
+ */
+void esb_radio_init(esb_radio_handler_t disabled_handler,
+		    esb_radio_handler_t evt_handler,
+		    uint8_t radio_irq_priority, uint8_t evt_irq_priority);
+
+/* Stop the ESB event interrupt and restore the default radio shortcuts. */
+void esb_radio_deinit(void);
+
+/* Radio configuration. */
+void esb_radio_tx_power_set(enum esb_tx_power tx_power);
+void esb_radio_bitrate_set(enum esb_bitrate bitrate);
+bool esb_radio_crc_set(enum esb_crc crc);
+void esb_radio_addresses_set(const struct esb_address *addr);
+
+/* Set the packet format. For ESB_PROTOCOL_ESB, payload_length is the static
+ * length of the next packets.
+ */
+void esb_radio_packet_format_set(enum esb_protocol protocol,
+				 uint8_t addr_length, uint8_t payload_length);
+
+/* Set what the radio starts after it is disabled. */
+void esb_radio_next_set(enum esb_radio_next next);
+
+/* Set the packet to send, or the buffer to receive to. */
+void esb_radio_packet_set(uint8_t *packet);
+
+/* Set the pipe to send the next packet on. */
+void esb_radio_tx_pipe_set(uint8_t pipe);
+
+/* Start sending a packet on a pipe. */
+void esb_radio_tx_start(uint8_t pipe, uint8_t channel);
+
+/* Start receiving on the pipes in the pipes bitfield. */
+void esb_radio_rx_start(uint8_t pipes, uint8_t channel);
+
+/* Start receiving with the current configuration. */
+void esb_radio_rx_enable(void);
+
+/* Disable the radio and wait until it is disabled. The disabled handler is
+ * not called.
+ */
+void esb_radio_disable(void);
+
+/* Disable the radio, the shortcuts and the interrupts. */
+void esb_radio_stop(void);
+
+/* Information about the last packet. */
+bool esb_radio_rx_done(void);
+bool esb_radio_crc_ok(void);
+uint8_t esb_radio_rx_pipe(void);
+uint8_t esb_radio_tx_pipe(void);
+uint32_t esb_radio_rx_crc(void);
+int8_t esb_radio_rssi(void);
+
+/* Start the ACK timer after sending a packet.
+ *
+ * The timer starts when the radio is ready to receive the ACK, and disables
+ * the radio after ack_timeout_us unless a packet is received. The
+ * retransmission can then start retransmit_delay_us after the timer start.
+ */
+void esb_radio_ack_timer_start(uint32_t ack_timeout_us,
+			       uint32_t retransmit_delay_us);
+
+/* Stop the ACK timer from controlling the radio. */
+void esb_radio_ack_timer_disable(void);
+
+/* Stop the ACK timer. */
+void esb_radio_ack_timer_stop(void);
+
+/* Start sending the packet again when the retransmit delay has passed. */
+void esb_radio_retransmit_start(void);
+
+/* Trigger the ESB event interrupt. */
+void esb_radio_evt_trigger(void);
+
+#endif /* ESB_RADIO_H__ */
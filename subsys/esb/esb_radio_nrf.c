@@ -0,0 +1,521 @@
+/*
+ * Copyright (c) 2018 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <irq.h>
+#include <sys/byteorder.h>
+#include <nrf.h>
+#include <esb.h>
+#ifdef DPPI_PRESENT
+#include <nrfx_dppi.h>
+#else
+#include <nrfx_ppi.h>
+#endif
+#include <helpers/nrfx_gppi.h>
+#include <nrf_erratas.h>
+
+#include "esb_radio.h"
+
+/* Radio ramp-up time, subtracted from the retransmit delay to get the time
+ * of the TXEN task.
+ */
+#define RADIO_RAMP_UP_US 130
+
+#define RADIO_SHORTS_COMMON                                                    \
+	(RADIO_SHORTS_READY_START_Msk | RADIO_SHORTS_END_DISABLE_Msk |         \
+	 RADIO_SHORTS_ADDRESS_RSSISTART_Msk |                                  \
+	 RADIO_SHORTS_DISABLED_RSSISTOP_Msk)
+
+#ifdef CONFIG_ESB_SYS_TIMER0
+#define ESB_SYS_TIMER NRF_TIMER0
+#define ESB_SYS_TIMER_IRQn TIMER0_IRQn
+#endif
+#ifdef CONFIG_ESB_SYS_TIMER1
+#define ESB_SYS_TIMER NRF_TIMER1
+#define ESB_SYS_TIMER_IRQn TIMER1_IRQn
+#endif
+#ifdef CONFIG_ESB_SYS_TIMER2
+#define ESB_SYS_TIMER NRF_TIMER2
+#define ESB_SYS_TIMER_IRQn TIMER2_IRQn
+#endif
+#ifdef CONFIG_ESB_SYS_TIMER3
+#define ESB_SYS_TIMER NRF_TIMER3
+#define ESB_SYS_TIMER_IRQn TIMER3_IRQn
+#endif
+#ifdef CONFIG_ESB_SYS_TIMER4
+#define ESB_SYS_TIMER NRF_TIMER4
+#define ESB_SYS_TIMER_IRQn TIMER4_IRQn
+#endif
+
+static uint32_t radio_shorts_common = RADIO_SHORTS_COMMON;
+
+/* PPI or DPPI instances */
+#ifdef DPPI_PRESENT
+typedef uint8_t ppi_channel_t;
+#else
+typedef nrf_ppi_channel_t ppi_channel_t;
+#endif
+
+static ppi_channel_t ppi_ch_radio_ready_timer_start;
+static ppi_channel_t ppi_ch_radio_address_timer_stop;
+static ppi_channel_t ppi_ch_timer_compare0_radio_disable;
+static ppi_channel_t ppi_ch_timer_compare1_radio_txen;
+
+static uint32_t ppi_all_channels_mask;
+
+static esb_radio_handler_t on_radio_disabled;
+static esb_radio_handler_t on_evt;
+
+/*  Function to do bytewise bit-swap on an unsigned 32-bit value */
+static uint32_t bytewise_bit_swap(const uint8_t *input)
+{
+#if __CORTEX_M == (0x04U)
+	uint32_t inp = (*(uint32_t *)input);
+
+	return sys_cpu_to_be32((uint32_t)__RBIT(inp));
+#else
+	uint32_t inp = sys_cpu_to_le32(*(uint32_t *)input);
+
+	inp = (inp & 0xF0F0F0F0) >> 4 | (inp & 0x0F0F0F0F) << 4;
+	inp = (inp & 0xCCCCCCCC) >> 2 | (inp & 0x33333333) << 2;
+	inp = (inp & 0xAAAAAAAA) >> 1 | (inp & 0x55555555) << 1;
+	return inp;
+#endif
+}
+
+/* Convert a base address from nRF24L format to nRF5 format */
+static uint32_t addr_conv(const uint8_t *addr)
+{
+	return __REV(bytewise_bit_swap(addr));
+}
+
+static inline void apply_errata143_workaround(uint8_t addr_length)
+{
+	/* Workaround for Errata 143
+	 * Check if the most significant bytes of address 0 (including
+	 * prefix) match those of another address. It's recommended to
+	 * use a unique address 0 since this will avoid the 3dBm penalty
+	 * incurred from the workaround.
+	 */
+	uint32_t base_address_mask =
+		addr_length == 5 ? 0xFFFF0000 : 0xFF000000;
+
+	/* Load the two addresses before comparing them to ensure
+	 * defined ordering of volatile accesses.
+	 */
+	uint32_t addr0 = NRF_RADIO->BASE0 & base_address_mask;
+	uint32_t addr1 = NRF_RADIO->BASE1 & base_address_mask;
+
+	if (addr0 == addr1) {
+		uint32_t prefix0 = NRF_RADIO->PREFIX0 & 0x000000FF;
+		uint32_t prefix1 = (NRF_RADIO->PREFIX0 & 0x0000FF00) >> 8;
+		uint32_t prefix2 = (NRF_RADIO->PREFIX0 & 0x00FF0000) >> 16;
+		uint32_t prefix3 = (NRF_RADIO->PREFIX0 & 0xFF000000) >> 24;
+		uint32_t prefix4 = NRF_RADIO->PREFIX1 & 0x000000FF;
+		uint32_t prefix5 = (NRF_RADIO->PREFIX1 & 0x0000FF00) >> 8;
+		uint32_t prefix6 = (NRF_RADIO->PREFIX1 & 0x00FF0000) >> 16;
+		uint32_t prefix7 = (NRF_RADIO->PREFIX1 & 0xFF000000) >> 24;
+
+		if (prefix0 == prefix1 || prefix0 == prefix2 ||
+			prefix0 == prefix3 || prefix0 == prefix4 ||
+			prefix0 == prefix5 || prefix0 == prefix6 ||
+			prefix0 == prefix7) {
+			/* This will cause a 3dBm sensitivity loss,
+			 * avoid using such address combinations if possible.
+			 */
+			*(volatile uint32_t *)0x40001774 =
+				((*(volatile uint32_t *)0x40001774) & 0xfffffffe) | 0x01000000;
+		}
+	}
+}
+
+static void sys_timer_init(void)
+{
+	/* Configure the system timer with a 1 MHz base frequency */
+	ESB_SYS_TIMER->PRESCALER = 4;
+	ESB_SYS_TIMER->BITMODE = TIMER_BITMODE_BITMODE_16Bit;
+	ESB_SYS_TIMER->SHORTS = TIMER_SHORTS_COMPARE1_CLEAR_Msk |
+				TIMER_SHORTS_COMPARE1_STOP_Msk;
+}
+
+static void ppi_init(void)
+{
+#ifdef DPPI_PRESENT
+	nrfx_dppi_channel_alloc(&ppi_ch_radio_ready_timer_start);
+	nrfx_dppi_channel_alloc(&ppi_ch_radio_address_timer_stop);
+	nrfx_dppi_channel_alloc(&ppi_ch_timer_compare0_radio_disable);
+	nrfx_dppi_channel_alloc(&ppi_ch_timer_compare1_radio_txen);
+
+	NRF_RADIO->PUBLISH_READY          = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_radio_ready_timer_start;
+	ESB_SYS_TIMER->SUBSCRIBE_START    = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_radio_ready_timer_start;
+	NRF_RADIO->PUBLISH_ADDRESS        = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_radio_address_timer_stop;
+	ESB_SYS_TIMER->SUBSCRIBE_SHUTDOWN = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_radio_address_timer_stop;
+	ESB_SYS_TIMER->PUBLISH_COMPARE[0] = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_timer_compare0_radio_disable;
+	NRF_RADIO->SUBSCRIBE_DISABLE      = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_timer_compare0_radio_disable;
+	ESB_SYS_TIMER->PUBLISH_COMPARE[1] = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_timer_compare1_radio_txen;
+	NRF_RADIO->SUBSCRIBE_TXEN         = DPPIC_SUBSCRIBE_CHG_EN_EN_Msk | ppi_ch_timer_compare1_radio_txen;
+#else
+	nrfx_ppi_channel_alloc(&ppi_ch_radio_ready_timer_start);
+	nrfx_ppi_channel_alloc(&ppi_ch_radio_address_timer_stop);
+	nrfx_ppi_channel_alloc(&ppi_ch_timer_compare0_radio_disable);
+	nrfx_ppi_channel_alloc(&ppi_ch_timer_compare1_radio_txen);
+
+	nrfx_ppi_channel_assign(ppi_ch_radio_ready_timer_start,
+		(uint32_t)&NRF_RADIO->EVENTS_READY, (uint32_t)&ESB_SYS_TIMER->TASKS_START);
+	nrfx_ppi_channel_assign(ppi_ch_radio_address_timer_stop,
+		(uint32_t)&NRF_RADIO->EVENTS_ADDRESS, (uint32_t)&ESB_SYS_TIMER->TASKS_SHUTDOWN);
+	nrfx_ppi_channel_assign(ppi_ch_timer_compare0_radio_disable,
+		(uint32_t)&ESB_SYS_TIMER->EVENTS_COMPARE[0], (uint32_t)&NRF_RADIO->TASKS_DISABLE);
+	nrfx_ppi_channel_assign(ppi_ch_timer_compare1_radio_txen,
+		(uint32_t)&ESB_SYS_TIMER->EVENTS_COMPARE[1], (uint32_t)&NRF_RADIO->TASKS_TXEN);
+#endif
+	ppi_all_channels_mask = (1 << ppi_ch_radio_ready_timer_start) | (1 << ppi_ch_radio_address_timer_stop) |
+							(1 << ppi_ch_timer_compare0_radio_disable) | (1 << ppi_ch_timer_compare1_radio_txen);
+}
+
+static void radio_irq_handler(void)
+{
+	if (NRF_RADIO->EVENTS_READY &&
+	    (NRF_RADIO->INTENSET & RADIO_INTENSET_READY_Msk)) {
+		NRF_RADIO->EVENTS_READY = 0;
+		ESB_SYS_TIMER->TASKS_START;
+	}
+
+	if (NRF_RADIO->EVENTS_DISABLED &&
+	    (NRF_RADIO->INTENSET & RADIO_INTENSET_DISABLED_Msk)) {
+		NRF_RADIO->EVENTS_DISABLED = 0;
+		/* Call the correct on_radio_disable function, depending on the
+		 * current protocol state.
+		 */
+		if (on_radio_disabled) {
+			on_radio_disabled();
+		}
+	}
+}
+
+ISR_DIRECT_DECLARE(RADIO_IRQHandler)
+{
+	radio_irq_handler();
+
+	ISR_DIRECT_PM();
+
+	return 1;
+}
+
+
+ISR_DIRECT_DECLARE(ESB_EVT_IRQHandler)
+{
+	if (on_evt) {
+		on_evt();
+	}
+
+	ISR_DIRECT_PM();
+
+	return 1;
+}
+
+ISR_DIRECT_DECLARE(ESB_SYS_TIMER_IRQHandler)
+{
+	ISR_DIRECT_PM();
+
+	return 1;
+}
+
+void esb_radio_init(esb_radio_handler_t disabled_handler,
+		    esb_radio_handler_t evt_handler,
+		    uint8_t radio_irq_priority, uint8_t evt_irq_priority)
+{
+	on_radio_disabled = disabled_handler;
+	on_evt = evt_handler;
+
+	sys_timer_init();
+	ppi_init();
+
+	IRQ_DIRECT_CONNECT(RADIO_IRQn, radio_irq_priority,
+			   RADIO_IRQHandler, 0);
+	IRQ_DIRECT_CONNECT(ESB_EVT_IRQ, evt_irq_priority,
+			   ESB_EVT_IRQHandler, 0);
+	IRQ_DIRECT_CONNECT(ESB_SYS_TIMER_IRQn, evt_irq_priority,
+			   ESB_SYS_TIMER_IRQHandler, 0);
+
+	irq_enable(RADIO_IRQn);
+	irq_enable(ESB_EVT_IRQ);
+	irq_enable(ESB_SYS_TIMER_IRQn);
+
+#ifdef CONFIG_SOC_NRF52832
+	if ((NRF_FICR->INFO.VARIANT & 0x0000FF00) == 0x00004500) {
+		/* Check if the device is an nRF52832 Rev. 2. */
+		/* Workaround for nRF52832 rev 2 errata 182 */
+		*(volatile uint32_t *)0x4000173C |= (1 << 10);
+	}
+#endif
+}
+
+void esb_radio_deinit(void)
+{
+	irq_disable(ESB_EVT_IRQ);
+
+	NRF_RADIO->SHORTS =
+	    RADIO_SHORTS_READY_START_Enabled << RADIO_SHORTS_READY_START_Pos |
+	    RADIO_SHORTS_END_DISABLE_Enabled << RADIO_SHORTS_END_DISABLE_Pos;
+}
+
+void esb_radio_tx_power_set(enum esb_tx_power tx_power)
+{
+	NRF_RADIO->TXPOWER = tx_power << RADIO_TXPOWER_TXPOWER_Pos;
+}
+
+void esb_radio_bitrate_set(enum esb_bitrate bitrate)
+{
+	NRF_RADIO->MODE = bitrate << RADIO_MODE_MODE_Pos;
+}
+
+bool esb_radio_crc_set(enum esb_crc crc)
+{
+	switch (crc) {
+	case ESB_CRC_16BIT:
+		NRF_RADIO->CRCINIT = 0xFFFFUL;  /* Initial value */
+		NRF_RADIO->CRCPOLY = 0x11021UL; /* CRC poly: x^16+x^12^x^5+1 */
+		break;
+
+	case ESB_CRC_8BIT:
+		NRF_RADIO->CRCINIT = 0xFFUL;  /* Initial value */
+		NRF_RADIO->CRCPOLY = 0x107UL; /* CRC poly: x^8+x^2^x^1+1 */
+		break;
+
+	case ESB_CRC_OFF:
+		break;
+
+	default:
+		return false;
+	}
+
+	NRF_RADIO->CRCINIT = 0xFFFFUL;  /* Initial value */
+	NRF_RADIO->CRCPOLY = 0x11021UL; /* CRC poly: x^16+x^12^x^5+1 */
+	NRF_RADIO->CRCCNF = ESB_CRC_16BIT << RADIO_CRCCNF_LEN_Pos;
+
+	return true;
+}
+
+void esb_radio_addresses_set(const struct esb_address *addr)
+{
+	NRF_RADIO->BASE0 = addr_conv(addr->base_addr_p0);
+	NRF_RADIO->BASE1 = addr_conv(addr->base_addr_p1);
+	NRF_RADIO->PREFIX0 = bytewise_bit_swap(&addr->pipe_prefixes[0]);
+	NRF_RADIO->PREFIX1 = bytewise_bit_swap(&addr->pipe_prefixes[4]);
+
+	/* Workaround for Errata 143 */
+#if NRF52_ERRATA_143_ENABLE_WORKAROUND
+	if (nrf52_errata_143()) {
+		apply_errata143_workaround(addr->addr_length);
+	}
+#endif
+}
+
+void esb_radio_packet_format_set(enum esb_protocol protocol,
+				 uint8_t addr_length, uint8_t payload_length)
+{
+	if (protocol == ESB_PROTOCOL_ESB) {
+		NRF_RADIO->PCNF0 = (1 << RADIO_PCNF0_S0LEN_Pos) |
+				   (0 << RADIO_PCNF0_LFLEN_Pos) |
+				   (1 << RADIO_PCNF0_S1LEN_Pos);
+
+		NRF_RADIO->PCNF1 =
+			(RADIO_PCNF1_WHITEEN_Disabled << RADIO_PCNF1_WHITEEN_Pos) |
+			(RADIO_PCNF1_ENDIAN_Big << RADIO_PCNF1_ENDIAN_Pos) |
+			((addr_length - 1) << RADIO_PCNF1_BALEN_Pos) |
+			(payload_length << RADIO_PCNF1_STATLEN_Pos) |
+			(payload_length << RADIO_PCNF1_MAXLEN_Pos);
+		return;
+	}
+
+#if (CONFIG_ESB_MAX_PAYLOAD_LENGTH <= 32)
+	/* Using 6 bits for length */
+	NRF_RADIO->PCNF0 = (0 << RADIO_PCNF0_S0LEN_Pos) |
+			   (6 << RADIO_PCNF0_LFLEN_Pos) |
+			   (3 << RADIO_PCNF0_S1LEN_Pos);
+#else
+	/* Using 8 bits for length */
+	NRF_RADIO->PCNF0 = (0 << RADIO_PCNF0_S0LEN_Pos) |
+			   (8 << RADIO_PCNF0_LFLEN_Pos) |
+			   (3 << RADIO_PCNF0_S1LEN_Pos);
+#endif
+	NRF_RADIO->PCNF1 =
+		(RADIO_PCNF1_WHITEEN_Disabled << RADIO_PCNF1_WHITEEN_Pos) |
+		(RADIO_PCNF1_ENDIAN_Big << RADIO_PCNF1_ENDIAN_Pos) |
+		((addr_length - 1) << RADIO_PCNF1_BALEN_Pos) |
+		(0 << RADIO_PCNF1_STATLEN_Pos) |
+		(CONFIG_ESB_MAX_PAYLOAD_LENGTH << RADIO_PCNF1_MAXLEN_Pos);
+}
+
+void esb_radio_next_set(enum esb_radio_next next)
+{
+	switch (next) {
+	case ESB_RADIO_NEXT_RX:
+		NRF_RADIO->SHORTS = radio_shorts_common |
+				    RADIO_SHORTS_DISABLED_RXEN_Msk;
+		break;
+
+	case ESB_RADIO_NEXT_TX:
+		NRF_RADIO->SHORTS = radio_shorts_common |
+				    RADIO_SHORTS_DISABLED_TXEN_Msk;
+		break;
+
+	default:
+		NRF_RADIO->SHORTS = radio_shorts_common;
+		break;
+	}
+}
+
+void esb_radio_packet_set(uint8_t *packet)
+{
+	NRF_RADIO->PACKETPTR = (uint32_t)packet;
+}
+
+void esb_radio_tx_pipe_set(uint8_t pipe)
+{
+	NRF_RADIO->TXADDRESS = pipe;
+}
+
+void esb_radio_tx_start(uint8_t pipe, uint8_t channel)
+{
+	if (NRF_RADIO->SHORTS & RADIO_SHORTS_DISABLED_RXEN_Msk) {
+		NRF_RADIO->INTENSET = RADIO_INTENSET_DISABLED_Msk |
+				      RADIO_INTENSET_READY_Msk;
+	} else {
+		NRF_RADIO->INTENSET = RADIO_INTENSET_DISABLED_Msk;
+	}
+
+	NRF_RADIO->TXADDRESS = pipe;
+	NRF_RADIO->RXADDRESSES = 1 << pipe;
+	NRF_RADIO->FREQUENCY = channel;
+
+	NVIC_ClearPendingIRQ(RADIO_IRQn);
+	irq_enable(RADIO_IRQn);
+
+	NRF_RADIO->EVENTS_ADDRESS = 0;
+	NRF_RADIO->EVENTS_PAYLOAD = 0;
+	NRF_RADIO->EVENTS_DISABLED = 0;
+
+	NRF_RADIO->TASKS_TXEN = 1;
+}
+
+void esb_radio_rx_start(uint8_t pipes, uint8_t channel)
+{
+	NRF_RADIO->INTENCLR = 0xFFFFFFFF;
+	NRF_RADIO->EVENTS_DISABLED = 0;
+	NRF_RADIO->INTENSET = RADIO_INTENSET_DISABLED_Msk;
+
+	NRF_RADIO->RXADDRESSES = pipes;
+	NRF_RADIO->FREQUENCY = channel;
+
+	NVIC_ClearPendingIRQ(RADIO_IRQn);
+	irq_enable(RADIO_IRQn);
+
+	NRF_RADIO->EVENTS_ADDRESS = 0;
+	NRF_RADIO->EVENTS_PAYLOAD = 0;
+	NRF_RADIO->EVENTS_DISABLED = 0;
+
+	NRF_RADIO->TASKS_RXEN = 1;
+}
+
+void esb_radio_rx_enable(void)
+{
+	NRF_RADIO->TASKS_RXEN = 1;
+}
+
+void esb_radio_disable(void)
+{
+	NRF_RADIO->EVENTS_DISABLED = 0;
+	NRF_RADIO->TASKS_DISABLE = 1;
+
+	while (NRF_RADIO->EVENTS_DISABLED == 0) {
+		/* wait for register to settle */
+	}
+
+	NRF_RADIO->EVENTS_DISABLED = 0;
+}
+
+void esb_radio_stop(void)
+{
+	NRF_RADIO->SHORTS = 0;
+	NRF_RADIO->INTENCLR = 0xFFFFFFFF;
+	NRF_RADIO->EVENTS_DISABLED = 0;
+	NRF_RADIO->TASKS_DISABLE = 1;
+	while (NRF_RADIO->EVENTS_DISABLED == 0) {
+		/* wait for register to settle */
+	}
+}
+
+bool esb_radio_rx_done(void)
+{
+	return NRF_RADIO->EVENTS_END;
+}
+
+bool esb_radio_crc_ok(void)
+{
+	return NRF_RADIO->CRCSTATUS != 0;
+}
+
+uint8_t esb_radio_rx_pipe(void)
+{
+	return NRF_RADIO->RXMATCH;
+}
+
+uint8_t esb_radio_tx_pipe(void)
+{
+	return NRF_RADIO->TXADDRESS;
+}
+
+uint32_t esb_radio_rx_crc(void)
+{
+	return NRF_RADIO->RXCRC;
+}
+
+int8_t esb_radio_rssi(void)
+{
+	return NRF_RADIO->RSSISAMPLE;
+}
+
+void esb_radio_ack_timer_start(uint32_t ack_timeout_us,
+			       uint32_t retransmit_delay_us)
+{
+	ESB_SYS_TIMER->CC[0] = ack_timeout_us;
+	ESB_SYS_TIMER->CC[1] = retransmit_delay_us - RADIO_RAMP_UP_US;
+	ESB_SYS_TIMER->TASKS_CLEAR = 1;
+	ESB_SYS_TIMER->EVENTS_COMPARE[0] = 0;
+	ESB_SYS_TIMER->EVENTS_COMPARE[1] = 0;
+
+	/* Remove */
+	ESB_SYS_TIMER->TASKS_START = 1;
+
+	nrfx_gppi_channels_enable(ppi_all_channels_mask);
+	nrfx_gppi_channels_disable(1 << ppi_ch_timer_compare1_radio_txen);
+
+	NRF_RADIO->EVENTS_END = 0;
+}
+
+void esb_radio_ack_timer_disable(void)
+{
+	nrfx_gppi_channels_disable(ppi_all_channels_mask);
+}
+
+void esb_radio_ack_timer_stop(void)
+{
+	ESB_SYS_TIMER->TASKS_SHUTDOWN = 1;
+}
+
+void esb_radio_retransmit_start(void)
+{
+	ESB_SYS_TIMER->TASKS_START = 1;
+	nrfx_gppi_channels_enable(1 << ppi_ch_timer_compare1_radio_txen);
+	if (ESB_SYS_TIMER->EVENTS_COMPARE[1]) {
+		NRF_RADIO->TASKS_TXEN = 1;
+	}
+}
+
+void esb_radio_evt_trigger(void)
+{
+	NVIC_SetPendingIRQ(ESB_EVT_IRQ);
+}
@@ -0,0 +1,1230 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/* Simulated radio for the Enhanced ShockBurst module.
+ *
+ * The simulation models the RADIO peripheral states, shortcuts and events
+ * used by ESB, the system timer with its (D)PPI connections, and a second
+ * radio node running the other end of the protocol. All the events are kept
+ * in a queue ordered by simulated time, and are processed by esb_sim_run().
+ * The radio and ESB event handlers are called from there, as the interrupts
+ * would be on hardware.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/__assert.h>
+#include <esb.h>
+#include <esb_sim.h>
+
+#include "esb_radio.h"
+
+/* Radio ramp-up time. */
+#define RADIO_RAMP_UP_NS 130000
+/* Timer resolution, the ESB system timer runs at 1 MHz. */
+#define TIMER_TICK_NS 1000
+
+#define PREAMBLE_LENGTH 1
+#define CRC_LENGTH 2
+
+#if (CONFIG_ESB_MAX_PAYLOAD_LENGTH <= 32)
+#define DPL_LENGTH_BITS 6
+#else
+#define DPL_LENGTH_BITS 8
+#endif
+#define DPL_S1_BITS 3
+#define ESB_S0_BITS 8
+#define ESB_S1_BITS 1
+
+/* ACK timeouts used by the peer, the same as in esb.c. */
+#define PEER_ACK_TIMEOUT_US_2MBPS 160
+#define PEER_ACK_TIMEOUT_US 300
+#define PEER_PID_MAX 3
+
+#define EVENT_QUEUE_SIZE 32
+
+#define NODE_DUT 0
+#define NODE_PEER 1
+#define NODE_COUNT 2
+
+enum radio_state {
+	RADIO_STATE_DISABLED,
+	RADIO_STATE_RXRU,
+	RADIO_STATE_RXIDLE,
+	RADIO_STATE_RX,
+	RADIO_STATE_TXRU,
+	RADIO_STATE_TX,
+};
+
+enum sim_event_type {
+	SIM_EVENT_READY,	/* Radio ramp-up done. */
+	SIM_EVENT_TX_END,	/* Last bit sent. */
+	SIM_EVENT_RX_ADDRESS,	/* Address of a packet on the air. */
+	SIM_EVENT_RX_END,	/* Last bit received. */
+	SIM_EVENT_TIMER_CC0,	/* System timer compare 0. */
+	SIM_EVENT_TIMER_CC1,	/* System timer compare 1. */
+	SIM_EVENT_PEER_TX,	/* Peer PTX starts an attempt. */
+	SIM_EVENT_PEER_ACK_TIMEOUT, /* Peer PTX ACK timeout. */
+};
+
+/* Packet on the air. */
+struct sim_frame {
+	uint8_t addr[5];	/* Prefix and base address. */
+	uint8_t addr_length;
+	uint8_t channel;
+	enum esb_bitrate bitrate;
+	enum esb_protocol protocol;
+	uint8_t header[2];	/* LENGTH or S0, and S1. */
+	uint8_t length;		/* Number of payload bytes. */
+	uint8_t data[CONFIG_ESB_MAX_PAYLOAD_LENGTH];
+	bool crc_error;
+};
+
+struct sim_event {
+	uint64_t time;
+	enum sim_event_type type;
+	uint8_t node;
+	uint32_t gen;		/* Generation of the radio, timer or peer. */
+	uint32_t arg;		/* Peer events: new packet or attempt. */
+	uint64_t end_time;	/* RX_ADDRESS: end of the packet. */
+	struct sim_frame frame;	/* RX_ADDRESS: packet. */
+};
+
+struct sim_radio {
+	enum radio_state state;
+	/* Incremented when the radio stops what it was doing, to cancel the
+	 * pending events.
+	 */
+	uint32_t gen;
+	enum esb_bitrate bitrate;
+	enum esb_protocol protocol;
+	uint8_t payload_length;	/* Static length for ESB_PROTOCOL_ESB. */
+	uint8_t tx_pipe;
+	uint8_t rx_pipes;
+	uint8_t rx_pipe;
+	uint16_t rx_crc;
+	bool crc_ok;
+	struct sim_frame tx_frame;
+	struct sim_frame rx_frame;
+	uint64_t rx_end_time;
+};
+
+/* System timer of the simulated device, with its PPI connections. */
+struct sim_timer {
+	bool running;
+	uint32_t gen;
+	uint32_t count;		/* Counter value at start_time. */
+	uint64_t start_time;
+	uint32_t cc[2];
+	bool compare[2];
+	bool ppi_ready_start;
+	bool ppi_address_shutdown;
+	bool ppi_cc0_disable;
+	bool ppi_cc1_txen;
+};
+
+struct sim_pipe_info {
+	bool valid;
+	uint8_t pid;
+	uint16_t crc;
+};
+
+struct sim_peer {
+	bool active;
+	struct esb_sim_peer_config cfg;
+	struct esb_sim_peer_stats stats;
+	struct sim_pipe_info pipe_info[CONFIG_ESB_PIPE_COUNT];
+	/* PTX state */
+	uint32_t packets_started;
+	uint8_t pid;
+	uint16_t retransmits_remaining;
+	uint32_t attempt;	/* Cancels stale ACK timeouts. */
+	bool wait_for_ack;
+	uint64_t packet_start_time;
+	uint64_t tx_end_time;
+};
+
+static struct {
+	uint64_t now;
+	struct sim_event queue[EVENT_QUEUE_SIZE];
+	uint32_t queue_count;
+	struct esb_sim_channel_config channel;
+	uint32_t prng;
+
+	/* Configuration shared by the nodes. */
+	struct esb_address addr;
+	uint8_t rf_channel;
+
+	struct sim_radio radio[NODE_COUNT];
+
+	/* Simulated device */
+	struct sim_timer timer;
+	enum esb_radio_next next;
+	uint8_t *packet;
+	bool rx_done;
+	bool radio_irq_enabled;
+	bool evt_irq_enabled;
+	bool evt_pending;
+	esb_radio_handler_t on_radio_disabled;
+	esb_radio_handler_t on_evt;
+
+	struct sim_peer peer;
+	/* Incremented when the peer is started or stopped, to cancel its
+	 * pending events.
+	 */
+	uint32_t peer_gen;
+} sim;
+
+static const struct esb_sim_channel_config channel_default =
+	ESB_SIM_CHANNEL_DEFAULT_CONFIG;
+
+static void radio_disable(uint8_t node, bool async);
+static void radio_txen(uint8_t node);
+static void peer_rx_restart(void);
+static void peer_next_packet(void);
+static void peer_attempt_failed(void);
+
+static uint32_t prng_next(void)
+{
+	/* xorshift32 */
+	uint32_t x = sim.prng;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	sim.prng = x;
+
+	return x;
+}
+
+static bool prng_permille(uint16_t permille)
+{
+	if (permille == 0) {
+		return false;
+	}
+
+	return (prng_next() % 1000) < permille;
+}
+
+static uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+
+	return crc;
+}
+
+static uint32_t bit_time_ns(enum esb_bitrate bitrate)
+{
+	switch (bitrate) {
+	case ESB_BITRATE_2MBPS:
+		return 500;
+
+	case ESB_BITRATE_250KBPS:
+		return 4000;
+
+	default:
+		return 1000;
+	}
+}
+
+static uint32_t header_bits(enum esb_protocol protocol)
+{
+	if (protocol == ESB_PROTOCOL_ESB) {
+		return ESB_S0_BITS + ESB_S1_BITS;
+	}
+
+	return DPL_LENGTH_BITS + DPL_S1_BITS;
+}
+
+static uint64_t frame_address_time_ns(const struct sim_frame *frame)
+{
+	return (uint64_t)8 * (PREAMBLE_LENGTH + frame->addr_length) *
+	       bit_time_ns(frame->bitrate);
+}
+
+static uint64_t frame_air_time_ns(const struct sim_frame *frame)
+{
+	uint32_t bits = 8 * (PREAMBLE_LENGTH + frame->addr_length) +
+			header_bits(frame->protocol) +
+			8 * (frame->length + CRC_LENGTH);
+
+	return (uint64_t)bits * bit_time_ns(frame->bitrate);
+}
+
+static uint16_t frame_crc(const struct sim_frame *frame)
+{
+	uint16_t crc = 0xFFFF;
+
+	crc = crc16_ccitt(crc, frame->addr, frame->addr_length);
+	crc = crc16_ccitt(crc, frame->header, sizeof(frame->header));
+	return crc16_ccitt(crc, frame->data, frame->length);
+}
+
+/* Address of a pipe: the prefix, followed by the base address bytes. */
+static void pipe_address_get(uint8_t pipe, uint8_t *addr)
+{
+	const uint8_t *base = (pipe == 0) ? sim.addr.base_addr_p0 :
+					    sim.addr.base_addr_p1;
+
+	addr[0] = sim.addr.pipe_prefixes[pipe];
+	memcpy(&addr[1], base, sim.addr.addr_length - 1);
+}
+
+static struct sim_event *event_schedule(uint64_t time,
+					enum sim_event_type type,
+					uint8_t node, uint32_t gen)
+{
+	uint32_t i;
+
+	__ASSERT(sim.queue_count < EVENT_QUEUE_SIZE,
+		 "Simulation event queue is full");
+
+	/* Events at the same time are processed in scheduling order. */
+	for (i = sim.queue_count; i > 0; i--) {
+		if (sim.queue[i - 1].time <= time) {
+			break;
+		}
+		sim.queue[i] = sim.queue[i - 1];
+	}
+
+	sim.queue[i].time = time;
+	sim.queue[i].type = type;
+	sim.queue[i].node = node;
+	sim.queue[i].gen = gen;
+	sim.queue[i].arg = 0;
+	sim.queue_count++;
+
+	return &sim.queue[i];
+}
+
+static uint32_t timer_count(void)
+{
+	if (!sim.timer.running) {
+		return sim.timer.count;
+	}
+
+	return sim.timer.count +
+	       (uint32_t)((sim.now - sim.timer.start_time) / TIMER_TICK_NS);
+}
+
+static void timer_compares_schedule(void)
+{
+	uint32_t count = timer_count();
+
+	for (int i = 0; i < 2; i++) {
+		if (sim.timer.cc[i] > count) {
+			event_schedule(sim.now + (uint64_t)(sim.timer.cc[i] -
+							    count) *
+					       TIMER_TICK_NS,
+				       SIM_EVENT_TIMER_CC0 + i, NODE_DUT,
+				       sim.timer.gen);
+		}
+	}
+}
+
+static void timer_start(void)
+{
+	if (sim.timer.running) {
+		return;
+	}
+
+	sim.timer.running = true;
+	sim.timer.start_time = sim.now;
+	sim.timer.gen++;
+	timer_compares_schedule();
+}
+
+static void timer_stop(void)
+{
+	sim.timer.count = timer_count();
+	sim.timer.running = false;
+	sim.timer.gen++;
+}
+
+static void timer_clear(void)
+{
+	sim.timer.count = 0;
+	sim.timer.start_time = sim.now;
+	sim.timer.gen++;
+	if (sim.timer.running) {
+		timer_compares_schedule();
+	}
+}
+
+static void timer_compare(int cc)
+{
+	sim.timer.compare[cc] = true;
+
+	if (cc == 0) {
+		if (sim.timer.ppi_cc0_disable) {
+			radio_disable(NODE_DUT, true);
+		}
+		return;
+	}
+
+	/* COMPARE1_CLEAR and COMPARE1_STOP shortcuts */
+	timer_clear();
+	timer_stop();
+
+	if (sim.timer.ppi_cc1_txen) {
+		radio_txen(NODE_DUT);
+	}
+}
+
+/* Build the packet to send from the packet pointer, like EasyDMA does. */
+static void dut_frame_get(struct sim_frame *frame)
+{
+	struct sim_radio *radio = &sim.radio[NODE_DUT];
+	const uint8_t *packet = sim.packet;
+
+	if (radio->protocol == ESB_PROTOCOL_ESB) {
+		frame->header[0] = packet[0];
+		frame->header[1] = packet[1] & BIT_MASK(ESB_S1_BITS);
+		frame->length = radio->payload_length;
+	} else {
+		frame->header[0] = packet[0] & BIT_MASK(DPL_LENGTH_BITS);
+		frame->header[1] = packet[1] & BIT_MASK(DPL_S1_BITS);
+		frame->length = MIN(frame->header[0],
+				    CONFIG_ESB_MAX_PAYLOAD_LENGTH);
+	}
+
+	memcpy(frame->data, &packet[2], frame->length);
+}
+
+/* Write the received packet to the packet pointer, like EasyDMA does. */
+static void dut_frame_put(const struct sim_frame *frame)
+{
+	struct sim_radio *radio = &sim.radio[NODE_DUT];
+	uint8_t *packet = sim.packet;
+	uint8_t length;
+
+	packet[0] = frame->header[0];
+	packet[1] = frame->header[1];
+
+	if (radio->protocol == ESB_PROTOCOL_ESB) {
+		length = radio->payload_length;
+		if (frame->length != length) {
+			radio->crc_ok = false;
+		}
+	} else {
+		/* Packets longer than MAXLEN are truncated. */
+		length = frame->length;
+		if (length > CONFIG_ESB_MAX_PAYLOAD_LENGTH) {
+			length = CONFIG_ESB_MAX_PAYLOAD_LENGTH;
+			radio->crc_ok = false;
+		}
+	}
+
+	memcpy(&packet[2], frame->data, MIN(length, frame->length));
+}
+
+static void radio_tx_begin(uint8_t node)
+{
+	struct sim_radio *radio = &sim.radio[node];
+	struct sim_frame *frame = &radio->tx_frame;
+	struct sim_event *evt;
+	uint64_t air_time;
+	uint64_t latency = (uint64_t)sim.channel.latency_us * 1000;
+
+	if (node == NODE_DUT) {
+		dut_frame_get(frame);
+	}
+
+	pipe_address_get(radio->tx_pipe, frame->addr);
+	frame->addr_length = sim.addr.addr_length;
+	frame->channel = sim.rf_channel;
+	frame->bitrate = radio->bitrate;
+	frame->protocol = radio->protocol;
+	frame->crc_error = false;
+
+	radio->state = RADIO_STATE_TX;
+	air_time = frame_air_time_ns(frame);
+
+	event_schedule(sim.now + air_time, SIM_EVENT_TX_END, node, radio->gen);
+
+	if (prng_permille(sim.channel.loss_permille)) {
+		return;
+	}
+
+	frame->crc_error = prng_permille(sim.channel.crc_error_permille);
+	evt = event_schedule(sim.now + frame_address_time_ns(frame) + latency,
+			     SIM_EVENT_RX_ADDRESS, !node, 0);
+	evt->end_time = sim.now + air_time + latency;
+	evt->frame = *frame;
+}
+
+static void radio_ready(uint8_t node)
+{
+	struct sim_radio *radio = &sim.radio[node];
+
+	if (node == NODE_DUT && sim.timer.ppi_ready_start) {
+		timer_start();
+	}
+
+	/* READY_START shortcut */
+	if (radio->state == RADIO_STATE_TXRU) {
+		radio_tx_begin(node);
+	} else {
+		radio->state = RADIO_STATE_RXIDLE;
+	}
+}
+
+static void radio_txen(uint8_t node)
+{
+	struct sim_radio *radio = &sim.radio[node];
+
+	if (radio->state != RADIO_STATE_DISABLED) {
+		return;
+	}
+
+	radio->state = RADIO_STATE_TXRU;
+	event_schedule(sim.now + RADIO_RAMP_UP_NS, SIM_EVENT_READY, node,
+		       radio->gen);
+}
+
+static void radio_rxen(uint8_t node)
+{
+	struct sim_radio *radio = &sim.radio[node];
+
+	if (radio->state != RADIO_STATE_DISABLED) {
+		return;
+	}
+
+	radio->state = RADIO_STATE_RXRU;
+	event_schedule(sim.now + RADIO_RAMP_UP_NS, SIM_EVENT_READY, node,
+		       radio->gen);
+}
+
+/* Disable a radio. For the simulated device, the DISABLED shortcuts are
+ * applied, and the disabled handler is called if the event comes from the
+ * hardware.
+ */
+static void radio_disable(uint8_t node, bool async)
+{
+	struct sim_radio *radio = &sim.radio[node];
+
+	radio->state = RADIO_STATE_DISABLED;
+	radio->gen++;
+
+	if (node != NODE_DUT) {
+		return;
+	}
+
+	switch (sim.next) {
+	case ESB_RADIO_NEXT_RX:
+		radio_rxen(NODE_DUT);
+		break;
+
+	case ESB_RADIO_NEXT_TX:
+		radio_txen(NODE_DUT);
+		break;
+
+	default:
+		break;
+	}
+
+	if (async && sim.radio_irq_enabled && sim.on_radio_disabled) {
+		sim.on_radio_disabled();
+	}
+}
+
+static bool radio_address_match(uint8_t node, const struct sim_frame *frame,
+				uint8_t *pipe)
+{
+	struct sim_radio *radio = &sim.radio[node];
+	uint8_t addr[5];
+
+	if (frame->channel != sim.rf_channel ||
+	    frame->bitrate != radio->bitrate ||
+	    frame->addr_length != sim.addr.addr_length) {
+		return false;
+	}
+
+	for (uint8_t i = 0; i < sim.addr.num_pipes; i++) {
+		if (!(radio->rx_pipes & BIT(i))) {
+			continue;
+		}
+
+		pipe_address_get(i, addr);
+		if (memcmp(addr, frame->addr, frame->addr_length) == 0) {
+			*pipe = i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void radio_rx_address(uint8_t node, const struct sim_event *evt)
+{
+	struct sim_radio *radio = &sim.radio[node];
+	uint8_t pipe;
+
+	if (radio->state != RADIO_STATE_RXIDLE ||
+	    !radio_address_match(node, &evt->frame, &pipe)) {
+		return;
+	}
+
+	radio->state = RADIO_STATE_RX;
+	radio->rx_pipe = pipe;
+	radio->rx_frame = evt->frame;
+	radio->rx_end_time = evt->end_time;
+
+	if (node == NODE_DUT && sim.timer.ppi_address_shutdown) {
+		timer_stop();
+	}
+
+	event_schedule(evt->end_time, SIM_EVENT_RX_END, node, radio->gen);
+}
+
+static void peer_rx_handler_call(const struct sim_frame *frame, uint8_t pipe)
+{
+	struct esb_payload payload = {
+		.length = frame->length,
+		.pipe = pipe,
+		.rssi = sim.channel.rssi,
+		.noack = !(frame->header[1] & 0x01),
+		.pid = frame->header[1] >> 1,
+	};
+
+	sim.peer.stats.rx_packets++;
+	sim.peer.stats.rx_bytes += frame->length;
+
+	if (sim.peer.cfg.rx_handler) {
+		memcpy(payload.data, frame->data, frame->length);
+		sim.peer.cfg.rx_handler(&payload);
+	}
+}
+
+static bool peer_frame_valid(const struct sim_radio *radio,
+			     const struct sim_frame *frame)
+{
+	if (frame->crc_error || frame->protocol != radio->protocol) {
+		return false;
+	}
+
+	if (radio->protocol == ESB_PROTOCOL_ESB) {
+		return frame->length == radio->payload_length;
+	}
+
+	return frame->length <= CONFIG_ESB_MAX_PAYLOAD_LENGTH;
+}
+
+static void peer_prx_rx_end(void)
+{
+	struct sim_peer *peer = &sim.peer;
+	struct sim_radio *radio = &sim.radio[NODE_PEER];
+	const struct sim_frame *frame = &radio->rx_frame;
+	struct sim_pipe_info *info = &peer->pipe_info[radio->rx_pipe];
+	struct sim_frame *ack = &radio->tx_frame;
+	uint16_t crc = frame_crc(frame);
+	uint8_t pid = frame->header[1] >> 1;
+	bool send_ack;
+
+	if (!peer_frame_valid(radio, frame)) {
+		peer_rx_restart();
+		return;
+	}
+
+	if (info->valid && info->crc == crc && info->pid == pid) {
+		peer->stats.rx_retransmits++;
+	} else {
+		peer_rx_handler_call(frame, radio->rx_pipe);
+	}
+
+	info->valid = true;
+	info->crc = crc;
+	info->pid = pid;
+
+	send_ack = !peer->cfg.selective_auto_ack || (frame->header[1] & 0x01);
+	if (!send_ack) {
+		peer_rx_restart();
+		return;
+	}
+
+	if (radio->protocol == ESB_PROTOCOL_ESB) {
+		ack->header[0] = frame->header[0];
+		ack->header[1] = 0;
+		ack->length = 0;
+	} else {
+		ack->length = peer->cfg.ack_payload_length;
+		ack->header[0] = ack->length;
+		ack->header[1] = frame->header[1];
+		for (uint8_t i = 0; i < ack->length; i++) {
+			ack->data[i] = (uint8_t)(peer->stats.ack_payloads + i);
+		}
+		if (ack->length > 0) {
+			peer->stats.ack_payloads++;
+		}
+	}
+
+	radio->tx_pipe = radio->rx_pipe;
+	radio->state = RADIO_STATE_DISABLED;
+	radio_txen(NODE_PEER);
+}
+
+static void peer_ptx_rx_end(void)
+{
+	struct sim_peer *peer = &sim.peer;
+	struct sim_radio *radio = &sim.radio[NODE_PEER];
+	const struct sim_frame *frame = &radio->rx_frame;
+	uint32_t latency_us;
+
+	radio->state = RADIO_STATE_DISABLED;
+	radio->gen++;
+
+	if (!peer->wait_for_ack || !peer_frame_valid(radio, frame)) {
+		peer_attempt_failed();
+		return;
+	}
+
+	peer->wait_for_ack = false;
+	peer->stats.tx_success++;
+
+	latency_us = (uint32_t)((sim.now - peer->packet_start_time) / 1000);
+	peer->stats.tx_latency_total_us += latency_us;
+	peer->stats.tx_latency_max_us = MAX(peer->stats.tx_latency_max_us,
+					    latency_us);
+
+	if (radio->protocol == ESB_PROTOCOL_ESB_DPL && frame->length > 0) {
+		peer_rx_handler_call(frame, radio->rx_pipe);
+	}
+
+	peer_next_packet();
+}
+
+static void radio_rx_end(uint8_t node)
+{
+	struct sim_radio *radio = &sim.radio[node];
+
+	radio->rx_crc = frame_crc(&radio->rx_frame);
+	radio->crc_ok = !radio->rx_frame.crc_error &&
+			(radio->rx_frame.protocol == radio->protocol);
+
+	if (node == NODE_DUT) {
+		dut_frame_put(&radio->rx_frame);
+		sim.rx_done = true;
+		/* END_DISABLE shortcut */
+		radio_disable(NODE_DUT, true);
+		return;
+	}
+
+	if (sim.peer.cfg.mode == ESB_MODE_PRX) {
+		peer_prx_rx_end();
+	} else {
+		peer_ptx_rx_end();
+	}
+}
+
+static void peer_rx_restart(void)
+{
+	struct sim_radio *radio = &sim.radio[NODE_PEER];
+
+	radio->state = RADIO_STATE_DISABLED;
+	radio->gen++;
+	radio->rx_pipes = BIT_MASK(CONFIG_ESB_PIPE_COUNT);
+	radio_rxen(NODE_PEER);
+}
+
+static uint32_t peer_ack_timeout_us(void)
+{
+	if (sim.peer.cfg.bitrate == ESB_BITRATE_2MBPS) {
+		return PEER_ACK_TIMEOUT_US_2MBPS;
+	}
+
+	return PEER_ACK_TIMEOUT_US;
+}
+
+static void peer_tx_end(void)
+{
+	struct sim_peer *peer = &sim.peer;
+	struct sim_radio *radio = &sim.radio[NODE_PEER];
+	struct sim_event *evt;
+
+	radio->state = RADIO_STATE_DISABLED;
+	radio->gen++;
+
+	if (peer->cfg.mode == ESB_MODE_PRX) {
+		/* DISABLED_RXEN shortcut after sending the ACK. */
+		peer_rx_restart();
+		return;
+	}
+
+	/* Wait for the ACK. The timeout is counted from the end of the packet,
+	 * like the ESB system timer does.
+	 */
+	peer->tx_end_time = sim.now;
+	peer->wait_for_ack = true;
+	radio->rx_pipes = BIT(peer->cfg.pipe);
+	radio_rxen(NODE_PEER);
+	evt = event_schedule(sim.now + (uint64_t)peer_ack_timeout_us() * 1000,
+			     SIM_EVENT_PEER_ACK_TIMEOUT, NODE_PEER, sim.peer_gen);
+	evt->arg = ++peer->attempt;
+}
+
+static void peer_ack_timeout(uint32_t attempt)
+{
+	struct sim_peer *peer = &sim.peer;
+	struct sim_radio *radio = &sim.radio[NODE_PEER];
+
+	/* The ACK address was received in time. */
+	if (attempt != peer->attempt || !peer->wait_for_ack ||
+	    radio->state == RADIO_STATE_RX) {
+		return;
+	}
+
+	radio->state = RADIO_STATE_DISABLED;
+	radio->gen++;
+	peer_attempt_failed();
+}
+
+static void peer_attempt_failed(void)
+{
+	struct sim_peer *peer = &sim.peer;
+	uint64_t start;
+
+	peer->wait_for_ack = false;
+
+	if (peer->retransmits_remaining == 0) {
+		peer->stats.tx_failed++;
+		peer_next_packet();
+		return;
+	}
+
+	peer->retransmits_remaining--;
+	peer->stats.tx_retransmits++;
+
+	/* The next attempt starts retransmit_delay after the end of the
+	 * previous one, ramp-up included.
+	 */
+	start = peer->tx_end_time +
+		(uint64_t)peer->cfg.retransmit_delay * 1000 - RADIO_RAMP_UP_NS;
+	event_schedule(MAX(start, sim.now), SIM_EVENT_PEER_TX, NODE_PEER,
+		       sim.peer_gen);
+}
+
+static void peer_next_packet(void)
+{
+	struct sim_peer *peer = &sim.peer;
+	struct sim_event *evt;
+	uint64_t start;
+
+	if (peer->packets_started >= peer->cfg.packet_count) {
+		return;
+	}
+
+	start = peer->packet_start_time +
+		(uint64_t)peer->cfg.packet_interval_us * 1000;
+	evt = event_schedule(MAX(start, sim.now), SIM_EVENT_PEER_TX, NODE_PEER,
+			     sim.peer_gen);
+	evt->arg = true;
+}
+
+static void peer_tx(bool new_packet)
+{
+	struct sim_peer *peer = &sim.peer;
+	struct sim_radio *radio = &sim.radio[NODE_PEER];
+	struct sim_frame *frame = &radio->tx_frame;
+
+	if (new_packet) {
+		peer->packets_started++;
+		peer->stats.tx_packets++;
+		peer->pid = (peer->pid + 1) & PEER_PID_MAX;
+		peer->retransmits_remaining = peer->cfg.retransmit_count;
+		peer->packet_start_time = sim.now;
+
+		frame->length = peer->cfg.packet_length;
+		for (uint8_t i = 0; i < frame->length; i++) {
+			frame->data[i] = (uint8_t)(peer->packets_started + i);
+		}
+
+		if (radio->protocol == ESB_PROTOCOL_ESB) {
+			frame->header[0] = peer->pid;
+			frame->header[1] = 0;
+		} else {
+			frame->header[0] = frame->length;
+			frame->header[1] = (peer->pid << 1) | 0x01;
+		}
+	}
+
+	radio->tx_pipe = peer->cfg.pipe;
+	radio->state = RADIO_STATE_DISABLED;
+	radio->gen++;
+	radio_txen(NODE_PEER);
+}
+
+static void event_process(const struct sim_event *evt)
+{
+	struct sim_radio *radio = &sim.radio[evt->node];
+
+	switch (evt->type) {
+	case SIM_EVENT_READY:
+		if (evt->gen == radio->gen) {
+			radio_ready(evt->node);
+		}
+		break;
+
+	case SIM_EVENT_TX_END:
+		if (evt->gen != radio->gen) {
+			break;
+		}
+		if (evt->node == NODE_DUT) {
+			/* END_DISABLE shortcut */
+			radio_disable(NODE_DUT, true);
+		} else {
+			peer_tx_end();
+		}
+		break;
+
+	case SIM_EVENT_RX_ADDRESS:
+		if (evt->node == NODE_DUT || sim.peer.active) {
+			radio_rx_address(evt->node, evt);
+		}
+		break;
+
+	case SIM_EVENT_RX_END:
+		if (evt->gen == radio->gen) {
+			radio_rx_end(evt->node);
+		}
+		break;
+
+	case SIM_EVENT_TIMER_CC0:
+	case SIM_EVENT_TIMER_CC1:
+		if (evt->gen == sim.timer.gen) {
+			timer_compare(evt->type - SIM_EVENT_TIMER_CC0);
+		}
+		break;
+
+	case SIM_EVENT_PEER_TX:
+		if (evt->gen == sim.peer_gen) {
+			peer_tx(evt->arg);
+		}
+		break;
+
+	case SIM_EVENT_PEER_ACK_TIMEOUT:
+		if (evt->gen == sim.peer_gen) {
+			peer_ack_timeout(evt->arg);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void evt_process(void)
+{
+	if (sim.evt_pending && sim.evt_irq_enabled) {
+		sim.evt_pending = false;
+		if (sim.on_evt) {
+			sim.on_evt();
+		}
+	}
+}
+
+void esb_sim_run(uint32_t duration_us)
+{
+	uint64_t end = sim.now + (uint64_t)duration_us * 1000;
+	struct sim_event evt;
+
+	evt_process();
+
+	while (sim.queue_count > 0 && sim.queue[0].time <= end) {
+		evt = sim.queue[0];
+		sim.queue_count--;
+		memmove(&sim.queue[0], &sim.queue[1],
+			sim.queue_count * sizeof(sim.queue[0]));
+
+		sim.now = evt.time;
+		event_process(&evt);
+		evt_process();
+	}
+
+	sim.now = end;
+}
+
+uint64_t esb_sim_time_us(void)
+{
+	return sim.now / 1000;
+}
+
+void esb_sim_channel_set(const struct esb_sim_channel_config *config)
+{
+	sim.channel = *config;
+	sim.prng = config->seed ? config->seed : 1;
+}
+
+void esb_sim_reset(void)
+{
+	sim.now = 0;
+	sim.queue_count = 0;
+	sim.evt_pending = false;
+	sim.rx_done = false;
+	sim.next = ESB_RADIO_NEXT_NONE;
+
+	for (int i = 0; i < NODE_COUNT; i++) {
+		sim.radio[i].state = RADIO_STATE_DISABLED;
+		sim.radio[i].gen++;
+	}
+
+	memset(&sim.timer, 0, sizeof(sim.timer));
+	memset(&sim.peer, 0, sizeof(sim.peer));
+
+	esb_sim_channel_set(&channel_default);
+}
+
+int esb_sim_peer_start(const struct esb_sim_peer_config *config)
+{
+	struct sim_peer *peer = &sim.peer;
+	struct sim_radio *radio = &sim.radio[NODE_PEER];
+
+	if (config->packet_length > CONFIG_ESB_MAX_PAYLOAD_LENGTH ||
+	    config->ack_payload_length > CONFIG_ESB_MAX_PAYLOAD_LENGTH ||
+	    config->payload_length > CONFIG_ESB_MAX_PAYLOAD_LENGTH ||
+	    config->pipe >= CONFIG_ESB_PIPE_COUNT) {
+		return -EINVAL;
+	}
+
+	if (config->protocol == ESB_PROTOCOL_ESB &&
+	    (config->packet_length != config->payload_length ||
+	     config->ack_payload_length > 0)) {
+		return -EINVAL;
+	}
+
+	esb_sim_peer_stop();
+
+	memset(peer, 0, sizeof(*peer));
+	peer->cfg = *config;
+	peer->active = true;
+
+	radio->bitrate = config->bitrate;
+	radio->protocol = config->protocol;
+	radio->payload_length = config->payload_length;
+
+	if (config->mode == ESB_MODE_PRX) {
+		/* The PRX is ramped up and listening right away. */
+		radio->rx_pipes = BIT_MASK(CONFIG_ESB_PIPE_COUNT);
+		radio->state = RADIO_STATE_RXIDLE;
+	} else {
+		peer->packet_start_time = sim.now;
+		if (config->packet_count > 0) {
+			struct sim_event *evt;
+
+			evt = event_schedule(sim.now, SIM_EVENT_PEER_TX,
+					     NODE_PEER, sim.peer_gen);
+			evt->arg = true;
+		}
+	}
+
+	return 0;
+}
+
+void esb_sim_peer_stop(void)
+{
+	struct sim_radio *radio = &sim.radio[NODE_PEER];
+
+	sim.peer.active = false;
+	sim.peer_gen++;
+	radio->state = RADIO_STATE_DISABLED;
+	radio->gen++;
+}
+
+void esb_sim_peer_stats_get(struct esb_sim_peer_stats *stats)
+{
+	*stats = sim.peer.stats;
+}
+
+void esb_radio_init(esb_radio_handler_t disabled_handler,
+		    esb_radio_handler_t evt_handler,
+		    uint8_t radio_irq_priority, uint8_t evt_irq_priority)
+{
+	sim.on_radio_disabled = disabled_handler;
+	sim.on_evt = evt_handler;
+	sim.radio_irq_enabled = true;
+	sim.evt_irq_enabled = true;
+	sim.evt_pending = false;
+}
+
+void esb_radio_deinit(void)
+{
+	sim.evt_irq_enabled = false;
+	sim.next = ESB_RADIO_NEXT_NONE;
+}
+
+void esb_radio_tx_power_set(enum esb_tx_power tx_power)
+{
+}
+
+void esb_radio_bitrate_set(enum esb_bitrate bitrate)
+{
+	sim.radio[NODE_DUT].bitrate = bitrate;
+}
+
+bool esb_radio_crc_set(enum esb_crc crc)
+{
+	switch (crc) {
+	case ESB_CRC_16BIT:
+	case ESB_CRC_8BIT:
+	case ESB_CRC_OFF:
+		/* The nRF radio always uses a 16-bit CRC, see
+		 * esb_radio_nrf.c.
+		 */
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+void esb_radio_addresses_set(const struct esb_address *addr)
+{
+	sim.addr = *addr;
+}
+
+void esb_radio_packet_format_set(enum esb_protocol protocol,
+				 uint8_t addr_length, uint8_t payload_length)
+{
+	struct sim_radio *radio = &sim.radio[NODE_DUT];
+
+	radio->protocol = protocol;
+	radio->payload_length = payload_length;
+	sim.addr.addr_length = addr_length;
+}
+
+void esb_radio_next_set(enum esb_radio_next next)
+{
+	sim.next = next;
+}
+
+void esb_radio_packet_set(uint8_t *packet)
+{
+	sim.packet = packet;
+}
+
+void esb_radio_tx_pipe_set(uint8_t pipe)
+{
+	sim.radio[NODE_DUT].tx_pipe = pipe;
+}
+
+void esb_radio_tx_start(uint8_t pipe, uint8_t channel)
+{
+	struct sim_radio *radio = &sim.radio[NODE_DUT];
+
+	radio->tx_pipe = pipe;
+	radio->rx_pipes = BIT(pipe);
+	sim.rf_channel = channel;
+	sim.radio_irq_enabled = true;
+
+	radio_txen(NODE_DUT);
+}
+
+void esb_radio_rx_start(uint8_t pipes, uint8_t channel)
+{
+	struct sim_radio *radio = &sim.radio[NODE_DUT];
+
+	radio->rx_pipes = pipes;
+	sim.rf_channel = channel;
+	sim.radio_irq_enabled = true;
+
+	radio_rxen(NODE_DUT);
+}
+
+void esb_radio_rx_enable(void)
+{
+	radio_rxen(NODE_DUT);
+}
+
+void esb_radio_disable(void)
+{
+	radio_disable(NODE_DUT, false);
+}
+
+void esb_radio_stop(void)
+{
+	sim.next = ESB_RADIO_NEXT_NONE;
+	sim.radio_irq_enabled = false;
+	radio_disable(NODE_DUT, false);
+}
+
+bool esb_radio_rx_done(void)
+{
+	return sim.rx_done;
+}
+
+bool esb_radio_crc_ok(void)
+{
+	return sim.radio[NODE_DUT].crc_ok;
+}
+
+uint8_t esb_radio_rx_pipe(void)
+{
+	return sim.radio[NODE_DUT].rx_pipe;
+}
+
+uint8_t esb_radio_tx_pipe(void)
+{
+	return sim.radio[NODE_DUT].tx_pipe;
+}
+
+uint32_t esb_radio_rx_crc(void)
+{
+	return sim.radio[NODE_DUT].rx_crc;
+}
+
+int8_t esb_radio_rssi(void)
+{
+	return sim.channel.rssi;
+}
+
+void esb_radio_ack_timer_start(uint32_t ack_timeout_us,
+			       uint32_t retransmit_delay_us)
+{
+	sim.timer.cc[0] = ack_timeout_us;
+	sim.timer.cc[1] = retransmit_delay_us - RADIO_RAMP_UP_NS / 1000;
+	timer_clear();
+	sim.timer.compare[0] = false;
+	sim.timer.compare[1] = false;
+	timer_start();
+
+	sim.timer.ppi_ready_start = true;
+	sim.timer.ppi_address_shutdown = true;
+	sim.timer.ppi_cc0_disable = true;
+	sim.timer.ppi_cc1_txen = false;
+
+	sim.rx_done = false;
+}
+
+void esb_radio_ack_timer_disable(void)
+{
+	sim.timer.ppi_ready_start = false;
+	sim.timer.ppi_address_shutdown = false;
+	sim.timer.ppi_cc0_disable = false;
+	sim.timer.ppi_cc1_txen = false;
+}
+
+void esb_radio_ack_timer_stop(void)
+{
+	timer_stop();
+}
+
+void esb_radio_retransmit_start(void)
+{
+	timer_start();
+	sim.timer.ppi_cc1_txen = true;
+	if (sim.timer.compare[1]) {
+		radio_txen(NODE_DUT);
+	}
+}
+
+void esb_radio_evt_trigger(void)
+{
+	sim.evt_pending = true;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <errno.h>
+#include <string.h>
+#include <sys/util.h>
+#include <sys/byteorder.h>
+#include <nfc/ndef/msg_parser.h>
+
+static uint32_t record_hdr_len(uint8_t flags)
+{
+	uint32_t len = 2;
+
+	len += (flags & NDEF_RECORD_SR_MASK) ?
+		NDEF_RECORD_PAYLOAD_LEN_SHORT_SIZE :
+		NDEF_RECORD_PAYLOAD_LEN_LONG_SIZE;
+
+	if (flags & NDEF_RECORD_IL_MASK) {
+		len += NDEF_RECORD_ID_LEN_SIZE;
+	}
+
+	return len;
+}
+
+/* Get the record length from its complete header. */
+static int record_len_get(const uint8_t *hdr, uint32_t *rec_len)
+{
+	uint8_t flags = hdr[0];
+	const uint8_t *len_field = &hdr[2];
+	uint32_t len = record_hdr_len(flags) + hdr[1];
+	uint32_t payload_length;
+
+	if (flags & NDEF_RECORD_SR_MASK) {
+		payload_length = *(len_field++);
+	} else {
+		payload_length = sys_get_be32(len_field);
+		len_field += NDEF_RECORD_PAYLOAD_LEN_LONG_SIZE;
+	}
+
+	if (flags & NDEF_RECORD_IL_MASK) {
+		len += *len_field;
+	}
+
+	if (payload_length > UINT32_MAX - len) {
+		return -ENOMEM;
+	}
+
+	*rec_len = len + payload_length;
+
+	return 0;
+}
+
+static int record_emit(struct nfc_ndef_msg_parser_stream *parser,
+		       const uint8_t *data, uint32_t len)
+{
+	struct nfc_ndef_bin_payload_desc bin_pay_desc;
+	struct nfc_ndef_record_desc rec_desc;
+	enum nfc_ndef_record_location record_location;
+	int err;
+
+	err = nfc_ndef_record_parse(&bin_pay_desc, &rec_desc, &record_location,
+				    data, &len);
+	if (err) {
+		return err;
+	}
+
+	/* Verify the records location flags. */
+	if (parser->record_count == 0) {
+		if ((record_location != NDEF_FIRST_RECORD) &&
+		    (record_location != NDEF_LONE_RECORD)) {
+			return -EFAULT;
+		}
+	} else {
+		if ((record_location != NDEF_MIDDLE_RECORD) &&
+		    (record_location != NDEF_LAST_RECORD)) {
+			return -EFAULT;
+		}
+	}
+
+	parser->done = (record_location == NDEF_LAST_RECORD) ||
+		       (record_location == NDEF_LONE_RECORD);
+
+	return parser->cb(parser, parser->record_count++, &rec_desc,
+			  parser->done);
+}
+
+/* Parse the records that are complete in the data, without copying them. */
+static int records_parse_in_place(struct nfc_ndef_msg_parser_stream *parser,
+				  const uint8_t **data, uint32_t *left)
+{
+	uint32_t rec_len;
+	int err;
+
+	while (*left && !parser->done) {
+		if ((*left < record_hdr_len(**data)) ||
+		    record_len_get(*data, &rec_len) ||
+		    (rec_len > *left)) {
+			break;
+		}
+
+		err = record_emit(parser, *data, rec_len);
+		if (err) {
+			return err;
+		}
+
+		*data += rec_len;
+		*left -= rec_len;
+	}
+
+	return 0;
+}
+
+void nfc_ndef_msg_parser_stream_init(struct nfc_ndef_msg_parser_stream *parser,
+				     uint8_t *buf,
+				     uint32_t buf_size,
+				     nfc_ndef_msg_parser_stream_cb_t cb)
+{
+	memset(parser, 0, sizeof(*parser));
+
+	parser->cb = cb;
+	parser->buf = buf;
+	parser->buf_size = buf_size;
+}
+
+int nfc_ndef_msg_parser_stream_push(struct nfc_ndef_msg_parser_stream *parser,
+				    const uint8_t *data,
+				    uint32_t *data_len)
+{
+	uint32_t left = *data_len;
+	uint32_t needed;
+	uint32_t chunk;
+	int err = 0;
+
+	while (left && !parser->done) {
+		if (parser->buf_len == 0) {
+			err = records_parse_in_place(parser, &data, &left);
+			if (err || !left || parser->done) {
+				break;
+			}
+		}
+
+		/* Collect the flags, then the rest of the header, and then
+		 * the rest of the record.
+		 */
+		if (parser->rec_len) {
+			needed = parser->rec_len;
+		} else if (parser->buf_len) {
+			needed = record_hdr_len(parser->buf[0]);
+		} else {
+			needed = 1;
+		}
+
+		if (needed > parser->buf_size) {
+			err = -ENOMEM;
+			break;
+		}
+
+		chunk = MIN(left, needed - parser->buf_len);
+		memcpy(parser->buf + parser->buf_len, data, chunk);
+		parser->buf_len += chunk;
+		data += chunk;
+		left -= chunk;
+
+		if ((parser->buf_len < needed) || (needed == 1)) {
+			continue;
+		}
+
+		if (!parser->rec_len) {
+			err = record_len_get(parser->buf, &parser->rec_len);
+			if (err) {
+				break;
+			}
+
+			if (parser->rec_len > parser->buf_len) {
+				continue;
+			}
+		}
+
+		err = record_emit(parser, parser->buf, parser->rec_len);
+		parser->buf_len = 0;
+		parser->rec_len = 0;
+		if (err) {
+			break;
+		}
+	}
+
+	*data_len -= left;
+
+	return err;
+}
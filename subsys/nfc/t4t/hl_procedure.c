@@ -24,8 +24,21 @@ LOG_MODULE_REGISTER(nfc_t4t_hl_procedure,
 #define CC_MIN_RAPDU_SIZE 0x0F
 #define CC_RAPDU_MAX_SIZE_OFFSET 0x03
 #define NFC_T4T_APDU_SELECT_DATA {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01}
-#define APDU_LE_MAP_2_MAX_VALUE 0xFF
 #define NFC_T4T_APDU_RSP_ALL 256
+#define CAPDU_HEADER_SIZE 4
+#define CAPDU_LC_SHORT_SIZE 1
+#define CAPDU_LC_LONG_SIZE 3
+#define CAPDU_LC_SHORT_MAX_VALUE 0xFF
+
+/* Largest UPDATE BINARY data that fits in the APDU buffer, with a short or an
+ * extended Lc field.
+ */
+#define UPDATE_DATA_MAX_SIZE                                                   \
+	MAX(MIN(CAPDU_LC_SHORT_MAX_VALUE,                                      \
+		CONFIG_NFC_T4T_HL_PROCEDURE_APDU_BUF_SIZE - CAPDU_HEADER_SIZE -\
+		CAPDU_LC_SHORT_SIZE),                                          \
+	    CONFIG_NFC_T4T_HL_PROCEDURE_APDU_BUF_SIZE - CAPDU_HEADER_SIZE -    \
+	    CAPDU_LC_LONG_SIZE)
 
 enum nfc_t4t_hl_transaction_type {
 	NFC_T4T_HL_SELECT,
@@ -34,7 +47,8 @@ enum nfc_t4t_hl_transaction_type {
 	NFC_T4T_HL_NDEF_READ,
 	NFC_T4T_HL_NDEF_NLEN_CLEAR,
 	NFC_T4T_HL_NDEF_UPDATE,
-	NFC_T4T_HL_NDEF_NLEN_UPDATE
+	NFC_T4T_HL_NDEF_NLEN_UPDATE,
+	NFC_T4T_HL_NONE
 };
 
 struct t4t_hl_ndef {
@@ -134,13 +148,23 @@ static int on_ndef_nlen_read(const struct nfc_t4t_apdu_resp *resp)
 	const uint8_t *data = resp->data.buff;
 	uint16_t len = resp->data.len;
 
-	if (len != NDEF_FILE_NLEN_SIZE) {
-		LOG_ERR("NDEF NLEN response is to long");
+	if (len < NDEF_FILE_NLEN_SIZE) {
+		LOG_ERR("NDEF NLEN response is to short");
 		return -EINVAL;
 	}
 
 	t4t_hl.ndef.nlen = sys_get_be16(data);
 
+	if (t4t_hl.ndef.nlen > (UINT16_MAX - NDEF_FILE_NLEN_SIZE)) {
+		LOG_ERR("Invalid NDEF NLEN value");
+		return -EINVAL;
+	}
+
+	if (t4t_hl.ndef.buff &&
+	    (t4t_hl.ndef.buff_size < (t4t_hl.ndef.nlen + NDEF_FILE_NLEN_SIZE))) {
+		return -ENOMEM;
+	}
+
 	return 0;
 }
 
@@ -156,38 +180,85 @@ static int t4t_file_assign(uint16_t id)
 	return nfc_t4t_cc_file_content_set(t4t_hl.ndef.cc, &file, id);
 }
 
+static uint16_t ndef_file_read_len(uint32_t len)
+{
+	return MIN(len, MIN(CONFIG_NFC_T4T_HL_PROCEDURE_RAPDU_MAX_SIZE,
+			    t4t_hl.ndef.cc->max_rapdu_size));
+}
+
+static int ndef_file_next_chunk_read(void)
+{
+	struct nfc_t4t_apdu_comm apdu_comm;
+	uint16_t file_len = t4t_hl.ndef.nlen + NDEF_FILE_NLEN_SIZE;
+
+	nfc_t4t_apdu_comm_clear(&apdu_comm);
+
+	apdu_comm.instruction = NFC_T4T_APDU_COMM_INS_READ;
+	apdu_comm.parameter = t4t_hl.file_offset;
+	apdu_comm.resp_len = ndef_file_read_len(file_len - t4t_hl.file_offset);
+
+	t4t_hl.transaction_type = NFC_T4T_HL_NDEF_READ;
+
+	return t4t_hl_data_exchange(&apdu_comm);
+}
+
 static int ndef_file_chunk_read(const struct nfc_t4t_apdu_resp *resp)
 {
 	__ASSERT_NO_MSG(resp);
 
 	int err;
-	uint16_t file_id;
-	struct nfc_t4t_apdu_comm apdu_comm;
+	uint16_t file_id = sys_get_be16(t4t_hl.ndef.file_id);
+	uint16_t file_len = t4t_hl.ndef.nlen + NDEF_FILE_NLEN_SIZE;
+	uint16_t offset = t4t_hl.file_offset;
 	const uint8_t *data = resp->data.buff;
 	uint16_t len = resp->data.len;
+	uint16_t nlen_part;
 
-	if (t4t_hl.ndef.buff_size < t4t_hl.file_offset + len) {
-		return -ENOMEM;
+	/* The first response can contain data past the NDEF message. */
+	len = MIN(len, file_len - offset);
+	if (len == 0) {
+		LOG_ERR("NDEF file read response is empty");
+		return -EINVAL;
 	}
 
-	memcpy(t4t_hl.ndef.buff + t4t_hl.file_offset, data, len);
-
 	t4t_hl.file_offset += len;
 
-	if (t4t_hl.file_offset < (t4t_hl.ndef.nlen + NDEF_FILE_NLEN_SIZE)) {
-		nfc_t4t_apdu_comm_clear(&apdu_comm);
-
-		apdu_comm.instruction = NFC_T4T_APDU_COMM_INS_READ;
-		apdu_comm.parameter = t4t_hl.file_offset;
-		apdu_comm.resp_len = MIN(t4t_hl.ndef.nlen - (t4t_hl.file_offset - NDEF_FILE_NLEN_SIZE),
-				MIN(APDU_LE_MAP_2_MAX_VALUE, t4t_hl.ndef.cc->max_rapdu_size));
+	/* Once the chunk is stored, the next READ BINARY command is sent
+	 * before the chunk is processed, so the exchange with the tag overlaps
+	 * with the processing. Without the NDEF file buffer, the chunk stays in
+	 * the ISO-DEP RX buffer, and is processed first.
+	 */
+	if (t4t_hl.ndef.buff) {
+		memcpy(t4t_hl.ndef.buff + offset, data, len);
+		data = t4t_hl.ndef.buff + offset;
+
+		if (t4t_hl.file_offset < file_len) {
+			err = ndef_file_next_chunk_read();
+			if (err) {
+				return err;
+			}
+		}
+	}
 
-		t4t_hl.transaction_type = NFC_T4T_HL_NDEF_READ;
+	/* Pass the NDEF message part of the response on as soon as it is
+	 * received, so it can be processed while the next one is read.
+	 */
+	nlen_part = (offset < NDEF_FILE_NLEN_SIZE) ?
+		MIN(len, NDEF_FILE_NLEN_SIZE - offset) : 0;
 
-		return t4t_hl_data_exchange(&apdu_comm);
+	if (hl_cb->ndef_chunk_read && (len > nlen_part)) {
+		err = hl_cb->ndef_chunk_read(file_id, data + nlen_part,
+					     len - nlen_part);
+		if (err) {
+			/* Ignore the response to the pending READ BINARY. */
+			t4t_hl.transaction_type = NFC_T4T_HL_NONE;
+			return err;
+		}
 	}
 
-	file_id = sys_get_be16(t4t_hl.ndef.file_id);
+	if (t4t_hl.file_offset < file_len) {
+		return t4t_hl.ndef.buff ? 0 : ndef_file_next_chunk_read();
+	}
 
 	err = t4t_file_assign(file_id);
 	if (err) {
@@ -195,8 +266,7 @@ static int ndef_file_chunk_read(const struct nfc_t4t_apdu_resp *resp)
 	}
 
 	if (hl_cb->ndef_read) {
-		hl_cb->ndef_read(file_id, t4t_hl.ndef.buff,
-				 t4t_hl.ndef.nlen + NDEF_FILE_NLEN_SIZE);
+		hl_cb->ndef_read(file_id, t4t_hl.ndef.buff, file_len);
 	}
 
 	return 0;
@@ -215,7 +285,7 @@ static int ndef_file_chunk_update(void)
 		apdu_comm.parameter = t4t_hl.file_offset;
 		apdu_comm.data.buff = t4t_hl.ndef.buff + t4t_hl.file_offset;
 		apdu_comm.data.len = MIN(t4t_hl.ndef.buff_size - t4t_hl.file_offset,
-				MIN(APDU_LE_MAP_2_MAX_VALUE, t4t_hl.ndef.cc->max_capdu_size));
+				MIN(UPDATE_DATA_MAX_SIZE, t4t_hl.ndef.cc->max_capdu_size));
 
 		t4t_hl.file_offset += apdu_comm.data.len;
 		t4t_hl.transaction_type = NFC_T4T_HL_NDEF_UPDATE;
@@ -404,22 +474,42 @@ int nfc_t4t_hl_procedure_ndef_read(struct nfc_t4t_cc_file *cc,
 				   uint16_t ndef_len)
 {
 	struct nfc_t4t_apdu_comm apdu_comm;
+	struct nfc_t4t_tlv_block *tlv_block;
 
 	t4t_hl.file_offset = 0;
 
-	if (!cc || !ndef_buff || !ndef_len) {
+	if (!cc || !hl_cb) {
 		return -EINVAL;
 	}
 
+	/* Without a buffer, the NDEF file is only passed to the chunk
+	 * callback.
+	 */
+	if (ndef_buff ? !ndef_len : !hl_cb->ndef_chunk_read) {
+		return -EINVAL;
+	}
+
+	t4t_hl.ndef.buff = ndef_buff;
+	t4t_hl.ndef.buff_size = ndef_len;
+	t4t_hl.ndef.cc = cc;
+
 	nfc_t4t_apdu_comm_clear(&apdu_comm);
 
 	apdu_comm.instruction = NFC_T4T_APDU_COMM_INS_READ;
 	apdu_comm.parameter = 0;
-	apdu_comm.resp_len = NDEF_FILE_NLEN_SIZE;
 
-	t4t_hl.ndef.buff = ndef_buff;
-	t4t_hl.ndef.buff_size = ndef_len;
-	t4t_hl.ndef.cc = cc;
+	/* Read the first part of the NDEF message together with the NLEN
+	 * field, as far as the NDEF file size allows it.
+	 */
+	tlv_block = nfc_t4t_cc_file_content_get(cc,
+						sys_get_be16(t4t_hl.ndef.file_id));
+	if (tlv_block) {
+		apdu_comm.resp_len =
+			ndef_file_read_len(tlv_block->value.max_file_size);
+	} else {
+		apdu_comm.resp_len = NDEF_FILE_NLEN_SIZE;
+	}
+
 	t4t_hl.transaction_type = NFC_T4T_HL_NDEF_NLEN_READ;
 
 	return t4t_hl_data_exchange(&apdu_comm);
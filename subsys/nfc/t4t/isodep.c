@@ -9,6 +9,7 @@
 #include <kernel.h>
 #include <zephyr/types.h>
 #include <sys/atomic.h>
+#include <sys/util.h>
 #include <nfc/t4t/isodep.h>
 #include <logging/log.h>
 
@@ -203,14 +204,19 @@ static int ats_parse(const uint8_t *data, size_t len)
 
 	fsci = t0 & T4T_ATS_T0_FSCI_MASK;
 
-	/* FSC is mapped from FSCI in the same way like FSD.
+	/* FSC is mapped from FSCI in the same way like FSD. RFU values are
+	 * interpreted as the largest defined one.
 	 * NFC Forum Digital Specification 2.0 14.6.2.
 	 */
+	fsci = MIN(fsci, NFC_T4T_ISODEP_FSD_256);
 	t4t_isodep.tag.fsc = fsd_value_map[fsci];
 
 	/* Include space for CRC */
 	t4t_isodep.tag.fsc -= ISODEP_CRC_LENGTH;
 
+	/* Frames sent to the Listener are also limited by the Tx buffer. */
+	t4t_isodep.tag.fsc = MIN(t4t_isodep.tag.fsc, t4t_isodep.tx_data.buf_size);
+
 	/* Check id ATS contains interface bytes, if not
 	 * set all data to default values according to
 	 * NFC Forum Digital Specification 2.0 14.6.2.
@@ -709,26 +715,32 @@ int nfc_t4t_isodep_rats_send(enum nfc_t4t_isodep_fsd fsd, uint8_t did)
 {
 	uint8_t param;
 
-	if (atomic_cas(&t4t_isodep.state, ISODEP_STATE_INITIALIZED,
-		       ISODEP_STATE_TRANSFER)) {
-	} else if (atomic_cas(&t4t_isodep.state, ISODEP_STATE_SELECTED,
-			      ISODEP_STATE_TRANSFER)) {
-	} else {
-		return -EACCES;
-	}
-
 	if (did > T4T_DID_MAX) {
 		LOG_ERR("Invalid DID value. It should be between 0-14.");
 
 		return -EINVAL;
 	}
 
+	if (fsd >= ARRAY_SIZE(fsd_value_map)) {
+		LOG_ERR("Invalid FSD value.");
+
+		return -EINVAL;
+	}
+
 	if (t4t_isodep.tx_data.buf_size < fsd_value_map[fsd]) {
 		LOG_ERR("Invalid FSD value. Increase Tx buffer size or decrease FSD");
 
 		return -ENOMEM;
 	}
 
+	if (atomic_cas(&t4t_isodep.state, ISODEP_STATE_INITIALIZED,
+		       ISODEP_STATE_TRANSFER)) {
+	} else if (atomic_cas(&t4t_isodep.state, ISODEP_STATE_SELECTED,
+			      ISODEP_STATE_TRANSFER)) {
+	} else {
+		return -EACCES;
+	}
+
 	/* Set DID field. */
 	param = did & T4T_RATS_DID_MASK;
 
@@ -757,6 +769,23 @@ int nfc_t4t_isodep_rats_send(enum nfc_t4t_isodep_fsd fsd, uint8_t did)
 	return 0;
 }
 
+enum nfc_t4t_isodep_fsd nfc_t4t_isodep_fsd_max_get(void)
+{
+	size_t buf_size = MIN(t4t_isodep.tx_data.buf_size,
+			      t4t_isodep.rx_data.buf_size);
+	enum nfc_t4t_isodep_fsd fsd = NFC_T4T_ISODEP_FSD_256;
+
+	/* The buffers are at least T4T_FSD_MIN bytes long, so the search ends
+	 * at NFC_T4T_ISODEP_FSD_16 at the latest.
+	 */
+	while ((fsd > NFC_T4T_ISODEP_FSD_16) &&
+	       (fsd_value_map[fsd] > buf_size)) {
+		fsd--;
+	}
+
+	return fsd;
+}
+
 int nfc_t4t_isodep_tag_deselect(void)
 {
 	size_t index = 0;
@@ -842,6 +871,7 @@ int nfc_t4t_isodep_data_received(const uint8_t *data, size_t data_len,
 
 int nfc_t4t_isodep_transmit(const uint8_t *data, size_t data_len)
 {
+	int err;
 	int64_t spent_time;
 	uint32_t delay;
 
@@ -875,7 +905,9 @@ int nfc_t4t_isodep_transmit(const uint8_t *data, size_t data_len)
 			LOG_DBG("Wait %d ms before sending first frame after ATS Response",
 				delay);
 
-			return k_work_reschedule(&isodep_work, K_MSEC(delay));
+			err = k_work_reschedule(&isodep_work, K_MSEC(delay));
+
+			return (err < 0) ? err : 0;
 		}
 	}
 
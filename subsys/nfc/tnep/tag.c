@@ -70,6 +70,7 @@ struct tnep_tag {
 	nfc_payload_set_t data_set;
 	initial_msg_encode_t initial_msg_encode;
 	uint8_t *current_buff;
+	uint8_t *app_buff;
 };
 
 static struct tnep_control tnep_ctrl;
@@ -106,51 +107,87 @@ static void tnep_tx_msg_clear(struct nfc_ndef_msg_desc *msg)
 	nfc_ndef_msg_clear(msg);
 }
 
-static int tnep_tx_msg_encode(struct nfc_ndef_msg_desc *msg)
+static uint8_t *tnep_tx_buf_next(void)
 {
-	int err = 0;
-	unsigned int key;
-	size_t len;
-	uint8_t *data;
-
+	return (tnep.current_buff == tnep.tx.data) ?
+	       tnep.tx.swap_data : tnep.tx.data;
+}
 
-	if (tnep.current_buff == tnep.tx.data) {
-		tnep.current_buff = tnep.tx.swap_data;
-	} else {
-		tnep.current_buff = tnep.tx.data;
+/* Get the part of the TX buffer that holds the NDEF message. */
+static uint8_t *tnep_tx_msg_area_get(uint8_t *buf, size_t *size)
+{
+	if (IS_ENABLED(CONFIG_NFC_T4T_NRFXLIB)) {
+		*size = nfc_t4t_ndef_file_msg_size_get(tnep.tx.len);
+		return nfc_t4t_ndef_file_msg_get(buf);
 	}
 
-	memset(tnep.current_buff, 0, tnep.tx.len);
+	*size = tnep.tx.len;
 
-	len = tnep.tx.len;
-	data = tnep.current_buff;
-
-	if (IS_ENABLED(CONFIG_NFC_T4T_NRFXLIB)) {
-		len = nfc_t4t_ndef_file_msg_size_get(len);
-		data = nfc_t4t_ndef_file_msg_get(data);
-	}
+	return buf;
+}
 
-	if (msg && (msg->record_count > 0)) {
-		err = nfc_ndef_msg_encode(msg,
-					  data,
-					  &len);
-	}
+/* Provide the next TX buffer, which holds an encoded NDEF message
+ * of the given length, to the NFC Tag.
+ */
+static void tnep_tx_buf_swap(uint32_t len)
+{
+	unsigned int key;
+	uint8_t *buf = tnep_tx_buf_next();
 
 	if (IS_ENABLED(CONFIG_NFC_T4T_NRFXLIB)) {
-		nfc_t4t_ndef_file_encode(tnep.current_buff, &len);
+		nfc_t4t_ndef_file_encode(buf, &len);
+	} else {
+		/* Without the NLEN field, the stale end of the previous
+		 * message must be cleared.
+		 */
+		memset(buf + len, 0, tnep.tx.len - len);
 	}
 
 	key = irq_lock();
 
 	__ASSERT_NO_MSG(tnep.data_set);
 
-	tnep.data_set(tnep.current_buff, tnep.tx.len);
+	tnep.current_buff = buf;
+	tnep.data_set(buf, tnep.tx.len);
 
 	irq_unlock(key);
+}
+
+static int tnep_tx_msg_encode(struct nfc_ndef_msg_desc *msg)
+{
+	int err = 0;
+	size_t size;
+	uint32_t len = 0;
+	uint8_t *data;
+
+	/* The application may still be encoding into the next TX buffer. */
+	if (tnep.app_buff) {
+		LOG_ERR("TX buffer taken by the application");
+		return -EBUSY;
+	}
+
+	data = tnep_tx_msg_area_get(tnep_tx_buf_next(), &size);
+
+	/* The message is encoded straight into the next TX buffer. */
+	if (msg && (msg->record_count > 0)) {
+		len = size;
+		err = nfc_ndef_msg_encode(msg, data, &len);
+		if (err) {
+			len = 0;
+		}
+	}
+
+	tnep_tx_buf_swap(len);
 
 	return err;
 }
 
+static int tnep_status_rec_size_get(uint32_t *len)
+{
+	return nfc_ndef_record_encode(&NFC_NDEF_TNEP_RECORD_DESC(status_record),
+				      NDEF_FIRST_RECORD, NULL, len);
+}
+
 static int tnep_tx_msg_add_rec(struct nfc_ndef_msg_desc *msg,
 			       const struct nfc_ndef_record_desc *record)
 {
@@ -265,22 +302,23 @@ static int tnep_svc_select_from_msg(void)
 						      NFC_NDEF_TNEP_REC_TYPE_LEN);
 
 		if (select_rec) {
-			/* Set service from record as active (or deselect) */
-			uint8_t bin_rec[CONFIG_NFC_TNEP_RX_MAX_RECORD_SIZE];
-			uint32_t bin_rec_len = sizeof(bin_rec);
-			struct nfc_ndef_tnep_rec_svc_select service;
+			/* Set service from record as active (or deselect).
+			 * The parsed payload points into the received message.
+			 */
+			const struct nfc_ndef_bin_payload_desc *payload =
+				msg_p->record[i]->payload_descriptor;
+			uint8_t uri_len = 0;
 
-			memset(bin_rec, 0x00, bin_rec_len);
+			if (payload->payload_length > 0) {
+				uri_len = payload->payload[0];
 
-			msg_p->record[i]->payload_constructor(
-					msg_p->record[i]->payload_descriptor,
-					bin_rec, &bin_rec_len);
+				if (uri_len >= payload->payload_length) {
+					return -EINVAL;
+				}
+			}
 
-			service.uri_len = bin_rec[0];
-			service.uri = &bin_rec[1];
-
-			svc_status = tnep_svc_set_active(service.uri,
-							 service.uri_len);
+			svc_status = tnep_svc_set_active(&payload->payload[1],
+							 uri_len);
 
 			break;
 		}
@@ -543,6 +581,7 @@ int nfc_tnep_tag_init(struct k_poll_event *events, uint8_t event_cnt,
 
 	tnep_ctrl.events = events;
 	tnep.current_buff = tnep.tx.data;
+	tnep.app_buff = NULL;
 	tnep.data_set = payload_set;
 	tnep.svc_cnt = _nfc_tnep_tag_service_list_end -
 		       _nfc_tnep_tag_service_list_start;
@@ -672,6 +711,9 @@ int nfc_tnep_tag_tx_msg_app_data(struct nfc_ndef_msg_desc *msg,
 		return -EACCES;
 	}
 
+	/* A TX buffer taken by the application is not used anymore. */
+	tnep.app_buff = NULL;
+
 	return tnep_new_app_msg_prepare(msg, status);
 }
 
@@ -694,6 +736,9 @@ int nfc_tnep_tag_tx_msg_no_app_data(void)
 		return -EACCES;
 	}
 
+	/* A TX buffer taken by the application is not used anymore. */
+	tnep.app_buff = NULL;
+
 	tnep_tx_msg_clear(&NFC_NDEF_MSG(app_msg));
 
 	err = tnep_tx_msg_add_rec_status(&NFC_NDEF_MSG(app_msg),
@@ -705,6 +750,114 @@ int nfc_tnep_tag_tx_msg_no_app_data(void)
 	return tnep_tx_msg_encode(&NFC_NDEF_MSG(app_msg));
 }
 
+int nfc_tnep_tag_tx_msg_buffer_get(uint8_t **data, size_t *size)
+{
+	int err;
+	uint8_t *msg;
+	size_t msg_size;
+	uint32_t status_len;
+
+	if (!data || !size) {
+		return -EINVAL;
+	}
+
+	/* Check the state of TNEP service. */
+	if (!atomic_cas(&current_state, TNEP_STATE_SERVICE_SELECTED,
+			TNEP_STATE_SERVICE_SELECTED)) {
+		LOG_ERR("Invalid state. App data can be provided only in service selected state");
+		return -EACCES;
+	}
+
+	if (!atomic_cas(&tnep.app_data_expected, TNEP_APP_DATA_EXPECTED,
+			TNEP_APP_DATA_EXPECTED)) {
+		LOG_ERR("TNEP App data already set.");
+		return -EACCES;
+	}
+
+	err = tnep_status_rec_size_get(&status_len);
+	if (err) {
+		return err;
+	}
+
+	tnep.app_buff = tnep_tx_buf_next();
+	msg = tnep_tx_msg_area_get(tnep.app_buff, &msg_size);
+
+	/* The TNEP status record is encoded in front of the application
+	 * records.
+	 */
+	*data = msg + status_len;
+	*size = msg_size - status_len;
+
+	return 0;
+}
+
+int nfc_tnep_tag_tx_msg_buffer_swap(size_t len,
+				    enum nfc_tnep_status_value status)
+{
+	int err;
+	uint8_t *msg;
+	size_t msg_size;
+	uint32_t status_len;
+
+	/* Check the state of TNEP service. */
+	if (!atomic_cas(&current_state, TNEP_STATE_SERVICE_SELECTED,
+			TNEP_STATE_SERVICE_SELECTED)) {
+		LOG_ERR("Invalid state. App data can be provided only in service selected state");
+		tnep.app_buff = NULL;
+		return -EACCES;
+	}
+
+	if (!atomic_cas(&tnep.app_data_expected, TNEP_APP_DATA_EXPECTED,
+			TNEP_APP_DATA_EXPECTED)) {
+		LOG_ERR("TNEP App data already set.");
+		tnep.app_buff = NULL;
+		return -EACCES;
+	}
+
+	if (!tnep.app_buff) {
+		LOG_ERR("TX buffer not taken");
+		return -EAGAIN;
+	}
+
+	err = tnep_status_rec_size_get(&status_len);
+	if (err) {
+		return err;
+	}
+
+	msg = tnep_tx_msg_area_get(tnep.app_buff, &msg_size);
+
+	if (len > (msg_size - status_len)) {
+		return -ENOMEM;
+	}
+
+	if (!atomic_cas(&tnep.app_data_expected, TNEP_APP_DATA_EXPECTED,
+			TNEP_APP_DATA_UNEXPECTED)) {
+		LOG_ERR("TNEP App data already set.");
+		tnep.app_buff = NULL;
+		return -EACCES;
+	}
+
+	status_record.status = status;
+
+	err = nfc_ndef_record_encode(&NFC_NDEF_TNEP_RECORD_DESC(status_record),
+				     len ? NDEF_FIRST_RECORD : NDEF_LONE_RECORD,
+				     msg, &status_len);
+	if (err) {
+		tnep.app_buff = NULL;
+		return err;
+	}
+
+	/* The first application record no longer begins the message. */
+	if (len) {
+		msg[status_len] &= ~NDEF_RECORD_MB_MASK;
+	}
+
+	tnep.app_buff = NULL;
+	tnep_tx_buf_swap(status_len + len);
+
+	return 0;
+}
+
 void nfc_tnep_tag_on_selected(void)
 {
 	k_poll_signal_raise(&tnep_ctrl.msg_tx, TNEP_EVENT_TAG_SELECTED);
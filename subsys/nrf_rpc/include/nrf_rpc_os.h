@@ -34,6 +34,24 @@ struct nrf_rpc_os_msg {
 
 typedef void (*nrf_rpc_os_work_t)(const uint8_t *data, size_t len);
 
+#if defined(CONFIG_NRF_RPC_OS_STATS)
+/* Thread pool statistics. */
+struct nrf_rpc_os_stats {
+	/* Number of packets passed to the thread pool. */
+	uint32_t packets;
+	/* Number of packets that found their queue full and had to wait. */
+	uint32_t overflows;
+	/* Maximum number of packets waiting in all the queues. */
+	uint32_t queue_depth_max;
+	/* Average time in microseconds that a packet waited for a thread. */
+	uint32_t latency_avg_us;
+	/* Maximum time in microseconds that a packet waited for a thread. */
+	uint32_t latency_max_us;
+};
+
+void nrf_rpc_os_stats_get(struct nrf_rpc_os_stats *stats);
+#endif /* defined(CONFIG_NRF_RPC_OS_STATS) */
+
 int nrf_rpc_os_init(nrf_rpc_os_work_t callback);
 
 void nrf_rpc_os_thread_pool_send(const uint8_t *data, size_t len);
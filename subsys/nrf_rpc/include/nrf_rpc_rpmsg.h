@@ -24,12 +24,31 @@ extern "C" {
 #endif
 
 #define NRF_RPC_TR_MAX_HEADER_SIZE 0
-#define NRF_RPC_TR_AUTO_FREE_RX_BUF 1
 
 typedef void (*nrf_rpc_tr_receive_handler_t)(const uint8_t *packet, size_t len);
 
 int nrf_rpc_tr_init(nrf_rpc_tr_receive_handler_t callback);
 
+#if defined(CONFIG_NRF_RPC_TR_RPMSG_NOCOPY)
+
+/* Packets are encoded directly in the RPMsg shared memory buffers and
+ * received packets are held by the transport until nRF RPC releases them.
+ */
+#define NRF_RPC_TR_AUTO_FREE_RX_BUF 0
+
+void nrf_rpc_tr_free_rx_buf(const uint8_t *buf);
+
+uint8_t *nrf_rpc_tr_rpmsg_alloc_tx_buf(size_t len);
+
+#define nrf_rpc_tr_alloc_tx_buf(buf, len)				       \
+	*(buf) = nrf_rpc_tr_rpmsg_alloc_tx_buf(len)
+
+void nrf_rpc_tr_free_tx_buf(uint8_t *buf);
+
+#else
+
+#define NRF_RPC_TR_AUTO_FREE_RX_BUF 1
+
 static inline void nrf_rpc_tr_free_rx_buf(const uint8_t *buf)
 {
 }
@@ -41,6 +60,8 @@ static inline void nrf_rpc_tr_free_rx_buf(const uint8_t *buf)
 
 #define nrf_rpc_tr_free_tx_buf(buf)
 
+#endif /* defined(CONFIG_NRF_RPC_TR_RPMSG_NOCOPY) */
+
 int nrf_rpc_tr_send(uint8_t *buf, size_t len);
 
 #ifdef __cplusplus
@@ -12,6 +12,11 @@
 /* Maximum number of remote thread that this implementation allows. */
 #define MAX_REMOTE_THREADS 255
 
+/* Offset of the group ID in the nRF RPC packet header. */
+#define PACKET_GROUP_ID_OFFSET 4
+
+#define POOL_QUEUE_COUNT CONFIG_NRF_RPC_THREAD_POOL_GROUP_QUEUES
+
 /* Initial value contains ones (context free) on the
  * CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE most significant bits.
  */
@@ -22,12 +27,26 @@
 struct pool_start_msg {
 	const uint8_t *data;
 	size_t len;
+#if defined(CONFIG_NRF_RPC_OS_STATS)
+	uint32_t timestamp;
+#endif
 };
 
 static nrf_rpc_os_work_t thread_pool_callback;
 
-static struct pool_start_msg pool_start_msg_buf[2];
-static struct k_msgq pool_start_msg;
+static struct pool_start_msg pool_start_msg_buf[POOL_QUEUE_COUNT]
+					       [CONFIG_NRF_RPC_THREAD_POOL_QUEUE_SIZE];
+static struct k_msgq pool_start_msg[POOL_QUEUE_COUNT];
+
+/* Number of packets in all the queues. */
+static struct k_sem pool_pending;
+
+#if defined(CONFIG_NRF_RPC_OS_STATS)
+static struct k_spinlock stats_lock;
+static struct nrf_rpc_os_stats stats;
+static uint64_t latency_total_us;
+static uint32_t served;
+#endif
 
 static struct k_sem context_reserved;
 static atomic_t context_mask;
@@ -49,12 +68,95 @@ BUILD_ASSERT(CONFIG_NRF_RPC_CMD_CTX_POOL_SIZE <= 8 * sizeof(atomic_val_t),
 BUILD_ASSERT(sizeof(uint32_t) == sizeof(atomic_val_t),
 	     "Only atomic_val_t is implemented that is the same as uint32_t");
 
+#if defined(CONFIG_NRF_RPC_OS_STATS)
+static void stats_queued(bool overflow)
+{
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+	uint32_t depth = k_sem_count_get(&pool_pending);
+
+	stats.packets++;
+	if (overflow) {
+		stats.overflows++;
+	}
+	stats.queue_depth_max = MAX(stats.queue_depth_max, depth);
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+static void stats_served(uint32_t timestamp)
+{
+	uint32_t latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - timestamp);
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	served++;
+	latency_total_us += latency_us;
+	stats.latency_max_us = MAX(stats.latency_max_us, latency_us);
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+void nrf_rpc_os_stats_get(struct nrf_rpc_os_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	*out = stats;
+	if (served > 0) {
+		out->latency_avg_us = latency_total_us / served;
+	}
+
+	k_spin_unlock(&stats_lock, key);
+}
+#endif /* defined(CONFIG_NRF_RPC_OS_STATS) */
+
+static uint32_t packet_queue(const uint8_t *data, size_t len)
+{
+	if (len <= PACKET_GROUP_ID_OFFSET) {
+		return 0;
+	}
+
+	return data[PACKET_GROUP_ID_OFFSET] % POOL_QUEUE_COUNT;
+}
+
+static void pool_msg_take(uint32_t home, struct pool_start_msg *msg)
+{
+	uint32_t i;
+
+	/* Each taken semaphore count stands for one packet in the queues,
+	 * and only a thread holding a count removes a packet, so one of
+	 * the queues has a packet for this thread.
+	 */
+	k_sem_take(&pool_pending, K_FOREVER);
+
+	if (k_msgq_get(&pool_start_msg[home], msg, K_NO_WAIT) == 0) {
+		return;
+	}
+
+	/* The own queue is empty. Steal from the other queues, starting
+	 * from the one with the highest priority.
+	 */
+	do {
+		for (i = 0; i < POOL_QUEUE_COUNT; i++) {
+			if (k_msgq_get(&pool_start_msg[i], msg,
+				       K_NO_WAIT) == 0) {
+				return;
+			}
+		}
+	} while (1);
+}
+
 static void thread_pool_entry(void *p1, void *p2, void *p3)
 {
+	uint32_t home = (uint32_t)(uintptr_t)p1;
 	struct pool_start_msg msg;
 
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
 	do {
-		k_msgq_get(&pool_start_msg, &msg, K_FOREVER);
+		pool_msg_take(home, &msg);
+#if defined(CONFIG_NRF_RPC_OS_STATS)
+		stats_served(msg.timestamp);
+#endif
 		thread_pool_callback(msg.data, msg.len);
 	} while (1);
 }
@@ -82,15 +184,22 @@ int nrf_rpc_os_init(nrf_rpc_os_work_t callback)
 
 	atomic_set(&context_mask, CONTEXT_MASK_INIT_VALUE);
 
-	k_msgq_init(&pool_start_msg, (char *)pool_start_msg_buf,
-		    sizeof(struct pool_start_msg),
-		    ARRAY_SIZE(pool_start_msg_buf));
+	err = k_sem_init(&pool_pending, 0, K_SEM_MAX_LIMIT);
+	if (err < 0) {
+		return err;
+	}
+
+	for (i = 0; i < POOL_QUEUE_COUNT; i++) {
+		k_msgq_init(&pool_start_msg[i], (char *)pool_start_msg_buf[i],
+			    sizeof(struct pool_start_msg),
+			    ARRAY_SIZE(pool_start_msg_buf[i]));
+	}
 
 	for (i = 0; i < CONFIG_NRF_RPC_THREAD_POOL_SIZE; i++) {
 		k_thread_create(&pool_threads[i], pool_stacks[i],
 			K_THREAD_STACK_SIZEOF(pool_stacks[i]),
 			thread_pool_entry,
-			NULL, NULL, NULL,
+			(void *)(uintptr_t)(i % POOL_QUEUE_COUNT), NULL, NULL,
 			CONFIG_NRF_RPC_THREAD_PRIORITY, 0, K_NO_WAIT);
 	}
 
@@ -100,10 +209,34 @@ int nrf_rpc_os_init(nrf_rpc_os_work_t callback)
 void nrf_rpc_os_thread_pool_send(const uint8_t *data, size_t len)
 {
 	struct pool_start_msg msg;
+	uint32_t queue = packet_queue(data, len);
+	bool overflow = false;
 
 	msg.data = data;
 	msg.len = len;
-	k_msgq_put(&pool_start_msg, &msg, K_FOREVER);
+#if defined(CONFIG_NRF_RPC_OS_STATS)
+	msg.timestamp = k_cycle_get_32();
+#endif
+
+	/* The remote side reserves one of the local pool threads for each
+	 * new command or event, so the queue is full only if the remote
+	 * side breaks the protocol. The packet is kept and the transport
+	 * waits for a free entry, which stops it from taking more packets
+	 * from the remote side.
+	 */
+	if (k_msgq_put(&pool_start_msg[queue], &msg, K_NO_WAIT) != 0) {
+		NRF_RPC_WRN("Thread pool queue %u full, waiting", queue);
+		overflow = true;
+		k_msgq_put(&pool_start_msg[queue], &msg, K_FOREVER);
+	}
+
+	k_sem_give(&pool_pending);
+
+#if defined(CONFIG_NRF_RPC_OS_STATS)
+	stats_queued(overflow);
+#else
+	ARG_UNUSED(overflow);
+#endif
 }
 
 void nrf_rpc_os_msg_set(struct nrf_rpc_os_msg *msg, const uint8_t *data,
@@ -48,6 +48,13 @@ static nrf_rpc_tr_receive_handler_t receive_callback;
 static int endpoint_id;
 static bool is_handshake_done;
 
+#if defined(CONFIG_NRF_RPC_TR_RPMSG_NOCOPY)
+/* Endpoint used for the zero-copy operations. It is taken from the first
+ * endpoint callback, which always comes before the handshake is done.
+ */
+static struct rpmsg_endpoint *endpoint;
+#endif
+
 /* Translates RPMsg error code to nRF RPC error code. */
 static int translate_error(int rpmsg_err)
 {
@@ -92,6 +99,10 @@ static void event_handler(enum nrf_rpc_event_type event,
 static int endpoint_cb(struct rpmsg_endpoint *ept, void *data, size_t len,
 	uint32_t src, void *priv)
 {
+#if defined(CONFIG_NRF_RPC_TR_RPMSG_NOCOPY)
+	endpoint = ept;
+#endif
+
 	if (len == 0) {
 		if (!is_handshake_done) {
 			if (!IS_ENABLED(CONFIG_RPMSG_SERVICE_MODE_MASTER)) {
@@ -105,6 +116,11 @@ static int endpoint_cb(struct rpmsg_endpoint *ept, void *data, size_t len,
 		return RPMSG_SUCCESS;
 	}
 
+#if defined(CONFIG_NRF_RPC_TR_RPMSG_NOCOPY)
+	/* The buffer is released by nRF RPC when the packet is decoded. */
+	rpmsg_hold_rx_buffer(ept, data);
+#endif
+
 	event_handler(NRF_RPC_EVENT_DATA, data, len);
 
 	return RPMSG_SUCCESS;
@@ -152,6 +168,49 @@ int nrf_rpc_tr_init(nrf_rpc_tr_receive_handler_t callback)
 	return 0;
 }
 
+#if defined(CONFIG_NRF_RPC_TR_RPMSG_NOCOPY)
+
+void nrf_rpc_tr_free_rx_buf(const uint8_t *buf)
+{
+	NRF_RPC_ASSERT(buf != NULL);
+
+	rpmsg_release_rx_buffer(endpoint, (void *)buf);
+}
+
+uint8_t *nrf_rpc_tr_rpmsg_alloc_tx_buf(size_t len)
+{
+	uint32_t size;
+	void *buf;
+
+	NRF_RPC_ASSERT(endpoint != NULL);
+
+	buf = rpmsg_get_tx_payload_buffer(endpoint, &size, true);
+	if (buf == NULL) {
+		NRF_RPC_ERR("No RPMsg TX buffer");
+		k_oops();
+	}
+
+	if (size < len) {
+		/* Packets bigger than an RPMsg buffer cannot be sent by
+		 * the copying transport either.
+		 */
+		NRF_RPC_ERR("Packet of %u bytes exceeds RPMsg buffer of %u",
+			    len, size);
+		k_oops();
+	}
+
+	return buf;
+}
+
+void nrf_rpc_tr_free_tx_buf(uint8_t *buf)
+{
+	NRF_RPC_ASSERT(buf != NULL);
+
+	rpmsg_release_tx_buffer(endpoint, buf);
+}
+
+#endif /* defined(CONFIG_NRF_RPC_TR_RPMSG_NOCOPY) */
+
 int nrf_rpc_tr_send(uint8_t *buf, size_t len)
 {
 	int err;
@@ -160,7 +219,15 @@ int nrf_rpc_tr_send(uint8_t *buf, size_t len)
 	NRF_RPC_DBG("Send %u bytes.", len);
 	DUMP_LIMITED_DBG(buf, len, "Data:");
 
+#if defined(CONFIG_NRF_RPC_TR_RPMSG_NOCOPY)
+	err = rpmsg_send_nocopy(endpoint, buf, len);
+	if (err < 0) {
+		/* nRF RPC does not use the buffer after the send. */
+		rpmsg_release_tx_buffer(endpoint, buf);
+	}
+#else
 	err = rpmsg_service_send(endpoint_id, buf, len);
+#endif
 	if (err > 0) {
 		err = 0;
 	}
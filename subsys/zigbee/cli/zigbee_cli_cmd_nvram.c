@@ -4,10 +4,12 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <string.h>
 #include <shell/shell.h>
 
 #include <zboss_api.h>
 #include <zb_nrf_platform.h>
+#include <zb_nrf_nvram_cache.h>
 #include "zigbee_cli.h"
 
 
@@ -70,6 +72,42 @@ static int cmd_zb_nvram_disable(const struct shell *shell, size_t argc, char **a
 	return 0;
 }
 
+#if defined(CONFIG_ZIGBEE_NVRAM_CACHE)
+/**@brief Print the Zigbee NVRAM cache statistics
+ *
+ * @code
+ * nvram stats [reset]
+ * @endcode
+ *
+ */
+static int cmd_zb_nvram_stats(const struct shell *shell, size_t argc, char **argv)
+{
+	struct zb_nvram_cache_stats stats;
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "reset")) {
+			zb_cli_print_error(shell, "Invalid argument", ZB_FALSE);
+			return -EINVAL;
+		}
+
+		zb_nvram_cache_stats_reset();
+		zb_cli_print_done(shell, ZB_FALSE);
+		return 0;
+	}
+
+	zb_nvram_cache_stats_get(&stats);
+	shell_print(shell, "Reads: %u (%u hits)", stats.reads,
+		    stats.read_hits);
+	shell_print(shell, "Writes: %u (%u hits)", stats.writes,
+		    stats.write_hits);
+	shell_print(shell, "Flushes: %u (%u errors)", stats.flushes,
+		    stats.errors);
+	zb_cli_print_done(shell, ZB_FALSE);
+
+	return 0;
+}
+#endif
+
 zb_bool_t zb_cli_nvram_enabled(void)
 {
 	return nvram_enabled;
@@ -80,6 +118,10 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_nvram,
 		      cmd_zb_nvram_enable, 1, 0),
 	SHELL_CMD_ARG(disable, NULL, "Disable Zigbee NVRAM.",
 		      cmd_zb_nvram_disable, 1, 0),
+#if defined(CONFIG_ZIGBEE_NVRAM_CACHE)
+	SHELL_CMD_ARG(stats, NULL, "Print or reset the NVRAM cache statistics.",
+		      cmd_zb_nvram_stats, 1, 1),
+#endif
 	SHELL_SUBCMD_SET_END);
 
 SHELL_CMD_REGISTER(nvram, &sub_nvram, "Zigbee NVRAM manipulation.",
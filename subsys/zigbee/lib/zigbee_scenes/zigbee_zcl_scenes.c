@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/byteorder.h>
 #include <logging/log.h>
 #include <settings/settings.h>
 #include <zb_nrf_platform.h>
@@ -11,35 +14,79 @@
 
 LOG_MODULE_REGISTER(zigbee_zcl_scenes, CONFIG_ZIGBEE_SCENES_LOG_LEVEL);
 
-static zb_uint8_t scene_table_get_entry(zb_uint16_t group_id, zb_uint8_t scene_id);
-static void scene_table_remove_entries_by_group(zb_uint16_t group_id);
-static void scene_table_init(void);
+#define SCENE_TABLE_SIZE CONFIG_ZIGBEE_SCENE_TABLE_SIZE
 
-struct zb_zcl_scenes_fieldset_data_on_off {
-	zb_bool_t  has_on_off;
-	zb_uint8_t on_off;
+/* The index is kept at most half full, so that the probe sequences are short. */
+#define SCENE_INDEX_SIZE (2 * SCENE_TABLE_SIZE)
+#define SCENE_INDEX_FREE 0xFF
+
+/* Each scene is stored under "scenes/<group ID><scene ID>", in hex. */
+#define SCENE_NAME_LEN 6
+#define SCENE_KEY_LEN (sizeof("scenes/") - 1 + SCENE_NAME_LEN)
+
+/* Stored scene: transition time, attribute mask and the stored attribute values. */
+#define SCENE_RECORD_HDR_LEN 3
+
+BUILD_ASSERT(SCENE_TABLE_SIZE < SCENE_INDEX_FREE,
+	     "Scene table entries must be addressable by the index");
+
+struct scene_attr {
+	zb_uint16_t cluster_id;
+	zb_uint16_t attr_id;
+	/* Position of the attribute value in the cluster's extension field set. */
+	zb_uint8_t offset;
 };
 
-struct zb_zcl_scenes_fieldset_data_level_control {
-	zb_bool_t  has_current_level;
-	zb_uint8_t current_level;
+/* Attributes that can be stored in a scene. The attributes of each cluster are
+ * listed together, in the order of the cluster's extension field set.
+ */
+static const struct scene_attr scene_attrs[] = {
+	{ ZB_ZCL_CLUSTER_ID_ON_OFF, ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, 0 },
+	{ ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL, ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID, 0 },
+	{ ZB_ZCL_CLUSTER_ID_WINDOW_COVERING,
+	  ZB_ZCL_ATTR_WINDOW_COVERING_CURRENT_POSITION_LIFT_PERCENTAGE_ID, 0 },
+	{ ZB_ZCL_CLUSTER_ID_WINDOW_COVERING,
+	  ZB_ZCL_ATTR_WINDOW_COVERING_CURRENT_POSITION_TILT_PERCENTAGE_ID, 1 },
 };
 
-struct zb_zcl_scenes_fieldset_data_window_covering {
-	zb_bool_t  has_current_position_lift_percentage;
-	zb_uint8_t current_position_lift_percentage;
-	zb_bool_t  has_current_position_tilt_percentage;
-	zb_uint8_t current_position_tilt_percentage;
+#define SCENE_ATTR_COUNT ARRAY_SIZE(scene_attrs)
+#define SCENE_RECORD_MAX_LEN (SCENE_RECORD_HDR_LEN + SCENE_ATTR_COUNT)
+
+BUILD_ASSERT(SCENE_ATTR_COUNT <= 8, "Scene attributes must fit in the attribute mask");
+
+struct scene_table_entry {
+	zb_zcl_scene_table_record_fixed_t common;
+	/* Bit mask of the scene_attrs entries stored in the scene. */
+	zb_uint8_t attr_mask;
+	zb_uint8_t attr_val[SCENE_ATTR_COUNT];
 };
 
-struct scene_table_on_off_entry {
-	zb_zcl_scene_table_record_fixed_t                  common;
-	struct zb_zcl_scenes_fieldset_data_on_off          on_off;
-	struct zb_zcl_scenes_fieldset_data_level_control   level_control;
-	struct zb_zcl_scenes_fieldset_data_window_covering window_covering;
+/* Scene table entry of the legacy format, where the whole table was stored in
+ * a single "scenes/scenes_table" entry. The attributes are in the order of
+ * the first entries of scene_attrs.
+ */
+struct legacy_scene_entry {
+	zb_zcl_scene_table_record_fixed_t common;
+	struct {
+		zb_bool_t present;
+		zb_uint8_t value;
+	} attrs[4];
 };
 
-static struct scene_table_on_off_entry scenes_table[CONFIG_ZIGBEE_SCENE_TABLE_SIZE];
+/* Largest scene table that could be stored in the legacy format. */
+#define LEGACY_TABLE_SIZE_MAX 30
+
+BUILD_ASSERT(ARRAY_SIZE(((struct legacy_scene_entry *)0)->attrs) <= SCENE_ATTR_COUNT,
+	     "Legacy scene attributes must be in the scene attribute table");
+
+/* The used entries are kept at the start of the table. */
+static struct scene_table_entry scenes_table[SCENE_TABLE_SIZE];
+static zb_uint8_t scenes_count;
+
+/* Open addressing index of scenes_table, by group and scene ID. */
+static zb_uint8_t scenes_index[SCENE_INDEX_SIZE];
+
+static bool legacy_table_found;
 
 struct response_info {
 	zb_zcl_parsed_hdr_t cmd_info;
@@ -49,324 +96,472 @@ struct response_info {
 
 static struct response_info resp_info;
 
-static int scenes_table_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+static zb_uint16_t scene_hash(zb_uint16_t group_id, zb_uint8_t scene_id)
 {
-	const char *next;
-	int rc;
+	/* Multiplicative hashing spreads the consecutive IDs used by most
+	 * installations over the whole index.
+	 */
+	uint32_t key = ((uint32_t)group_id << 8) | scene_id;
 
-	if (settings_name_steq(name, "scenes_table", &next) && !next) {
-		if (len != sizeof(scenes_table)) {
-			return -EINVAL;
+	return ((key * 2654435769U) >> 16) % SCENE_INDEX_SIZE;
+}
+
+/* Returns the index slot of the scene, or the free slot it would be added in. */
+static zb_uint16_t scene_index_find(zb_uint16_t group_id, zb_uint8_t scene_id)
+{
+	zb_uint16_t slot = scene_hash(group_id, scene_id);
+
+	while (scenes_index[slot] != SCENE_INDEX_FREE) {
+		const struct scene_table_entry *entry = &scenes_table[scenes_index[slot]];
+
+		if (entry->common.group_id == group_id &&
+		    entry->common.scene_id == scene_id) {
+			break;
 		}
 
-		rc = read_cb(cb_arg, scenes_table, sizeof(scenes_table));
-		if (rc >= 0) {
-			return 0;
+		slot = (slot + 1) % SCENE_INDEX_SIZE;
+	}
+
+	return slot;
+}
+
+static void scene_index_remove(zb_uint16_t slot)
+{
+	zb_uint16_t next = slot;
+
+	/* Move back the entries that would no longer be found past the freed
+	 * slot, so that no tombstones are needed.
+	 */
+	while (true) {
+		const struct scene_table_entry *entry;
+		zb_uint16_t home;
+
+		next = (next + 1) % SCENE_INDEX_SIZE;
+		if (scenes_index[next] == SCENE_INDEX_FREE) {
+			break;
 		}
 
-		return rc;
+		entry = &scenes_table[scenes_index[next]];
+		home = scene_hash(entry->common.group_id, entry->common.scene_id);
+
+		if ((slot < next) ? (home <= slot || home > next) :
+				    (home <= slot && home > next)) {
+			scenes_index[slot] = scenes_index[next];
+			slot = next;
+		}
 	}
 
-	return -ENOENT;
+	scenes_index[slot] = SCENE_INDEX_FREE;
 }
 
-static void scenes_table_save(void)
+static struct scene_table_entry *scene_table_find(zb_uint16_t group_id, zb_uint8_t scene_id)
 {
-	settings_save_one("scenes/scenes_table", scenes_table, sizeof(scenes_table));
+	zb_uint16_t slot = scene_index_find(group_id, scene_id);
+
+	if (scenes_index[slot] == SCENE_INDEX_FREE) {
+		return NULL;
+	}
+
+	return &scenes_table[scenes_index[slot]];
 }
 
-struct settings_handler scenes_conf = {
-	.name = "scenes",
-	.h_set = scenes_table_set
-};
+/* The scene must not be in the table yet. */
+static struct scene_table_entry *scene_table_add(zb_uint16_t group_id, zb_uint8_t scene_id)
+{
+	struct scene_table_entry *entry;
 
-static zb_bool_t has_cluster(zb_uint16_t cluster_id)
+	if (scenes_count == SCENE_TABLE_SIZE) {
+		return NULL;
+	}
+
+	entry = &scenes_table[scenes_count];
+	memset(entry, 0, sizeof(*entry));
+	entry->common.group_id = group_id;
+	entry->common.scene_id = scene_id;
+
+	scenes_index[scene_index_find(group_id, scene_id)] = scenes_count++;
+
+	return entry;
+}
+
+static void scene_table_remove(struct scene_table_entry *entry)
 {
-	return (get_endpoint_by_cluster(cluster_id, ZB_ZCL_CLUSTER_SERVER_ROLE)
-		== CONFIG_ZIGBEE_SCENES_ENDPOINT)
-		? ZB_TRUE : ZB_FALSE;
+	zb_uint8_t idx = entry - scenes_table;
+	struct scene_table_entry *last;
+
+	LOG_INF("removing scene: entry idx %hd", idx);
+
+	scene_index_remove(scene_index_find(entry->common.group_id, entry->common.scene_id));
+
+	/* Keep the table compact by moving the last entry into the gap: */
+	if (idx != --scenes_count) {
+		last = &scenes_table[scenes_count];
+		*entry = *last;
+		scenes_index[scene_index_find(entry->common.group_id,
+					      entry->common.scene_id)] = idx;
+	}
 }
 
-static zb_bool_t add_fieldset(zb_zcl_scenes_fieldset_common_t *fieldset,
-			      struct scene_table_on_off_entry *entry)
+static void scene_table_init(void)
+{
+	scenes_count = 0;
+	memset(scenes_index, SCENE_INDEX_FREE, sizeof(scenes_index));
+}
+
+static void scene_key_get(char *key, zb_uint16_t group_id, zb_uint8_t scene_id)
+{
+	snprintf(key, SCENE_KEY_LEN + 1, "scenes/%04x%02x", group_id, scene_id);
+}
+
+static int scene_save(const struct scene_table_entry *entry)
+{
+	char key[SCENE_KEY_LEN + 1];
+	zb_uint8_t record[SCENE_RECORD_MAX_LEN];
+	size_t len = SCENE_RECORD_HDR_LEN;
+	int err;
+
+	/* Only the attributes present in the scene are stored: */
+	sys_put_le16(entry->common.transition_time, &record[0]);
+	record[2] = entry->attr_mask;
+	for (size_t i = 0; i < SCENE_ATTR_COUNT; i++) {
+		if (entry->attr_mask & BIT(i)) {
+			record[len++] = entry->attr_val[i];
+		}
+	}
+
+	scene_key_get(key, entry->common.group_id, entry->common.scene_id);
+	err = settings_save_one(key, record, len);
+	if (err) {
+		LOG_ERR("Unable to store scene %s: %d", log_strdup(key), err);
+	}
+
+	return err;
+}
+
+/* Stores the changed scene. If that fails, the change is undone in the table,
+ * so that it matches the stored scenes: the previous content is restored, or
+ * the new scene is removed if prev is NULL.
+ */
+static zb_uint8_t scene_commit(struct scene_table_entry *entry,
+			       const struct scene_table_entry *prev)
 {
-	zb_uint8_t *fs_data_ptr;
+	if (!scene_save(entry)) {
+		return ZB_ZCL_STATUS_SUCCESS;
+	}
 
-	if (fieldset->cluster_id == ZB_ZCL_CLUSTER_ID_ON_OFF &&
-	    fieldset->fieldset_length >= 1 &&
-	    has_cluster(ZB_ZCL_CLUSTER_ID_ON_OFF)) {
-		fs_data_ptr = (zb_uint8_t *)fieldset + sizeof(zb_zcl_scenes_fieldset_common_t);
+	if (prev) {
+		*entry = *prev;
+	} else {
+		scene_table_remove(entry);
+	}
 
-		entry->on_off.has_on_off = ZB_TRUE;
-		entry->on_off.on_off = *fs_data_ptr;
+	return ZB_ZCL_STATUS_INSUFF_SPACE;
+}
 
-		LOG_INF("Add fieldset: cluster_id=0x%x, length=%d, on/off=%d",
-			fieldset->cluster_id, fieldset->fieldset_length, entry->on_off.on_off);
+static void scene_delete(const struct scene_table_entry *entry)
+{
+	char key[SCENE_KEY_LEN + 1];
+	int err;
 
-		return ZB_TRUE;
+	scene_key_get(key, entry->common.group_id, entry->common.scene_id);
+	err = settings_delete(key);
+	if (err) {
+		LOG_ERR("Unable to delete scene %s: %d", log_strdup(key), err);
 	}
-	if (fieldset->cluster_id == ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL &&
-	    fieldset->fieldset_length >= 1 &&
-	    has_cluster(ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL)) {
-		fs_data_ptr = (zb_uint8_t *)fieldset + sizeof(zb_zcl_scenes_fieldset_common_t);
+}
 
-		entry->level_control.has_current_level = ZB_TRUE;
-		entry->level_control.current_level = *fs_data_ptr;
+static void legacy_entry_convert(const struct legacy_scene_entry *legacy)
+{
+	struct scene_table_entry *entry;
 
-		LOG_INF("Add fieldset: cluster_id=0x%x, length=%d, level=%d",
-			fieldset->cluster_id,
-			fieldset->fieldset_length,
-			entry->level_control.current_level);
+	if (legacy->common.group_id == ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD) {
+		return;
+	}
 
-		return ZB_TRUE;
+	/* Scenes already stored in the new format take precedence: */
+	if (scene_table_find(legacy->common.group_id, legacy->common.scene_id)) {
+		return;
 	}
-	if (fieldset->cluster_id == ZB_ZCL_CLUSTER_ID_WINDOW_COVERING &&
-	    fieldset->fieldset_length >= 1 &&
-	    has_cluster(ZB_ZCL_CLUSTER_ID_WINDOW_COVERING)) {
-		fs_data_ptr = (zb_uint8_t *)fieldset + sizeof(zb_zcl_scenes_fieldset_common_t);
 
-		entry->window_covering.has_current_position_lift_percentage = ZB_TRUE;
-		entry->window_covering.current_position_lift_percentage = *fs_data_ptr;
+	entry = scene_table_add(legacy->common.group_id, legacy->common.scene_id);
+	if (!entry) {
+		LOG_WRN("No space for legacy scene 0x%x/%hd", legacy->common.group_id,
+			legacy->common.scene_id);
+		return;
+	}
 
-		if (fieldset->fieldset_length >= 2) {
-			entry->window_covering.has_current_position_tilt_percentage = ZB_TRUE;
-			entry->window_covering.current_position_tilt_percentage =
-				*(fs_data_ptr + 1);
+	entry->common = legacy->common;
+	for (size_t i = 0; i < ARRAY_SIZE(legacy->attrs); i++) {
+		if (legacy->attrs[i].present) {
+			entry->attr_mask |= BIT(i);
+			entry->attr_val[i] = legacy->attrs[i].value;
 		}
+	}
+}
+
+static int legacy_table_set(size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	struct legacy_scene_entry legacy[LEGACY_TABLE_SIZE_MAX];
+	int rc;
+
+	if (len % sizeof(legacy[0]) || len > sizeof(legacy)) {
+		LOG_WRN("Invalid legacy scene table (%u bytes)", (unsigned int)len);
+		return -EINVAL;
+	}
 
-		LOG_INF("Add fieldset: cluster_id=0x%x, length=%d, lift=%d",
-			fieldset->cluster_id, fieldset->fieldset_length,
-			entry->window_covering.current_position_lift_percentage);
+	rc = read_cb(cb_arg, legacy, len);
+	if (rc < 0) {
+		return rc;
+	}
 
-		return ZB_TRUE;
+	if (rc != len) {
+		return -EINVAL;
 	}
 
-	LOG_INF("Ignore fieldset: cluster_id = 0x%x, length = %d",
-		fieldset->cluster_id, fieldset->fieldset_length);
+	for (size_t i = 0; i < len / sizeof(legacy[0]); i++) {
+		legacy_entry_convert(&legacy[i]);
+	}
 
-	return ZB_FALSE;
+	LOG_INF("Converting scene table stored in the legacy format");
+	legacy_table_found = true;
+	return 0;
 }
 
-static zb_uint8_t *dump_fieldsets(struct scene_table_on_off_entry *entry,
-				  zb_uint8_t *payload_ptr)
+static int scenes_table_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
 {
-	if (entry->on_off.has_on_off == ZB_TRUE) {
-		LOG_INF("Append On/Off fieldset");
+	zb_uint8_t record[SCENE_RECORD_MAX_LEN];
+	struct scene_table_entry *entry;
+	zb_uint16_t group_id;
+	zb_uint8_t scene_id;
+	zb_uint8_t attr_mask;
+	size_t pos = SCENE_RECORD_HDR_LEN;
+	const char *next;
+	char *end;
+	unsigned long id;
+	int rc;
 
-		/* Extension set: Cluster ID = On/Off */
-		ZB_ZCL_PACKET_PUT_DATA16_VAL(payload_ptr, ZB_ZCL_CLUSTER_ID_ON_OFF);
+	if (settings_name_steq(name, "scenes_table", &next) && !next) {
+		return legacy_table_set(len, read_cb, cb_arg);
+	}
 
-		/* Extension set: Fieldset length = 1 */
-		ZB_ZCL_PACKET_PUT_DATA8(payload_ptr, 1);
+	if (settings_name_next(name, &next) != SCENE_NAME_LEN || next) {
+		return -ENOENT;
+	}
 
-		/* Extension set: On/Off state */
-		ZB_ZCL_PACKET_PUT_DATA8(payload_ptr, entry->on_off.on_off);
+	id = strtoul(name, &end, 16);
+	if (end != name + SCENE_NAME_LEN) {
+		return -ENOENT;
 	}
 
-	if (entry->level_control.has_current_level == ZB_TRUE) {
-		LOG_INF("Append level control fieldset");
+	group_id = id >> 8;
+	scene_id = id & 0xFF;
+
+	if (len < SCENE_RECORD_HDR_LEN || len > sizeof(record)) {
+		return -EINVAL;
+	}
 
-		/* Extension set: Cluster ID = Level Control */
-		ZB_ZCL_PACKET_PUT_DATA16_VAL(payload_ptr, ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL);
+	rc = read_cb(cb_arg, record, len);
+	if (rc < 0) {
+		return rc;
+	}
 
-		/* Extension set: Fieldset length = 1 */
-		ZB_ZCL_PACKET_PUT_DATA8(payload_ptr, 1);
+	if (rc != len) {
+		return -EINVAL;
+	}
 
-		/* Extension set: current_level state */
-		ZB_ZCL_PACKET_PUT_DATA8(payload_ptr, entry->level_control.current_level);
+	attr_mask = record[2];
+	if (attr_mask & ~BIT_MASK(SCENE_ATTR_COUNT)) {
+		return -EINVAL;
 	}
 
-	if (entry->window_covering.has_current_position_lift_percentage == ZB_TRUE) {
-		LOG_INF("Append window covering fieldset");
+	entry = scene_table_find(group_id, scene_id);
+	if (!entry) {
+		entry = scene_table_add(group_id, scene_id);
+	}
 
-		/* Extension set: Cluster ID = Window covering */
-		ZB_ZCL_PACKET_PUT_DATA16_VAL(payload_ptr, ZB_ZCL_CLUSTER_ID_WINDOW_COVERING);
+	if (!entry) {
+		LOG_WRN("No space for stored scene 0x%x/%hd", group_id, scene_id);
+		return -ENOMEM;
+	}
 
-		/* Extension set: Fieldset length = 1 or 2*/
-		if (entry->window_covering.has_current_position_tilt_percentage == ZB_TRUE) {
-			ZB_ZCL_PACKET_PUT_DATA8(payload_ptr, 2);
-		} else {
-			ZB_ZCL_PACKET_PUT_DATA8(payload_ptr, 1);
+	entry->common.transition_time = sys_get_le16(&record[0]);
+	entry->attr_mask = attr_mask;
+	for (size_t i = 0; i < SCENE_ATTR_COUNT; i++) {
+		if (!(attr_mask & BIT(i))) {
+			continue;
 		}
-		/* Extension set: current_position_lift_percentage state */
-		ZB_ZCL_PACKET_PUT_DATA8(payload_ptr,
-			entry->window_covering.current_position_lift_percentage);
-
-		if (entry->window_covering.has_current_position_tilt_percentage == ZB_TRUE) {
-			/* Extension set: current_position_tilt_percentage state */
-			ZB_ZCL_PACKET_PUT_DATA8(payload_ptr,
-				entry->window_covering.current_position_tilt_percentage);
+
+		if (pos == len) {
+			scene_table_remove(entry);
+			return -EINVAL;
 		}
+
+		entry->attr_val[i] = record[pos++];
 	}
 
-	/* Pass the updated data pointer. */
-	return payload_ptr;
+	return 0;
 }
 
-static zb_ret_t get_on_off_value(zb_uint8_t *on_off)
+static int scenes_table_commit(void)
 {
-	zb_zcl_attr_t *attr_desc = zb_zcl_get_attr_desc_a(
-		CONFIG_ZIGBEE_SCENES_ENDPOINT,
-		ZB_ZCL_CLUSTER_ID_ON_OFF,
-		ZB_ZCL_CLUSTER_SERVER_ROLE,
-		ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID);
+	if (!legacy_table_found) {
+		return 0;
+	}
 
-	if (attr_desc != NULL) {
-		*on_off = (zb_bool_t)ZB_ZCL_GET_ATTRIBUTE_VAL_8(attr_desc);
-		return RET_OK;
+	legacy_table_found = false;
+
+	/* The legacy table is only deleted once all scenes are stored in the
+	 * new format, otherwise the conversion is repeated on the next boot.
+	 */
+	for (zb_uint8_t i = 0; i < scenes_count; i++) {
+		if (scene_save(&scenes_table[i])) {
+			return 0;
+		}
 	}
 
-	return RET_ERROR;
+	(void)settings_delete("scenes/scenes_table");
+
+	return 0;
 }
 
-static zb_ret_t get_current_level_value(zb_uint8_t *current_level)
+struct settings_handler scenes_conf = {
+	.name = "scenes",
+	.h_set = scenes_table_set,
+	.h_commit = scenes_table_commit,
+};
+
+static zb_bool_t has_cluster(zb_uint16_t cluster_id)
 {
-	zb_zcl_attr_t *attr_desc = zb_zcl_get_attr_desc_a(
+	return (get_endpoint_by_cluster(cluster_id, ZB_ZCL_CLUSTER_SERVER_ROLE)
+		== CONFIG_ZIGBEE_SCENES_ENDPOINT)
+		? ZB_TRUE : ZB_FALSE;
+}
+
+static zb_zcl_attr_t *scene_attr_desc_get(const struct scene_attr *attr)
+{
+	return zb_zcl_get_attr_desc_a(
 		CONFIG_ZIGBEE_SCENES_ENDPOINT,
-		ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL,
+		attr->cluster_id,
 		ZB_ZCL_CLUSTER_SERVER_ROLE,
-		ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID);
+		attr->attr_id);
+}
+
+static zb_ret_t scene_attr_get(const struct scene_attr *attr, zb_uint8_t *value)
+{
+	zb_zcl_attr_t *attr_desc = scene_attr_desc_get(attr);
 
 	if (attr_desc != NULL) {
-		*current_level = ZB_ZCL_GET_ATTRIBUTE_VAL_8(attr_desc);
+		*value = ZB_ZCL_GET_ATTRIBUTE_VAL_8(attr_desc);
 		return RET_OK;
 	}
 
 	return RET_ERROR;
 }
 
-static zb_ret_t get_current_lift_value(zb_uint8_t *percentage)
+static zb_bool_t add_fieldset(zb_zcl_scenes_fieldset_common_t *fieldset,
+			      struct scene_table_entry *entry)
 {
-	zb_zcl_attr_t *attr_desc = zb_zcl_get_attr_desc_a(
-		CONFIG_ZIGBEE_SCENES_ENDPOINT,
-		ZB_ZCL_CLUSTER_ID_WINDOW_COVERING,
-		ZB_ZCL_CLUSTER_SERVER_ROLE,
-		ZB_ZCL_ATTR_WINDOW_COVERING_CURRENT_POSITION_LIFT_PERCENTAGE_ID);
+	zb_uint8_t *fs_data_ptr = (zb_uint8_t *)fieldset + sizeof(zb_zcl_scenes_fieldset_common_t);
+	zb_bool_t added = ZB_FALSE;
+
+	if (has_cluster(fieldset->cluster_id)) {
+		for (size_t i = 0; i < SCENE_ATTR_COUNT; i++) {
+			if (scene_attrs[i].cluster_id != fieldset->cluster_id ||
+			    scene_attrs[i].offset >= fieldset->fieldset_length) {
+				continue;
+			}
 
-	if (attr_desc != NULL) {
-		*percentage = ZB_ZCL_GET_ATTRIBUTE_VAL_8(attr_desc);
-		return RET_OK;
+			entry->attr_mask |= BIT(i);
+			entry->attr_val[i] = fs_data_ptr[scene_attrs[i].offset];
+			added = ZB_TRUE;
+		}
 	}
 
-	return RET_ERROR;
+	LOG_INF("%s fieldset: cluster_id=0x%x, length=%d",
+		added ? "Add" : "Ignore", fieldset->cluster_id, fieldset->fieldset_length);
+
+	return added;
 }
 
-static zb_ret_t get_current_tilt_value(zb_uint8_t *percentage)
+static zb_uint8_t *dump_fieldsets(const struct scene_table_entry *entry,
+				  zb_uint8_t *payload_ptr)
 {
-	zb_zcl_attr_t *attr_desc = zb_zcl_get_attr_desc_a(
-		CONFIG_ZIGBEE_SCENES_ENDPOINT,
-		ZB_ZCL_CLUSTER_ID_WINDOW_COVERING,
-		ZB_ZCL_CLUSTER_SERVER_ROLE,
-		ZB_ZCL_ATTR_WINDOW_COVERING_CURRENT_POSITION_TILT_PERCENTAGE_ID);
+	for (size_t i = 0; i < SCENE_ATTR_COUNT; i++) {
+		zb_uint8_t len = 0;
 
-	if (attr_desc != NULL) {
-		*percentage = ZB_ZCL_GET_ATTRIBUTE_VAL_8(attr_desc);
-		return RET_OK;
+		if (scene_attrs[i].offset != 0 || !(entry->attr_mask & BIT(i))) {
+			continue;
+		}
+
+		/* The field set ends at the first attribute missing from the scene: */
+		while (i + len < SCENE_ATTR_COUNT &&
+		       scene_attrs[i + len].cluster_id == scene_attrs[i].cluster_id &&
+		       (entry->attr_mask & BIT(i + len))) {
+			len++;
+		}
+
+		LOG_INF("Append fieldset: cluster_id=0x%x, length=%d",
+			scene_attrs[i].cluster_id, len);
+
+		/* Extension set: Cluster ID */
+		ZB_ZCL_PACKET_PUT_DATA16_VAL(payload_ptr, scene_attrs[i].cluster_id);
+
+		/* Extension set: Fieldset length */
+		ZB_ZCL_PACKET_PUT_DATA8(payload_ptr, len);
+
+		/* Extension set: Attribute values */
+		for (zb_uint8_t j = 0; j < len; j++) {
+			ZB_ZCL_PACKET_PUT_DATA8(payload_ptr, entry->attr_val[i + j]);
+		}
 	}
 
-	return RET_ERROR;
+	/* Pass the updated data pointer. */
+	return payload_ptr;
 }
 
-static void save_state_as_scene(struct scene_table_on_off_entry *entry)
+static void save_state_as_scene(struct scene_table_entry *entry)
 {
-	if (has_cluster(ZB_ZCL_CLUSTER_ID_ON_OFF) &&
-	    get_on_off_value(&entry->on_off.on_off) == RET_OK) {
-		LOG_INF("Save On/Off state inside scene table");
-		entry->on_off.has_on_off = ZB_TRUE;
-	}
-	if (has_cluster(ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL) &&
-	    get_current_level_value(&entry->level_control.current_level) == RET_OK) {
-		LOG_INF("Save level control state inside scene table");
-		entry->level_control.has_current_level = ZB_TRUE;
-	}
-	if (has_cluster(ZB_ZCL_CLUSTER_ID_WINDOW_COVERING)) {
-		LOG_INF("Save window covering state inside scene table");
-		if (get_current_lift_value(
-		    &entry->window_covering.current_position_lift_percentage) == RET_OK) {
-			entry->window_covering.has_current_position_lift_percentage = ZB_TRUE;
-		}
-		if (get_current_tilt_value(
-		    &entry->window_covering.current_position_tilt_percentage) == RET_OK) {
-			entry->window_covering.has_current_position_tilt_percentage = ZB_TRUE;
+	entry->attr_mask = 0;
+
+	for (size_t i = 0; i < SCENE_ATTR_COUNT; i++) {
+		if (has_cluster(scene_attrs[i].cluster_id) &&
+		    scene_attr_get(&scene_attrs[i], &entry->attr_val[i]) == RET_OK) {
+			entry->attr_mask |= BIT(i);
 		}
 	}
+
+	LOG_INF("Save state inside scene table: attribute mask 0x%x", entry->attr_mask);
 }
 
-static void recall_scene(struct scene_table_on_off_entry *entry)
+static void recall_scene(const struct scene_table_entry *entry)
 {
 	zb_bufid_t buf = zb_buf_get_any();
 	zb_zcl_attr_t *attr_desc;
+	zb_uint8_t value;
 	zb_ret_t result;
 
-	if (entry->on_off.has_on_off) {
-		LOG_INF("Recall On/Off state");
-
-		attr_desc = zb_zcl_get_attr_desc_a(
-			CONFIG_ZIGBEE_SCENES_ENDPOINT,
-			ZB_ZCL_CLUSTER_ID_ON_OFF,
-			ZB_ZCL_CLUSTER_SERVER_ROLE,
-			ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID);
-
-		ZB_ZCL_INVOKE_USER_APP_SET_ATTR_WITH_RESULT(
-			buf,
-			CONFIG_ZIGBEE_SCENES_ENDPOINT,
-			ZB_ZCL_CLUSTER_ID_ON_OFF,
-			attr_desc,
-			&entry->on_off.on_off,
-			result
-		);
-	}
-	if (entry->level_control.has_current_level) {
-		LOG_INF("Recall level control state");
-
-		attr_desc = zb_zcl_get_attr_desc_a(
-			CONFIG_ZIGBEE_SCENES_ENDPOINT,
-			ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL,
-			ZB_ZCL_CLUSTER_SERVER_ROLE,
-			ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID);
+	LOG_INF("Recall scene: attribute mask 0x%x", entry->attr_mask);
 
-		ZB_ZCL_INVOKE_USER_APP_SET_ATTR_WITH_RESULT(
-			buf,
-			CONFIG_ZIGBEE_SCENES_ENDPOINT,
-			ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL,
-			attr_desc,
-			&entry->level_control.current_level,
-			result
-		);
-	}
-	if (entry->window_covering.has_current_position_lift_percentage) {
-		LOG_INF("Recall window covering lift state");
-
-		attr_desc = zb_zcl_get_attr_desc_a(
-			CONFIG_ZIGBEE_SCENES_ENDPOINT,
-			ZB_ZCL_CLUSTER_ID_WINDOW_COVERING,
-			ZB_ZCL_CLUSTER_SERVER_ROLE,
-			ZB_ZCL_ATTR_WINDOW_COVERING_CURRENT_POSITION_LIFT_PERCENTAGE_ID);
-
-		ZB_ZCL_INVOKE_USER_APP_SET_ATTR_WITH_RESULT(
-				buf,
-				CONFIG_ZIGBEE_SCENES_ENDPOINT,
-				ZB_ZCL_CLUSTER_ID_WINDOW_COVERING,
-				attr_desc,
-				&entry->window_covering.current_position_lift_percentage,
-				result
-		);
-	}
-	if (entry->window_covering.has_current_position_tilt_percentage) {
-		LOG_INF("Recall window covering tilt state");
+	/* All attributes of the scene are written in one pass, with a single
+	 * buffer for the application callbacks.
+	 */
+	for (size_t i = 0; i < SCENE_ATTR_COUNT; i++) {
+		if (!(entry->attr_mask & BIT(i))) {
+			continue;
+		}
 
-		attr_desc = zb_zcl_get_attr_desc_a(
-			CONFIG_ZIGBEE_SCENES_ENDPOINT,
-			ZB_ZCL_CLUSTER_ID_WINDOW_COVERING,
-			ZB_ZCL_CLUSTER_SERVER_ROLE,
-			ZB_ZCL_ATTR_WINDOW_COVERING_CURRENT_POSITION_TILT_PERCENTAGE_ID);
+		attr_desc = scene_attr_desc_get(&scene_attrs[i]);
+		if (attr_desc == NULL) {
+			continue;
+		}
 
+		value = entry->attr_val[i];
 		ZB_ZCL_INVOKE_USER_APP_SET_ATTR_WITH_RESULT(
 			buf,
 			CONFIG_ZIGBEE_SCENES_ENDPOINT,
-			ZB_ZCL_CLUSTER_ID_WINDOW_COVERING,
+			scene_attrs[i].cluster_id,
 			attr_desc,
-			&entry->window_covering.current_position_tilt_percentage,
+			&value,
 			result
 		);
 	}
@@ -374,15 +569,21 @@ static void recall_scene(struct scene_table_on_off_entry *entry)
 	zb_buf_free(buf);
 }
 
-static void send_view_scene_resp(zb_bufid_t bufid, zb_uint16_t idx)
+static void send_view_scene_resp(zb_bufid_t bufid)
 {
 	zb_uint8_t *payload_ptr;
 	zb_uint8_t view_scene_status = ZB_ZCL_STATUS_NOT_FOUND;
+	const struct scene_table_entry *entry;
+
+	LOG_DBG(">> %s bufid %hd", __func__, bufid);
 
-	LOG_DBG(">> %s bufid %hd idx %d", __func__, bufid, idx);
+	/* Look the scene up when sending, as the table may have changed since
+	 * the request was received.
+	 */
+	entry = scene_table_find(resp_info.view_scene_req.group_id,
+				 resp_info.view_scene_req.scene_id);
 
-	if (idx != 0xFF &&
-	    scenes_table[idx].common.group_id != ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD) {
+	if (entry) {
 		/* Scene found */
 		view_scene_status = ZB_ZCL_STATUS_SUCCESS;
 	} else if (!zb_aps_is_endpoint_in_group(resp_info.view_scene_req.group_id,
@@ -402,13 +603,13 @@ static void send_view_scene_resp(zb_bufid_t bufid, zb_uint16_t idx)
 	if (view_scene_status == ZB_ZCL_STATUS_SUCCESS) {
 		ZB_ZCL_SCENES_ADD_TRANSITION_TIME_VIEW_SCENE_RES(
 			payload_ptr,
-			scenes_table[idx].common.transition_time);
+			entry->common.transition_time);
 
 		ZB_ZCL_SCENES_ADD_SCENE_NAME_VIEW_SCENE_RES(
 			payload_ptr,
-			scenes_table[idx].common.scene_name);
+			entry->common.scene_name);
 
-		payload_ptr = dump_fieldsets(&scenes_table[idx], payload_ptr);
+		payload_ptr = dump_fieldsets(entry, payload_ptr);
 	}
 
 	ZB_ZCL_SCENES_SEND_VIEW_SCENE_RES(
@@ -452,13 +653,13 @@ static void send_get_scene_membership_resp(zb_bufid_t bufid)
 			resp_info.cmd_info.seq_number,
 			capacity_ptr,
 			ZB_ZCL_STATUS_SUCCESS,
-			0,
+			SCENE_TABLE_SIZE - scenes_count,
 			resp_info.get_scene_membership_req.group_id);
 
 		scene_count_ptr = payload_ptr;
 		ZB_ZCL_SCENES_ADD_SCENE_COUNT_GET_SCENE_MEMBERSHIP_RES(payload_ptr, 0);
 
-		while (i < CONFIG_ZIGBEE_SCENE_TABLE_SIZE) {
+		while (i < scenes_count) {
 			if (scenes_table[i].common.group_id ==
 			    resp_info.get_scene_membership_req.group_id) {
 				/* Add to payload */
@@ -467,10 +668,6 @@ static void send_get_scene_membership_resp(zb_bufid_t bufid)
 				ZB_ZCL_SCENES_ADD_SCENE_ID_GET_SCENE_MEMBERSHIP_RES(
 					payload_ptr,
 					scenes_table[i].common.scene_id);
-			} else if (scenes_table[i].common.group_id ==
-				   ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD) {
-				LOG_INF("add capacity num");
-				++(*capacity_ptr);
 			}
 			++i;
 		}
@@ -488,55 +685,32 @@ static void send_get_scene_membership_resp(zb_bufid_t bufid)
 	LOG_DBG("<< %s", __func__);
 }
 
-static void scene_table_init(void)
-{
-	zb_uint8_t i = 0;
-
-	memset(scenes_table, 0, sizeof(scenes_table));
-	while (i < CONFIG_ZIGBEE_SCENE_TABLE_SIZE) {
-		scenes_table[i].common.group_id = ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD;
-		++i;
-	}
-}
-
-static zb_uint8_t scene_table_get_entry(zb_uint16_t group_id, zb_uint8_t scene_id)
-{
-	zb_uint8_t i = 0;
-	zb_uint8_t idx = 0xFF, free_idx = 0xFF;
-
-	while (i < CONFIG_ZIGBEE_SCENE_TABLE_SIZE) {
-		if (scenes_table[i].common.group_id == group_id &&
-		    scenes_table[i].common.scene_id == scene_id) {
-			idx = i;
-			break;
-		} else if ((free_idx == 0xFF) &&
-			 (scenes_table[i].common.group_id ==
-			  ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD)) {
-			/* Remember free index */
-			free_idx = i;
-		}
-		++i;
-	}
-
-	return ((idx != 0xFF) ? idx : free_idx);
-}
-
 static void scene_table_remove_entries_by_group(zb_uint16_t group_id)
 {
 	zb_uint8_t i = 0;
 
 	LOG_DBG(">> %s: group_id 0x%x", __func__, group_id);
-	while (i < CONFIG_ZIGBEE_SCENE_TABLE_SIZE) {
+	while (i < scenes_count) {
 		if (scenes_table[i].common.group_id == group_id) {
-			LOG_INF("removing scene: entry idx %hd", i);
-			memset(&scenes_table[i], 0, sizeof(scenes_table[i]));
-			scenes_table[i].common.group_id = ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD;
+			/* The last entry is moved into this one, so check it again. */
+			scene_delete(&scenes_table[i]);
+			scene_table_remove(&scenes_table[i]);
+		} else {
+			++i;
 		}
-		++i;
 	}
 	LOG_DBG("<< %s", __func__);
 }
 
+static void scene_table_remove_all(void)
+{
+	for (zb_uint8_t i = 0; i < scenes_count; i++) {
+		scene_delete(&scenes_table[i]);
+	}
+
+	scene_table_init();
+}
+
 static zb_ret_t get_scene_valid_value(zb_bool_t *scene_valid)
 {
 	zb_zcl_attr_t *attr_desc = zb_zcl_get_attr_desc_a(
@@ -594,7 +768,7 @@ static zb_ret_t get_current_scene_group_id_value(zb_uint16_t *group_id)
 		ZB_ZCL_ATTR_SCENES_CURRENT_GROUP_ID);
 
 	if (attr_desc != NULL) {
-		*group_id = (zb_bool_t)ZB_ZCL_GET_ATTRIBUTE_VAL_8(attr_desc);
+		*group_id = ZB_ZCL_GET_ATTRIBUTE_VAL_16(attr_desc);
 		return RET_OK;
 	}
 
@@ -616,51 +790,19 @@ static void update_scene_valid_value(void)
 	    get_current_scene_group_id_value(&group_id) == RET_OK &&
 	    scene_valid == ZB_TRUE) {
 		/* Verify if scene_valid should be reset. */
-		zb_uint8_t idx = scene_table_get_entry(group_id, scene_id);
+		const struct scene_table_entry *entry = scene_table_find(group_id, scene_id);
 
-		if (group_id == ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD ||
-		    scene_id < CONFIG_ZIGBEE_SCENE_TABLE_SIZE ||
-		    idx == ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD) {
+		if (group_id == ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD || entry == NULL) {
 			(void)set_scene_valid_value(ZB_FALSE);
 			return;
 		}
 
-		if (scenes_table[idx].on_off.has_on_off) {
-			zb_uint8_t on_off;
-
-			(void)get_on_off_value(&on_off);
-			if (on_off != scenes_table[idx].on_off.on_off) {
-				(void)set_scene_valid_value(ZB_FALSE);
-				return;
-			}
-		}
-
-		if (scenes_table[idx].level_control.has_current_level) {
-			zb_uint8_t current_level;
+		for (size_t i = 0; i < SCENE_ATTR_COUNT; i++) {
+			zb_uint8_t value;
 
-			(void)get_current_level_value(&current_level);
-			if (current_level != scenes_table[idx].level_control.current_level) {
-				(void)set_scene_valid_value(ZB_FALSE);
-				return;
-			}
-		}
-
-		if (scenes_table[idx].window_covering.has_current_position_lift_percentage) {
-			zb_uint8_t lift;
-
-			(void)get_current_lift_value(&lift);
-			if (lift !=
-			    scenes_table[idx].window_covering.current_position_lift_percentage) {
-				(void)set_scene_valid_value(ZB_FALSE);
-				return;
-			}
-		}
-		if (scenes_table[idx].window_covering.has_current_position_tilt_percentage) {
-			zb_uint8_t tilt;
-
-			(void)get_current_lift_value(&tilt);
-			if (tilt !=
-			    scenes_table[idx].window_covering.current_position_tilt_percentage) {
+			if ((entry->attr_mask & BIT(i)) &&
+			    scene_attr_get(&scene_attrs[i], &value) == RET_OK &&
+			    value != entry->attr_val[i]) {
 				(void)set_scene_valid_value(ZB_FALSE);
 				return;
 			}
@@ -688,7 +830,7 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 			ZB_ZCL_DEVICE_CMD_PARAM_IN_GET(
 				bufid,
 				zb_zcl_scenes_add_scene_req_t);
-		zb_uint8_t idx = 0xFF;
+		struct scene_table_entry *entry;
 		zb_uint8_t *add_scene_status =
 			ZB_ZCL_DEVICE_CMD_PARAM_OUT_GET(bufid, zb_uint8_t);
 
@@ -699,17 +841,20 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 			add_scene_req->transition_time);
 
 		*add_scene_status = ZB_ZCL_STATUS_INVALID_FIELD;
-		idx = scene_table_get_entry(add_scene_req->group_id,
-					    add_scene_req->scene_id);
+		entry = scene_table_find(add_scene_req->group_id,
+					 add_scene_req->scene_id);
 
-		if (idx != 0xFF) {
+		if (entry || scenes_count < SCENE_TABLE_SIZE) {
 			zb_zcl_scenes_fieldset_common_t *fieldset;
 			zb_uint8_t fs_content_length;
+			/* Field sets of the new scene, which replace the existing ones. */
+			struct scene_table_entry fieldsets = { 0 };
+			struct scene_table_entry prev;
 
-			if (scenes_table[idx].common.group_id !=
-			    ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD) {
+			if (entry) {
 				/* Indicate that we overwriting existing record */
 				device_cb_param->status = RET_ALREADY_EXISTS;
+				prev = *entry;
 			}
 			zb_bool_t empty_entry = ZB_TRUE;
 
@@ -718,7 +863,7 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 				fieldset,
 				fs_content_length);
 			while (fieldset) {
-				if (add_fieldset(fieldset, &scenes_table[idx]) == ZB_TRUE) {
+				if (add_fieldset(fieldset, &fieldsets) == ZB_TRUE) {
 					empty_entry = ZB_FALSE;
 				}
 				ZB_ZCL_SCENES_GET_ADD_SCENE_REQ_NEXT_FIELDSET_DESC(
@@ -727,13 +872,17 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 					fs_content_length);
 			}
 			if (empty_entry == ZB_FALSE) {
+				bool existed = (entry != NULL);
+
 				/* Store this scene */
-				scenes_table[idx].common.group_id = add_scene_req->group_id;
-				scenes_table[idx].common.scene_id = add_scene_req->scene_id;
-				scenes_table[idx].common.transition_time =
-						add_scene_req->transition_time;
-				*add_scene_status = ZB_ZCL_STATUS_SUCCESS;
-				scenes_table_save();
+				if (!existed) {
+					entry = scene_table_add(add_scene_req->group_id,
+								add_scene_req->scene_id);
+				}
+				entry->common.transition_time = add_scene_req->transition_time;
+				entry->attr_mask = fieldsets.attr_mask;
+				memcpy(entry->attr_val, fieldsets.attr_val, sizeof(entry->attr_val));
+				*add_scene_status = scene_commit(entry, existed ? &prev : NULL);
 			}
 		} else {
 			LOG_ERR("Unable to add scene: ZB_ZCL_STATUS_INSUFF_SPACE");
@@ -746,27 +895,23 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 		const zb_zcl_scenes_view_scene_req_t *view_scene_req =
 			ZB_ZCL_DEVICE_CMD_PARAM_IN_GET(bufid, zb_zcl_scenes_view_scene_req_t);
 		const zb_zcl_parsed_hdr_t *in_cmd_info = ZB_ZCL_DEVICE_CMD_PARAM_CMD_INFO(bufid);
-		zb_uint8_t idx = 0xFF;
 
 		LOG_INF("ZB_ZCL_SCENES_VIEW_SCENE_CB_ID: group_id 0x%x scene_id %hd",
 			view_scene_req->group_id,
 			view_scene_req->scene_id);
 
-		idx = scene_table_get_entry(view_scene_req->group_id, view_scene_req->scene_id);
-		LOG_INF("Scene table entry index: %d", idx);
-
 		/* Send View Scene Response */
 		ZB_MEMCPY(&resp_info.cmd_info, in_cmd_info, sizeof(zb_zcl_parsed_hdr_t));
 		ZB_MEMCPY(&resp_info.view_scene_req, view_scene_req,
 			  sizeof(zb_zcl_scenes_view_scene_req_t));
-		zb_buf_get_out_delayed_ext(send_view_scene_resp, idx, 0);
+		zb_buf_get_out_delayed(send_view_scene_resp);
 	}
 	break;
 
 	case ZB_ZCL_SCENES_REMOVE_SCENE_CB_ID: {
 		const zb_zcl_scenes_remove_scene_req_t *remove_scene_req =
 			ZB_ZCL_DEVICE_CMD_PARAM_IN_GET(bufid, zb_zcl_scenes_remove_scene_req_t);
-		zb_uint8_t idx = 0xFF;
+		struct scene_table_entry *entry;
 		zb_uint8_t *remove_scene_status =
 			ZB_ZCL_DEVICE_CMD_PARAM_OUT_GET(bufid, zb_uint8_t);
 		const zb_zcl_parsed_hdr_t *in_cmd_info = ZB_ZCL_DEVICE_CMD_PARAM_CMD_INFO(bufid);
@@ -776,17 +921,14 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 			remove_scene_req->scene_id);
 
 		*remove_scene_status = ZB_ZCL_STATUS_NOT_FOUND;
-		idx = scene_table_get_entry(remove_scene_req->group_id,
-					    remove_scene_req->scene_id);
+		entry = scene_table_find(remove_scene_req->group_id,
+					 remove_scene_req->scene_id);
 
-		if (idx != 0xFF &&
-		    scenes_table[idx].common.group_id != ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD) {
+		if (entry) {
 			/* Remove this entry */
-			memset(&scenes_table[idx], 0, sizeof(scenes_table[idx]));
-			scenes_table[idx].common.group_id = ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD;
-			LOG_INF("removing scene: entry idx %hd", idx);
+			scene_delete(entry);
+			scene_table_remove(entry);
 			*remove_scene_status = ZB_ZCL_STATUS_SUCCESS;
-			scenes_table_save();
 		} else if (!zb_aps_is_endpoint_in_group(
 				remove_scene_req->group_id,
 				ZB_ZCL_PARSED_HDR_SHORT_DATA(in_cmd_info).dst_endpoint)) {
@@ -813,7 +955,6 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 		} else {
 			scene_table_remove_entries_by_group(remove_all_scenes_req->group_id);
 			*remove_all_scenes_status = ZB_ZCL_STATUS_SUCCESS;
-			scenes_table_save();
 		}
 	}
 	break;
@@ -821,7 +962,9 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 	case ZB_ZCL_SCENES_STORE_SCENE_CB_ID: {
 		const zb_zcl_scenes_store_scene_req_t *store_scene_req =
 			ZB_ZCL_DEVICE_CMD_PARAM_IN_GET(bufid, zb_zcl_scenes_store_scene_req_t);
-		zb_uint8_t idx = 0xFF;
+		struct scene_table_entry *entry;
+		struct scene_table_entry prev;
+		bool existed;
 		zb_uint8_t *store_scene_status =
 			ZB_ZCL_DEVICE_CMD_PARAM_OUT_GET(bufid, zb_uint8_t);
 		const zb_zcl_parsed_hdr_t *in_cmd_info = ZB_ZCL_DEVICE_CMD_PARAM_CMD_INFO(bufid);
@@ -835,29 +978,27 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 				ZB_ZCL_PARSED_HDR_SHORT_DATA(in_cmd_info).dst_endpoint)) {
 			*store_scene_status = ZB_ZCL_STATUS_INVALID_FIELD;
 		} else {
-			idx = scene_table_get_entry(store_scene_req->group_id,
-						    store_scene_req->scene_id);
-
-			if (idx != 0xFF) {
-				if (scenes_table[idx].common.group_id !=
-				    ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD) {
-					/* Update existing entry with current On/Off state */
-					device_cb_param->status = RET_ALREADY_EXISTS;
-					LOG_INF("update existing scene: entry idx %hd", idx);
-				} else {
-					/* Create new entry with empty name
-					 * and 0 transition time
-					 */
-					scenes_table[idx].common.group_id =
-						store_scene_req->group_id;
-					scenes_table[idx].common.scene_id =
-						store_scene_req->scene_id;
-					scenes_table[idx].common.transition_time = 0;
-					LOG_INF("create new scene: entry idx %hd", idx);
-				}
-				save_state_as_scene(&scenes_table[idx]);
-				*store_scene_status = ZB_ZCL_STATUS_SUCCESS;
-				scenes_table_save();
+			entry = scene_table_find(store_scene_req->group_id,
+						 store_scene_req->scene_id);
+			existed = (entry != NULL);
+
+			if (entry) {
+				/* Update existing entry with current On/Off state */
+				device_cb_param->status = RET_ALREADY_EXISTS;
+				LOG_INF("update existing scene: entry idx %d",
+					(int)(entry - scenes_table));
+				prev = *entry;
+			} else {
+				/* Create new entry with empty name
+				 * and 0 transition time
+				 */
+				entry = scene_table_add(store_scene_req->group_id,
+							store_scene_req->scene_id);
+			}
+
+			if (entry) {
+				save_state_as_scene(entry);
+				*store_scene_status = scene_commit(entry, existed ? &prev : NULL);
 			} else {
 				*store_scene_status = ZB_ZCL_STATUS_INSUFF_SPACE;
 			}
@@ -868,7 +1009,7 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 	case ZB_ZCL_SCENES_RECALL_SCENE_CB_ID: {
 		const zb_zcl_scenes_recall_scene_req_t *recall_scene_req =
 			ZB_ZCL_DEVICE_CMD_PARAM_IN_GET(bufid, zb_zcl_scenes_recall_scene_req_t);
-		zb_uint8_t idx = 0xFF;
+		const struct scene_table_entry *entry;
 		zb_uint8_t *recall_scene_status =
 			ZB_ZCL_DEVICE_CMD_PARAM_OUT_GET(bufid, zb_uint8_t);
 
@@ -876,13 +1017,12 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 			recall_scene_req->group_id,
 			recall_scene_req->scene_id);
 
-		idx = scene_table_get_entry(recall_scene_req->group_id,
-					    recall_scene_req->scene_id);
+		entry = scene_table_find(recall_scene_req->group_id,
+					 recall_scene_req->scene_id);
 
-		if (idx != 0xFF &&
-		    scenes_table[idx].common.group_id != ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD) {
+		if (entry) {
 			/* Recall this entry */
-			recall_scene(&scenes_table[idx]);
+			recall_scene(entry);
 			*recall_scene_status = ZB_ZCL_STATUS_SUCCESS;
 		} else {
 			*recall_scene_status = ZB_ZCL_STATUS_NOT_FOUND;
@@ -918,13 +1058,11 @@ zb_bool_t zcl_scenes_cb(zb_bufid_t bufid)
 
 		/* Have only one endpoint */
 		scene_table_remove_entries_by_group(remove_all_scenes_req->group_id);
-		scenes_table_save();
 	}
 	break;
 
 	case ZB_ZCL_SCENES_INTERNAL_REMOVE_ALL_SCENES_ALL_ENDPOINTS_ALL_GROUPS_CB_ID: {
-		scene_table_init();
-		scenes_table_save();
+		scene_table_remove_all();
 	}
 	break;
 
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <string.h>
+#include <kernel.h>
 #include <sys/__assert.h>
 #include <random/rand32.h>
 #include <zboss_api.h>
@@ -14,6 +16,7 @@
 #elif CONFIG_ZIGBEE_USE_SOFTWARE_AES
 #include <tinycrypt/aes.h>
 #include <tinycrypt/constants.h>
+#include <sys/byteorder.h>
 #else
 #error No crypto suite for Zigbee stack has been selected
 #endif
@@ -30,58 +33,143 @@
 #if CONFIG_CRYPTO_NRF_ECB
 static const struct device *dev;
 
-static void encrypt_aes(zb_uint8_t *key, zb_uint8_t *msg, zb_uint8_t *c)
+/* Starting a cipher session is more expensive than encrypting a block, and
+ * ZBOSS encrypts many blocks with the same key for every CCM* frame, so the
+ * session is kept until the key changes. The open session holds the ECB
+ * peripheral, so it is also closed when another user of the peripheral
+ * calls zb_osif_aes_session_release().
+ */
+static struct cipher_ctx session;
+static uint8_t session_key[ECB_AES_KEY_SIZE];
+static bool session_valid;
+static K_MUTEX_DEFINE(session_mutex);
+
+static void session_end(void)
+{
+	if (session_valid) {
+		cipher_free_session(dev, &session);
+		session_valid = false;
+	}
+
+	memset(session_key, 0, sizeof(session_key));
+}
+
+static int session_start(const uint8_t *key)
 {
 	int err;
 
-	__ASSERT(dev, "encryption call too early");
+	if (session_valid && !memcmp(key, session_key, sizeof(session_key))) {
+		return 0;
+	}
 
-	struct cipher_ctx ctx = {
+	session_end();
+
+	memcpy(session_key, key, sizeof(session_key));
+	session = (struct cipher_ctx) {
 		.keylen = ECB_AES_KEY_SIZE,
-		.key.bit_stream = key,
+		.key.bit_stream = session_key,
 		.flags = CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS,
 	};
-	struct cipher_pkt encryption = {
-		.in_buf = msg,
-		.in_len = ECB_AES_BLOCK_SIZE,
-		.out_buf_max = ECB_AES_BLOCK_SIZE,
-		.out_buf = c,
-	};
 
-	err = cipher_begin_session(dev, &ctx, CRYPTO_CIPHER_ALGO_AES,
+	err = cipher_begin_session(dev, &session, CRYPTO_CIPHER_ALGO_AES,
 				   CRYPTO_CIPHER_MODE_ECB,
 				   CRYPTO_CIPHER_OP_ENCRYPT);
+	session_valid = !err;
+
+	return err;
+}
+
+static void encrypt_aes(const uint8_t *key, const uint8_t *msg, uint8_t *c,
+			size_t count)
+{
+	int err;
+
+	__ASSERT(dev, "encryption call too early");
+
+	k_mutex_lock(&session_mutex, K_FOREVER);
+
+	err = session_start(key);
 	__ASSERT(!err, "Session init failed");
 
-	if (err) {
-		goto out;
-	}
+	for (size_t i = 0; !err && i < count; i++) {
+		struct cipher_pkt encryption = {
+			.in_buf = (uint8_t *)&msg[i * ECB_AES_BLOCK_SIZE],
+			.in_len = ECB_AES_BLOCK_SIZE,
+			.out_buf_max = ECB_AES_BLOCK_SIZE,
+			.out_buf = &c[i * ECB_AES_BLOCK_SIZE],
+		};
 
-	err = cipher_block_op(&ctx, &encryption);
-	__ASSERT(!err, "Encryption failed");
+		err = cipher_block_op(&session, &encryption);
+		__ASSERT(!err, "Encryption failed");
+	}
 
-out:
-	cipher_free_session(dev, &ctx);
+	k_mutex_unlock(&session_mutex);
 }
 #elif CONFIG_BT_CTLR
-static void encrypt_aes(zb_uint8_t *key, zb_uint8_t *msg, zb_uint8_t *c)
+static void encrypt_aes(const uint8_t *key, const uint8_t *msg, uint8_t *c,
+			size_t count)
 {
 	int err;
 
-	err = bt_encrypt_be(key, msg, c);
-	__ASSERT(!err, "Encryption failed");
+	for (size_t i = 0; i < count; i++) {
+		err = bt_encrypt_be(key, &msg[i * ECB_AES_BLOCK_SIZE],
+				    &c[i * ECB_AES_BLOCK_SIZE]);
+		__ASSERT(!err, "Encryption failed");
+	}
 }
 #elif CONFIG_ZIGBEE_USE_SOFTWARE_AES
-static void encrypt_aes(zb_uint8_t *key, zb_uint8_t *msg, zb_uint8_t *c)
+/* Expanding the key is more expensive than encrypting a block, and ZBOSS
+ * encrypts many blocks with the same key for every CCM* frame, so the key
+ * schedule is kept until the key changes.
+ */
+static struct tc_aes_key_sched_struct session;
+static bool session_valid;
+static K_MUTEX_DEFINE(session_mutex);
+
+static bool session_key_matches(const uint8_t *key)
+{
+	if (!session_valid) {
+		return false;
+	}
+
+	/* The key schedule starts with the key itself, so no separate copy
+	 * of the key is kept:
+	 */
+	for (int i = 0; i < ECB_AES_KEY_SIZE / sizeof(uint32_t); i++) {
+		if (session.words[i] != sys_get_be32(&key[i * 4])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void session_end(void)
+{
+	memset(&session, 0, sizeof(session));
+	session_valid = false;
+}
+
+static void encrypt_aes(const uint8_t *key, const uint8_t *msg, uint8_t *c,
+			size_t count)
 {
 	int err;
-	struct tc_aes_key_sched_struct s;
 
-	err = tc_aes128_set_encrypt_key(&s, key);
-	__ASSERT(err == TC_CRYPTO_SUCCESS, "Key set failed");
+	k_mutex_lock(&session_mutex, K_FOREVER);
+
+	if (!session_key_matches(key)) {
+		err = tc_aes128_set_encrypt_key(&session, key);
+		__ASSERT(err == TC_CRYPTO_SUCCESS, "Key set failed");
+		session_valid = (err == TC_CRYPTO_SUCCESS);
+	}
+
+	for (size_t i = 0; session_valid && i < count; i++) {
+		err = tc_aes_encrypt(&c[i * ECB_AES_BLOCK_SIZE],
+				     &msg[i * ECB_AES_BLOCK_SIZE], &session);
+		__ASSERT(err == TC_CRYPTO_SUCCESS, "Encryption failed");
+	}
 
-	err = tc_aes_encrypt(c, msg, &s);
-	__ASSERT(err == TC_CRYPTO_SUCCESS, "Encryption failed");
+	k_mutex_unlock(&session_mutex);
 }
 #endif
 
@@ -102,8 +190,24 @@ zb_uint32_t zb_random_seed(void)
 void zb_osif_aes_init(void)
 {
 #if CONFIG_CRYPTO_NRF_ECB
+	k_mutex_lock(&session_mutex, K_FOREVER);
 	dev = DEVICE_DT_GET(DT_INST(0, nordic_nrf_ecb));
 	__ASSERT(device_is_ready(dev), "Crypto driver not found");
+	session_end();
+	k_mutex_unlock(&session_mutex);
+#elif CONFIG_ZIGBEE_USE_SOFTWARE_AES
+	k_mutex_lock(&session_mutex, K_FOREVER);
+	session_end();
+	k_mutex_unlock(&session_mutex);
+#endif
+}
+
+void zb_osif_aes_session_release(void)
+{
+#if CONFIG_CRYPTO_NRF_ECB
+	k_mutex_lock(&session_mutex, K_FOREVER);
+	session_end();
+	k_mutex_unlock(&session_mutex);
 #endif
 }
 
@@ -114,5 +218,16 @@ void zb_osif_aes128_hw_encrypt(zb_uint8_t *key, zb_uint8_t *msg, zb_uint8_t *c)
 		return;
 	}
 
-	encrypt_aes(key, msg, c);
+	encrypt_aes(key, msg, c, 1);
+}
+
+void zb_osif_aes128_hw_encrypt_blocks(const uint8_t *key, const uint8_t *msg,
+				      uint8_t *c, size_t count)
+{
+	if (!(c && msg && key)) {
+		__ASSERT(false, "NULL argument passed");
+		return;
+	}
+
+	encrypt_aes(key, msg, c, count);
 }
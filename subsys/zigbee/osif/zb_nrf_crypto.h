@@ -7,7 +7,32 @@
 #ifndef ZB_NRF_CRYPTO_H__
 #define ZB_NRF_CRYPTO_H__
 
+#include <stddef.h>
+#include <zephyr/types.h>
+
 void zb_osif_rng_init(void);
 void zb_osif_aes_init(void);
 
+/**@brief Release the ECB peripheral held by the Zigbee AES session.
+ *
+ * With the nRF ECB crypto driver, the cipher session stays open between
+ * encryptions with the same key, and the driver has a single session. Other
+ * users of the driver must call this function before they begin their own
+ * session. The next Zigbee encryption opens the session again.
+ */
+void zb_osif_aes_session_release(void);
+
+/**@brief Encrypt consecutive blocks with AES-128 in ECB mode.
+ *
+ * Works like zb_osif_aes128_hw_encrypt(), for all blocks of a frame in one
+ * call.
+ *
+ * @param key   128-bit key.
+ * @param msg   Plaintext blocks.
+ * @param c     Buffer for the ciphertext blocks.
+ * @param count Number of 16-byte blocks to encrypt.
+ */
+void zb_osif_aes128_hw_encrypt_blocks(const uint8_t *key, const uint8_t *msg,
+				      uint8_t *c, size_t count);
+
 #endif /* ZB_NRF_CRYPTO_H__ */
@@ -10,6 +10,8 @@
 
 #include <zboss_api.h>
 
+#include "zb_nrf_nvram_cache.h"
+
 #ifdef ZB_USE_NVRAM
 
 /* ZBOSS uses two virtual pages in the same size. */
@@ -43,6 +45,10 @@ void zb_osif_nvram_init(const zb_char_t *name)
 		LOG_ERR("Can't open ZBOSS NVRAM flash area");
 	}
 
+#if defined(CONFIG_ZIGBEE_NVRAM_CACHE)
+	zb_nvram_cache_init(fa);
+#endif
+
 #ifdef ZB_PRODUCTION_CONFIG
 	ret = flash_area_open(PM_ZBOSS_PRODUCT_CONFIG_ID, &fa_pc);
 	if (ret) {
@@ -89,7 +95,11 @@ zb_ret_t zb_osif_nvram_read(zb_uint8_t page, zb_uint32_t pos, zb_uint8_t *buf,
 
 	uint32_t flash_addr = get_page_base_offset(page) + pos;
 
+#if defined(CONFIG_ZIGBEE_NVRAM_CACHE)
+	int err = zb_nvram_cache_read(flash_addr, buf, len);
+#else
 	int err = flash_area_read(fa, flash_addr, buf, len);
+#endif
 
 	if (err) {
 		LOG_ERR("Read error: %d", err);
@@ -126,7 +136,11 @@ zb_ret_t zb_osif_nvram_write(zb_uint8_t page, zb_uint32_t pos, void *buf,
 	LOG_DBG("Function: %s, page: %d, pos: %d, len: %d",
 		__func__, page, pos, len);
 
+#if defined(CONFIG_ZIGBEE_NVRAM_CACHE)
+	int err = zb_nvram_cache_write(flash_addr, buf, len);
+#else
 	int err = flash_area_write(fa, flash_addr, buf, len);
+#endif
 
 	if (err) {
 		LOG_ERR("Write error: %d", err);
@@ -141,8 +155,13 @@ zb_ret_t zb_osif_nvram_erase_async(zb_uint8_t page)
 	zb_ret_t ret = RET_OK;
 
 	if (page < zb_get_nvram_page_count()) {
+#if defined(CONFIG_ZIGBEE_NVRAM_CACHE)
+		int err = zb_nvram_cache_erase(get_page_base_offset(page),
+					       zb_get_nvram_page_length());
+#else
 		int err = flash_area_erase(fa, get_page_base_offset(page),
 					   zb_get_nvram_page_length());
+#endif
 		if (err) {
 			LOG_ERR("Erase error: %d", err);
 			ret = RET_ERROR;
@@ -154,12 +173,22 @@ zb_ret_t zb_osif_nvram_erase_async(zb_uint8_t page)
 
 void zb_osif_nvram_wait_for_last_op(void)
 {
-	/* empty for synchronous erase and write */
+	/* empty for synchronous erase and write, pending cached writes are
+	 * visible to reads.
+	 */
 }
 
 void zb_osif_nvram_flush(void)
 {
+#if defined(CONFIG_ZIGBEE_NVRAM_CACHE)
+	int err = zb_nvram_cache_flush();
+
+	if (err) {
+		LOG_ERR("Flush error: %d", err);
+	}
+#else
 	/* empty for synchronous erase and write */
+#endif
 }
 
 
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <sys/util.h>
+#include <logging/log.h>
+
+#include "zb_nrf_nvram_cache.h"
+
+#define LINE_SIZE CONFIG_ZIGBEE_NVRAM_CACHE_LINE_SIZE
+#define LINE_COUNT CONFIG_ZIGBEE_NVRAM_CACHE_LINE_COUNT
+
+BUILD_ASSERT((LINE_SIZE & (LINE_SIZE - 1)) == 0,
+	     "The cache line size must be a power of two.");
+BUILD_ASSERT(LINE_SIZE <= UINT16_MAX, "The cache line size is too large.");
+
+LOG_MODULE_DECLARE(zboss_osif, CONFIG_ZBOSS_OSIF_LOG_LEVEL);
+
+struct cache_line {
+	/* Offset of the line in the flash area. */
+	off_t base;
+	/* Pending range within the line. */
+	uint16_t start;
+	uint16_t end;
+	uint8_t data[LINE_SIZE];
+};
+
+static struct {
+	const struct flash_area *fa;
+	struct cache_line lines[LINE_COUNT];
+	/* The lines are used as a FIFO, starting at the oldest pending line. */
+	uint8_t head;
+	uint8_t count;
+	struct zb_nvram_cache_stats stats;
+} cache;
+
+static struct cache_line *line_get(uint8_t idx)
+{
+	return &cache.lines[(cache.head + idx) % LINE_COUNT];
+}
+
+static int line_flush_oldest(void)
+{
+	struct cache_line *line = line_get(0);
+	int err;
+
+	err = flash_area_write(cache.fa, line->base + line->start,
+			       &line->data[line->start],
+			       line->end - line->start);
+	if (err) {
+		/* Keep the line, so no later line reaches the flash before
+		 * it does.
+		 */
+		LOG_ERR("Cache flush error: %d", err);
+		cache.stats.errors++;
+		return err;
+	}
+
+	cache.head = (cache.head + 1) % LINE_COUNT;
+	cache.count--;
+	cache.stats.flushes++;
+
+	return err;
+}
+
+/* Write a chunk that doesn't cross a line boundary. Returns 1 if the chunk
+ * was merged into the newest pending line.
+ */
+static int line_write(off_t off, const uint8_t *data, size_t len)
+{
+	off_t base = off & ~((off_t)LINE_SIZE - 1);
+	uint16_t start = off - base;
+	struct cache_line *line;
+	int err;
+
+	/* Only appending to the newest line keeps the flash writes in the
+	 * same order as the writes to the cache.
+	 */
+	if (cache.count) {
+		line = line_get(cache.count - 1);
+		if (line->base == base && line->end == start) {
+			memcpy(&line->data[start], data, len);
+			line->end += len;
+			return 1;
+		}
+	}
+
+	if (cache.count == LINE_COUNT) {
+		err = line_flush_oldest();
+		if (err) {
+			return err;
+		}
+	}
+
+	line = line_get(cache.count++);
+	line->base = base;
+	line->start = start;
+	line->end = start + len;
+	memcpy(&line->data[start], data, len);
+
+	return 0;
+}
+
+void zb_nvram_cache_init(const struct flash_area *fa)
+{
+	cache.fa = fa;
+	cache.head = 0;
+	cache.count = 0;
+}
+
+int zb_nvram_cache_read(off_t off, void *buf, size_t len)
+{
+	bool hit = false;
+	int err;
+
+	cache.stats.reads++;
+
+	err = flash_area_read(cache.fa, off, buf, len);
+	if (err) {
+		return err;
+	}
+
+	/* Newer lines overwrite older ones: */
+	for (uint8_t i = 0; i < cache.count; i++) {
+		struct cache_line *line = line_get(i);
+		off_t lo = MAX(off, line->base + line->start);
+		off_t hi = MIN(off + (off_t)len, line->base + line->end);
+
+		if (lo < hi) {
+			memcpy((uint8_t *)buf + (lo - off),
+			       &line->data[lo - line->base], hi - lo);
+			hit = true;
+		}
+	}
+
+	if (hit) {
+		cache.stats.read_hits++;
+	}
+
+	return 0;
+}
+
+int zb_nvram_cache_write(off_t off, const void *buf, size_t len)
+{
+	const uint8_t *data = buf;
+	bool hit = true;
+
+	cache.stats.writes++;
+
+	while (len) {
+		size_t chunk = MIN(len, LINE_SIZE - (off & (LINE_SIZE - 1)));
+		int err = line_write(off, data, chunk);
+
+		if (err < 0) {
+			return err;
+		}
+
+		hit = hit && (err == 1);
+		off += chunk;
+		data += chunk;
+		len -= chunk;
+	}
+
+	if (hit) {
+		cache.stats.write_hits++;
+	}
+
+	return 0;
+}
+
+int zb_nvram_cache_erase(off_t off, size_t len)
+{
+	/* ZBOSS only erases a page once its contents have been written to the
+	 * other page, so everything written before the erase has to be in
+	 * flash first.
+	 */
+	int err = zb_nvram_cache_flush();
+
+	if (err) {
+		return err;
+	}
+
+	return flash_area_erase(cache.fa, off, len);
+}
+
+int zb_nvram_cache_flush(void)
+{
+	while (cache.count) {
+		int err = line_flush_oldest();
+
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+void zb_nvram_cache_stats_get(struct zb_nvram_cache_stats *stats)
+{
+	*stats = cache.stats;
+}
+
+void zb_nvram_cache_stats_reset(void)
+{
+	memset(&cache.stats, 0, sizeof(cache.stats));
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/** @file
+ * @brief Write-back cache for the ZBOSS NVRAM flash area.
+ */
+
+#ifndef ZB_NRF_NVRAM_CACHE_H__
+#define ZB_NRF_NVRAM_CACHE_H__
+
+#include <zephyr/types.h>
+#include <sys/types.h>
+#include <storage/flash_map.h>
+
+/**
+ * @defgroup zigbee_nvram_cache Zigbee NVRAM cache
+ * @{
+ *
+ * Writes are kept in RAM cache lines that are aligned to
+ * @kconfig{CONFIG_ZIGBEE_NVRAM_CACHE_LINE_SIZE}, and consecutive writes to
+ * the same line are merged into a single flash write. The cache lines are
+ * written to flash in the order they were allocated, so the flash contents
+ * are always a prefix of the sequence of writes, even if the power fails.
+ *
+ * All functions except @ref zb_nvram_cache_stats_get must be called from
+ * the ZBOSS thread.
+ */
+
+/** Zigbee NVRAM cache statistics. */
+struct zb_nvram_cache_stats {
+	/** Number of reads. */
+	uint32_t reads;
+	/** Number of reads served at least partially from the cache. */
+	uint32_t read_hits;
+	/** Number of writes. */
+	uint32_t writes;
+	/** Number of writes merged into the pending cache lines. */
+	uint32_t write_hits;
+	/** Number of cache lines written to flash. */
+	uint32_t flushes;
+	/** Number of failed flash writes. */
+	uint32_t errors;
+};
+
+/**@brief Initialize the cache.
+ *
+ * Pending writes are discarded.
+ *
+ * @param fa Flash area to cache.
+ */
+void zb_nvram_cache_init(const struct flash_area *fa);
+
+/**@brief Read from the flash area, including any pending writes.
+ *
+ * @param off Offset in the flash area.
+ * @param buf Buffer to read into.
+ * @param len Number of bytes to read.
+ *
+ * @return 0 on success, or a negative error code from the flash area.
+ */
+int zb_nvram_cache_read(off_t off, void *buf, size_t len);
+
+/**@brief Write to the flash area through the cache.
+ *
+ * The oldest cache line is written to flash if no cache line is available.
+ *
+ * @param off Offset in the flash area.
+ * @param buf Data to write.
+ * @param len Number of bytes to write.
+ *
+ * @return 0 on success, or a negative error code from the flash area.
+ */
+int zb_nvram_cache_write(off_t off, const void *buf, size_t len);
+
+/**@brief Erase a part of the flash area.
+ *
+ * All pending writes are written to flash before the erase.
+ *
+ * @param off Offset in the flash area.
+ * @param len Number of bytes to erase.
+ *
+ * @return 0 on success, or a negative error code from the flash area.
+ */
+int zb_nvram_cache_erase(off_t off, size_t len);
+
+/**@brief Write all pending cache lines to flash.
+ *
+ * Stops at the first line that fails to be written. The line stays in the
+ * cache, so the flash only ever holds a prefix of the writes.
+ *
+ * @return 0 on success, or the error code from the flash area.
+ */
+int zb_nvram_cache_flush(void);
+
+/**@brief Get the cache statistics.
+ *
+ * @param stats Statistics structure to fill.
+ */
+void zb_nvram_cache_stats_get(struct zb_nvram_cache_stats *stats);
+
+/**@brief Reset the cache statistics. */
+void zb_nvram_cache_stats_reset(void);
+
+/**
+ * @}
+ */
+
+#endif /* ZB_NRF_NVRAM_CACHE_H__ */
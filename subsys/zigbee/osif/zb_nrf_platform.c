@@ -5,6 +5,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <kernel.h>
 #include <sys/reboot.h>
 #include <logging/log.h>
@@ -65,6 +66,13 @@ LOG_MODULE_REGISTER(zboss_osif, CONFIG_ZBOSS_OSIF_LOG_LEVEL);
 /* Signal object to indicate that frame has been received */
 static struct k_poll_signal zigbee_sig = K_POLL_SIGNAL_INITIALIZER(zigbee_sig);
 
+/* Mask of the events notified since the last zigbee_event_poll() call. */
+static atomic_t zigbee_events = ATOMIC_INIT(0);
+
+#ifdef CONFIG_ZIGBEE_EVENT_STATS
+static struct zigbee_event_stats event_stats;
+#endif
+
 /** Global mutex to protect access to the ZBOSS global state.
  *
  * @note Functions for locking/unlocking the mutex are called directly from
@@ -571,9 +579,46 @@ __weak zb_uint32_t zb_get_utc_time(void)
 
 void zigbee_event_notify(zigbee_event_t event)
 {
+	(void)atomic_or(&zigbee_events, BIT(event));
 	k_poll_signal_raise(&zigbee_sig, event);
 }
 
+#ifdef CONFIG_ZIGBEE_EVENT_STATS
+static void event_stats_update(atomic_val_t events, bool slept,
+			       uint32_t time_slept_us)
+{
+	event_stats.polls++;
+	event_stats.slept_us += time_slept_us;
+
+	if (!slept) {
+		event_stats.pending++;
+	} else if (!events) {
+		event_stats.timeouts++;
+	}
+
+	for (int i = 0; i < ZIGBEE_EVENT_COUNT; i++) {
+		if (events & BIT(i)) {
+			event_stats.events[i]++;
+		}
+	}
+}
+
+void zigbee_event_stats_get(struct zigbee_event_stats *stats)
+{
+	*stats = event_stats;
+}
+
+void zigbee_event_stats_reset(void)
+{
+	memset(&event_stats, 0, sizeof(event_stats));
+}
+#else
+static inline void event_stats_update(atomic_val_t events, bool slept,
+				      uint32_t time_slept_us)
+{
+}
+#endif /* CONFIG_ZIGBEE_EVENT_STATS */
+
 uint32_t zigbee_event_poll(uint32_t timeout_us)
 {
 	/* Configure event/signals to wait for in zigbee_event_poll function. */
@@ -583,21 +628,37 @@ uint32_t zigbee_event_poll(uint32_t timeout_us)
 					 &zigbee_sig),
 	};
 
-	unsigned int signaled = 0;
-	int result;
+	atomic_val_t events;
+	uint32_t time_slept_us;
+	bool slept = false;
 	/* Store timestamp of event polling start. */
 	int64_t timestamp_poll_start = k_uptime_ticks();
 
-	k_poll(wait_events, 1, K_USEC(timeout_us));
+	/* Events notified while ZBOSS was busy are handled right away. */
+	if (!atomic_get(&zigbee_events)) {
+		k_poll(wait_events, 1, K_USEC(timeout_us));
+		slept = true;
+	}
 
-	k_poll_signal_check(&zigbee_sig, &signaled, &result);
-	if (signaled) {
-		k_poll_signal_reset(&zigbee_sig);
+	/* Take all events notified so far. The signal is reset after the
+	 * mask is cleared, so an event notified in between is kept in the
+	 * mask, and the next poll returns right away.
+	 */
+	events = atomic_clear(&zigbee_events);
+	k_poll_signal_reset(&zigbee_sig);
+	wait_events[0].state = K_POLL_STATE_NOT_READY;
 
-		LOG_DBG("Received new Zigbee event: 0x%02x", result);
+	if (events) {
+		LOG_DBG("Received new Zigbee events: 0x%02lx",
+			(unsigned long)events);
 	}
 
-	return k_ticks_to_us_floor32(k_uptime_ticks() - timestamp_poll_start);
+	time_slept_us =
+		k_ticks_to_us_floor32(k_uptime_ticks() - timestamp_poll_start);
+
+	event_stats_update(events, slept, time_slept_us);
+
+	return time_slept_us;
 }
 
 void zigbee_enable(void)
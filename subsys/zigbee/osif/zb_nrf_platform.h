@@ -19,8 +19,26 @@ typedef enum {
 	ZIGBEE_EVENT_TX_DONE,
 	ZIGBEE_EVENT_RX_DONE,
 	ZIGBEE_EVENT_APP,
+	/** Number of event types. */
+	ZIGBEE_EVENT_COUNT,
 } zigbee_event_t;
 
+/** Statistics of the ZBOSS thread wake-ups. */
+struct zigbee_event_stats {
+	/** Number of zigbee_event_poll() calls. */
+	uint32_t polls;
+	/** Number of polls that returned without sleeping, because events were
+	 *  notified while the ZBOSS thread was busy.
+	 */
+	uint32_t pending;
+	/** Number of polls that slept until the timeout without any event. */
+	uint32_t timeouts;
+	/** Number of polls that handled each event type. */
+	uint32_t events[ZIGBEE_EVENT_COUNT];
+	/** Total time spent in zigbee_event_poll(), in microseconds. */
+	uint64_t slept_us;
+};
+
 /**
  * @defgroup zigbee_zboss_osif Zigbee ZBOSS OSIF API
  * @{
@@ -72,6 +90,9 @@ bool zigbee_is_zboss_thread_suspended(void);
 int zigbee_init(void);
 
 /**@brief Notify the ZBOSS thread about a new event.
+ *
+ * Events notified while the ZBOSS thread is busy are accumulated, and
+ * handled by the next call to @ref zigbee_event_poll.
  *
  * @param[in] event  Event to notify.
  */
@@ -80,6 +101,9 @@ void zigbee_event_notify(zigbee_event_t event);
 /**@brief Function which waits for event in case
  *        of empty Zigbee stack scheduler queue.
  *
+ * The function returns without blocking if any events were notified since
+ * the previous call.
+ *
  * @param[in] timeout_us  Maximum amount of time, in microseconds
  *                        for which the ZBOSS task processing may be blocked.
  *
@@ -87,6 +111,17 @@ void zigbee_event_notify(zigbee_event_t event);
  */
 uint32_t zigbee_event_poll(uint32_t timeout_us);
 
+#ifdef CONFIG_ZIGBEE_EVENT_STATS
+/**@brief Get the statistics of the ZBOSS thread wake-ups.
+ *
+ * @param[out] stats  Statistics structure to fill.
+ */
+void zigbee_event_stats_get(struct zigbee_event_stats *stats);
+
+/**@brief Reset the statistics of the ZBOSS thread wake-ups. */
+void zigbee_event_stats_reset(void);
+#endif /* CONFIG_ZIGBEE_EVENT_STATS */
+
 /**@brief Function for checking if the Zigbee NVRAM has been initialised.
  *
  * @retval ZB_TRUE  Zigbee NVRAM is initialised.
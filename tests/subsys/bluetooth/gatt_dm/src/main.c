@@ -9,6 +9,7 @@
 #include <sys/util.h>
 #include <bluetooth/uuid.h>
 #include <bluetooth/gatt_dm.h>
+#include <bluetooth/services/lbs.h>
 #include "../mock/gatt_discover_mock.h"
 
 /* Timeout for the discovery in ms */
@@ -44,6 +45,17 @@ const struct bt_gatt_attr discover_sim[] = {
 	BT_GATT_DISCOVER_MOCK_DESC(16, BT_UUID_DIS_MANUFACTURER_NAME),
 };
 
+const struct bt_gatt_attr discover_sim_vendor[] = {
+	/* LBS */
+	BT_GATT_DISCOVER_MOCK_SERV(1, BT_UUID_LBS, 7),
+	BT_GATT_DISCOVER_MOCK_CHRC(2, BT_UUID_LBS_BUTTON, BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY),
+	BT_GATT_DISCOVER_MOCK_DESC(3, BT_UUID_LBS_BUTTON),
+	BT_GATT_DISCOVER_MOCK_DESC(4, BT_UUID_GATT_CCC),
+
+	BT_GATT_DISCOVER_MOCK_CHRC(5, BT_UUID_LBS_LED, BT_GATT_CHRC_WRITE),
+	BT_GATT_DISCOVER_MOCK_DESC(6, BT_UUID_LBS_LED),
+	BT_GATT_DISCOVER_MOCK_DESC(7, BT_UUID_GATT_CCC),
+};
 
 void test_cb_completed(struct bt_gatt_dm *dm, void *context)
 {
@@ -79,6 +91,12 @@ void test_setup(void)
 	bt_gatt_discover_mock_setup(discover_sim, ARRAY_SIZE(discover_sim));
 }
 
+void test_setup_vendor(void)
+{
+	k_sem_reset(&discovery_finished);
+	bt_gatt_discover_mock_setup(discover_sim_vendor, ARRAY_SIZE(discover_sim_vendor));
+}
+
 struct bt_gatt_dm *run_dm(const struct bt_uuid *svc_uuid)
 {
 	struct bt_gatt_dm *dm;
@@ -376,6 +394,42 @@ void test_gatt_generic_serv(void)
 	/* No cleanup here - cleanup is done in run_dm_next */
 }
 
+/* 128-bit UUIDs repeated in the service must be stored only once */
+void test_gatt_LBS_uuid_shared(void)
+{
+	struct bt_gatt_dm *dm;
+	const struct bt_gatt_dm_attr *attr_chrc;
+	const struct bt_gatt_dm_attr *attr_desc;
+	const struct bt_gatt_chrc *chrc_val;
+
+	dm = run_dm(BT_UUID_LBS);
+	zassert_not_null(dm, "Device Manager pointer not set");
+	zassert_equal(7,
+		      bt_gatt_dm_attr_cnt(dm),
+		      "Unexpected number of attributes detected: %d",
+		      bt_gatt_dm_attr_cnt(dm));
+
+	attr_chrc = bt_gatt_dm_char_by_uuid(dm, BT_UUID_LBS_LED);
+	zassert_not_null(attr_chrc, "Unexpected NULL instead of LBS_LED");
+	zassert_equal(5, attr_chrc->handle, "Unexpected handle: %d", attr_chrc->handle);
+	chrc_val = bt_gatt_dm_attr_chrc_val(attr_chrc);
+	zassert_not_null(chrc_val, "Unexpected NULL instead of LBS_LED value");
+	attr_desc = bt_gatt_dm_desc_by_uuid(dm, attr_chrc, BT_UUID_LBS_LED);
+	zassert_not_null(attr_desc, "Unexpected NULL");
+	zassert_equal(6, attr_desc->handle, "Unexpected handle: %d", attr_desc->handle);
+	zassert_equal_ptr(chrc_val->uuid, attr_desc->uuid, "UUID stored twice");
+
+	attr_chrc = bt_gatt_dm_char_by_uuid(dm, BT_UUID_LBS_BUTTON);
+	zassert_not_null(attr_chrc, "Unexpected NULL instead of LBS_BUTTON");
+	chrc_val = bt_gatt_dm_attr_chrc_val(attr_chrc);
+	attr_desc = bt_gatt_dm_attr_by_handle(dm, 3);
+	zassert_not_null(attr_desc, "Unexpected NULL");
+	zassert_equal_ptr(chrc_val->uuid, attr_desc->uuid, "UUID stored twice");
+
+	bt_gatt_dm_data_release(dm);
+	zassert_equal(0, bt_gatt_dm_attr_cnt(dm), "Parameter count after clearing: %d", bt_gatt_dm_attr_cnt(dm));
+}
+
 void test_main(void)
 {
 	ztest_test_suite(
@@ -387,7 +441,8 @@ void test_main(void)
 		ztest_unit_test_setup_teardown(test_gatt_HIDS_attr_by_handle, test_setup, unit_test_noop),
 		ztest_unit_test_setup_teardown(test_gatt_HIDS_next_chrc_access, test_setup, unit_test_noop),
 		ztest_unit_test_setup_teardown(test_gatt_HIDS_chrc_by_uuid, test_setup, unit_test_noop),
-		ztest_unit_test_setup_teardown(test_gatt_generic_serv, test_setup, unit_test_noop)
+		ztest_unit_test_setup_teardown(test_gatt_generic_serv, test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_gatt_LBS_uuid_shared, test_setup_vendor, unit_test_noop)
 	);
 
 	ztest_run_test_suite(test_gatt);
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <ztest.h>
+#include "light_ctrl_reg.h"
+
+/* Regulator step interval used in the step responses. */
+#define REG_INT 100
+/* Illuminance contributed by every step of linear lightness. */
+#define PLANT_GAIN 0.01f
+/* Number of regulator steps for every daylight level. */
+#define STEPS 1000
+/* Maximum deviation between the two regulator implementations' outputs. */
+#define OUTPUT_TOLERANCE 4
+
+#define Q16(_val) ((int64_t)((_val) * LIGHT_CTRL_REG_Q16_ONE))
+#define Q16_SAT ((int64_t)INT32_MAX * LIGHT_CTRL_REG_Q16_ONE)
+
+struct reg_sim {
+	/* Floating point regulator, closing the loop: */
+	float i_float;
+	uint16_t out_float;
+	/* Fixed point regulator, fed the same ambient illuminance: */
+	int64_t i_q16;
+	uint16_t out_q16;
+	/* Fixed point regulator, closing its own loop: */
+	int64_t i_loop;
+	uint16_t out_loop;
+};
+
+/* Illuminance sensors report in centilux: */
+static struct sensor_value sensor_lux(float lux)
+{
+	int32_t centi_lux = (int32_t)(lux * 100.0f);
+
+	return (struct sensor_value){
+		.val1 = centi_lux / 100,
+		.val2 = (centi_lux % 100) * 10000,
+	};
+}
+
+static float sensor_to_float(const struct sensor_value *val)
+{
+	return val->val1 + val->val2 / 1000000.0f;
+}
+
+static void step_response(const struct bt_mesh_light_ctrl_srv_reg_cfg *cfg,
+			  struct reg_sim *sim, float target, float daylight)
+{
+	struct sensor_value target_lux = sensor_lux(target);
+	struct sensor_value amb;
+	struct sensor_value amb_loop;
+	bool idle_float;
+	bool idle_q16;
+	bool idle_loop;
+
+	for (int i = 0; i < STEPS; i++) {
+		amb = sensor_lux(daylight + sim->out_float * PLANT_GAIN);
+		amb_loop = sensor_lux(daylight + sim->out_loop * PLANT_GAIN);
+
+		sim->out_float = light_ctrl_reg_step_float(
+			cfg, &sim->i_float, sensor_to_float(&target_lux),
+			sensor_to_float(&amb), REG_INT, &idle_float);
+		sim->out_q16 = light_ctrl_reg_step_q16(
+			cfg, &sim->i_q16,
+			light_ctrl_reg_q16_from_sensor(&target_lux),
+			light_ctrl_reg_q16_from_sensor(&amb), REG_INT,
+			&idle_q16);
+		sim->out_loop = light_ctrl_reg_step_q16(
+			cfg, &sim->i_loop,
+			light_ctrl_reg_q16_from_sensor(&target_lux),
+			light_ctrl_reg_q16_from_sensor(&amb_loop), REG_INT,
+			&idle_loop);
+
+		/* Given the same input, the implementations should only
+		 * differ by rounding:
+		 */
+		zassert_within(sim->out_float, sim->out_q16, OUTPUT_TOLERANCE,
+			       "Step %d: float %u, q16 %u", i, sim->out_float,
+			       sim->out_q16);
+		zassert_equal(idle_float, idle_q16, "Step %d", i);
+	}
+
+	/* Both regulators should have settled within the dead zone, or at
+	 * zero output if the daylight alone is sufficient.
+	 */
+	float accuracy = (cfg->accuracy * target) / (2 * 100.0f) + PLANT_GAIN;
+
+	if (daylight >= target) {
+		zassert_equal(sim->out_float, 0, "Float output %u",
+			      sim->out_float);
+		zassert_equal(sim->out_loop, 0, "Q16 output %u", sim->out_loop);
+		return;
+	}
+
+	zassert_true(idle_float, "Float regulator not settled");
+	zassert_true(idle_loop, "Q16 regulator not settled");
+	zassert_within(daylight + sim->out_float * PLANT_GAIN, target,
+		       accuracy, "Float regulator out of accuracy");
+	zassert_within(daylight + sim->out_loop * PLANT_GAIN, target,
+		       accuracy, "Q16 regulator out of accuracy");
+}
+
+static void test_q16_from_float(void)
+{
+	zassert_equal(light_ctrl_reg_q16_from_float(0.0f), 0, NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(-0.0f), 0, NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(1.0f), Q16(1), NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(0.5f), Q16(0.5), NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(250.75f), Q16(250.75),
+		      NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(-25.0f), Q16(-25), NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(1000.0f), Q16(1000), NULL);
+
+	/* Fractions are truncated: */
+	zassert_equal(light_ctrl_reg_q16_from_float(0.3f), 19660, NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(1e-6f), 0, NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(1e-30f), 0, NULL);
+
+	/* Out of range values saturate: */
+	zassert_equal(light_ctrl_reg_q16_from_float(1e12f), Q16_SAT, NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(-1e12f), -Q16_SAT, NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(INFINITY), Q16_SAT, NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(-INFINITY), -Q16_SAT,
+		      NULL);
+	zassert_equal(light_ctrl_reg_q16_from_float(NAN), 0, NULL);
+}
+
+static void test_q16_from_sensor(void)
+{
+	zassert_equal(light_ctrl_reg_q16_from_sensor(
+			      &(struct sensor_value){ 500, 0 }),
+		      Q16(500), NULL);
+	zassert_equal(light_ctrl_reg_q16_from_sensor(
+			      &(struct sensor_value){ 1, 500000 }),
+		      Q16(1.5), NULL);
+	zassert_equal(light_ctrl_reg_q16_from_sensor(
+			      &(struct sensor_value){ -1, -500000 }),
+		      Q16(-1.5), NULL);
+	zassert_equal(light_ctrl_reg_q16_from_sensor(
+			      &(struct sensor_value){ 16777214, 0 }),
+		      Q16(16777214), NULL);
+}
+
+static void test_step_response(void)
+{
+	const struct bt_mesh_light_ctrl_srv_reg_cfg cfgs[] = {
+		{ .kiu = 250, .kid = 25, .kpu = 80, .kpd = 80, .accuracy = 2 },
+		{ .kiu = 40.5f, .kid = 20.25f, .kpu = 0.3f, .kpd = 1.5f,
+		  .accuracy = 5 },
+		{ .kiu = 1000, .kid = 1000, .kpu = 0, .kpd = 0, .accuracy = 0 },
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(cfgs); i++) {
+		struct reg_sim sim = {};
+
+		step_response(&cfgs[i], &sim, 500.0f, 0.0f);
+		step_response(&cfgs[i], &sim, 500.0f, 300.0f);
+		step_response(&cfgs[i], &sim, 200.0f, 300.0f);
+		step_response(&cfgs[i], &sim, 650.25f, 100.0f);
+	}
+}
+
+static void test_saturation(void)
+{
+	const struct bt_mesh_light_ctrl_srv_reg_cfg cfg = {
+		.kiu = 1e9f, .kid = 1e9f, .kpu = 1e9f, .kpd = 1e9f,
+	};
+	int64_t max = light_ctrl_reg_q16_from_sensor(
+		&(struct sensor_value){ 16777214, 0 });
+	int64_t i = 0;
+	bool idle;
+
+	/* The outputs must saturate instead of wrapping around: */
+	zassert_equal(light_ctrl_reg_step_q16(&cfg, &i, max, 0, REG_INT, &idle),
+		      UINT16_MAX, NULL);
+	zassert_false(idle, NULL);
+	zassert_equal(light_ctrl_reg_step_q16(&cfg, &i, max, 0, REG_INT, &idle),
+		      UINT16_MAX, NULL);
+	zassert_equal(light_ctrl_reg_step_q16(&cfg, &i, 0, max, REG_INT, &idle),
+		      0, NULL);
+	zassert_equal(i, 0, NULL);
+}
+
+static void test_interval_next(void)
+{
+	zassert_equal(light_ctrl_reg_interval_next(100, true, 100, 800), 200,
+		      NULL);
+	zassert_equal(light_ctrl_reg_interval_next(400, true, 100, 800), 800,
+		      NULL);
+	zassert_equal(light_ctrl_reg_interval_next(800, true, 100, 800), 800,
+		      NULL);
+	zassert_equal(light_ctrl_reg_interval_next(800, false, 100, 800), 100,
+		      NULL);
+	zassert_equal(light_ctrl_reg_interval_next(100, true, 100, 100), 100,
+		      NULL);
+	zassert_equal(light_ctrl_reg_interval_next(60, true, 60, 100), 100,
+		      NULL);
+}
+
+static void test_in_band(void)
+{
+	/* 2 % accuracy around 500 lux is 495 to 505 lux. */
+	zassert_true(light_ctrl_reg_in_band(2, 50000, 50000), NULL);
+	zassert_true(light_ctrl_reg_in_band(2, 50000, 49500), NULL);
+	zassert_true(light_ctrl_reg_in_band(2, 50000, 50500), NULL);
+	zassert_false(light_ctrl_reg_in_band(2, 50000, 49499), NULL);
+	zassert_false(light_ctrl_reg_in_band(2, 50000, 50501), NULL);
+	zassert_false(light_ctrl_reg_in_band(0, 50000, 50001), NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(light_ctrl_reg_test,
+			 ztest_unit_test(test_q16_from_float),
+			 ztest_unit_test(test_q16_from_sensor),
+			 ztest_unit_test(test_step_response),
+			 ztest_unit_test(test_saturation),
+			 ztest_unit_test(test_interval_next),
+			 ztest_unit_test(test_in_band)
+			 );
+
+	ztest_run_test_suite(light_ctrl_reg_test);
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <bluetooth/mesh.h>
+#include <sys/byteorder.h>
+#include "model_utils.h"
+
+#define OP_A 0x8204
+#define OP_B 0x8205
+#define PUB_ADDR 0xc000
+#define WINDOW K_MSEC(CONFIG_BT_MESH_MODEL_PUB_COALESCE_WINDOW * 2)
+
+/** Mocks ******************************************/
+
+BT_MESH_MODEL_PUB_DEFINE(pub0, NULL, 3);
+BT_MESH_MODEL_PUB_DEFINE(pub1, NULL, 3);
+BT_MESH_MODEL_PUB_DEFINE(pub2, NULL, 3);
+BT_MESH_MODEL_PUB_DEFINE(pub3, NULL, 3);
+
+static struct bt_mesh_model models[] = {
+	BT_MESH_MODEL(0x1000, NULL, &pub0, NULL),
+	BT_MESH_MODEL(0x1001, NULL, &pub1, NULL),
+	BT_MESH_MODEL(0x1002, NULL, &pub2, NULL),
+	BT_MESH_MODEL(0x1003, NULL, &pub3, NULL),
+};
+
+static struct {
+	struct bt_mesh_model *model;
+	uint16_t op;
+	uint8_t val;
+} published[8];
+
+static int publish_count;
+static int publish_err;
+static int send_count;
+static bool provisioned;
+
+int bt_mesh_model_publish(struct bt_mesh_model *model)
+{
+	struct net_buf_simple *msg = model->pub->msg;
+
+	zassert_true(publish_count < ARRAY_SIZE(published), "Too many publications");
+	zassert_equal(msg->len, 3, "Wrong message length");
+
+	published[publish_count].model = model;
+	published[publish_count].op = sys_get_be16(&msg->data[0]);
+	published[publish_count].val = msg->data[2];
+	publish_count++;
+
+	return publish_err;
+}
+
+int bt_mesh_model_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
+		       struct net_buf_simple *msg,
+		       const struct bt_mesh_send_cb *cb, void *cb_data)
+{
+	send_count++;
+	return 0;
+}
+
+bool bt_mesh_is_provisioned(void)
+{
+	return provisioned;
+}
+
+int bt_mesh_msg_ack_ctx_prepare(struct bt_mesh_msg_ack_ctx *ack, uint32_t op,
+				uint16_t dst, void *user_data)
+{
+	return 0;
+}
+
+int bt_mesh_msg_ack_ctx_wait(struct bt_mesh_msg_ack_ctx *ack,
+			     k_timeout_t timeout)
+{
+	return 0;
+}
+
+void bt_mesh_msg_ack_ctx_clear(struct bt_mesh_msg_ack_ctx *ack)
+{
+}
+
+/** End Mocks **************************************/
+
+static int status_send(struct bt_mesh_model *model,
+		       struct bt_mesh_msg_ctx *ctx, uint16_t op, uint8_t val)
+{
+	NET_BUF_SIMPLE_DEFINE(buf, 3);
+
+	net_buf_simple_add_be16(&buf, op);
+	net_buf_simple_add_u8(&buf, val);
+
+	return model_status_send(model, ctx, &buf);
+}
+
+static void expect_published(int idx, struct bt_mesh_model *model, uint16_t op,
+			     uint8_t val)
+{
+	zassert_true(idx < publish_count, "Publication %d missing", idx);
+	zassert_equal_ptr(published[idx].model, model,
+			  "Publication %d from wrong model", idx);
+	zassert_equal(published[idx].op, op, "Publication %d: wrong opcode", idx);
+	zassert_equal(published[idx].val, val, "Publication %d: wrong value", idx);
+}
+
+static void setup(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(models); i++) {
+		models[i].elem_idx = (i == 2) ? 1 : 0;
+		models[i].mod_idx = i;
+		models[i].pub->addr = PUB_ADDR;
+	}
+
+	memset(published, 0, sizeof(published));
+	publish_count = 0;
+	publish_err = 0;
+	send_count = 0;
+	provisioned = true;
+}
+
+static void test_coalesce(void)
+{
+	setup();
+
+	zassert_ok(status_send(&models[0], NULL, OP_A, 1), "Send failed");
+	zassert_ok(status_send(&models[0], NULL, OP_A, 2), "Send failed");
+	zassert_equal(publish_count, 0, "Published before the window");
+
+	k_sleep(WINDOW);
+
+	zassert_equal(publish_count, 1, "Publications not coalesced");
+	expect_published(0, &models[0], OP_A, 2);
+}
+
+static void test_element_order(void)
+{
+	setup();
+
+	/* models[2] is on the second element: */
+	zassert_ok(status_send(&models[2], NULL, OP_A, 1), "Send failed");
+	zassert_ok(status_send(&models[0], NULL, OP_A, 2), "Send failed");
+	zassert_ok(status_send(&models[1], NULL, OP_A, 3), "Send failed");
+
+	k_sleep(WINDOW);
+
+	zassert_equal(publish_count, 3, "Wrong number of publications");
+	expect_published(0, &models[0], OP_A, 2);
+	expect_published(1, &models[1], OP_A, 3);
+	expect_published(2, &models[2], OP_A, 1);
+}
+
+static void test_opcode_change(void)
+{
+	setup();
+
+	zassert_ok(status_send(&models[0], NULL, OP_A, 1), "Send failed");
+	zassert_ok(status_send(&models[0], NULL, OP_B, 2), "Send failed");
+
+	/* The pending status is flushed before it gets overwritten: */
+	zassert_equal(publish_count, 1, "Pending status not flushed");
+	expect_published(0, &models[0], OP_A, 1);
+
+	k_sleep(WINDOW);
+
+	zassert_equal(publish_count, 2, "Wrong number of publications");
+	expect_published(1, &models[0], OP_B, 2);
+}
+
+static void test_full(void)
+{
+	setup();
+
+	zassert_ok(status_send(&models[0], NULL, OP_A, 1), "Send failed");
+	zassert_ok(status_send(&models[1], NULL, OP_A, 2), "Send failed");
+	zassert_ok(status_send(&models[2], NULL, OP_A, 3), "Send failed");
+	zassert_equal(publish_count, 0, "Published before the window");
+
+	/* No room for more pending publications: */
+	zassert_ok(status_send(&models[3], NULL, OP_A, 4), "Send failed");
+	zassert_equal(publish_count, 1, "Not sent immediately");
+	expect_published(0, &models[3], OP_A, 4);
+
+	k_sleep(WINDOW);
+
+	zassert_equal(publish_count, 4, "Wrong number of publications");
+}
+
+static void test_publish_error(void)
+{
+	setup();
+
+	publish_err = -EBUSY;
+
+	zassert_ok(status_send(&models[0], NULL, OP_A, 1), "Send failed");
+	zassert_ok(status_send(&models[1], NULL, OP_A, 2), "Send failed");
+
+	k_sleep(WINDOW);
+
+	/* A failing publication doesn't hold back the others: */
+	zassert_equal(publish_count, 2, "Wrong number of publications");
+	expect_published(0, &models[0], OP_A, 1);
+	expect_published(1, &models[1], OP_A, 2);
+}
+
+static void test_not_coalesced(void)
+{
+	struct bt_mesh_msg_ctx ctx = { .addr = 0x0001 };
+
+	setup();
+
+	/* Responses are sent immediately: */
+	zassert_ok(status_send(&models[0], &ctx, OP_A, 1), "Send failed");
+	zassert_equal(send_count, 1, "Response not sent");
+
+	models[1].pub->addr = BT_MESH_ADDR_UNASSIGNED;
+	zassert_equal(status_send(&models[1], NULL, OP_A, 2), -EADDRNOTAVAIL,
+		      "Published without address");
+
+	provisioned = false;
+	zassert_equal(status_send(&models[0], NULL, OP_A, 3), -EAGAIN,
+		      "Published while unprovisioned");
+
+	k_sleep(WINDOW);
+
+	zassert_equal(publish_count, 0, "Unexpected publications");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(model_utils_test,
+			 ztest_unit_test(test_coalesce),
+			 ztest_unit_test(test_element_order),
+			 ztest_unit_test(test_opcode_change),
+			 ztest_unit_test(test_full),
+			 ztest_unit_test(test_publish_error),
+			 ztest_unit_test(test_not_coalesced)
+			 );
+
+	ztest_run_test_suite(model_utils_test);
+}
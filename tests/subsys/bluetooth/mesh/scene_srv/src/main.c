@@ -0,0 +1,509 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ztest.h>
+#include <bluetooth/mesh.h>
+#include <bluetooth/mesh/models.h>
+#include <sys/byteorder.h>
+#include "model_utils.h"
+
+#define TEST_SIG_ID 0x1000
+#define TEST_VND_COMPANY 0x0059
+#define TEST_VND_ID 0x0001
+
+#define STORAGE_ENTRIES 8
+#define STORAGE_VAL_LEN 256
+
+/** Mocks ******************************************/
+
+static struct bt_mesh_scene_srv scene_srv;
+
+static struct bt_mesh_model models[] = {
+	BT_MESH_MODEL_SCENE_SRV(&scene_srv),
+	BT_MESH_MODEL(TEST_SIG_ID, NULL, NULL, NULL),
+};
+
+static struct bt_mesh_model vnd_models[] = {
+	BT_MESH_MODEL_VND(TEST_VND_COMPANY, TEST_VND_ID, NULL, NULL, NULL),
+};
+
+static struct bt_mesh_elem elems[] = {
+	BT_MESH_ELEM(0, models, vnd_models),
+};
+
+static const struct bt_mesh_comp comp = {
+	.elem = elems,
+	.elem_count = ARRAY_SIZE(elems),
+};
+
+static struct {
+	char path[16];
+	uint8_t data[STORAGE_VAL_LEN];
+	size_t len;
+	bool valid;
+} storage[STORAGE_ENTRIES];
+
+static int legacy_deletes;
+static int page_writes;
+static bool provisioned;
+
+/* Scene data of the test models: */
+static uint8_t sig_state[3];
+static uint8_t vnd_state[5];
+static uint8_t sig_recalled[sizeof(sig_state)];
+static uint8_t vnd_recalled[sizeof(vnd_state)];
+
+static ssize_t sig_store(struct bt_mesh_model *model, uint8_t data[])
+{
+	memcpy(data, sig_state, sizeof(sig_state));
+	return sizeof(sig_state);
+}
+
+static void sig_recall(struct bt_mesh_model *model, const uint8_t data[],
+		       size_t len, struct bt_mesh_model_transition *transition)
+{
+	zassert_equal(len, sizeof(sig_recalled), "Wrong SIG scene data length");
+	memcpy(sig_recalled, data, len);
+}
+
+static ssize_t vnd_store(struct bt_mesh_model *model, uint8_t data[])
+{
+	memcpy(data, vnd_state, sizeof(vnd_state));
+	return sizeof(vnd_state);
+}
+
+static void vnd_recall(struct bt_mesh_model *model, const uint8_t data[],
+		       size_t len, struct bt_mesh_model_transition *transition)
+{
+	zassert_equal(len, sizeof(vnd_recalled), "Wrong vendor scene data length");
+	memcpy(vnd_recalled, data, len);
+}
+
+BT_MESH_SCENE_ENTRY_SIG(test) = {
+	.id.sig = TEST_SIG_ID,
+	.maxlen = sizeof(sig_state),
+	.store = sig_store,
+	.recall = sig_recall,
+};
+
+BT_MESH_SCENE_ENTRY_VND(test) = {
+	.id.vnd = {
+		.id = TEST_VND_ID,
+		.company = TEST_VND_COMPANY,
+	},
+	.maxlen = sizeof(vnd_state),
+	.store = vnd_store,
+	.recall = vnd_recall,
+};
+
+const struct bt_mesh_comp *bt_mesh_comp_get(void)
+{
+	return &comp;
+}
+
+uint16_t bt_mesh_elem_count(void)
+{
+	return comp.elem_count;
+}
+
+bool bt_mesh_is_provisioned(void)
+{
+	return provisioned;
+}
+
+int bt_mesh_model_data_store(struct bt_mesh_model *mod, bool vnd,
+			     const char *name, const void *data,
+			     size_t data_len)
+{
+	const char *type = strchr(name, '/');
+	int free_slot = -1;
+
+	zassert_equal_ptr(mod, scene_srv.model, "Stored by wrong model");
+
+	if (!data && type && (type[1] == 's' || type[1] == 'v')) {
+		legacy_deletes++;
+	}
+
+	for (int i = 0; i < STORAGE_ENTRIES; i++) {
+		if (!storage[i].valid) {
+			free_slot = (free_slot < 0) ? i : free_slot;
+			continue;
+		}
+
+		if (!strcmp(storage[i].path, name)) {
+			storage[i].valid = false;
+			free_slot = i;
+			break;
+		}
+	}
+
+	if (!data) {
+		return 0;
+	}
+
+	page_writes++;
+	zassert_true(free_slot >= 0, "Out of storage");
+	zassert_true(data_len <= STORAGE_VAL_LEN, "Too long value");
+
+	strcpy(storage[free_slot].path, name);
+	memcpy(storage[free_slot].data, data, data_len);
+	storage[free_slot].len = data_len;
+	storage[free_slot].valid = true;
+
+	return 0;
+}
+
+struct bt_mesh_model *bt_mesh_model_find(const struct bt_mesh_elem *elem,
+					 uint16_t id)
+{
+	for (int i = 0; i < elem->model_count; i++) {
+		if (elem->models[i].id == id) {
+			return &elem->models[i];
+		}
+	}
+
+	return NULL;
+}
+
+struct bt_mesh_model *bt_mesh_model_find_vnd(const struct bt_mesh_elem *elem,
+					     uint16_t company, uint16_t id)
+{
+	for (int i = 0; i < elem->vnd_model_count; i++) {
+		if (elem->vnd_models[i].vnd.company == company &&
+		    elem->vnd_models[i].vnd.id == id) {
+			return &elem->vnd_models[i];
+		}
+	}
+
+	return NULL;
+}
+
+int bt_mesh_model_extend(struct bt_mesh_model *mod,
+			 struct bt_mesh_model *base_mod)
+{
+	return 0;
+}
+
+bool bt_mesh_model_is_extended(struct bt_mesh_model *model)
+{
+	return false;
+}
+
+void bt_mesh_model_msg_init(struct net_buf_simple *msg, uint32_t opcode)
+{
+	net_buf_simple_init(msg, 0);
+}
+
+int model_status_send(struct bt_mesh_model *model, struct bt_mesh_msg_ctx *ctx,
+		      struct net_buf_simple *buf)
+{
+	return 0;
+}
+
+int tid_check_and_update(struct bt_mesh_tid_ctx *prev_transaction, uint8_t tid,
+			 const struct bt_mesh_msg_ctx *ctx)
+{
+	return 0;
+}
+
+uint8_t model_transition_encode(int32_t transition_time)
+{
+	return 0;
+}
+
+int32_t model_transition_decode(uint8_t encoded_transition)
+{
+	return 0;
+}
+
+uint8_t model_delay_encode(uint32_t delay)
+{
+	return 0;
+}
+
+int32_t model_delay_decode(uint8_t encoded_delay)
+{
+	return 0;
+}
+
+const char *bt_hex(const void *buf, size_t len)
+{
+	return "";
+}
+
+int settings_load_subtree(const char *subtree)
+{
+	return 0;
+}
+
+static ssize_t storage_read(void *cb_arg, void *data, size_t len)
+{
+	int i = (int)(intptr_t)cb_arg;
+
+	len = MIN(len, storage[i].len);
+	memcpy(data, storage[i].data, len);
+
+	return len;
+}
+
+int settings_load_subtree_direct(const char *subtree, settings_load_direct_cb cb,
+				 void *param)
+{
+	const char *path = strstr(subtree, "/data/");
+
+	zassert_not_null(path, "Not a model data path");
+	path += strlen("/data/");
+
+	for (int i = 0; i < STORAGE_ENTRIES; i++) {
+		if (storage[i].valid && !strcmp(storage[i].path, path)) {
+			cb(NULL, storage[i].len, storage_read,
+			   (void *)(intptr_t)i, param);
+		}
+	}
+
+	return 0;
+}
+
+int settings_name_next(const char *name, const char **next)
+{
+	const char *sep = strchr(name, '/');
+
+	*next = sep ? sep + 1 : NULL;
+
+	return sep ? sep - name : strlen(name);
+}
+
+/** End Mocks **************************************/
+
+/* Feed the stored entries to the Scene Server the way the settings
+ * subsystem does it at boot, first before and then after the mesh starts.
+ */
+static void storage_load(void)
+{
+	scene_srv.count = 0;
+	scene_srv.pages = 0;
+	scene_srv.sigpages = 0;
+	scene_srv.vndpages = 0;
+	memset(scene_srv.legacy, 0, sizeof(scene_srv.legacy));
+
+	for (int pass = 0; pass < 2; pass++) {
+		provisioned = (pass == 1);
+
+		for (int i = 0; i < STORAGE_ENTRIES; i++) {
+			if (!storage[i].valid) {
+				continue;
+			}
+
+			zassert_ok(models[0].cb->settings_set(&models[0], storage[i].path,
+							       storage[i].len, storage_read,
+							       (void *)(intptr_t)i),
+				   "Loading %s failed", storage[i].path);
+		}
+	}
+}
+
+static bool storage_has(const char *path)
+{
+	for (int i = 0; i < STORAGE_ENTRIES; i++) {
+		if (storage[i].valid && !strcmp(storage[i].path, path)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int storage_count(void)
+{
+	int count = 0;
+
+	for (int i = 0; i < STORAGE_ENTRIES; i++) {
+		count += storage[i].valid;
+	}
+
+	return count;
+}
+
+static void scene_store(uint16_t scene)
+{
+	NET_BUF_SIMPLE_DEFINE(buf, 2);
+	struct bt_mesh_msg_ctx ctx = { 0 };
+	const struct bt_mesh_model_op *op;
+
+	for (op = models[1].op; op->func; op++) {
+		if (op->opcode == BT_MESH_SCENE_OP_STORE_UNACK) {
+			break;
+		}
+	}
+
+	zassert_not_null(op->func, "No Store Unacknowledged handler");
+
+	net_buf_simple_add_le16(&buf, scene);
+	zassert_ok(op->func(&models[1], &ctx, &buf), "Store failed");
+}
+
+static void legacy_store(uint16_t scene, char type, const uint8_t *data,
+			 size_t len)
+{
+	char path[16];
+	uint8_t buf[16];
+	size_t overhead = (type == 'v') ? 2 : 0;
+
+	/* struct scene_data: len, elem_idx, model ID, [company,] data */
+	buf[0] = len + overhead;
+	buf[1] = 0;
+	if (type == 'v') {
+		sys_put_le16(TEST_VND_ID, &buf[2]);
+		sys_put_le16(TEST_VND_COMPANY, &buf[4]);
+	} else {
+		sys_put_le16(TEST_SIG_ID, &buf[2]);
+	}
+
+	memcpy(&buf[4 + overhead], data, len);
+
+	sprintf(path, "%x/%c0", scene, type);
+	bt_mesh_model_data_store(scene_srv.model, false, path, buf,
+				 4 + overhead + len);
+}
+
+static void setup(void)
+{
+	memset(storage, 0, sizeof(storage));
+	memset(sig_recalled, 0, sizeof(sig_recalled));
+	memset(vnd_recalled, 0, sizeof(vnd_recalled));
+	legacy_deletes = 0;
+	page_writes = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(models); i++) {
+		models[i].elem_idx = 0;
+		models[i].mod_idx = i;
+	}
+
+	vnd_models[0].elem_idx = 0;
+	vnd_models[0].mod_idx = 0;
+
+	storage_load();
+}
+
+static void test_store_load(void)
+{
+	static const uint8_t sig[] = { 0x01, 0x02, 0x03 };
+	static const uint8_t vnd[] = { 0x0a, 0x0b, 0x0c, 0x0d, 0x0e };
+
+	setup();
+
+	memcpy(sig_state, sig, sizeof(sig));
+	memcpy(vnd_state, vnd, sizeof(vnd));
+	scene_store(1);
+
+	/* Both models share a single packed page: */
+	zassert_true(storage_has("1/p0"), "No packed page");
+	zassert_equal(storage_count(), 1, "Unexpected entries");
+
+	memset(sig_state, 0, sizeof(sig_state));
+	memset(vnd_state, 0, sizeof(vnd_state));
+	storage_load();
+
+	zassert_equal(scene_srv.count, 1, "Scene not recovered");
+	zassert_equal(scene_srv.all[0], 1, "Wrong scene recovered");
+	zassert_mem_equal(sig_recalled, sig, sizeof(sig), "Wrong SIG data");
+	zassert_mem_equal(vnd_recalled, vnd, sizeof(vnd), "Wrong vendor data");
+}
+
+static void test_store_unchanged(void)
+{
+	static const uint8_t sig[] = { 0x21, 0x22, 0x23 };
+
+	setup();
+
+	memcpy(sig_state, sig, sizeof(sig));
+	scene_store(4);
+	zassert_equal(page_writes, 1, "Scene not written");
+
+	/* Storing the same data again doesn't write, also after reboot: */
+	scene_store(4);
+	storage_load();
+	scene_store(4);
+	zassert_equal(page_writes, 1, "Unchanged scene written");
+
+	/* Any change to the packed data is written: */
+	sig_state[2]++;
+	scene_store(4);
+	zassert_equal(page_writes, 2, "Changed scene not written");
+
+	memset(sig_recalled, 0, sizeof(sig_recalled));
+	storage_load();
+	zassert_equal(sig_recalled[2], sig[2] + 1, "Wrong SIG data");
+}
+
+static void test_legacy_migration(void)
+{
+	static const uint8_t sig[] = { 0x11, 0x12, 0x13 };
+	static const uint8_t vnd[] = { 0x1a, 0x1b, 0x1c, 0x1d, 0x1e };
+
+	setup();
+
+	legacy_store(2, 's', sig, sizeof(sig));
+	legacy_store(2, 'v', vnd, sizeof(vnd));
+	legacy_store(3, 's', sig, sizeof(sig));
+
+	storage_load();
+
+	zassert_equal(scene_srv.count, 2, "Scenes not recovered");
+	zassert_mem_equal(sig_recalled, sig, sizeof(sig), "Wrong SIG data");
+	zassert_mem_equal(vnd_recalled, vnd, sizeof(vnd), "Wrong vendor data");
+	zassert_equal(scene_srv.sigpages, 1, "Wrong SIG page count");
+	zassert_equal(scene_srv.vndpages, 1, "Wrong vendor page count");
+
+	/* Storing scene 2 replaces its legacy pages with a packed page, but
+	 * leaves the legacy pages of scene 3 alone:
+	 */
+	memcpy(sig_state, sig, sizeof(sig));
+	memcpy(vnd_state, vnd, sizeof(vnd));
+	scene_store(2);
+
+	zassert_true(storage_has("2/p0"), "No packed page");
+	zassert_false(storage_has("2/s0"), "Legacy SIG page left");
+	zassert_false(storage_has("2/v0"), "Legacy vendor page left");
+	zassert_true(storage_has("3/s0"), "Legacy page of other scene deleted");
+	zassert_equal(scene_srv.sigpages, 1, "Legacy pages forgotten too early");
+
+	/* Once the last scene is migrated, the legacy pages are no longer
+	 * deleted on every store:
+	 */
+	scene_store(3);
+	zassert_false(storage_has("3/s0"), "Legacy SIG page left");
+	zassert_equal(scene_srv.sigpages, 0, "SIG page count not reset");
+	zassert_equal(scene_srv.vndpages, 0, "Vendor page count not reset");
+
+	legacy_deletes = 0;
+	sig_state[0]++;
+	scene_store(2);
+	scene_store(3);
+	zassert_equal(legacy_deletes, 0, "Legacy pages deleted again");
+
+	/* The migrated scenes load from the packed pages only: */
+	memset(sig_recalled, 0, sizeof(sig_recalled));
+	storage_load();
+	zassert_equal(scene_srv.count, 2, "Scenes not recovered");
+	zassert_equal(scene_srv.sigpages, 0, "Legacy pages found");
+	zassert_equal(sig_recalled[0], sig[0] + 1, "Wrong SIG data");
+}
+
+void test_main(void)
+{
+	zassert_ok(models[0].cb->init(&models[0]), "Init failed");
+
+	ztest_test_suite(scene_srv_test,
+			 ztest_unit_test(test_store_load),
+			 ztest_unit_test(test_store_unchanged),
+			 ztest_unit_test(test_legacy_migration)
+			 );
+
+	ztest_run_test_suite(scene_srv_test);
+}
@@ -2425,6 +2425,145 @@ static void test_present_rel_output_ripple_voltage(void)
 	percentage8_check(sensor_type);
 }
 
+static void test_sensor_type_list_sorted(void)
+{
+	uint16_t prev_id = 0;
+	bool first = true;
+
+	Z_STRUCT_SECTION_FOREACH(bt_mesh_sensor_type, type) {
+		if (!first) {
+			zassert_true(type->id > prev_id,
+				     "Sensor type 0x%04x is not sorted", type->id);
+		}
+
+		zassert_equal_ptr(bt_mesh_sensor_type_get(type->id), type,
+				  "Lookup of 0x%04x failed", type->id);
+
+		prev_id = type->id;
+		first = false;
+	}
+
+	zassert_is_null(bt_mesh_sensor_type_get(0xffff), "Unknown ID found");
+}
+
+static void test_series_store(void)
+{
+	static const struct bt_mesh_sensor_column columns[] = {
+		{ .start = { 0 }, .end = { 10 } },
+		{ .start = { 10, 100000 }, .end = { 20 } },
+	};
+	static struct bt_mesh_sensor_series_entry entries[ARRAY_SIZE(columns)];
+	static struct bt_mesh_sensor_series_store store =
+		BT_MESH_SENSOR_SERIES_STORE_INIT(entries,
+						 BT_MESH_SENSOR_SERIES_AGGR_MEAN, 4);
+	struct bt_mesh_sensor sensor = {
+		.type = &bt_mesh_sensor_avg_amb_temp_in_day,
+		.series = {
+			.columns = columns,
+			.column_count = ARRAY_SIZE(columns),
+			.store = &store,
+		},
+	};
+	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX];
+	const struct sensor_value x1 = { 5 };
+	const struct sensor_value x2 = { 15 };
+	const struct sensor_value x_none = { 30 };
+
+	zassert_ok(bt_mesh_sensor_series_sample_add(&sensor, &x1,
+						    &(struct sensor_value){ 20 }), NULL);
+	zassert_ok(bt_mesh_sensor_series_sample_add(&sensor, &x1,
+						    &(struct sensor_value){ 21 }), NULL);
+	zassert_ok(bt_mesh_sensor_series_sample_add(&sensor, &x2,
+						    &(struct sensor_value){ -5 }), NULL);
+	zassert_equal(bt_mesh_sensor_series_sample_add(&sensor, &x_none,
+						       &(struct sensor_value){ 0 }),
+		      -ENOENT, NULL);
+
+	zassert_ok(sensor_series_store_get(&sensor, &columns[0], value), NULL);
+	zassert_equal(value[0].val1, 20, NULL);
+	zassert_equal(value[0].val2, 500000, NULL);
+	zassert_equal(value[1].val1, 0, NULL);
+	zassert_equal(value[2].val1, 10, NULL);
+
+	zassert_ok(sensor_series_store_get(&sensor, &columns[1], value), NULL);
+	zassert_equal(value[0].val1, -5, NULL);
+	zassert_equal(value[1].val2, 100000, NULL);
+
+	zassert_ok(bt_mesh_sensor_series_sample_add(&sensor, &x1,
+						    &(struct sensor_value){ 22 }), NULL);
+	zassert_ok(bt_mesh_sensor_series_sample_add(&sensor, &x1,
+						    &(struct sensor_value){ 23 }), NULL);
+	zassert_equal(entries[0].count, 4, NULL);
+
+	/* Past the window, a sample replaces the mean of one sample. */
+	zassert_ok(bt_mesh_sensor_series_sample_add(&sensor, &x1,
+						    &(struct sensor_value){ 25 }), NULL);
+	zassert_equal(entries[0].count, 4, NULL);
+	zassert_equal(entries[0].min, 20000000, NULL);
+	zassert_equal(entries[0].max, 25000000, NULL);
+	zassert_ok(sensor_series_store_get(&sensor, &columns[0], value), NULL);
+	zassert_equal(value[0].val1, 22, NULL);
+	zassert_equal(value[0].val2, 375000, NULL);
+
+	store.aggr = BT_MESH_SENSOR_SERIES_AGGR_MAX;
+	zassert_ok(sensor_series_store_get(&sensor, &columns[0], value), NULL);
+	zassert_equal(value[0].val1, 25, NULL);
+
+	bt_mesh_sensor_series_store_reset(&sensor);
+	zassert_ok(sensor_series_store_get(&sensor, &columns[0], value), NULL);
+	zassert_equal(value[0].val1, 0, NULL);
+	zassert_equal(value[0].val2, 0, NULL);
+}
+
+static void series_store_window_check(uint32_t window)
+{
+	static const struct bt_mesh_sensor_column columns[] = {
+		{ .start = { 0 }, .end = { 10 } },
+	};
+	static struct bt_mesh_sensor_series_entry entries[ARRAY_SIZE(columns)];
+	struct bt_mesh_sensor_series_store store =
+		BT_MESH_SENSOR_SERIES_STORE_INIT(entries,
+						 BT_MESH_SENSOR_SERIES_AGGR_MEAN,
+						 window);
+	struct bt_mesh_sensor sensor = {
+		.type = &bt_mesh_sensor_avg_amb_temp_in_day,
+		.series = {
+			.columns = columns,
+			.column_count = ARRAY_SIZE(columns),
+			.store = &store,
+		},
+	};
+	struct sensor_value value[CONFIG_BT_MESH_SENSOR_CHANNELS_MAX];
+	const struct sensor_value x = { 5 };
+
+	bt_mesh_sensor_series_store_reset(&sensor);
+
+	/* A constant input keeps a constant mean, also past the window. */
+	for (uint32_t i = 0; i < 3 * window + 1; i++) {
+		zassert_ok(bt_mesh_sensor_series_sample_add(&sensor, &x,
+				&(struct sensor_value){ 10 }), NULL);
+		zassert_equal(entries[0].count, MIN(i + 1, window), NULL);
+		zassert_ok(sensor_series_store_get(&sensor, &columns[0], value),
+			   NULL);
+		zassert_equal(value[0].val1, 10, NULL);
+		zassert_equal(value[0].val2, 0, NULL);
+	}
+
+	/* The new sample replaces one of the window samples. */
+	zassert_ok(bt_mesh_sensor_series_sample_add(&sensor, &x,
+			&(struct sensor_value){ 10 + 10 * window }), NULL);
+	zassert_ok(sensor_series_store_get(&sensor, &columns[0], value), NULL);
+	zassert_equal(value[0].val1, 20, NULL);
+	zassert_equal(value[0].val2, 0, NULL);
+}
+
+static void test_series_store_window(void)
+{
+	series_store_window_check(1);
+	series_store_window_check(3);
+	series_store_window_check(5);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(sensor_types_test,
@@ -2533,7 +2672,10 @@ void test_main(void)
 			ztest_unit_test(test_output_voltage_stat),
 			ztest_unit_test(test_present_output_current),
 			ztest_unit_test(test_present_output_voltage),
-			ztest_unit_test(test_present_rel_output_ripple_voltage)
+			ztest_unit_test(test_present_rel_output_ripple_voltage),
+			ztest_unit_test(test_sensor_type_list_sorted),
+			ztest_unit_test(test_series_store),
+			ztest_unit_test(test_series_store_window)
 			 );
 
 	ztest_run_test_suite(sensor_types_test);
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <ztest.h>
+#include <sys/util.h>
+#include <bluetooth/mesh/time_srv.h>
+#include "time_util.h"
+
+/* Every day of a full 400 year Gregorian cycle from the TAI epoch. */
+#define ERA_DAYS 146097
+
+static const uint8_t month_cfg[12] = { 31, 28, 31, 30, 31, 30,
+				       31, 31, 30, 31, 30, 31 };
+static const uint8_t month_leap_cfg[12] = { 31, 29, 31, 30, 31, 30,
+					    31, 31, 30, 31, 30, 31 };
+
+/* Reference implementations, counting days year by year: */
+
+static int ref_ts_to_tai(struct bt_mesh_time_tai *tai, struct tm *timeptr)
+{
+	uint32_t current_year = timeptr->tm_year + TM_START_YEAR;
+	uint32_t days = 0;
+
+	if (current_year < TAI_START_YEAR) {
+		return -EAGAIN;
+	}
+
+	for (int year = TAI_START_YEAR; year < current_year; year++) {
+		days += is_leap_year(year) ? DAYS_LEAP_YEAR : DAYS_YEAR;
+	}
+
+	const uint8_t *months =
+		is_leap_year(current_year) ? month_leap_cfg : month_cfg;
+
+	for (int i = 0; i < timeptr->tm_mon; i++) {
+		days += months[i];
+	}
+
+	days += timeptr->tm_mday - 1;
+
+	tai->sec = (days * SEC_PER_DAY);
+	tai->sec += ((uint64_t)timeptr->tm_hour * SEC_PER_HOUR);
+	tai->sec += ((uint64_t)timeptr->tm_min * SEC_PER_MIN);
+	tai->sec += (uint64_t)timeptr->tm_sec;
+	tai->subsec = 0;
+	return 0;
+}
+
+static void ref_tai_to_ts(const struct bt_mesh_time_tai *tai,
+			  struct tm *timeptr)
+{
+	uint64_t day_cnt = tai->sec / SEC_PER_DAY;
+	bool is_leap;
+	uint32_t year;
+
+	timeptr->tm_hour = (tai->sec % SEC_PER_DAY) / SEC_PER_HOUR;
+	timeptr->tm_min = (tai->sec % SEC_PER_HOUR) / SEC_PER_MIN;
+	timeptr->tm_sec = (tai->sec % SEC_PER_MIN);
+	timeptr->tm_wday = (TAI_START_DAY + day_cnt) % WEEKDAY_CNT;
+	timeptr->tm_isdst = -1;
+
+	for (year = TAI_START_YEAR;; year++) {
+		is_leap = is_leap_year(year);
+
+		uint32_t days_in_year = is_leap ? DAYS_LEAP_YEAR : DAYS_YEAR;
+
+		if (days_in_year > day_cnt) {
+			break;
+		}
+
+		day_cnt -= days_in_year;
+	}
+
+	timeptr->tm_yday = day_cnt;
+	timeptr->tm_year = year - TM_START_YEAR;
+
+	const uint8_t *months = is_leap ? month_leap_cfg : month_cfg;
+
+	for (timeptr->tm_mon = 0;
+	     timeptr->tm_mon < ARRAY_SIZE(month_cfg) &&
+	     months[timeptr->tm_mon] <= day_cnt;
+	     timeptr->tm_mon++) {
+		day_cnt -= months[timeptr->tm_mon];
+	}
+
+	timeptr->tm_mday = day_cnt + 1;
+}
+
+static int ref_day_of_week(int year, int month, int day)
+{
+	int day_cnt = 0;
+
+	year += TM_START_YEAR;
+
+	for (int i = TM_START_YEAR; i < year; i++) {
+		day_cnt += is_leap_year(i) ? DAYS_LEAP_YEAR : DAYS_YEAR;
+	}
+
+	const uint8_t *months =
+		is_leap_year(year) ? month_leap_cfg : month_cfg;
+
+	for (int i = 0; i < month; i++) {
+		day_cnt += months[i];
+	}
+
+	day_cnt += day;
+	return (day_cnt - 1) % WEEKDAY_CNT;
+}
+
+static int day_of_week(int year, int month, int day)
+{
+	return (days_from_civil(year + TM_START_YEAR, month + 1, day) -
+		days_from_civil(TM_START_YEAR, 1, 1)) %
+	       WEEKDAY_CNT;
+}
+
+static void tm_check(const struct tm *expected, const struct tm *actual,
+		     uint64_t sec)
+{
+	zassert_equal(expected->tm_year, actual->tm_year, "%llu", sec);
+	zassert_equal(expected->tm_mon, actual->tm_mon, "%llu", sec);
+	zassert_equal(expected->tm_mday, actual->tm_mday, "%llu", sec);
+	zassert_equal(expected->tm_yday, actual->tm_yday, "%llu", sec);
+	zassert_equal(expected->tm_wday, actual->tm_wday, "%llu", sec);
+	zassert_equal(expected->tm_hour, actual->tm_hour, "%llu", sec);
+	zassert_equal(expected->tm_min, actual->tm_min, "%llu", sec);
+	zassert_equal(expected->tm_sec, actual->tm_sec, "%llu", sec);
+}
+
+static void test_epochs(void)
+{
+	zassert_equal(days_from_civil(1970, 1, 1), 0, NULL);
+	zassert_equal(days_from_civil(2000, 1, 1), 10957, NULL);
+	zassert_equal(days_from_civil(1969, 12, 31), -1, NULL);
+	zassert_equal(days_from_civil(1900, 1, 1), -25567, NULL);
+	zassert_equal(days_from_civil(2000, 2, 29), days_from_civil(2000, 3, 0),
+		      NULL);
+	zassert_equal(days_from_civil(2021, 12, 32), days_from_civil(2022, 1, 1),
+		      NULL);
+}
+
+static void test_tai_conversion(void)
+{
+	for (uint32_t day = 0; day < ERA_DAYS + 1; day++) {
+		/* Visit a different time of day for every day: */
+		struct bt_mesh_time_tai tai = {
+			.sec = day * SEC_PER_DAY + (day * 7919) % SEC_PER_DAY,
+		};
+		struct bt_mesh_time_tai ref_tai;
+		struct tm expected;
+		struct tm tm;
+
+		ref_tai_to_ts(&tai, &expected);
+		tai_to_ts(&tai, &tm);
+		tm_check(&expected, &tm, tai.sec);
+
+		zassert_ok(ts_to_tai(&ref_tai, &tm), NULL);
+		zassert_equal(ref_tai.sec, tai.sec, "%llu", (uint64_t)tai.sec);
+
+		zassert_ok(ref_ts_to_tai(&ref_tai, &tm), NULL);
+		zassert_equal(ref_tai.sec, tai.sec, "%llu", (uint64_t)tai.sec);
+	}
+}
+
+static void test_day_of_week(void)
+{
+	for (int year = 0; year < 500; year++) {
+		for (int month = 0; month < 12; month++) {
+			const uint8_t *months =
+				is_leap_year(year + TM_START_YEAR) ?
+					month_leap_cfg :
+					month_cfg;
+
+			for (int day = 1; day <= months[month]; day++) {
+				zassert_equal(day_of_week(year, month, day),
+					      ref_day_of_week(year, month, day),
+					      "%d-%d-%d", year, month, day);
+			}
+		}
+	}
+}
+
+static void test_civil_round_trip(void)
+{
+	int64_t prev = days_from_civil(-1, 12, 31);
+
+	for (int year = 0; year < 2800; year++) {
+		for (uint32_t month = 1; month <= 12; month++) {
+			const uint8_t *months = is_leap_year(year) ?
+							month_leap_cfg :
+							month_cfg;
+
+			for (uint32_t mday = 1; mday <= months[month - 1];
+			     mday++) {
+				int64_t days =
+					days_from_civil(year, month, mday);
+				uint32_t out_month;
+				uint32_t out_mday;
+				int32_t out_year;
+
+				zassert_equal(days, prev + 1, "%d-%u-%u", year,
+					      month, mday);
+				prev = days;
+
+				civil_from_days(days, &out_year, &out_month,
+						&out_mday);
+				zassert_equal(out_year, year, NULL);
+				zassert_equal(out_month, month, NULL);
+				zassert_equal(out_mday, mday, NULL);
+			}
+		}
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(time_util_test,
+			 ztest_unit_test(test_epochs),
+			 ztest_unit_test(test_tai_conversion),
+			 ztest_unit_test(test_day_of_week),
+			 ztest_unit_test(test_civil_round_trip)
+			 );
+
+	ztest_run_test_suite(time_util_test);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <nrf_rpc_cbor.h>
+
+#include "cbkproxy.h"
+
+#define CALLBACK_SLOTS 4
+
+static void *callbacks[CALLBACK_SLOTS];
+
+void nrf_rpc_cbor_decoding_done(CborValue *value)
+{
+	ARG_UNUSED(value);
+}
+
+void nrf_rpc_cbor_rsp_no_err(struct nrf_rpc_cbor_ctx *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+void nrf_rpc_err(int code, enum nrf_rpc_err_src src,
+		 const struct nrf_rpc_group *group, uint8_t id,
+		 uint8_t packet_type)
+{
+	ARG_UNUSED(code);
+	ARG_UNUSED(src);
+	ARG_UNUSED(group);
+	ARG_UNUSED(id);
+	ARG_UNUSED(packet_type);
+}
+
+int cbkproxy_in_set(void *callback)
+{
+	for (int i = 0; i < CALLBACK_SLOTS; i++) {
+		if (!callbacks[i] || callbacks[i] == callback) {
+			callbacks[i] = callback;
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void *cbkproxy_in_get(int index)
+{
+	if (index < 0 || index >= CALLBACK_SLOTS) {
+		return NULL;
+	}
+
+	return callbacks[index];
+}
+
+void *cbkproxy_out_get(int index, void *handler)
+{
+	if (index < 0 || index >= CALLBACK_SLOTS) {
+		return NULL;
+	}
+
+	return handler;
+}
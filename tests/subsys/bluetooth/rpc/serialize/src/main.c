@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#include "serialize.h"
+
+#define BUF_SIZE 256
+
+static uint8_t buf[BUF_SIZE];
+static CborEncoder encoder;
+static CborParser parser;
+static CborValue value;
+
+static const char test_str[] = "nRF RPC";
+static const uint8_t test_data[] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+
+static void test_callback(void)
+{
+}
+
+static void test_handler(void)
+{
+}
+
+static void encode_start(void)
+{
+	cbor_encoder_init(&encoder, buf, sizeof(buf), 0);
+}
+
+static size_t encoded_size(void)
+{
+	return cbor_encoder_get_buffer_size(&encoder, buf);
+}
+
+static void decode_start(void)
+{
+	zassert_equal(cbor_parser_init(buf, encoded_size(), 0, &parser, &value),
+		      CborNoError, "Parser init failed");
+}
+
+static void test_uint_size(void)
+{
+	static const uint32_t values[] = {
+		0, 23, 24, UINT8_MAX, UINT8_MAX + 1, UINT16_MAX, UINT16_MAX + 1, UINT32_MAX
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		encode_start();
+		ser_encode_uint(&encoder, values[i]);
+		zassert_equal(encoded_size(), SER_UINT_SIZE(values[i]),
+			      "Wrong size of %u", values[i]);
+
+		decode_start();
+		zassert_equal(ser_decode_uint(&value), values[i], "Wrong value");
+		zassert_true(ser_decoding_done_and_check(&value), "Decoding failed");
+	}
+
+	zassert_equal(SER_UINT8_SIZE_MAX, 2, "Wrong 8-bit size");
+	zassert_equal(SER_UINT16_SIZE_MAX, 3, "Wrong 16-bit size");
+	zassert_equal(SER_UINT32_SIZE_MAX, 5, "Wrong 32-bit size");
+}
+
+static void test_buffer_size(void)
+{
+	encode_start();
+	ser_encode_buffer(&encoder, test_data, sizeof(test_data));
+	zassert_equal(encoded_size(), SER_BUFFER_SIZE(sizeof(test_data)), "Wrong buffer size");
+
+	encode_start();
+	ser_encode_str(&encoder, test_str, -1);
+	zassert_equal(encoded_size(), SER_BUFFER_SIZE(strlen(test_str)), "Wrong string size");
+}
+
+static void test_round_trip(void)
+{
+	struct ser_scratchpad scratchpad;
+	size_t scratchpad_size = SCRATCHPAD_ALIGN(sizeof(test_str)) +
+				 SCRATCHPAD_ALIGN(sizeof(test_data));
+	const char *str;
+	const uint8_t *data;
+
+	encode_start();
+	ser_encode_uint(&encoder, scratchpad_size);
+	ser_encode_null(&encoder);
+	ser_encode_undefined(&encoder);
+	ser_encode_bool(&encoder, true);
+	ser_encode_int(&encoder, -1000);
+	ser_encode_uint(&encoder, 100000);
+	ser_encode_str(&encoder, test_str, -1);
+	ser_encode_buffer(&encoder, test_data, sizeof(test_data));
+	ser_encode_buffer(&encoder, NULL, 0);
+	ser_encode_callback(&encoder, (void *)test_callback);
+	ser_encode_callback(&encoder, (void *)test_callback);
+
+	decode_start();
+	SER_SCRATCHPAD_DECLARE(&scratchpad, &value);
+
+	zassert_true(ser_decode_is_null(&value), "Expected null");
+	ser_decode_skip(&value);
+	zassert_true(ser_decode_is_undefined(&value), "Expected undefined");
+	ser_decode_skip(&value);
+	zassert_true(ser_decode_bool(&value), "Wrong bool");
+	zassert_equal(ser_decode_int(&value), -1000, "Wrong int");
+	zassert_equal(ser_decode_uint(&value), 100000, "Wrong uint");
+
+	str = ser_decode_str_into_scratchpad(&scratchpad);
+	zassert_not_null(str, "No string");
+	zassert_mem_equal(str, test_str, strlen(test_str), "Wrong string");
+
+	data = ser_decode_buffer_into_scratchpad(&scratchpad);
+	zassert_not_null(data, "No buffer");
+	zassert_mem_equal(data, test_data, sizeof(test_data), "Wrong buffer");
+
+	zassert_is_null(ser_decode_buffer_into_scratchpad(&scratchpad), "Expected NULL buffer");
+
+	zassert_equal_ptr(ser_decode_callback(&value, (void *)test_handler),
+			  (void *)test_handler,
+			  "Wrong callback handler");
+	zassert_equal_ptr(ser_decode_callback_call(&value), (void *)test_callback,
+			  "Wrong callback");
+
+	zassert_true(ser_decoding_done_and_check(&value), "Decoding failed");
+}
+
+static void test_scratchpad_request_size(void)
+{
+	struct ser_scratchpad scratchpad;
+
+	encode_start();
+	ser_encode_uint(&encoder, sizeof(test_str));
+
+	decode_start();
+	SER_SCRATCHPAD_DECLARE(&scratchpad, &value);
+
+	zassert_equal(net_buf_simple_tailroom(&scratchpad.buf), SCRATCHPAD_ALIGN(sizeof(test_str)),
+		      "Scratchpad not sized from the request");
+	zassert_true(ser_decoding_done_and_check(&value), "Decoding failed");
+}
+
+static void test_scratchpad_size_limit(void)
+{
+	struct ser_scratchpad scratchpad;
+
+	encode_start();
+	ser_encode_uint(&encoder, CONFIG_BT_RPC_SCRATCHPAD_SIZE_MAX + 1);
+	ser_encode_str(&encoder, test_str, -1);
+
+	decode_start();
+	SER_SCRATCHPAD_DECLARE(&scratchpad, &value);
+
+	zassert_false(ser_decode_valid(&value), "Too big scratchpad accepted");
+	zassert_is_null(ser_decode_str_into_scratchpad(&scratchpad), "String decoded");
+	zassert_false(ser_decoding_done_and_check(&value), "Decoding succeeded");
+}
+
+static void test_scratchpad_full(void)
+{
+	struct ser_scratchpad scratchpad;
+	uint8_t data[CONFIG_BT_RPC_SCRATCHPAD_SIZE_MAX / 2 + 1];
+
+	memset(data, 0xAA, sizeof(data));
+
+	/* The peer understates the scratchpad size. */
+	encode_start();
+	ser_encode_uint(&encoder, SCRATCHPAD_ALIGN(sizeof(data)));
+	ser_encode_buffer(&encoder, data, sizeof(data));
+	ser_encode_buffer(&encoder, data, sizeof(data));
+
+	decode_start();
+	SER_SCRATCHPAD_DECLARE(&scratchpad, &value);
+
+	zassert_not_null(ser_decode_buffer_into_scratchpad(&scratchpad), "First buffer");
+	zassert_is_null(ser_decode_buffer_into_scratchpad(&scratchpad), "Scratchpad overflow");
+	zassert_false(ser_decoding_done_and_check(&value), "Decoding succeeded");
+}
+
+static void test_scratchpad_add_full(void)
+{
+	struct ser_scratchpad scratchpad;
+
+	encode_start();
+	ser_encode_uint(&encoder, sizeof(uint32_t));
+
+	decode_start();
+	SER_SCRATCHPAD_DECLARE(&scratchpad, &value);
+
+	zassert_not_null(ser_scratchpad_add(&scratchpad, sizeof(uint32_t)), "First item");
+	zassert_true(ser_decode_valid(&value), "Decoder invalid");
+	zassert_is_null(ser_scratchpad_add(&scratchpad, 1), "Scratchpad overflow");
+	zassert_false(ser_decode_valid(&value), "Overflow not reported");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(bt_rpc_serialize,
+			 ztest_unit_test(test_uint_size),
+			 ztest_unit_test(test_buffer_size),
+			 ztest_unit_test(test_round_trip),
+			 ztest_unit_test(test_scratchpad_request_size),
+			 ztest_unit_test(test_scratchpad_size_limit),
+			 ztest_unit_test(test_scratchpad_full),
+			 ztest_unit_test(test_scratchpad_add_full)
+			 );
+
+	ztest_run_test_suite(bt_rpc_serialize);
+}
@@ -0,0 +1,674 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <ztest.h>
+#include <esb.h>
+#include <esb_sim.h>
+
+#define PACKET_COUNT 200
+#define PACKET_LENGTH 32
+/* Simulated time to wait for a packet before giving up. */
+#define PACKET_TIMEOUT_US 100000
+
+static uint32_t tx_success;
+static uint32_t tx_failed;
+static uint32_t rx_received;
+static uint32_t last_tx_attempts;
+static uint64_t last_tx_success_us;
+static uint32_t peer_rx_count;
+static struct esb_payload peer_rx_last;
+static uint8_t peer_rx_pipes[PACKET_COUNT];
+/* Leave the received payloads in the RX FIFO. */
+static bool rx_keep;
+
+static void event_handler(const struct esb_evt *event)
+{
+	struct esb_payload payload;
+
+	last_tx_attempts = event->tx_attempts;
+
+	switch (event->evt_id) {
+	case ESB_EVENT_TX_SUCCESS:
+		tx_success++;
+		last_tx_success_us = esb_sim_time_us();
+		break;
+
+	case ESB_EVENT_TX_FAILED:
+		tx_failed++;
+		break;
+
+	case ESB_EVENT_RX_RECEIVED:
+		while (!rx_keep && esb_read_rx_payload(&payload) == 0) {
+			rx_received++;
+		}
+		break;
+	}
+}
+
+static void peer_rx_handler(const struct esb_payload *payload)
+{
+	if (peer_rx_count < ARRAY_SIZE(peer_rx_pipes)) {
+		peer_rx_pipes[peer_rx_count] = payload->pipe;
+	}
+
+	peer_rx_count++;
+	peer_rx_last = *payload;
+}
+
+static void setup(void)
+{
+	esb_disable();
+	esb_sim_reset();
+
+	tx_success = 0;
+	tx_failed = 0;
+	rx_received = 0;
+	last_tx_attempts = 0;
+	peer_rx_count = 0;
+	rx_keep = false;
+}
+
+static void dut_init(enum esb_mode mode, enum esb_protocol protocol,
+		     uint16_t retransmit_count)
+{
+	struct esb_config config = ESB_DEFAULT_CONFIG;
+
+	config.mode = mode;
+	config.protocol = protocol;
+	config.retransmit_count = retransmit_count;
+	config.payload_length = PACKET_LENGTH;
+	config.event_handler = event_handler;
+
+	zassert_ok(esb_init(&config), NULL);
+}
+
+static void peer_prx_start(enum esb_protocol protocol)
+{
+	struct esb_sim_peer_config config = ESB_SIM_PEER_DEFAULT_CONFIG;
+
+	config.protocol = protocol;
+	config.payload_length = PACKET_LENGTH;
+	config.rx_handler = peer_rx_handler;
+
+	zassert_ok(esb_sim_peer_start(&config), NULL);
+}
+
+static void payload_fill(struct esb_payload *payload, uint32_t seq)
+{
+	payload->pipe = 0;
+	payload->noack = false;
+	payload->length = PACKET_LENGTH;
+	for (int i = 0; i < PACKET_LENGTH; i++) {
+		payload->data[i] = (uint8_t)(seq + i);
+	}
+}
+
+/* Send packets with the TX FIFO kept full, and return the simulated time it
+ * took, in microseconds.
+ */
+static uint64_t ptx_send(uint32_t count)
+{
+	struct esb_payload payload;
+	uint64_t start = esb_sim_time_us();
+	uint64_t timeout = start + (uint64_t)count * PACKET_TIMEOUT_US;
+	uint32_t written = 0;
+
+	while ((tx_success + tx_failed) < count) {
+		zassert_true(esb_sim_time_us() < timeout, "Sending timed out");
+
+		while (written < count) {
+			payload_fill(&payload, written);
+			if (esb_write_payload(&payload) != 0) {
+				break;
+			}
+			written++;
+		}
+
+		/* A failed packet is dropped, and the next one is sent. */
+		if (esb_is_idle() && (tx_success + tx_failed) < written) {
+			esb_start_tx();
+		}
+
+		esb_sim_run(100);
+	}
+
+	return last_tx_success_us - start;
+}
+
+static void ptx_benchmark(uint16_t loss_permille)
+{
+	struct esb_sim_channel_config channel = ESB_SIM_CHANNEL_DEFAULT_CONFIG;
+	struct esb_sim_peer_stats stats;
+	struct esb_pipe_stats pipe_stats;
+	uint64_t time_us;
+
+	channel.loss_permille = loss_permille;
+	esb_sim_channel_set(&channel);
+
+	dut_init(ESB_MODE_PTX, ESB_PROTOCOL_ESB_DPL, 15);
+	peer_prx_start(ESB_PROTOCOL_ESB_DPL);
+
+	time_us = ptx_send(PACKET_COUNT);
+
+	esb_sim_peer_stats_get(&stats);
+	zassert_equal(tx_success, PACKET_COUNT, "%u packets failed",
+		      tx_failed);
+	zassert_equal(stats.rx_packets, PACKET_COUNT, NULL);
+	zassert_equal(stats.rx_bytes, PACKET_COUNT * PACKET_LENGTH, NULL);
+	zassert_equal(peer_rx_last.length, PACKET_LENGTH, NULL);
+	if (loss_permille == 0) {
+		zassert_equal(stats.rx_retransmits, 0, NULL);
+	} else {
+		zassert_not_equal(stats.rx_retransmits, 0, NULL);
+	}
+
+	zassert_ok(esb_get_pipe_stats(0, &pipe_stats), NULL);
+	zassert_equal(pipe_stats.tx_success, PACKET_COUNT, NULL);
+	zassert_equal(pipe_stats.tx_bytes, PACKET_COUNT * PACKET_LENGTH, NULL);
+	zassert_equal(pipe_stats.tx_failed, 0, NULL);
+	/* Every attempt without an ACK was retransmitted. */
+	zassert_equal(pipe_stats.ack_lost, pipe_stats.retransmits, NULL);
+	zassert_true(pipe_stats.retransmits >= stats.rx_retransmits, NULL);
+	zassert_equal(pipe_stats.rssi, channel.rssi, NULL);
+	zassert_equal(pipe_stats.rssi_avg, channel.rssi, NULL);
+
+	TC_PRINT("PTX, %u%% loss: %u packets in %u us, %u kbps, "
+		 "%u retransmits received\n",
+		 loss_permille / 10, PACKET_COUNT, (uint32_t)time_us,
+		 (uint32_t)(PACKET_COUNT * PACKET_LENGTH * 8 * 1000ULL /
+			    time_us),
+		 stats.rx_retransmits);
+}
+
+static void test_ptx_throughput(void)
+{
+	ptx_benchmark(0);
+}
+
+static void test_ptx_throughput_loss_10(void)
+{
+	ptx_benchmark(100);
+}
+
+static void test_ptx_throughput_loss_30(void)
+{
+	ptx_benchmark(300);
+}
+
+static void test_ptx_latency(void)
+{
+	struct esb_payload payload;
+	uint64_t start;
+	uint32_t latency;
+
+	dut_init(ESB_MODE_PTX, ESB_PROTOCOL_ESB_DPL, 3);
+	peer_prx_start(ESB_PROTOCOL_ESB_DPL);
+
+	payload_fill(&payload, 0);
+	start = esb_sim_time_us();
+	zassert_ok(esb_write_payload(&payload), NULL);
+	esb_sim_run(PACKET_TIMEOUT_US);
+
+	zassert_equal(tx_success, 1, NULL);
+	zassert_equal(last_tx_attempts, 1, NULL);
+
+	/* Two ramp-ups, the packet and the ACK at 2 Mbps */
+	latency = last_tx_success_us - start;
+	zassert_true(latency > 2 * 130 && latency < 2 * 130 + 250,
+		     "Latency %u us", latency);
+
+	TC_PRINT("PTX latency: %u us\n", latency);
+}
+
+static void test_ptx_retransmit(void)
+{
+	struct esb_sim_channel_config channel = ESB_SIM_CHANNEL_DEFAULT_CONFIG;
+	struct esb_sim_peer_stats stats;
+	struct esb_pipe_stats pipe_stats;
+	struct esb_payload payload;
+
+	channel.loss_permille = 1000;
+	esb_sim_channel_set(&channel);
+
+	dut_init(ESB_MODE_PTX, ESB_PROTOCOL_ESB_DPL, 5);
+	peer_prx_start(ESB_PROTOCOL_ESB_DPL);
+
+	payload_fill(&payload, 0);
+	zassert_ok(esb_write_payload(&payload), NULL);
+	esb_sim_run(PACKET_TIMEOUT_US);
+
+	esb_sim_peer_stats_get(&stats);
+	zassert_equal(tx_success, 0, NULL);
+	zassert_equal(tx_failed, 1, NULL);
+	zassert_equal(last_tx_attempts, 6, NULL);
+	zassert_equal(stats.rx_packets, 0, NULL);
+
+	zassert_ok(esb_get_pipe_stats(0, &pipe_stats), NULL);
+	zassert_equal(pipe_stats.tx_failed, 1, NULL);
+	zassert_equal(pipe_stats.retransmits, 5, NULL);
+	zassert_equal(pipe_stats.ack_lost, 6, NULL);
+
+	/* The packet stays in the TX FIFO, and goes through once the channel
+	 * is clear.
+	 */
+	channel.loss_permille = 0;
+	esb_sim_channel_set(&channel);
+	zassert_ok(esb_start_tx(), NULL);
+	esb_sim_run(PACKET_TIMEOUT_US);
+
+	esb_sim_peer_stats_get(&stats);
+	zassert_equal(tx_success, 1, NULL);
+	zassert_equal(stats.rx_packets, 1, NULL);
+}
+
+static void test_ptx_ack_window(void)
+{
+	struct esb_sim_channel_config channel = ESB_SIM_CHANNEL_DEFAULT_CONFIG;
+	struct esb_sim_peer_stats stats;
+	struct esb_payload payload;
+
+	/* The ACK arrives after the ACK timeout. */
+	channel.latency_us = 20;
+	esb_sim_channel_set(&channel);
+
+	dut_init(ESB_MODE_PTX, ESB_PROTOCOL_ESB_DPL, 3);
+	peer_prx_start(ESB_PROTOCOL_ESB_DPL);
+
+	payload_fill(&payload, 0);
+	zassert_ok(esb_write_payload(&payload), NULL);
+	esb_sim_run(PACKET_TIMEOUT_US);
+
+	esb_sim_peer_stats_get(&stats);
+	zassert_equal(tx_failed, 1, NULL);
+	zassert_equal(last_tx_attempts, 4, NULL);
+	/* The peer got the packet, and all the retransmissions. */
+	zassert_equal(stats.rx_packets, 1, NULL);
+	zassert_equal(stats.rx_retransmits, 3, NULL);
+}
+
+static void test_ptx_crc_error(void)
+{
+	struct esb_sim_channel_config channel = ESB_SIM_CHANNEL_DEFAULT_CONFIG;
+	struct esb_sim_peer_stats stats;
+
+	channel.crc_error_permille = 200;
+	esb_sim_channel_set(&channel);
+
+	dut_init(ESB_MODE_PTX, ESB_PROTOCOL_ESB_DPL, 15);
+	peer_prx_start(ESB_PROTOCOL_ESB_DPL);
+
+	ptx_send(PACKET_COUNT);
+
+	esb_sim_peer_stats_get(&stats);
+	zassert_equal(tx_success, PACKET_COUNT, NULL);
+	zassert_equal(stats.rx_packets, PACKET_COUNT, NULL);
+}
+
+static void test_ptx_legacy(void)
+{
+	struct esb_sim_peer_stats stats;
+
+	dut_init(ESB_MODE_PTX, ESB_PROTOCOL_ESB, 3);
+	peer_prx_start(ESB_PROTOCOL_ESB);
+
+	ptx_send(PACKET_COUNT);
+
+	esb_sim_peer_stats_get(&stats);
+	zassert_equal(tx_success, PACKET_COUNT, NULL);
+	zassert_equal(stats.rx_packets, PACKET_COUNT, NULL);
+	zassert_equal(stats.rx_retransmits, 0, NULL);
+}
+
+static void test_prx_ack_payload(void)
+{
+	struct esb_sim_peer_config config = ESB_SIM_PEER_DEFAULT_CONFIG;
+	struct esb_sim_peer_stats stats;
+	struct esb_pipe_stats pipe_stats;
+	struct esb_payload payload;
+	const uint32_t ack_payloads = 4;
+
+	dut_init(ESB_MODE_PRX, ESB_PROTOCOL_ESB_DPL, 3);
+
+	for (uint32_t i = 0; i < ack_payloads; i++) {
+		payload_fill(&payload, i);
+		payload.length = 8;
+		zassert_ok(esb_write_payload(&payload), NULL);
+	}
+
+	zassert_ok(esb_start_rx(), NULL);
+
+	config.mode = ESB_MODE_PTX;
+	config.packet_count = PACKET_COUNT;
+	config.packet_interval_us = 1000;
+	config.rx_handler = peer_rx_handler;
+	zassert_ok(esb_sim_peer_start(&config), NULL);
+
+	esb_sim_run(PACKET_COUNT * 1000 + PACKET_TIMEOUT_US);
+
+	esb_sim_peer_stats_get(&stats);
+	zassert_equal(stats.tx_packets, PACKET_COUNT, NULL);
+	zassert_equal(stats.tx_success, PACKET_COUNT, NULL);
+	zassert_equal(stats.tx_retransmits, 0, NULL);
+	zassert_equal(rx_received, PACKET_COUNT, NULL);
+
+	/* Each ACK payload is reported sent when the next packet arrives. */
+	zassert_equal(stats.rx_packets, ack_payloads, NULL);
+	zassert_equal(peer_rx_last.length, 8, NULL);
+	zassert_equal(peer_rx_last.data[0], ack_payloads - 1, NULL);
+	zassert_equal(tx_success, ack_payloads, NULL);
+
+	zassert_ok(esb_get_pipe_stats(0, &pipe_stats), NULL);
+	zassert_equal(pipe_stats.tx_success, ack_payloads, NULL);
+	zassert_equal(pipe_stats.tx_bytes, ack_payloads * 8, NULL);
+	zassert_equal(pipe_stats.rx_packets, PACKET_COUNT, NULL);
+	zassert_equal(pipe_stats.rx_bytes, PACKET_COUNT * PACKET_LENGTH, NULL);
+	zassert_equal(pipe_stats.ack_lost, 0, NULL);
+
+	TC_PRINT("PRX: %u packets, average latency %u us, max %u us\n",
+		 stats.tx_success,
+		 (uint32_t)(stats.tx_latency_total_us / stats.tx_success),
+		 stats.tx_latency_max_us);
+
+	zassert_ok(esb_stop_rx(), NULL);
+}
+
+static void test_prx_loss(void)
+{
+	struct esb_sim_channel_config channel = ESB_SIM_CHANNEL_DEFAULT_CONFIG;
+	struct esb_sim_peer_config config = ESB_SIM_PEER_DEFAULT_CONFIG;
+	struct esb_sim_peer_stats stats;
+	struct esb_pipe_stats pipe_stats;
+
+	channel.loss_permille = 100;
+	esb_sim_channel_set(&channel);
+
+	dut_init(ESB_MODE_PRX, ESB_PROTOCOL_ESB_DPL, 3);
+	zassert_ok(esb_start_rx(), NULL);
+
+	config.mode = ESB_MODE_PTX;
+	config.packet_count = PACKET_COUNT;
+	config.retransmit_count = 15;
+	zassert_ok(esb_sim_peer_start(&config), NULL);
+
+	esb_sim_run(PACKET_COUNT * 10000);
+
+	esb_sim_peer_stats_get(&stats);
+	zassert_equal(stats.tx_success, PACKET_COUNT, NULL);
+	zassert_not_equal(stats.tx_retransmits, 0, NULL);
+	/* Retransmissions of packets whose ACK got lost are dropped. */
+	zassert_equal(rx_received, PACKET_COUNT, NULL);
+
+	zassert_ok(esb_get_pipe_stats(0, &pipe_stats), NULL);
+	zassert_equal(pipe_stats.rx_packets, PACKET_COUNT, NULL);
+	zassert_not_equal(pipe_stats.ack_lost, 0, NULL);
+	zassert_true(pipe_stats.ack_lost <= stats.tx_retransmits, NULL);
+
+	TC_PRINT("PRX, 10%% loss: %u packets, %u retransmits, "
+		 "average latency %u us, max %u us\n",
+		 stats.tx_success, stats.tx_retransmits,
+		 (uint32_t)(stats.tx_latency_total_us / stats.tx_success),
+		 stats.tx_latency_max_us);
+
+	zassert_ok(esb_stop_rx(), NULL);
+}
+
+static void test_ptx_pipe_weights(void)
+{
+	struct esb_payload payload;
+	struct esb_pipe_stats pipe_stats;
+	uint32_t count[2] = {0};
+	const uint32_t packets = 80;
+
+	dut_init(ESB_MODE_PTX, ESB_PROTOCOL_ESB_DPL, 3);
+	peer_prx_start(ESB_PROTOCOL_ESB_DPL);
+
+	zassert_ok(esb_set_pipe_weight(0, 3), NULL);
+	zassert_equal(esb_set_pipe_weight(1, 0), -EINVAL, NULL);
+
+	/* Keep packets queued on both pipes. */
+	while (peer_rx_count < packets) {
+		for (uint8_t pipe = 0; pipe < 2; pipe++) {
+			payload_fill(&payload, peer_rx_count);
+			payload.pipe = pipe;
+			(void)esb_write_payload(&payload);
+		}
+
+		esb_sim_run(100);
+	}
+
+	for (uint32_t i = 0; i < packets; i++) {
+		count[peer_rx_pipes[i]]++;
+	}
+
+	/* The first turn of pipe 0 started before its weight was set. */
+	zassert_mem_equal(peer_rx_pipes, ((uint8_t[]){0, 1, 0, 0, 0, 1}), 6,
+			  NULL);
+	zassert_equal(count[0], 60, "%u packets on pipe 0", count[0]);
+	zassert_equal(count[1], 20, "%u packets on pipe 1", count[1]);
+
+	zassert_ok(esb_get_pipe_stats(1, &pipe_stats), NULL);
+	zassert_true(pipe_stats.tx_success >= count[1], NULL);
+	zassert_ok(esb_reset_pipe_stats(1), NULL);
+	zassert_ok(esb_get_pipe_stats(1, &pipe_stats), NULL);
+	zassert_equal(pipe_stats.tx_success, 0, NULL);
+}
+
+static void test_pipe_queue_size(void)
+{
+	struct esb_config config = ESB_DEFAULT_CONFIG;
+	struct esb_payload payload;
+
+	config.tx_mode = ESB_TXMODE_MANUAL;
+	zassert_ok(esb_init(&config), NULL);
+
+	/* A pipe cannot take the TX FIFO elements of the other pipes. */
+	payload_fill(&payload, 0);
+	for (int i = 0; i < CONFIG_ESB_TX_PIPE_QUEUE_SIZE; i++) {
+		zassert_ok(esb_write_payload(&payload), NULL);
+	}
+	zassert_equal(esb_write_payload(&payload), -ENOMEM, NULL);
+
+	payload.pipe = 1;
+	zassert_ok(esb_write_payload(&payload), NULL);
+
+	/* Popping a payload makes room on its pipe. */
+	zassert_ok(esb_pop_tx(), NULL);
+	payload.pipe = 0;
+	zassert_ok(esb_write_payload(&payload), NULL);
+	zassert_equal(esb_write_payload(&payload), -ENOMEM, NULL);
+}
+
+static void test_ptx_pop(void)
+{
+	struct esb_config config = ESB_DEFAULT_CONFIG;
+	struct esb_payload payload;
+
+	config.tx_mode = ESB_TXMODE_MANUAL;
+	config.payload_length = PACKET_LENGTH;
+	config.event_handler = event_handler;
+	zassert_ok(esb_init(&config), NULL);
+	peer_prx_start(ESB_PROTOCOL_ESB_DPL);
+
+	zassert_equal(esb_pop_tx(), -ENODATA, NULL);
+
+	for (uint32_t i = 0; i < 4; i++) {
+		payload_fill(&payload, i);
+		payload.pipe = (i < 3) ? 0 : 1;
+		zassert_ok(esb_write_payload(&payload), NULL);
+	}
+
+	/* The payload that would be sent next is removed. */
+	zassert_ok(esb_pop_tx(), NULL);
+
+	/* The payload in flight can't be removed. */
+	zassert_ok(esb_start_tx(), NULL);
+	zassert_equal(esb_pop_tx(), -EBUSY, NULL);
+	zassert_equal(esb_flush_tx(), -EBUSY, NULL);
+	esb_sim_run(PACKET_TIMEOUT_US);
+
+	/* Pipe 0 used up its turn, so the payload of pipe 1 is removed. */
+	zassert_ok(esb_pop_tx(), NULL);
+
+	while (esb_start_tx() == 0) {
+		esb_sim_run(PACKET_TIMEOUT_US);
+	}
+
+	zassert_equal(tx_success, 2, NULL);
+	zassert_equal(peer_rx_count, 2, NULL);
+	zassert_mem_equal(peer_rx_pipes, ((uint8_t[]){0, 0}), 2, NULL);
+	zassert_equal(peer_rx_last.data[0], 2, NULL);
+}
+
+static void test_tx_payload_borrow(void)
+{
+	struct esb_config config = ESB_DEFAULT_CONFIG;
+	struct esb_payload *payload;
+	struct esb_payload *other;
+	struct esb_payload copy;
+
+	config.tx_mode = ESB_TXMODE_MANUAL;
+	config.payload_length = PACKET_LENGTH;
+	config.event_handler = event_handler;
+	zassert_ok(esb_init(&config), NULL);
+	peer_prx_start(ESB_PROTOCOL_ESB_DPL);
+
+	/* Only one payload can be allocated, and the FIFO is kept intact. */
+	zassert_ok(esb_tx_payload_alloc(&payload), NULL);
+	zassert_equal(esb_tx_payload_alloc(&other), -EBUSY, NULL);
+	payload_fill(&copy, 0);
+	zassert_equal(esb_write_payload(&copy), -EBUSY, NULL);
+	zassert_equal(esb_flush_tx(), -EBUSY, NULL);
+	zassert_equal(esb_tx_payload_submit(&copy), -EINVAL, NULL);
+	zassert_ok(esb_tx_payload_discard(payload), NULL);
+	zassert_equal(esb_tx_payload_discard(payload), -EINVAL, NULL);
+	zassert_equal(esb_tx_payload_submit(payload), -EINVAL, NULL);
+	zassert_equal(esb_pop_tx(), -ENODATA, NULL);
+
+	/* An invalid payload stays allocated. */
+	zassert_ok(esb_tx_payload_alloc(&payload), NULL);
+	payload_fill(payload, 1);
+	payload->length = CONFIG_ESB_MAX_PAYLOAD_LENGTH + 1;
+	zassert_equal(esb_tx_payload_submit(payload), -EMSGSIZE, NULL);
+	payload->length = PACKET_LENGTH;
+	zassert_ok(esb_tx_payload_submit(payload), NULL);
+
+	zassert_ok(esb_tx_payload_alloc(&payload), NULL);
+	zassert_equal(esb_pop_tx(), -EBUSY, NULL);
+	payload_fill(payload, 2);
+	zassert_ok(esb_tx_payload_submit(payload), NULL);
+
+	/* A payload that doesn't fit in its pipe queue stays allocated. */
+	for (int i = 2; i < CONFIG_ESB_TX_PIPE_QUEUE_SIZE; i++) {
+		zassert_ok(esb_tx_payload_alloc(&payload), NULL);
+		payload_fill(payload, i + 1);
+		zassert_ok(esb_tx_payload_submit(payload), NULL);
+	}
+
+	zassert_ok(esb_tx_payload_alloc(&payload), NULL);
+	payload_fill(payload, CONFIG_ESB_TX_PIPE_QUEUE_SIZE + 1);
+	zassert_equal(esb_tx_payload_submit(payload), -ENOMEM, NULL);
+	payload->pipe = 1;
+	zassert_ok(esb_tx_payload_submit(payload), NULL);
+
+	/* The manual TX mode sends one payload at a time. */
+	while (esb_start_tx() == 0) {
+		esb_sim_run(PACKET_TIMEOUT_US);
+	}
+
+	zassert_equal(tx_success, CONFIG_ESB_TX_PIPE_QUEUE_SIZE + 1, NULL);
+	zassert_equal(peer_rx_count, CONFIG_ESB_TX_PIPE_QUEUE_SIZE + 1, NULL);
+	zassert_equal(peer_rx_last.length, PACKET_LENGTH, NULL);
+	zassert_ok(esb_flush_tx(), NULL);
+}
+
+static void test_rx_payload_borrow(void)
+{
+	struct esb_sim_peer_config config = ESB_SIM_PEER_DEFAULT_CONFIG;
+	struct esb_payload *payload;
+	struct esb_payload *other;
+	struct esb_payload copy;
+	const uint32_t packets = 4;
+
+	rx_keep = true;
+	dut_init(ESB_MODE_PRX, ESB_PROTOCOL_ESB_DPL, 3);
+	zassert_equal(esb_rx_payload_get(&payload), -ENODATA, NULL);
+	zassert_ok(esb_start_rx(), NULL);
+
+	config.mode = ESB_MODE_PTX;
+	config.packet_count = packets;
+	config.packet_interval_us = 1000;
+	zassert_ok(esb_sim_peer_start(&config), NULL);
+
+	esb_sim_run(1500);
+	zassert_ok(esb_rx_payload_get(&payload), NULL);
+	zassert_equal(payload->length, PACKET_LENGTH, NULL);
+	zassert_equal(payload->data[0], 1, NULL);
+
+	/* The borrowed payload is not overwritten by the next packets. */
+	esb_sim_run(packets * 1000 + PACKET_TIMEOUT_US);
+	zassert_equal(payload->data[0], 1, NULL);
+
+	/* Only one payload can be borrowed, and the FIFO is kept intact. */
+	zassert_equal(esb_rx_payload_get(&other), -EBUSY, NULL);
+	zassert_equal(esb_read_rx_payload(&copy), -EBUSY, NULL);
+	zassert_equal(esb_flush_rx(), -EBUSY, NULL);
+	zassert_equal(esb_rx_payload_release(&copy), -EINVAL, NULL);
+	zassert_ok(esb_rx_payload_release(payload), NULL);
+	zassert_equal(esb_rx_payload_release(payload), -EINVAL, NULL);
+
+	/* The next payloads are received in order. */
+	zassert_ok(esb_rx_payload_get(&payload), NULL);
+	zassert_equal(payload->data[0], 2, NULL);
+	zassert_ok(esb_rx_payload_release(payload), NULL);
+	zassert_ok(esb_read_rx_payload(&copy), NULL);
+	zassert_equal(copy.data[0], 3, NULL);
+
+	zassert_ok(esb_flush_rx(), NULL);
+	zassert_equal(esb_rx_payload_get(&payload), -ENODATA, NULL);
+
+	zassert_ok(esb_stop_rx(), NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(esb_sim_test,
+			 ztest_unit_test_setup_teardown(test_ptx_throughput,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(
+				 test_ptx_throughput_loss_10, setup,
+				 unit_test_noop),
+			 ztest_unit_test_setup_teardown(
+				 test_ptx_throughput_loss_30, setup,
+				 unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_ptx_latency,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_ptx_retransmit,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_ptx_ack_window,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_ptx_crc_error,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_ptx_legacy,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_prx_ack_payload,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_prx_loss,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_ptx_pipe_weights,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_pipe_queue_size,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_ptx_pop,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_tx_payload_borrow,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_rx_payload_borrow,
+							setup, unit_test_noop)
+			 );
+
+	ztest_run_test_suite(esb_sim_test);
+}
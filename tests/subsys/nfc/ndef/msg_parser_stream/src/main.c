@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <nfc/ndef/msg_parser.h>
+
+#define MAX_RECORDS 4
+#define TYPE_LEN_MAX 8
+#define ID_LEN_MAX 8
+#define PAYLOAD_LEN_MAX 300
+
+/* First record: short record with an ID. */
+static const uint8_t rec_first[] = {
+	NDEF_FIRST_RECORD | NDEF_RECORD_SR_MASK | NDEF_RECORD_IL_MASK | TNF_WELL_KNOWN,
+	1, 3, 2, 'T', 'i', 'd', 'a', 'b', 'c'
+};
+
+/* Middle record: long record without an ID, followed by its payload. */
+static const uint8_t rec_middle_hdr[] = {
+	NDEF_MIDDLE_RECORD | TNF_MEDIA_TYPE,
+	4, 0x00, 0x00, 0x01, 0x04, 't', 'e', 'x', 't'
+};
+
+#define REC_MIDDLE_PAYLOAD_LEN 260
+#define REC_MIDDLE_LEN (sizeof(rec_middle_hdr) + REC_MIDDLE_PAYLOAD_LEN)
+
+/* Last record: short record with an empty ID and no payload. */
+static const uint8_t rec_last[] = {
+	NDEF_LAST_RECORD | NDEF_RECORD_SR_MASK | NDEF_RECORD_IL_MASK | TNF_ABSOLUTE_URI,
+	1, 0, 0, 'u'
+};
+
+static const uint8_t rec_lone[] = {
+	NDEF_LONE_RECORD | NDEF_RECORD_SR_MASK | TNF_WELL_KNOWN,
+	1, 2, 'U', 0x01, 'x'
+};
+
+struct record {
+	enum nfc_ndef_record_tnf tnf;
+	uint8_t type[TYPE_LEN_MAX];
+	uint8_t type_length;
+	uint8_t id[ID_LEN_MAX];
+	uint8_t id_length;
+	uint8_t payload[PAYLOAD_LEN_MAX];
+	uint32_t payload_length;
+};
+
+static uint8_t msg[sizeof(rec_first) + REC_MIDDLE_LEN + sizeof(rec_last)];
+static uint8_t record_buf[REC_MIDDLE_LEN];
+static struct nfc_ndef_msg_parser_stream parser;
+static struct record records[MAX_RECORDS];
+static struct record expected[MAX_RECORDS];
+static uint32_t record_count;
+static uint32_t expected_count;
+static bool last_reported;
+static int cb_err;
+
+static void record_copy(struct record *rec, const struct nfc_ndef_record_desc *rec_desc)
+{
+	const struct nfc_ndef_bin_payload_desc *payload = rec_desc->payload_descriptor;
+
+	zassert_true(rec_desc->type_length <= TYPE_LEN_MAX, "Type too long");
+	zassert_true(rec_desc->id_length <= ID_LEN_MAX, "ID too long");
+	zassert_true(payload->payload_length <= PAYLOAD_LEN_MAX, "Payload too long");
+
+	memset(rec, 0, sizeof(*rec));
+	rec->tnf = rec_desc->tnf;
+	rec->type_length = rec_desc->type_length;
+	memcpy(rec->type, rec_desc->type, rec_desc->type_length);
+	rec->id_length = rec_desc->id_length;
+	memcpy(rec->id, rec_desc->id, rec_desc->id_length);
+	rec->payload_length = payload->payload_length;
+	memcpy(rec->payload, payload->payload, payload->payload_length);
+}
+
+static int record_cb(struct nfc_ndef_msg_parser_stream *p, uint32_t index,
+		     const struct nfc_ndef_record_desc *rec_desc, bool last)
+{
+	zassert_equal_ptr(p, &parser, "Wrong parser");
+	zassert_equal(index, record_count, "Wrong record index");
+	zassert_true(record_count < MAX_RECORDS, "Too many records");
+	zassert_false(last_reported, "Record after the last one");
+
+	record_copy(&records[record_count++], rec_desc);
+	last_reported = last;
+
+	return cb_err;
+}
+
+static void msg_build(void)
+{
+	uint8_t *p = msg;
+
+	memcpy(p, rec_first, sizeof(rec_first));
+	p += sizeof(rec_first);
+	memcpy(p, rec_middle_hdr, sizeof(rec_middle_hdr));
+	p += sizeof(rec_middle_hdr);
+
+	for (int i = 0; i < REC_MIDDLE_PAYLOAD_LEN; i++) {
+		*(p++) = i;
+	}
+
+	memcpy(p, rec_last, sizeof(rec_last));
+}
+
+/* Parse the message with the regular parser to get the expected records. */
+static void reference_parse(const uint8_t *data, uint32_t len)
+{
+	uint8_t desc_buf[NFC_NDEF_PARSER_REQIRED_MEMO_SIZE_CALC(MAX_RECORDS)];
+	uint32_t desc_len = sizeof(desc_buf);
+	const struct nfc_ndef_msg_desc *msg_desc =
+		(const struct nfc_ndef_msg_desc *)desc_buf;
+
+	zassert_ok(nfc_ndef_msg_parse(desc_buf, &desc_len, data, &len),
+		   "Reference parsing failed");
+
+	for (int i = 0; i < msg_desc->record_count; i++) {
+		record_copy(&expected[i], msg_desc->record[i]);
+	}
+
+	expected_count = msg_desc->record_count;
+}
+
+static void stream_init(uint32_t buf_size)
+{
+	memset(records, 0, sizeof(records));
+	record_count = 0;
+	last_reported = false;
+	cb_err = 0;
+
+	nfc_ndef_msg_parser_stream_init(&parser, record_buf, buf_size, record_cb);
+}
+
+/* Push the first split bytes of the data, and the rest in chunks of the
+ * given size, until the parser reports an error or the end of the message.
+ */
+static int stream_parse(const uint8_t *data, uint32_t len, uint32_t split,
+			uint32_t chunk, uint32_t *consumed)
+{
+	uint32_t offset = 0;
+	uint32_t size = split;
+	uint32_t push_len;
+	int err;
+
+	*consumed = 0;
+
+	while ((offset < len) && !nfc_ndef_msg_parser_stream_done(&parser)) {
+		push_len = MIN(size, len - offset);
+		size = chunk;
+
+		err = nfc_ndef_msg_parser_stream_push(&parser, &data[offset], &push_len);
+		offset += push_len;
+		*consumed = offset;
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static void records_check(void)
+{
+	zassert_equal(record_count, expected_count, "Wrong record count");
+	zassert_true(last_reported, "Last record not reported");
+	zassert_true(nfc_ndef_msg_parser_stream_done(&parser), "Parser not done");
+
+	for (int i = 0; i < record_count; i++) {
+		zassert_equal(records[i].tnf, expected[i].tnf, "Record %d: wrong TNF", i);
+		zassert_equal(records[i].type_length, expected[i].type_length,
+			      "Record %d: wrong type length", i);
+		zassert_mem_equal(records[i].type, expected[i].type, expected[i].type_length,
+				  "Record %d: wrong type", i);
+		zassert_equal(records[i].id_length, expected[i].id_length,
+			      "Record %d: wrong ID length", i);
+		zassert_mem_equal(records[i].id, expected[i].id, expected[i].id_length,
+				  "Record %d: wrong ID", i);
+		zassert_equal(records[i].payload_length, expected[i].payload_length,
+			      "Record %d: wrong payload length", i);
+		zassert_mem_equal(records[i].payload, expected[i].payload,
+				  expected[i].payload_length, "Record %d: wrong payload", i);
+	}
+}
+
+static void split_check(const uint8_t *data, uint32_t len)
+{
+	uint32_t consumed;
+
+	reference_parse(data, len);
+
+	/* The record buffer only fits the largest record, and every offset
+	 * splits a header, type length, ID length or field of some record.
+	 */
+	for (uint32_t split = 0; split <= len; split++) {
+		stream_init(sizeof(record_buf));
+		zassert_ok(stream_parse(data, len, split, len, &consumed),
+			   "Parsing failed at split %u", split);
+		zassert_equal(consumed, len, "Wrong consumed length at split %u", split);
+		records_check();
+	}
+
+	stream_init(sizeof(record_buf));
+	zassert_ok(stream_parse(data, len, 1, 1, &consumed), "Parsing bytewise failed");
+	zassert_equal(consumed, len, "Wrong consumed length");
+	records_check();
+}
+
+static void test_split(void)
+{
+	msg_build();
+
+	split_check(msg, sizeof(msg));
+	split_check(rec_lone, sizeof(rec_lone));
+}
+
+static void test_in_place(void)
+{
+	uint32_t consumed;
+
+	msg_build();
+	reference_parse(msg, sizeof(msg));
+
+	/* Records that are complete in a chunk need no record buffer. */
+	stream_init(0);
+	zassert_ok(stream_parse(msg, sizeof(msg), sizeof(msg), sizeof(msg), &consumed),
+		   "Parsing failed");
+	zassert_equal(consumed, sizeof(msg), "Wrong consumed length");
+	records_check();
+}
+
+static void test_trailing_data(void)
+{
+	uint8_t data[sizeof(rec_lone) + sizeof(rec_first)];
+	uint32_t consumed;
+
+	memcpy(data, rec_lone, sizeof(rec_lone));
+	memcpy(&data[sizeof(rec_lone)], rec_first, sizeof(rec_first));
+	reference_parse(data, sizeof(data));
+
+	for (uint32_t split = 0; split <= sizeof(data); split++) {
+		stream_init(sizeof(record_buf));
+		zassert_ok(stream_parse(data, sizeof(data), split, sizeof(data), &consumed),
+			   "Parsing failed at split %u", split);
+		zassert_equal(consumed, sizeof(rec_lone),
+			      "Trailing data consumed at split %u", split);
+		records_check();
+	}
+}
+
+static void test_no_mem(void)
+{
+	uint32_t consumed;
+
+	msg_build();
+
+	/* Split inside the header of the first record. */
+	stream_init(2);
+	zassert_equal(stream_parse(msg, sizeof(msg), 1, sizeof(msg), &consumed), -ENOMEM,
+		      "Header overflowed the record buffer");
+	zassert_equal(consumed, 1, "Wrong consumed length");
+	zassert_equal(record_count, 0, "Unexpected records");
+
+	/* Split inside the middle record, which is larger than the buffer. */
+	stream_init(REC_MIDDLE_LEN - 1);
+	zassert_equal(stream_parse(msg, sizeof(msg), sizeof(rec_first) + 1, sizeof(msg),
+				   &consumed), -ENOMEM,
+		      "Record overflowed the record buffer");
+	zassert_equal(record_count, 1, "Wrong record count");
+
+	/* The same record is parsed in place if it's not split. */
+	stream_init(REC_MIDDLE_LEN - 1);
+	zassert_ok(stream_parse(msg, sizeof(msg), sizeof(rec_first), sizeof(msg), &consumed),
+		   "Parsing failed");
+	zassert_equal(record_count, 3, "Wrong record count");
+}
+
+static void location_check(const uint8_t *data, uint32_t len, uint32_t records_before)
+{
+	uint8_t desc_buf[NFC_NDEF_PARSER_REQIRED_MEMO_SIZE_CALC(MAX_RECORDS)];
+	uint32_t desc_len = sizeof(desc_buf);
+	uint32_t raw_len = len;
+	uint32_t consumed;
+
+	zassert_equal(nfc_ndef_msg_parse(desc_buf, &desc_len, data, &raw_len), -EFAULT,
+		      "Reference parser accepted the message");
+
+	for (uint32_t split = 0; split <= len; split++) {
+		stream_init(sizeof(record_buf));
+		zassert_equal(stream_parse(data, len, split, len, &consumed), -EFAULT,
+			      "Wrong location accepted at split %u", split);
+		zassert_equal(record_count, records_before,
+			      "Wrong record count at split %u", split);
+		zassert_false(last_reported, "Last record reported");
+	}
+}
+
+static void test_location(void)
+{
+	uint8_t data[sizeof(msg)];
+	uint32_t consumed;
+
+	msg_build();
+
+	/* First record without the Message Begin flag. */
+	memcpy(data, msg, sizeof(msg));
+	data[0] &= ~NDEF_FIRST_RECORD;
+	location_check(data, sizeof(data), 0);
+
+	/* Last record in the first place. */
+	memcpy(data, msg, sizeof(msg));
+	data[0] ^= NDEF_LONE_RECORD;
+	location_check(data, sizeof(data), 0);
+
+	/* Middle record with the Message Begin flag. */
+	memcpy(data, msg, sizeof(msg));
+	data[sizeof(rec_first)] |= NDEF_FIRST_RECORD;
+	location_check(data, sizeof(data), 1);
+
+	/* Lone record after the first record. */
+	memcpy(data, msg, sizeof(msg));
+	data[sizeof(msg) - sizeof(rec_last)] |= NDEF_FIRST_RECORD;
+	location_check(data, sizeof(data), 2);
+
+	/* A message without the Message End flag is never done. */
+	stream_init(sizeof(record_buf));
+	zassert_ok(stream_parse(msg, sizeof(msg) - sizeof(rec_last), sizeof(rec_first) + 1,
+				sizeof(msg), &consumed), "Parsing failed");
+	zassert_equal(record_count, 2, "Wrong record count");
+	zassert_false(nfc_ndef_msg_parser_stream_done(&parser), "Parser done");
+}
+
+static void test_cb_error(void)
+{
+	uint32_t consumed;
+
+	msg_build();
+
+	stream_init(sizeof(record_buf));
+	cb_err = -ECANCELED;
+	zassert_equal(stream_parse(msg, sizeof(msg), sizeof(msg), sizeof(msg), &consumed),
+		      -ECANCELED, "Callback error not returned");
+	zassert_equal(record_count, 1, "Parsing not stopped");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nfc_ndef_msg_parser_stream_test,
+			 ztest_unit_test(test_split),
+			 ztest_unit_test(test_in_place),
+			 ztest_unit_test(test_trailing_data),
+			 ztest_unit_test(test_no_mem),
+			 ztest_unit_test(test_location),
+			 ztest_unit_test(test_cb_error)
+			 );
+
+	ztest_run_test_suite(nfc_ndef_msg_parser_stream_test);
+}
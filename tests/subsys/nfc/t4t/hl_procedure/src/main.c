@@ -0,0 +1,763 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <ztest.h>
+#include <sys/byteorder.h>
+#include <nfc/t4t/apdu.h>
+#include <nfc/t4t/cc_file.h>
+#include <nfc/t4t/hl_procedure.h>
+#include <nfc/t4t/isodep.h>
+
+#define RAPDU_MAX_SIZE CONFIG_NFC_T4T_HL_PROCEDURE_RAPDU_MAX_SIZE
+#define APDU_STATUS_SIZE 2
+
+#define TX_BUF_SIZE 256
+#define RX_BUF_SIZE MAX(256, RAPDU_MAX_SIZE + APDU_STATUS_SIZE)
+
+#define NDEF_FILE_ID 0xE104
+#define NDEF_FILE_SIZE 1024
+#define NDEF_MSG_LEN 1000
+#define NDEF_FILE_NLEN_SIZE 2
+#define CC_FILE_ID 0xE103
+#define CC_FILE_SIZE 15
+
+#define ISODEP_CRC_SIZE 2
+#define ISODEP_PCB_SIZE 1
+#define ISODEP_CHAINING_BIT BIT(4)
+#define RATS_CMD 0xE0
+
+#define STATUS_WRONG_LENGTH 0x6700
+#define STATUS_INS_NOT_SUPPORTED 0x6D00
+
+/* Time model for the simulated tag, in microseconds. A bit takes 128/fc at
+ * 106 kbit/s, and a byte is sent with a parity bit.
+ */
+#define BYTE_AIR_TIME_NS (9 * 9440)
+#define FRAME_DELAY_US 100
+#define TAG_PROCESSING_US 500
+#define CHUNK_PROCESSING_US 2000
+
+static const uint16_t fsd_value_map[] = {16, 24, 32, 40, 48, 64, 96, 128, 256};
+static const uint8_t ndef_app_name[] = {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01,
+					0x01};
+
+static uint8_t tx_buf[TX_BUF_SIZE];
+static uint8_t rx_buf[RX_BUF_SIZE];
+static uint8_t ndef_buf[NDEF_FILE_SIZE];
+static uint8_t ndef_msg[NDEF_FILE_SIZE];
+static uint8_t chunk_buf[NDEF_FILE_SIZE];
+
+NFC_T4T_CC_DESC_DEF(t4t_cc, 1);
+
+/* Simulated Type 4 Tag. */
+static struct {
+	/* Configuration. */
+	uint8_t fsci;
+	uint16_t mle;
+	uint16_t mlc;
+
+	/* Files. */
+	uint8_t cc[CC_FILE_SIZE];
+	uint8_t ndef[NDEF_FILE_SIZE];
+	uint8_t *file;
+	size_t file_size;
+
+	/* ISO-DEP state. */
+	uint16_t fsd;
+	uint8_t capdu[NDEF_FILE_SIZE + 16];
+	size_t capdu_len;
+	uint8_t rapdu[RX_BUF_SIZE];
+	size_t rapdu_len;
+	size_t rapdu_sent;
+	uint8_t frame[TX_BUF_SIZE + ISODEP_PCB_SIZE];
+	size_t frame_len;
+	struct k_sem frame_sem;
+
+	/* Simulated time. */
+	uint64_t now;
+	uint64_t radio_free;
+	uint64_t frame_ready;
+
+	/* Statistics. */
+	uint32_t frames;
+	uint32_t reads;
+	uint32_t updates;
+	size_t update_max;
+	bool frame_size_err;
+} tag;
+
+/* Reader state. */
+static struct {
+	enum {
+		OP_NONE,
+		OP_READ,
+		OP_READ_STREAM,
+		OP_UPDATE
+	} op;
+	bool done;
+	int err;
+	size_t chunk_len;
+	uint64_t start;
+	uint64_t end;
+} reader;
+
+static uint64_t air_time(size_t len)
+{
+	return ((len + ISODEP_CRC_SIZE) * BYTE_AIR_TIME_NS) / 1000;
+}
+
+static void tag_config(uint8_t fsci, uint16_t mle, uint16_t mlc)
+{
+	tag.fsci = fsci;
+	tag.mle = mle;
+	tag.mlc = mlc;
+
+	sys_put_be16(CC_FILE_SIZE, &tag.cc[0]);
+	tag.cc[2] = 0x20;
+	sys_put_be16(mle, &tag.cc[3]);
+	sys_put_be16(mlc, &tag.cc[5]);
+	tag.cc[7] = NFC_T4T_TLV_BLOCK_TYPE_NDEF_FILE_CONTROL_TLV;
+	tag.cc[8] = 6;
+	sys_put_be16(NDEF_FILE_ID, &tag.cc[9]);
+	sys_put_be16(NDEF_FILE_SIZE, &tag.cc[11]);
+	tag.cc[13] = 0x00;
+	tag.cc[14] = 0x00;
+
+	for (size_t i = 0; i < NDEF_MSG_LEN; i++) {
+		ndef_msg[i] = i * 7 + (i >> 8);
+	}
+
+	memset(tag.ndef, 0, sizeof(tag.ndef));
+	sys_put_be16(NDEF_MSG_LEN, tag.ndef);
+	memcpy(&tag.ndef[NDEF_FILE_NLEN_SIZE], ndef_msg, NDEF_MSG_LEN);
+
+	tag.file = NULL;
+	tag.capdu_len = 0;
+	tag.now = 0;
+	tag.radio_free = 0;
+	tag.frames = 0;
+	tag.reads = 0;
+	tag.updates = 0;
+	tag.update_max = 0;
+	tag.frame_size_err = false;
+}
+
+static void rapdu_status_set(uint16_t status)
+{
+	sys_put_be16(status, &tag.rapdu[tag.rapdu_len]);
+	tag.rapdu_len += APDU_STATUS_SIZE;
+}
+
+static void tag_select(uint8_t p1, const uint8_t *data, size_t lc)
+{
+	if (p1 == NFC_T4T_APDU_SELECT_BY_NAME >> 8) {
+		if ((lc != sizeof(ndef_app_name)) ||
+		    memcmp(data, ndef_app_name, lc)) {
+			rapdu_status_set(NFC_T4T_APDU_RAPDU_STATUS_SEL_ITEM_NOT_FOUND);
+			return;
+		}
+	} else if ((lc == sizeof(uint16_t)) &&
+		   (sys_get_be16(data) == CC_FILE_ID)) {
+		tag.file = tag.cc;
+		tag.file_size = sizeof(tag.cc);
+	} else if ((lc == sizeof(uint16_t)) &&
+		   (sys_get_be16(data) == NDEF_FILE_ID)) {
+		tag.file = tag.ndef;
+		tag.file_size = sizeof(tag.ndef);
+	} else {
+		rapdu_status_set(NFC_T4T_APDU_RAPDU_STATUS_SEL_ITEM_NOT_FOUND);
+		return;
+	}
+
+	rapdu_status_set(NFC_T4T_APDU_RAPDU_STATUS_CMD_COMPLETED);
+}
+
+static void tag_read(uint16_t offset, size_t le)
+{
+	size_t len;
+
+	if (!tag.file || (offset >= tag.file_size) || (le > tag.mle)) {
+		rapdu_status_set(STATUS_WRONG_LENGTH);
+		return;
+	}
+
+	if (tag.file == tag.ndef) {
+		tag.reads++;
+	}
+
+	len = MIN(le, tag.file_size - offset);
+	zassert_true(len + APDU_STATUS_SIZE <= sizeof(tag.rapdu), NULL);
+
+	memcpy(tag.rapdu, &tag.file[offset], len);
+	tag.rapdu_len = len;
+	rapdu_status_set(NFC_T4T_APDU_RAPDU_STATUS_CMD_COMPLETED);
+}
+
+static void tag_update(uint16_t offset, const uint8_t *data, size_t lc)
+{
+	if ((tag.file != tag.ndef) || (offset + lc > tag.file_size) ||
+	    (lc > tag.mlc)) {
+		rapdu_status_set(STATUS_WRONG_LENGTH);
+		return;
+	}
+
+	tag.updates++;
+	tag.update_max = MAX(tag.update_max, lc);
+
+	memcpy(&tag.file[offset], data, lc);
+	rapdu_status_set(NFC_T4T_APDU_RAPDU_STATUS_CMD_COMPLETED);
+}
+
+/* Decode the C-APDU according to ISO/IEC 7816-4 5.1, rejecting any invalid
+ * Lc and Le encoding.
+ */
+static void tag_apdu_process(void)
+{
+	const uint8_t *capdu = tag.capdu;
+	const uint8_t *body = &capdu[4];
+	size_t body_len = tag.capdu_len - 4;
+	const uint8_t *data = NULL;
+	size_t lc = 0;
+	size_t le = 0;
+
+	tag.rapdu_len = 0;
+	tag.rapdu_sent = 0;
+
+	if (tag.capdu_len < 4) {
+		rapdu_status_set(STATUS_WRONG_LENGTH);
+		return;
+	}
+
+	if (body_len == 0) {
+		/* No Lc and Le. */
+	} else if (body_len == 1) {
+		le = body[0] ? body[0] : 256;
+	} else if (body[0] != 0) {
+		lc = body[0];
+		data = &body[1];
+
+		if (body_len == 2 + lc) {
+			le = body[1 + lc] ? body[1 + lc] : 256;
+		} else if (body_len != 1 + lc) {
+			rapdu_status_set(STATUS_WRONG_LENGTH);
+			return;
+		}
+	} else if (body_len == 3) {
+		le = sys_get_be16(&body[1]);
+		le = le ? le : 65536;
+	} else if (body_len > 3) {
+		lc = sys_get_be16(&body[1]);
+		data = &body[3];
+
+		if (body_len == 5 + lc) {
+			le = sys_get_be16(&body[3 + lc]);
+			le = le ? le : 65536;
+		} else if (body_len != 3 + lc) {
+			rapdu_status_set(STATUS_WRONG_LENGTH);
+			return;
+		}
+	} else {
+		rapdu_status_set(STATUS_WRONG_LENGTH);
+		return;
+	}
+
+	switch (capdu[1]) {
+	case NFC_T4T_APDU_COMM_INS_SELECT:
+		tag_select(capdu[2], data, lc);
+		break;
+	case NFC_T4T_APDU_COMM_INS_READ:
+		tag_read(sys_get_be16(&capdu[2]), le);
+		break;
+	case NFC_T4T_APDU_COMM_INS_UPDATE:
+		tag_update(sys_get_be16(&capdu[2]), data, lc);
+		break;
+	default:
+		rapdu_status_set(STATUS_INS_NOT_SUPPORTED);
+		break;
+	}
+}
+
+static void tag_rapdu_block_send(uint8_t block_num)
+{
+	size_t len = MIN(tag.rapdu_len - tag.rapdu_sent,
+			 tag.fsd - ISODEP_PCB_SIZE - ISODEP_CRC_SIZE);
+
+	tag.frame[0] = 0x02 | block_num;
+	if (tag.rapdu_sent + len < tag.rapdu_len) {
+		tag.frame[0] |= ISODEP_CHAINING_BIT;
+	}
+
+	memcpy(&tag.frame[ISODEP_PCB_SIZE], &tag.rapdu[tag.rapdu_sent], len);
+	tag.frame_len = ISODEP_PCB_SIZE + len;
+	tag.rapdu_sent += len;
+}
+
+/* Handle a frame from the reader, and prepare the response frame. */
+static void tag_frame_handle(const uint8_t *data, size_t len)
+{
+	uint8_t pcb = data[0];
+
+	if (pcb == RATS_CMD) {
+		tag.fsd = fsd_value_map[data[1] >> 4];
+
+		/* TA, TB and TC present, FWI and SFGI set to 0. */
+		tag.frame[0] = 5;
+		tag.frame[1] = 0x70 | tag.fsci;
+		tag.frame[2] = 0x00;
+		tag.frame[3] = 0x00;
+		tag.frame[4] = 0x00;
+		tag.frame_len = 5;
+		return;
+	}
+
+	/* Frames from the reader must fit in the FSC of the tag. */
+	if (len + ISODEP_CRC_SIZE > fsd_value_map[MIN(tag.fsci, 8)]) {
+		tag.frame_size_err = true;
+	}
+
+	switch (pcb & 0xE6) {
+	case 0x02:
+		/* I-block. */
+		memcpy(&tag.capdu[tag.capdu_len], &data[ISODEP_PCB_SIZE],
+		       len - ISODEP_PCB_SIZE);
+		tag.capdu_len += len - ISODEP_PCB_SIZE;
+
+		if (pcb & ISODEP_CHAINING_BIT) {
+			/* R(ACK) */
+			tag.frame[0] = 0xA2 | (pcb & 0x01);
+			tag.frame_len = 1;
+			return;
+		}
+
+		tag_apdu_process();
+		tag.capdu_len = 0;
+		tag_rapdu_block_send(pcb & 0x01);
+		break;
+
+	case 0xA2:
+		/* R(ACK) for a chained response. */
+		zassert_true(tag.rapdu_sent < tag.rapdu_len, "Unexpected ACK");
+		tag_rapdu_block_send(pcb & 0x01);
+		break;
+
+	case 0xC2:
+		/* S(DESELECT) */
+		tag.frame[0] = pcb;
+		tag.frame_len = 1;
+		break;
+
+	default:
+		zassert_unreachable("Unexpected frame 0x%02x", pcb);
+	}
+}
+
+static void isodep_ready_to_send(uint8_t *data, size_t data_len, uint32_t ftd)
+{
+	uint64_t start = MAX(tag.now, tag.radio_free);
+
+	tag_frame_handle(data, data_len);
+	tag.frames++;
+
+	tag.frame_ready = start + air_time(data_len) + TAG_PROCESSING_US +
+			  air_time(tag.frame_len) + FRAME_DELAY_US;
+	tag.radio_free = tag.frame_ready;
+
+	k_sem_give(&tag.frame_sem);
+}
+
+static void reader_done(int err)
+{
+	if (!reader.done) {
+		reader.err = err;
+		reader.done = true;
+	}
+}
+
+static void isodep_selected(const struct nfc_t4t_isodep_tag *t4t_tag)
+{
+	int err = nfc_t4t_hl_procedure_ndef_tag_app_select();
+
+	if (err) {
+		reader_done(err);
+	}
+}
+
+static void isodep_deselected(void)
+{
+	reader_done(0);
+}
+
+static void isodep_error(int err)
+{
+	reader_done(-EIO);
+}
+
+static void isodep_data_received(const uint8_t *data, size_t data_len)
+{
+	int err = nfc_t4t_hl_procedure_on_data_received(data, data_len);
+
+	if (err) {
+		reader_done(err);
+	}
+}
+
+static const struct nfc_t4t_isodep_cb isodep_cb = {
+	.selected = isodep_selected,
+	.deselected = isodep_deselected,
+	.error = isodep_error,
+	.ready_to_send = isodep_ready_to_send,
+	.data_received = isodep_data_received
+};
+
+static int ndef_op_start(void)
+{
+	struct nfc_t4t_cc_file *cc = &NFC_T4T_CC_DESC(t4t_cc);
+
+	reader.start = tag.now;
+
+	switch (reader.op) {
+	case OP_READ:
+		return nfc_t4t_hl_procedure_ndef_read(cc, ndef_buf,
+						      sizeof(ndef_buf));
+	case OP_READ_STREAM:
+		return nfc_t4t_hl_procedure_ndef_read(cc, NULL, 0);
+	case OP_UPDATE:
+		return nfc_t4t_hl_procedure_ndef_update(cc, ndef_buf,
+			NDEF_MSG_LEN + NDEF_FILE_NLEN_SIZE);
+	default:
+		return -EINVAL;
+	}
+}
+
+static void hl_selected(enum nfc_t4t_hl_procedure_select type)
+{
+	int err;
+
+	switch (type) {
+	case NFC_T4T_HL_PROCEDURE_NDEF_APP_SELECT:
+		err = nfc_t4t_hl_procedure_cc_select();
+		break;
+	case NFC_T4T_HL_PROCEDURE_CC_SELECT:
+		err = nfc_t4t_hl_procedure_cc_read(&NFC_T4T_CC_DESC(t4t_cc));
+		break;
+	case NFC_T4T_HL_PROCEDURE_NDEF_FILE_SELECT:
+		err = ndef_op_start();
+		break;
+	default:
+		err = -EINVAL;
+		break;
+	}
+
+	if (err) {
+		reader_done(err);
+	}
+}
+
+static void hl_cc_read(struct nfc_t4t_cc_file *cc)
+{
+	int err;
+
+	zassert_equal(cc->tlv_count, 1, NULL);
+	zassert_equal(cc->max_rapdu_size, tag.mle, NULL);
+	zassert_equal(cc->max_capdu_size, tag.mlc, NULL);
+
+	err = nfc_t4t_hl_procedure_ndef_file_select(
+		cc->tlv_block_array[0].value.file_id);
+	if (err) {
+		reader_done(err);
+	}
+}
+
+static void ndef_op_done(void)
+{
+	int err;
+
+	reader.end = tag.now;
+
+	err = nfc_t4t_isodep_tag_deselect();
+	if (err) {
+		reader_done(err);
+	}
+}
+
+static void hl_ndef_read(uint16_t file_id, const uint8_t *data, size_t len)
+{
+	zassert_equal(file_id, NDEF_FILE_ID, NULL);
+	zassert_equal(len, NDEF_MSG_LEN + NDEF_FILE_NLEN_SIZE, NULL);
+
+	if (reader.op == OP_READ) {
+		zassert_equal_ptr(data, ndef_buf, NULL);
+		zassert_equal(sys_get_be16(data), NDEF_MSG_LEN, NULL);
+		zassert_mem_equal(&data[NDEF_FILE_NLEN_SIZE], ndef_msg,
+				  NDEF_MSG_LEN, NULL);
+	} else {
+		zassert_is_null(data, NULL);
+	}
+
+	ndef_op_done();
+}
+
+static void hl_ndef_updated(uint16_t file_id)
+{
+	zassert_equal(file_id, NDEF_FILE_ID, NULL);
+
+	ndef_op_done();
+}
+
+static int hl_ndef_chunk_read(uint16_t file_id, const uint8_t *data,
+			      size_t len)
+{
+	zassert_true(reader.chunk_len + len <= NDEF_MSG_LEN, NULL);
+
+	memcpy(&chunk_buf[reader.chunk_len], data, len);
+	reader.chunk_len += len;
+
+	/* Processing the chunk takes time, like parsing it would. */
+	tag.now += CHUNK_PROCESSING_US;
+
+	return 0;
+}
+
+static const struct nfc_t4t_hl_procedure_cb hl_cb = {
+	.selected = hl_selected,
+	.cc_read = hl_cc_read,
+	.ndef_read = hl_ndef_read,
+	.ndef_updated = hl_ndef_updated,
+	.ndef_chunk_read = hl_ndef_chunk_read
+};
+
+/* Run the whole NDEF detection procedure with the simulated tag, passing
+ * the tag frames to the reader until the tag is deselected.
+ */
+static void procedure_run(enum nfc_t4t_isodep_fsd fsd, int op)
+{
+	static uint8_t frame[sizeof(tag.frame)];
+
+	memset(&reader, 0, sizeof(reader));
+	memset(chunk_buf, 0, sizeof(chunk_buf));
+	reader.op = op;
+	k_sem_reset(&tag.frame_sem);
+
+	zassert_ok(nfc_t4t_isodep_rats_send(fsd, 0), NULL);
+
+	while (!reader.done) {
+		zassert_ok(k_sem_take(&tag.frame_sem, K_MSEC(100)),
+			   "No frame sent to the tag");
+
+		/* The reader can send the next frame before the data of
+		 * this one is processed.
+		 */
+		memcpy(frame, tag.frame, tag.frame_len);
+		tag.now = MAX(tag.now, tag.frame_ready);
+
+		zassert_ok(nfc_t4t_isodep_data_received(frame, tag.frame_len,
+							0),
+			   NULL);
+	}
+
+	zassert_ok(reader.err, "Procedure failed: %d", reader.err);
+	zassert_false(tag.frame_size_err, "Frame exceeds the tag FSC");
+}
+
+static uint32_t reads_expected(uint16_t mle)
+{
+	uint16_t chunk = MIN(mle, RAPDU_MAX_SIZE);
+
+	/* NLEN is read together with the start of the NDEF message. */
+	return ceiling_fraction(NDEF_MSG_LEN + NDEF_FILE_NLEN_SIZE, chunk);
+}
+
+static void test_apdu_encode(void)
+{
+	static const uint8_t short_le[] = {0x00, 0xB0, 0x00, 0x02, 0x00};
+	static const uint8_t extended_le[] = {0x00, 0xB0, 0x00, 0x02,
+					      0x00, 0x01, 0x2C};
+	static const uint8_t extended_lc_le[] = {0x00, 0xA4, 0x04, 0x00,
+						 0x00, 0x00, 0x02, 0xE1, 0x04,
+						 0x01, 0x2C};
+	uint8_t file_id[] = {0xE1, 0x04};
+	struct nfc_t4t_apdu_comm comm;
+	uint8_t data[300];
+	uint8_t buf[310];
+	uint16_t len;
+
+	nfc_t4t_apdu_comm_clear(&comm);
+	comm.instruction = NFC_T4T_APDU_COMM_INS_READ;
+	comm.parameter = 2;
+	comm.resp_len = 256;
+
+	len = sizeof(buf);
+	zassert_ok(nfc_t4t_apdu_comm_encode(&comm, buf, &len), NULL);
+	zassert_equal(len, sizeof(short_le), NULL);
+	zassert_mem_equal(buf, short_le, len, NULL);
+
+	/* Extended Le without Lc starts with a zero byte: */
+	comm.resp_len = 300;
+
+	len = sizeof(buf);
+	zassert_ok(nfc_t4t_apdu_comm_encode(&comm, buf, &len), NULL);
+	zassert_equal(len, sizeof(extended_le), NULL);
+	zassert_mem_equal(buf, extended_le, len, NULL);
+
+	/* Lc has to be extended along with Le: */
+	nfc_t4t_apdu_comm_clear(&comm);
+	comm.instruction = NFC_T4T_APDU_COMM_INS_SELECT;
+	comm.parameter = NFC_T4T_APDU_SELECT_BY_NAME;
+	comm.data.buff = file_id;
+	comm.data.len = sizeof(file_id);
+	comm.resp_len = 300;
+
+	len = sizeof(buf);
+	zassert_ok(nfc_t4t_apdu_comm_encode(&comm, buf, &len), NULL);
+	zassert_equal(len, sizeof(extended_lc_le), NULL);
+	zassert_mem_equal(buf, extended_lc_le, len, NULL);
+
+	/* Extended Lc without Le: */
+	memset(data, 0x5a, sizeof(data));
+	comm.instruction = NFC_T4T_APDU_COMM_INS_UPDATE;
+	comm.parameter = 0;
+	comm.data.buff = data;
+	comm.data.len = sizeof(data);
+	comm.resp_len = 0;
+
+	len = sizeof(buf);
+	zassert_ok(nfc_t4t_apdu_comm_encode(&comm, buf, &len), NULL);
+	zassert_equal(len, 4 + 3 + sizeof(data), NULL);
+	zassert_equal(buf[4], 0x00, NULL);
+	zassert_equal(sys_get_be16(&buf[5]), sizeof(data), NULL);
+	zassert_mem_equal(&buf[7], data, sizeof(data), NULL);
+}
+
+static void test_fsd_max(void)
+{
+	zassert_equal(nfc_t4t_isodep_fsd_max_get(), NFC_T4T_ISODEP_FSD_256,
+		      NULL);
+	zassert_equal(nfc_t4t_isodep_rats_send(NFC_T4T_ISODEP_FSD_256 + 1, 0),
+		      -EINVAL, NULL);
+}
+
+static void test_ndef_read(void)
+{
+	tag_config(8, 0xFFFF, 0xFFFF);
+	memset(ndef_buf, 0, sizeof(ndef_buf));
+
+	procedure_run(nfc_t4t_isodep_fsd_max_get(), OP_READ);
+
+	zassert_equal(tag.reads, reads_expected(tag.mle), "%u reads",
+		      tag.reads);
+	zassert_equal(reader.chunk_len, NDEF_MSG_LEN, NULL);
+	zassert_mem_equal(chunk_buf, ndef_msg, NDEF_MSG_LEN, NULL);
+}
+
+static void test_ndef_read_small_tag(void)
+{
+	/* The RFU FSCI value is handled like the largest one. */
+	tag_config(0xF, 0x3B, 0x34);
+	memset(ndef_buf, 0, sizeof(ndef_buf));
+
+	procedure_run(NFC_T4T_ISODEP_FSD_64, OP_READ);
+
+	zassert_equal(tag.reads, reads_expected(tag.mle), "%u reads",
+		      tag.reads);
+	zassert_mem_equal(chunk_buf, ndef_msg, NDEF_MSG_LEN, NULL);
+}
+
+static void test_ndef_read_stream(void)
+{
+	tag_config(8, 0xFFFF, 0xFFFF);
+
+	procedure_run(nfc_t4t_isodep_fsd_max_get(), OP_READ_STREAM);
+
+	zassert_equal(tag.reads, reads_expected(tag.mle), NULL);
+	zassert_equal(reader.chunk_len, NDEF_MSG_LEN, NULL);
+	zassert_mem_equal(chunk_buf, ndef_msg, NDEF_MSG_LEN, NULL);
+}
+
+static void test_ndef_update(void)
+{
+	size_t chunk;
+
+	tag_config(5, 0xFFFF, 0x0400);
+
+	for (size_t i = 0; i < NDEF_MSG_LEN; i++) {
+		ndef_msg[i] = i * 3;
+	}
+
+	sys_put_be16(NDEF_MSG_LEN, ndef_buf);
+	memcpy(&ndef_buf[NDEF_FILE_NLEN_SIZE], ndef_msg, NDEF_MSG_LEN);
+
+	procedure_run(nfc_t4t_isodep_fsd_max_get(), OP_UPDATE);
+
+	zassert_equal(sys_get_be16(tag.ndef), NDEF_MSG_LEN, NULL);
+	zassert_mem_equal(&tag.ndef[NDEF_FILE_NLEN_SIZE], ndef_msg,
+			  NDEF_MSG_LEN, NULL);
+
+	/* The largest chunks that fit in the APDU buffer are written, with
+	 * NLEN cleared before and set after them.
+	 */
+	chunk = CONFIG_NFC_T4T_HL_PROCEDURE_APDU_BUF_SIZE - 5;
+	if (chunk > 255) {
+		chunk = CONFIG_NFC_T4T_HL_PROCEDURE_APDU_BUF_SIZE - 7;
+	}
+
+	chunk = MIN(chunk, MIN(tag.mlc, NDEF_MSG_LEN));
+
+	zassert_equal(tag.update_max, chunk, "%zu", tag.update_max);
+	zassert_equal(tag.updates,
+		      ceiling_fraction(NDEF_MSG_LEN, chunk) + 2, NULL);
+}
+
+static void bench_run(const char *name, enum nfc_t4t_isodep_fsd fsd,
+		      uint16_t mle, int op)
+{
+	uint64_t time;
+
+	tag_config(8, mle, 0xFFFF);
+
+	procedure_run(fsd, op);
+
+	time = reader.end - reader.start;
+
+	TC_PRINT("  %-28s %3u frames, %2u reads, %6llu us, %6llu B/s\n", name,
+		 tag.frames, tag.reads, (unsigned long long)time,
+		 (unsigned long long)((NDEF_MSG_LEN * 1000000ULL) / time));
+}
+
+static void test_benchmark(void)
+{
+	TC_PRINT("Reading %u bytes, %u us processing per chunk:\n",
+		 NDEF_MSG_LEN, CHUNK_PROCESSING_US);
+
+	bench_run("FSD 64, MLe 59", NFC_T4T_ISODEP_FSD_64, 0x3B, OP_READ);
+	bench_run("FSD 64", NFC_T4T_ISODEP_FSD_64, 0xFFFF, OP_READ);
+	bench_run("FSD 256, no prefetch", NFC_T4T_ISODEP_FSD_256, 0xFFFF,
+		  OP_READ_STREAM);
+	bench_run("FSD 256, prefetch", NFC_T4T_ISODEP_FSD_256, 0xFFFF,
+		  OP_READ);
+}
+
+void test_main(void)
+{
+	k_sem_init(&tag.frame_sem, 0, 1);
+
+	zassert_ok(nfc_t4t_isodep_init(tx_buf, sizeof(tx_buf), rx_buf,
+				       sizeof(rx_buf), &isodep_cb),
+		   NULL);
+	zassert_ok(nfc_t4t_hl_procedure_cb_register(&hl_cb), NULL);
+
+	ztest_test_suite(nfc_t4t_hl_procedure_test,
+			 ztest_unit_test(test_apdu_encode),
+			 ztest_unit_test(test_fsd_max),
+			 ztest_unit_test(test_ndef_read),
+			 ztest_unit_test(test_ndef_read_small_tag),
+			 ztest_unit_test(test_ndef_read_stream),
+			 ztest_unit_test(test_ndef_update),
+			 ztest_unit_test(test_benchmark)
+			 );
+
+	ztest_run_test_suite(nfc_t4t_hl_procedure_test);
+}
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <ztest.h>
+#include <nfc/tnep/tag.h>
+#include <nfc/ndef/msg.h>
+#include <nfc/ndef/msg_parser.h>
+#include <nfc/ndef/tnep_rec.h>
+
+#define TAG_BUF_SIZE 256
+#define MSG_MAX_RECORD_CNT 4
+
+static uint8_t tag_buf[TAG_BUF_SIZE];
+static uint8_t tag_swap_buf[TAG_BUF_SIZE];
+static struct k_poll_event events[NFC_TNEP_EVENTS_NUMBER];
+
+/* Buffer currently provided to the NFC Tag. */
+static uint8_t *tag_payload;
+
+static uint8_t desc_buf[NFC_NDEF_PARSER_REQIRED_MEMO_SIZE_CALC(
+				MSG_MAX_RECORD_CNT)];
+
+static const uint8_t svc_uri[] = "svc:test";
+static const uint8_t app_type[] = {'t'};
+static const uint8_t app_data[] = "Service data exchanged in place";
+static const uint8_t poller_data[] = "Poller data";
+
+static int selected_cnt;
+static int deselected_cnt;
+static int received_cnt;
+static int error_cnt;
+static int last_error;
+static const uint8_t *received_data;
+static size_t received_len;
+
+static void svc_selected(void)
+{
+	selected_cnt++;
+}
+
+static void svc_deselected(void)
+{
+	deselected_cnt++;
+}
+
+static void svc_msg_received(const uint8_t *data, size_t len)
+{
+	received_cnt++;
+	received_data = data;
+	received_len = len;
+}
+
+static void svc_error(int err)
+{
+	error_cnt++;
+	last_error = err;
+}
+
+NFC_TNEP_TAG_SERVICE_DEF(svc, svc_uri, (ARRAY_SIZE(svc_uri) - 1),
+			 NFC_TNEP_COMM_MODE_SINGLE_RESPONSE, 0, 0,
+			 TAG_BUF_SIZE, svc_selected, svc_deselected,
+			 svc_msg_received, svc_error);
+
+static int tag_payload_set(uint8_t *data, size_t len)
+{
+	zassert_true((data == tag_buf) || (data == tag_swap_buf),
+		     "Unknown buffer");
+	zassert_equal(len, TAG_BUF_SIZE, NULL);
+
+	tag_payload = data;
+
+	return 0;
+}
+
+static bool tag_buf_contains(const uint8_t *data)
+{
+	return ((data >= tag_buf) && (data < (tag_buf + TAG_BUF_SIZE))) ||
+	       ((data >= tag_swap_buf) &&
+		(data < (tag_swap_buf + TAG_BUF_SIZE)));
+}
+
+static void tnep_process(void)
+{
+	(void)k_poll(events, ARRAY_SIZE(events), K_NO_WAIT);
+	nfc_tnep_tag_process();
+}
+
+/* The NFC Polling Device writes to the buffer provided to the NFC Tag. */
+static void poller_write(const struct nfc_ndef_msg_desc *msg)
+{
+	uint32_t len = TAG_BUF_SIZE;
+
+	zassert_ok(nfc_ndef_msg_encode(msg, tag_payload, &len), NULL);
+
+	nfc_tnep_tag_rx_msg_indicate(tag_payload, len);
+	tnep_process();
+}
+
+static void poller_svc_select(const uint8_t *uri, size_t uri_len)
+{
+	NFC_NDEF_MSG_DEF(select_msg, 1);
+	NFC_TNEP_SERIVCE_SELECT_RECORD_DESC_DEF(select_rec, uri_len, uri);
+
+	zassert_ok(nfc_ndef_msg_record_add(&NFC_NDEF_MSG(select_msg),
+				&NFC_NDEF_TNEP_RECORD_DESC(select_rec)),
+		   NULL);
+
+	poller_write(&NFC_NDEF_MSG(select_msg));
+}
+
+static void poller_data_write(void)
+{
+	NFC_NDEF_MSG_DEF(data_msg, 1);
+	NFC_NDEF_RECORD_BIN_DATA_DEF(data_rec, TNF_WELL_KNOWN, NULL, 0,
+				     app_type, sizeof(app_type),
+				     poller_data, sizeof(poller_data));
+
+	zassert_ok(nfc_ndef_msg_record_add(&NFC_NDEF_MSG(data_msg),
+					   &NFC_NDEF_RECORD_BIN_DATA(data_rec)),
+		   NULL);
+
+	poller_write(&NFC_NDEF_MSG(data_msg));
+}
+
+static const struct nfc_ndef_msg_desc *tag_msg_parse(void)
+{
+	uint32_t desc_len = sizeof(desc_buf);
+	uint32_t len = TAG_BUF_SIZE;
+
+	zassert_ok(nfc_ndef_msg_parse(desc_buf, &desc_len, tag_payload, &len),
+		   "Invalid NDEF message");
+
+	return (const struct nfc_ndef_msg_desc *)desc_buf;
+}
+
+static const struct nfc_ndef_bin_payload_desc *
+record_check(const struct nfc_ndef_record_desc *record, const uint8_t *type)
+{
+	zassert_equal(record->type_length, 2, NULL);
+	zassert_mem_equal(record->type, type, 2, NULL);
+
+	return record->payload_descriptor;
+}
+
+static void status_record_check(const struct nfc_ndef_record_desc *record,
+				enum nfc_tnep_status_value status)
+{
+	const struct nfc_ndef_bin_payload_desc *payload;
+
+	payload = record_check(record, nfc_ndef_tnep_rec_type_status);
+	zassert_equal(payload->payload_length, 1, NULL);
+	zassert_equal(payload->payload[0], status, NULL);
+}
+
+static void app_record_check(const struct nfc_ndef_record_desc *record)
+{
+	const struct nfc_ndef_bin_payload_desc *payload =
+		record->payload_descriptor;
+
+	zassert_equal(record->type_length, sizeof(app_type), NULL);
+	zassert_mem_equal(record->type, app_type, sizeof(app_type), NULL);
+	zassert_equal(payload->payload_length, sizeof(app_data), NULL);
+	zassert_mem_equal(payload->payload, app_data, sizeof(app_data), NULL);
+}
+
+static void initial_msg_check(void)
+{
+	const struct nfc_ndef_msg_desc *msg = tag_msg_parse();
+
+	zassert_equal(msg->record_count, 1, NULL);
+	record_check(msg->record[0], nfc_ndef_tnep_rec_type_svc_param);
+}
+
+static void test_initial_msg(void)
+{
+	uint8_t *data;
+	size_t size;
+
+	initial_msg_check();
+
+	/* Application data can't be provided before a service is selected. */
+	zassert_equal(nfc_tnep_tag_tx_msg_buffer_get(&data, &size), -EACCES,
+		      NULL);
+	zassert_equal(nfc_tnep_tag_tx_msg_buffer_swap(0,
+						      NFC_TNEP_STATUS_SUCCESS),
+		      -EACCES, NULL);
+}
+
+static void test_invalid_select(void)
+{
+	static const uint8_t invalid_payload[] = {sizeof(svc_uri), 's'};
+
+	NFC_NDEF_MSG_DEF(select_msg, 1);
+	NFC_NDEF_RECORD_BIN_DATA_DEF(select_rec, TNF_WELL_KNOWN, NULL, 0,
+				     nfc_ndef_tnep_rec_type_svc_select,
+				     NFC_NDEF_TNEP_REC_TYPE_LEN,
+				     invalid_payload, sizeof(invalid_payload));
+
+	zassert_ok(nfc_ndef_msg_record_add(&NFC_NDEF_MSG(select_msg),
+				&NFC_NDEF_RECORD_BIN_DATA(select_rec)),
+		   NULL);
+
+	/* The URI length points past the end of the record. */
+	poller_write(&NFC_NDEF_MSG(select_msg));
+	zassert_equal(selected_cnt, 0, NULL);
+
+	/* The Initial message is provided again after the tag selection. */
+	nfc_tnep_tag_on_selected();
+	tnep_process();
+	initial_msg_check();
+}
+
+static void test_app_data_in_place(void)
+{
+	NFC_NDEF_MSG_DEF(app_msg, 1);
+	NFC_NDEF_RECORD_BIN_DATA_DEF(app_rec, TNF_WELL_KNOWN, NULL, 0,
+				     app_type, sizeof(app_type),
+				     app_data, sizeof(app_data));
+	const struct nfc_ndef_msg_desc *msg;
+	uint8_t *prev_payload;
+	uint8_t *data;
+	size_t size;
+	uint32_t len;
+
+	poller_svc_select(svc_uri, ARRAY_SIZE(svc_uri) - 1);
+	zassert_equal(selected_cnt, 1, NULL);
+
+	/* An empty message is provided until the application responds. */
+	zassert_equal(tag_payload[0], 0, NULL);
+
+	zassert_ok(nfc_tnep_tag_tx_msg_buffer_get(&data, &size), NULL);
+
+	/* The application encodes into the next buffer. */
+	prev_payload = tag_payload;
+	zassert_true(tag_buf_contains(data), NULL);
+	zassert_false((data >= tag_payload) &&
+		      (data < (tag_payload + TAG_BUF_SIZE)), NULL);
+	zassert_true(size < TAG_BUF_SIZE, NULL);
+
+	zassert_ok(nfc_ndef_msg_record_add(&NFC_NDEF_MSG(app_msg),
+					   &NFC_NDEF_RECORD_BIN_DATA(app_rec)),
+		   NULL);
+
+	len = size;
+	zassert_ok(nfc_ndef_msg_encode(&NFC_NDEF_MSG(app_msg), data, &len),
+		   NULL);
+	zassert_ok(nfc_tnep_tag_tx_msg_buffer_swap(len,
+						   NFC_TNEP_STATUS_SUCCESS),
+		   NULL);
+
+	zassert_not_equal(tag_payload, prev_payload, NULL);
+
+	msg = tag_msg_parse();
+	zassert_equal(msg->record_count, 2, NULL);
+	status_record_check(msg->record[0], NFC_TNEP_STATUS_SUCCESS);
+	app_record_check(msg->record[1]);
+
+	/* Only one response is allowed for each received message. */
+	zassert_equal(nfc_tnep_tag_tx_msg_buffer_get(&data, &size), -EACCES,
+		      NULL);
+	zassert_equal(nfc_tnep_tag_tx_msg_buffer_swap(0,
+						      NFC_TNEP_STATUS_SUCCESS),
+		      -EACCES, NULL);
+}
+
+static void test_app_data_taken_buffer(void)
+{
+	const struct nfc_ndef_msg_desc *msg;
+	uint8_t *payload;
+	uint8_t *data;
+	size_t size;
+
+	poller_data_write();
+	zassert_equal(received_cnt, 1, NULL);
+
+	/* The received message is not copied. */
+	zassert_true(tag_buf_contains(received_data), NULL);
+
+	zassert_ok(nfc_tnep_tag_tx_msg_buffer_get(&data, &size), NULL);
+	zassert_equal(nfc_tnep_tag_tx_msg_buffer_swap(size + 1,
+						      NFC_TNEP_STATUS_SUCCESS),
+		      -ENOMEM, NULL);
+
+	/* TNEP does not provide the taken buffer when the next message
+	 * is received.
+	 */
+	payload = tag_payload;
+	poller_data_write();
+	zassert_equal(received_cnt, 1, NULL);
+	zassert_equal(error_cnt, 1, NULL);
+	zassert_equal(last_error, -EBUSY, NULL);
+	zassert_equal_ptr(tag_payload, payload, NULL);
+
+	zassert_ok(nfc_tnep_tag_tx_msg_buffer_swap(0,
+				NFC_TNEP_STATUS_SERVICE_ERROR_BEGIN),
+		   NULL);
+	zassert_not_equal(tag_payload, payload, NULL);
+	zassert_equal(nfc_tnep_tag_tx_msg_buffer_swap(0,
+						      NFC_TNEP_STATUS_SUCCESS),
+		      -EACCES, NULL);
+
+	msg = tag_msg_parse();
+	zassert_equal(msg->record_count, 1, NULL);
+	status_record_check(msg->record[0],
+			    NFC_TNEP_STATUS_SERVICE_ERROR_BEGIN);
+}
+
+static void test_app_data_msg(void)
+{
+	NFC_TNEP_TAG_APP_MSG_DEF(app_msg, 1);
+	NFC_NDEF_RECORD_BIN_DATA_DEF(app_rec, TNF_WELL_KNOWN, NULL, 0,
+				     app_type, sizeof(app_type),
+				     app_data, sizeof(app_data));
+	const struct nfc_ndef_msg_desc *msg;
+	uint8_t *data;
+	size_t size;
+
+	poller_data_write();
+	zassert_equal(received_cnt, 2, NULL);
+
+	/* Providing the message gives back the taken buffer. */
+	zassert_ok(nfc_tnep_tag_tx_msg_buffer_get(&data, &size), NULL);
+	zassert_ok(nfc_ndef_msg_record_add(&NFC_NDEF_MSG(app_msg),
+					   &NFC_NDEF_RECORD_BIN_DATA(app_rec)),
+		   NULL);
+	zassert_ok(nfc_tnep_tag_tx_msg_app_data(&NFC_NDEF_MSG(app_msg),
+						NFC_TNEP_STATUS_SUCCESS),
+		   NULL);
+
+	/* The status record is added after the application records. */
+	msg = tag_msg_parse();
+	zassert_equal(msg->record_count, 2, NULL);
+	app_record_check(msg->record[0]);
+	status_record_check(msg->record[1], NFC_TNEP_STATUS_SUCCESS);
+
+	zassert_equal(nfc_tnep_tag_tx_msg_buffer_swap(0,
+						      NFC_TNEP_STATUS_SUCCESS),
+		      -EACCES, NULL);
+}
+
+static void test_deselect(void)
+{
+	poller_svc_select(NULL, 0);
+	zassert_equal(deselected_cnt, 1, NULL);
+	zassert_equal(error_cnt, 1, NULL);
+
+	initial_msg_check();
+}
+
+void test_main(void)
+{
+	zassert_ok(nfc_tnep_tag_tx_msg_buffer_register(tag_buf, tag_swap_buf,
+						       TAG_BUF_SIZE),
+		   NULL);
+	zassert_ok(nfc_tnep_tag_init(events, ARRAY_SIZE(events),
+				     tag_payload_set),
+		   NULL);
+	zassert_ok(nfc_tnep_tag_initial_msg_create(0, NULL), NULL);
+
+	ztest_test_suite(nfc_tnep_tag_test,
+			 ztest_unit_test(test_initial_msg),
+			 ztest_unit_test(test_invalid_select),
+			 ztest_unit_test(test_app_data_in_place),
+			 ztest_unit_test(test_app_data_taken_buffer),
+			 ztest_unit_test(test_app_data_msg),
+			 ztest_unit_test(test_deselect)
+	);
+
+	ztest_run_test_suite(nfc_tnep_tag_test);
+}
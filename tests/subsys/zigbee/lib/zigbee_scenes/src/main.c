@@ -0,0 +1,483 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <zboss_api.h>
+
+#include <zigbee_zcl_scenes.c>
+
+#define STORAGE_ENTRIES (SCENE_TABLE_SIZE + 2)
+#define LEGACY_KEY "scenes/scenes_table"
+
+/* Scene IDs are picked from a small range, to get many index collisions. */
+#define TEST_GROUP 0x1234
+
+static struct {
+	char key[SCENE_KEY_LEN + 8];
+	zb_uint8_t data[sizeof(struct legacy_scene_entry) * (LEGACY_TABLE_SIZE_MAX + 1)];
+	size_t len;
+	bool valid;
+} storage[STORAGE_ENTRIES];
+
+static int save_err;
+
+/** Mocks ******************************************/
+
+int settings_save_one(const char *name, const void *value, size_t val_len)
+{
+	int free_slot = -1;
+
+	if (save_err) {
+		return save_err;
+	}
+
+	zassert_true(val_len <= sizeof(storage[0].data), "Too long value");
+
+	for (int i = 0; i < STORAGE_ENTRIES; i++) {
+		if (storage[i].valid && !strcmp(storage[i].key, name)) {
+			free_slot = i;
+			break;
+		}
+
+		if (!storage[i].valid && free_slot < 0) {
+			free_slot = i;
+		}
+	}
+
+	zassert_true(free_slot >= 0, "Out of storage");
+
+	strcpy(storage[free_slot].key, name);
+	memcpy(storage[free_slot].data, value, val_len);
+	storage[free_slot].len = val_len;
+	storage[free_slot].valid = true;
+
+	return 0;
+}
+
+int settings_delete(const char *name)
+{
+	for (int i = 0; i < STORAGE_ENTRIES; i++) {
+		if (storage[i].valid && !strcmp(storage[i].key, name)) {
+			storage[i].valid = false;
+		}
+	}
+
+	return 0;
+}
+
+int settings_name_steq(const char *name, const char *key, const char **next)
+{
+	size_t len = strlen(key);
+
+	if (next) {
+		*next = NULL;
+	}
+
+	if (strncmp(name, key, len)) {
+		return 0;
+	}
+
+	if (name[len] == '/') {
+		if (next) {
+			*next = &name[len + 1];
+		}
+
+		return 1;
+	}
+
+	return (name[len] == '\0' || name[len] == '=');
+}
+
+int settings_name_next(const char *name, const char **next)
+{
+	int len = 0;
+
+	if (next) {
+		*next = NULL;
+	}
+
+	while (name[len] != '\0' && name[len] != '=' && name[len] != '/') {
+		len++;
+	}
+
+	if (name[len] == '/' && next) {
+		*next = &name[len + 1];
+	}
+
+	return len;
+}
+
+/** End Mocks **************************************/
+
+static ssize_t storage_read(void *cb_arg, void *data, size_t len)
+{
+	int i = (int)(intptr_t)cb_arg;
+
+	len = MIN(len, storage[i].len);
+	memcpy(data, storage[i].data, len);
+
+	return len;
+}
+
+/* Load the stored entries the way the settings subsystem does it at boot. */
+static void storage_load(void)
+{
+	scene_table_init();
+
+	for (int i = 0; i < STORAGE_ENTRIES; i++) {
+		const char *name;
+
+		if (!storage[i].valid) {
+			continue;
+		}
+
+		zassert_true(settings_name_steq(storage[i].key, scenes_conf.name, &name),
+			     "Unexpected key %s", storage[i].key);
+		zassert_ok(scenes_conf.h_set(name, storage[i].len, storage_read,
+					     (void *)(intptr_t)i),
+			   "Loading %s failed", storage[i].key);
+	}
+
+	zassert_ok(scenes_conf.h_commit(), "Commit failed");
+}
+
+static bool storage_has(const char *key)
+{
+	for (int i = 0; i < STORAGE_ENTRIES; i++) {
+		if (storage[i].valid && !strcmp(storage[i].key, key)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void storage_clear(void)
+{
+	memset(storage, 0, sizeof(storage));
+	save_err = 0;
+}
+
+/* Checks that every scene in the table is found through the index, and that
+ * the index has no other entries.
+ */
+static void index_check(void)
+{
+	int used = 0;
+
+	for (int i = 0; i < SCENE_INDEX_SIZE; i++) {
+		used += (scenes_index[i] != SCENE_INDEX_FREE);
+	}
+
+	zassert_equal(used, scenes_count, "Index out of sync with the table");
+
+	for (int i = 0; i < scenes_count; i++) {
+		zassert_equal_ptr(scene_table_find(scenes_table[i].common.group_id,
+						   scenes_table[i].common.scene_id),
+				  &scenes_table[i], "Scene %d not found", i);
+	}
+}
+
+/* Finds the scene IDs of TEST_GROUP that start probing at the given slot. */
+static int colliding_scenes_get(zb_uint16_t home, zb_uint8_t *scene_ids, int count)
+{
+	int found = 0;
+
+	for (int id = 0; id < 0xff && found < count; id++) {
+		if (scene_hash(TEST_GROUP, id) == home) {
+			scene_ids[found++] = id;
+		}
+	}
+
+	return found;
+}
+
+static void test_index_collisions(void)
+{
+	zb_uint8_t last[3];
+	zb_uint8_t first[2];
+
+	scene_table_init();
+
+	/* Scenes probing from the last slot wrap around to the start of the
+	 * index, where they collide with the scenes probing from the first slot:
+	 */
+	zassert_equal(colliding_scenes_get(SCENE_INDEX_SIZE - 1, last, ARRAY_SIZE(last)),
+		      ARRAY_SIZE(last), "Not enough colliding scenes");
+	zassert_equal(colliding_scenes_get(0, first, ARRAY_SIZE(first)),
+		      ARRAY_SIZE(first), "Not enough colliding scenes");
+
+	for (int i = 0; i < ARRAY_SIZE(last); i++) {
+		zassert_not_null(scene_table_add(TEST_GROUP, last[i]), "Add failed");
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(first); i++) {
+		zassert_not_null(scene_table_add(TEST_GROUP, first[i]), "Add failed");
+	}
+
+	index_check();
+
+	/* Removing the first scene of the probe sequence moves the others back
+	 * across the end of the index:
+	 */
+	scene_table_remove(scene_table_find(TEST_GROUP, last[0]));
+	zassert_is_null(scene_table_find(TEST_GROUP, last[0]), "Removed scene found");
+	index_check();
+
+	/* The scenes at their home slot must stay there: */
+	scene_table_remove(scene_table_find(TEST_GROUP, last[1]));
+	zassert_is_null(scene_table_find(TEST_GROUP, last[1]), "Removed scene found");
+	index_check();
+
+	scene_table_remove(scene_table_find(TEST_GROUP, first[1]));
+	index_check();
+
+	scene_table_remove(scene_table_find(TEST_GROUP, last[2]));
+	scene_table_remove(scene_table_find(TEST_GROUP, first[0]));
+	index_check();
+	zassert_equal(scenes_count, 0, "Table not empty");
+}
+
+static void test_index_full(void)
+{
+	scene_table_init();
+
+	for (int i = 0; i < SCENE_TABLE_SIZE; i++) {
+		zassert_not_null(scene_table_add(TEST_GROUP, i), "Add failed");
+	}
+
+	zassert_is_null(scene_table_add(TEST_GROUP, SCENE_TABLE_SIZE), "Added to a full table");
+	index_check();
+
+	for (int i = 0; i < SCENE_TABLE_SIZE; i++) {
+		scene_table_remove(scene_table_find(TEST_GROUP, i));
+		index_check();
+	}
+}
+
+static void test_index_random(void)
+{
+	/* Twice as many scene IDs as fit in the table: */
+	bool present[2 * SCENE_TABLE_SIZE] = { 0 };
+	uint32_t rand = 1;
+
+	scene_table_init();
+
+	for (int i = 0; i < 2000; i++) {
+		zb_uint8_t id;
+		struct scene_table_entry *entry;
+
+		rand = rand * 1103515245 + 12345;
+		id = (rand >> 16) % ARRAY_SIZE(present);
+		entry = scene_table_find(TEST_GROUP, id);
+
+		zassert_equal(!!entry, present[id], "Scene %u lookup mismatch", id);
+
+		if (entry) {
+			scene_table_remove(entry);
+			present[id] = false;
+		} else if (scenes_count < SCENE_TABLE_SIZE) {
+			zassert_not_null(scene_table_add(TEST_GROUP, id), "Add failed");
+			present[id] = true;
+		}
+
+		index_check();
+	}
+}
+
+static void test_store_load(void)
+{
+	struct scene_table_entry *entry;
+
+	storage_clear();
+	scene_table_init();
+
+	entry = scene_table_add(TEST_GROUP, 1);
+	entry->common.transition_time = 100;
+	entry->attr_mask = BIT(0) | BIT(2);
+	entry->attr_val[0] = 1;
+	entry->attr_val[2] = 50;
+	zassert_ok(scene_save(entry), "Save failed");
+
+	entry = scene_table_add(0x0001, 2);
+	entry->attr_mask = BIT(1);
+	entry->attr_val[1] = 0x80;
+	zassert_ok(scene_save(entry), "Save failed");
+
+	zassert_true(storage_has("scenes/123401"), "Scene not stored");
+	zassert_true(storage_has("scenes/000102"), "Scene not stored");
+
+	storage_load();
+
+	zassert_equal(scenes_count, 2, "Scenes not loaded");
+	index_check();
+
+	entry = scene_table_find(TEST_GROUP, 1);
+	zassert_not_null(entry, "Scene not loaded");
+	zassert_equal(entry->common.transition_time, 100, "Wrong transition time");
+	zassert_equal(entry->attr_mask, BIT(0) | BIT(2), "Wrong attributes");
+	zassert_equal(entry->attr_val[0], 1, "Wrong on/off");
+	zassert_equal(entry->attr_val[2], 50, "Wrong lift");
+
+	entry = scene_table_find(0x0001, 2);
+	zassert_not_null(entry, "Scene not loaded");
+	zassert_equal(entry->attr_mask, BIT(1), "Wrong attributes");
+	zassert_equal(entry->attr_val[1], 0x80, "Wrong level");
+}
+
+static void test_commit_error(void)
+{
+	struct scene_table_entry *entry;
+	struct scene_table_entry prev;
+
+	storage_clear();
+	scene_table_init();
+
+	entry = scene_table_add(TEST_GROUP, 1);
+	entry->attr_mask = BIT(0);
+	entry->attr_val[0] = 1;
+	zassert_equal(scene_commit(entry, NULL), ZB_ZCL_STATUS_SUCCESS, "Commit failed");
+
+	/* A new scene that can't be stored is removed from the table: */
+	save_err = -ENOSPC;
+	entry = scene_table_add(TEST_GROUP, 2);
+	zassert_equal(scene_commit(entry, NULL), ZB_ZCL_STATUS_INSUFF_SPACE,
+		      "Unstored scene reported as added");
+	zassert_is_null(scene_table_find(TEST_GROUP, 2), "Unstored scene kept");
+	zassert_equal(scenes_count, 1, "Wrong scene count");
+	index_check();
+
+	/* A changed scene that can't be stored keeps its previous content: */
+	entry = scene_table_find(TEST_GROUP, 1);
+	prev = *entry;
+	entry->attr_mask = BIT(1);
+	entry->attr_val[1] = 0x80;
+	zassert_equal(scene_commit(entry, &prev), ZB_ZCL_STATUS_INSUFF_SPACE,
+		      "Unstored scene reported as changed");
+	zassert_equal(entry->attr_mask, BIT(0), "Previous attributes lost");
+	zassert_equal(entry->attr_val[0], 1, "Previous on/off lost");
+	save_err = 0;
+
+	storage_load();
+
+	zassert_equal(scenes_count, 1, "Wrong scene count");
+	entry = scene_table_find(TEST_GROUP, 1);
+	zassert_not_null(entry, "Scene not loaded");
+	zassert_equal(entry->attr_mask, BIT(0), "Wrong attributes");
+}
+
+static void legacy_store(const struct legacy_scene_entry *legacy, size_t count)
+{
+	zassert_ok(settings_save_one(LEGACY_KEY, legacy, count * sizeof(legacy[0])),
+		   "Legacy store failed");
+}
+
+static void test_legacy_migration(void)
+{
+	struct legacy_scene_entry legacy[5];
+	struct scene_table_entry *entry;
+
+	storage_clear();
+	memset(legacy, 0, sizeof(legacy));
+
+	for (int i = 0; i < ARRAY_SIZE(legacy); i++) {
+		legacy[i].common.group_id = ZB_ZCL_SCENES_FREE_SCENE_TABLE_RECORD;
+	}
+
+	/* On/off, level, lift and tilt: */
+	legacy[0].common.group_id = TEST_GROUP;
+	legacy[0].common.scene_id = 3;
+	legacy[0].common.transition_time = 20;
+	legacy[0].attrs[0].present = ZB_TRUE;
+	legacy[0].attrs[0].value = 1;
+	legacy[0].attrs[3].present = ZB_TRUE;
+	legacy[0].attrs[3].value = 70;
+
+	legacy[2].common.group_id = 0x0002;
+	legacy[2].common.scene_id = 4;
+	legacy[2].attrs[1].present = ZB_TRUE;
+	legacy[2].attrs[1].value = 0x40;
+
+	/* Also stored in the new format, which takes precedence: */
+	legacy[4].common.group_id = 0x0003;
+	legacy[4].common.scene_id = 5;
+	legacy[4].attrs[1].present = ZB_TRUE;
+	legacy[4].attrs[1].value = 0x10;
+
+	legacy_store(legacy, ARRAY_SIZE(legacy));
+
+	scene_table_init();
+	entry = scene_table_add(0x0003, 5);
+	entry->attr_mask = BIT(1);
+	entry->attr_val[1] = 0x20;
+	zassert_ok(scene_save(entry), "Save failed");
+
+	/* Failing to store the converted scenes keeps the legacy table: */
+	save_err = -EIO;
+	storage_load();
+	save_err = 0;
+
+	zassert_equal(scenes_count, 3, "Legacy scenes not loaded");
+	zassert_true(storage_has(LEGACY_KEY), "Legacy table deleted");
+
+	storage_load();
+
+	zassert_false(storage_has(LEGACY_KEY), "Legacy table not deleted");
+	zassert_true(storage_has("scenes/123403"), "Scene not converted");
+	zassert_true(storage_has("scenes/000204"), "Scene not converted");
+
+	/* The converted scenes load from the new format only: */
+	storage_load();
+
+	zassert_equal(scenes_count, 3, "Scenes not loaded");
+	index_check();
+
+	entry = scene_table_find(TEST_GROUP, 3);
+	zassert_not_null(entry, "Scene not converted");
+	zassert_equal(entry->common.transition_time, 20, "Wrong transition time");
+	zassert_equal(entry->attr_mask, BIT(0) | BIT(3), "Wrong attributes");
+	zassert_equal(entry->attr_val[0], 1, "Wrong on/off");
+	zassert_equal(entry->attr_val[3], 70, "Wrong tilt");
+
+	entry = scene_table_find(0x0002, 4);
+	zassert_not_null(entry, "Scene not converted");
+	zassert_equal(entry->attr_mask, BIT(1), "Wrong attributes");
+	zassert_equal(entry->attr_val[1], 0x40, "Wrong level");
+
+	entry = scene_table_find(0x0003, 5);
+	zassert_not_null(entry, "Scene not loaded");
+	zassert_equal(entry->attr_val[1], 0x20, "Legacy scene took precedence");
+}
+
+static void test_legacy_invalid(void)
+{
+	static struct legacy_scene_entry legacy[LEGACY_TABLE_SIZE_MAX + 1];
+
+	storage_clear();
+	legacy_store(legacy, ARRAY_SIZE(legacy));
+
+	zassert_equal(scenes_conf.h_set("scenes_table", sizeof(legacy), storage_read,
+					(void *)(intptr_t)0),
+		      -EINVAL, "Too large legacy table accepted");
+	zassert_equal(scenes_conf.h_set("scenes_table", sizeof(legacy[0]) + 1,
+					storage_read, (void *)(intptr_t)0),
+		      -EINVAL, "Partial legacy entry accepted");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(zigbee_scenes_tests,
+			ztest_unit_test(test_index_collisions),
+			ztest_unit_test(test_index_full),
+			ztest_unit_test(test_index_random),
+			ztest_unit_test(test_store_load),
+			ztest_unit_test(test_commit_error),
+			ztest_unit_test(test_legacy_migration),
+			ztest_unit_test(test_legacy_invalid)
+	);
+
+	ztest_run_test_suite(zigbee_scenes_tests);
+}
@@ -5,6 +5,8 @@
  */
 
 #include <ztest.h>
+#include <device.h>
+#include <crypto/cipher.h>
 #include <logging/log.h>
 #include <zb_nrf_crypto.h>
 #include <zboss_api.h>
@@ -43,10 +45,45 @@ static void test_crypto(void)
 	}
 }
 
+static void test_session_release(void)
+{
+	const struct device *dev = DEVICE_DT_GET(DT_INST(0, nordic_nrf_ecb));
+	uint8_t aes_encrypted[AES_PLAINTEXT_LENGTH] = {};
+	struct cipher_ctx ctx = {
+		.keylen = AES_KEY_LENGTH,
+		.key.bit_stream = aes_key,
+		.flags = CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS,
+	};
+
+	zb_osif_aes_init();
+	zb_osif_aes128_hw_encrypt(aes_key, aes_plaintext, aes_encrypted);
+
+	/* The Zigbee session holds the peripheral until it is released: */
+	zassert_not_equal(cipher_begin_session(dev, &ctx,
+					       CRYPTO_CIPHER_ALGO_AES,
+					       CRYPTO_CIPHER_MODE_ECB,
+					       CRYPTO_CIPHER_OP_ENCRYPT),
+			  0, "Session not kept");
+
+	zb_osif_aes_session_release();
+	zassert_ok(cipher_begin_session(dev, &ctx, CRYPTO_CIPHER_ALGO_AES,
+					CRYPTO_CIPHER_MODE_ECB,
+					CRYPTO_CIPHER_OP_ENCRYPT),
+		   "Peripheral not released");
+	cipher_free_session(dev, &ctx);
+
+	/* The next encryption opens the session again: */
+	memset(aes_encrypted, 0, sizeof(aes_encrypted));
+	zb_osif_aes128_hw_encrypt(aes_key, aes_plaintext, aes_encrypted);
+	zassert_mem_equal(aes_encrypted, aes_ciphertext, AES_PLAINTEXT_LENGTH,
+			  "Encrypted data mismatch");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(nrf_osif_crypto_tests,
-			ztest_unit_test(test_crypto)
+			ztest_unit_test(test_crypto),
+			ztest_unit_test(test_session_release)
 	);
 
 	ztest_run_test_suite(nrf_osif_crypto_tests);
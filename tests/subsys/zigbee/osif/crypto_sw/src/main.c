@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <logging/log.h>
+#include <zb_nrf_crypto.h>
+#include <zboss_api.h>
+#include "native_rtc.h"
+
+LOG_MODULE_REGISTER(zboss_osif, CONFIG_ZBOSS_OSIF_LOG_LEVEL);
+
+#define AES_KEY_LENGTH       16
+#define AES_BLOCK_LENGTH     16
+
+/* Blocks in a CCM* protected frame of maximum length. */
+#define FRAME_BLOCKS 8
+#define BENCH_FRAMES 2000
+
+/* AES test values (taken from FIPS-197) */
+static uint8_t key_a[AES_KEY_LENGTH] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static uint8_t plaintext_a[AES_BLOCK_LENGTH] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t ciphertext_a[AES_BLOCK_LENGTH] = {
+	0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+	0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+/* AES test values (taken from NIST SP 800-38A) */
+static uint8_t key_b[AES_KEY_LENGTH] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static uint8_t plaintext_b[AES_BLOCK_LENGTH] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+	0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a
+};
+static const uint8_t ciphertext_b[AES_BLOCK_LENGTH] = {
+	0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60,
+	0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97
+};
+
+static uint8_t frame[FRAME_BLOCKS * AES_BLOCK_LENGTH];
+
+static void check_block(const uint8_t *expected, const uint8_t *actual)
+{
+	zassert_mem_equal(actual, expected, AES_BLOCK_LENGTH,
+			  "Encrypted data mismatch");
+}
+
+static void test_vectors(void)
+{
+	uint8_t encrypted[AES_BLOCK_LENGTH];
+
+	zb_osif_aes_init();
+
+	zb_osif_aes128_hw_encrypt(key_a, plaintext_a, encrypted);
+	check_block(ciphertext_a, encrypted);
+
+	/* Repeated with the same key, reusing the session: */
+	zb_osif_aes128_hw_encrypt(key_a, plaintext_a, encrypted);
+	check_block(ciphertext_a, encrypted);
+
+	/* The session must follow the key changes: */
+	zb_osif_aes128_hw_encrypt(key_b, plaintext_b, encrypted);
+	check_block(ciphertext_b, encrypted);
+
+	zb_osif_aes128_hw_encrypt(key_a, plaintext_a, encrypted);
+	check_block(ciphertext_a, encrypted);
+}
+
+static void test_key_in_place_change(void)
+{
+	uint8_t key[AES_KEY_LENGTH];
+	uint8_t encrypted[AES_BLOCK_LENGTH];
+
+	/* The session is keyed by the key contents, not the key buffer: */
+	memcpy(key, key_a, sizeof(key));
+	zb_osif_aes128_hw_encrypt(key, plaintext_a, encrypted);
+	check_block(ciphertext_a, encrypted);
+
+	memcpy(key, key_b, sizeof(key));
+	zb_osif_aes128_hw_encrypt(key, plaintext_b, encrypted);
+	check_block(ciphertext_b, encrypted);
+}
+
+static void test_blocks(void)
+{
+	uint8_t blocks[2 * AES_BLOCK_LENGTH];
+	uint8_t encrypted[2 * AES_BLOCK_LENGTH];
+
+	memcpy(&blocks[0], plaintext_b, AES_BLOCK_LENGTH);
+	memcpy(&blocks[AES_BLOCK_LENGTH], plaintext_b, AES_BLOCK_LENGTH);
+
+	zb_osif_aes128_hw_encrypt_blocks(key_b, blocks, encrypted, 2);
+	check_block(ciphertext_b, &encrypted[0]);
+	check_block(ciphertext_b, &encrypted[AES_BLOCK_LENGTH]);
+
+	/* A release keeps the result, also when there's nothing to release: */
+	zb_osif_aes_session_release();
+	zb_osif_aes128_hw_encrypt_blocks(key_b, blocks, encrypted, 1);
+	check_block(ciphertext_b, &encrypted[0]);
+}
+
+static void frame_encrypt(bool key_change, uint8_t *encrypted)
+{
+	uint8_t scratch[AES_BLOCK_LENGTH];
+
+	for (int j = 0; j < FRAME_BLOCKS; j++) {
+		/* Encrypting with another key in between forces a new key
+		 * schedule for every block, like before it was reused:
+		 */
+		if (key_change) {
+			zb_osif_aes128_hw_encrypt(key_b, plaintext_b, scratch);
+		}
+
+		zb_osif_aes128_hw_encrypt(key_a, &frame[j * AES_BLOCK_LENGTH],
+					  &encrypted[j * AES_BLOCK_LENGTH]);
+	}
+}
+
+static uint64_t bench_run(bool key_change, uint8_t *encrypted)
+{
+	uint64_t start = native_rtc_gettime_us(RTC_CLOCK_PSEUDOHOSTREALTIME);
+
+	for (int i = 0; i < BENCH_FRAMES; i++) {
+		frame_encrypt(key_change, encrypted);
+	}
+
+	return native_rtc_gettime_us(RTC_CLOCK_PSEUDOHOSTREALTIME) - start;
+}
+
+static void test_benchmark(void)
+{
+	static uint8_t uncached_out[sizeof(frame)];
+	static uint8_t cached_out[sizeof(frame)];
+	uint64_t uncached;
+	uint64_t cached;
+
+	for (int i = 0; i < sizeof(frame); i++) {
+		frame[i] = i * 7;
+	}
+
+	uncached = bench_run(true, uncached_out);
+	cached = bench_run(false, cached_out);
+
+	/* The reused key schedule must not change the result: */
+	zassert_mem_equal(cached_out, uncached_out, sizeof(frame),
+			  "Encrypted frame mismatch");
+
+	TC_PRINT("%u frames of %u blocks:\n", BENCH_FRAMES, FRAME_BLOCKS);
+	TC_PRINT("  new key schedule per block: %llu us\n",
+		 (unsigned long long)uncached);
+	TC_PRINT("  reused key schedule:        %llu us\n",
+		 (unsigned long long)cached);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nrf_osif_crypto_sw_tests,
+			ztest_unit_test(test_vectors),
+			ztest_unit_test(test_key_in_place_change),
+			ztest_unit_test(test_blocks),
+			ztest_unit_test(test_benchmark)
+	);
+
+	ztest_run_test_suite(nrf_osif_crypto_sw_tests);
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <ztest.h>
+#include <storage/flash_map.h>
+#include <logging/log.h>
+
+#include "zb_nrf_nvram_cache.h"
+
+LOG_MODULE_REGISTER(zboss_osif, CONFIG_ZBOSS_OSIF_LOG_LEVEL);
+
+#define LINE_SIZE CONFIG_ZIGBEE_NVRAM_CACHE_LINE_SIZE
+#define LINE_COUNT CONFIG_ZIGBEE_NVRAM_CACHE_LINE_COUNT
+
+#define TEST_PAGE_SIZE 0x1000
+#define TEST_PAGE_COUNT 2
+#define RECORD_SIZE 16
+
+static const struct flash_area *fa;
+static uint8_t record[RECORD_SIZE];
+static uint8_t buf[LINE_SIZE * 2];
+
+static void record_fill(uint8_t val)
+{
+	memset(record, val, sizeof(record));
+}
+
+/* Check the flash contents, bypassing the cache: */
+static void flash_check(off_t off, uint8_t val, size_t len)
+{
+	zassert_ok(flash_area_read(fa, off, buf, len), NULL);
+	for (size_t i = 0; i < len; i++) {
+		zassert_equal(buf[i], val, "0x%x: 0x%02x instead of 0x%02x",
+			      off + i, buf[i], val);
+	}
+}
+
+static void cache_check(off_t off, uint8_t val, size_t len)
+{
+	zassert_ok(zb_nvram_cache_read(off, buf, len), NULL);
+	for (size_t i = 0; i < len; i++) {
+		zassert_equal(buf[i], val, "0x%x: 0x%02x instead of 0x%02x",
+			      off + i, buf[i], val);
+	}
+}
+
+static void setup(void)
+{
+	zassert_ok(flash_area_erase(fa, 0, TEST_PAGE_SIZE * TEST_PAGE_COUNT),
+		   NULL);
+	zb_nvram_cache_init(fa);
+	zb_nvram_cache_stats_reset();
+}
+
+static void test_read_through(void)
+{
+	struct zb_nvram_cache_stats stats;
+
+	record_fill(0xaa);
+	zassert_ok(zb_nvram_cache_write(RECORD_SIZE, record, RECORD_SIZE),
+		   NULL);
+
+	/* The write is only visible through the cache: */
+	flash_check(RECORD_SIZE, 0xff, RECORD_SIZE);
+	cache_check(RECORD_SIZE, 0xaa, RECORD_SIZE);
+
+	/* Reads around the pending write come from flash: */
+	cache_check(0, 0xff, RECORD_SIZE);
+	cache_check(2 * RECORD_SIZE, 0xff, RECORD_SIZE);
+
+	zb_nvram_cache_stats_get(&stats);
+	zassert_equal(stats.reads, 3, NULL);
+	zassert_equal(stats.read_hits, 1, NULL);
+	zassert_equal(stats.flushes, 0, NULL);
+
+	zassert_ok(zb_nvram_cache_flush(), NULL);
+	flash_check(RECORD_SIZE, 0xaa, RECORD_SIZE);
+	flash_check(0, 0xff, RECORD_SIZE);
+	cache_check(RECORD_SIZE, 0xaa, RECORD_SIZE);
+}
+
+static void test_coalescing(void)
+{
+	struct zb_nvram_cache_stats stats;
+
+	for (int i = 0; i < LINE_SIZE / RECORD_SIZE; i++) {
+		record_fill(i);
+		zassert_ok(zb_nvram_cache_write(i * RECORD_SIZE, record,
+						RECORD_SIZE),
+			   NULL);
+	}
+
+	zb_nvram_cache_stats_get(&stats);
+	zassert_equal(stats.writes, LINE_SIZE / RECORD_SIZE, NULL);
+	zassert_equal(stats.write_hits, LINE_SIZE / RECORD_SIZE - 1, NULL);
+
+	/* All writes end up in a single flash write: */
+	zassert_ok(zb_nvram_cache_flush(), NULL);
+	zb_nvram_cache_stats_get(&stats);
+	zassert_equal(stats.flushes, 1, NULL);
+	zassert_equal(stats.errors, 0, NULL);
+
+	for (int i = 0; i < LINE_SIZE / RECORD_SIZE; i++) {
+		flash_check(i * RECORD_SIZE, i, RECORD_SIZE);
+	}
+
+	/* Nothing is left to flush: */
+	zassert_ok(zb_nvram_cache_flush(), NULL);
+	zb_nvram_cache_stats_get(&stats);
+	zassert_equal(stats.flushes, 1, NULL);
+}
+
+static void test_line_boundary(void)
+{
+	struct zb_nvram_cache_stats stats;
+	uint8_t data[RECORD_SIZE * 2];
+
+	memset(data, 0x55, sizeof(data));
+
+	/* A write across the line boundary takes two lines: */
+	zassert_ok(zb_nvram_cache_write(LINE_SIZE - RECORD_SIZE, data,
+					sizeof(data)),
+		   NULL);
+	cache_check(LINE_SIZE - RECORD_SIZE, 0x55, sizeof(data));
+
+	/* Appending to the second line is still merged: */
+	record_fill(0x66);
+	zassert_ok(zb_nvram_cache_write(LINE_SIZE + RECORD_SIZE, record,
+					RECORD_SIZE),
+		   NULL);
+
+	zassert_ok(zb_nvram_cache_flush(), NULL);
+	zb_nvram_cache_stats_get(&stats);
+	zassert_equal(stats.writes, 2, NULL);
+	zassert_equal(stats.write_hits, 1, NULL);
+	zassert_equal(stats.flushes, 2, NULL);
+
+	flash_check(LINE_SIZE - RECORD_SIZE, 0x55, sizeof(data));
+	flash_check(LINE_SIZE + RECORD_SIZE, 0x66, RECORD_SIZE);
+}
+
+static void test_write_order(void)
+{
+	struct zb_nvram_cache_stats stats;
+
+	/* Writes that can't be appended to the newest line take a new line,
+	 * even if an older line covers the same area:
+	 */
+	record_fill(0x01);
+	zassert_ok(zb_nvram_cache_write(RECORD_SIZE, record, RECORD_SIZE),
+		   NULL);
+	record_fill(0x02);
+	zassert_ok(zb_nvram_cache_write(0, record, RECORD_SIZE), NULL);
+
+	zb_nvram_cache_stats_get(&stats);
+	zassert_equal(stats.write_hits, 0, NULL);
+
+	/* Fill the remaining lines, then one more to push out the oldest: */
+	for (int i = 2; i <= LINE_COUNT; i++) {
+		record_fill(i + 1);
+		zassert_ok(zb_nvram_cache_write(i * LINE_SIZE, record,
+						RECORD_SIZE),
+			   NULL);
+	}
+
+	zb_nvram_cache_stats_get(&stats);
+	zassert_equal(stats.flushes, 1, NULL);
+
+	/* Only the first write has reached the flash: */
+	flash_check(RECORD_SIZE, 0x01, RECORD_SIZE);
+	flash_check(0, 0xff, RECORD_SIZE);
+	for (int i = 2; i <= LINE_COUNT; i++) {
+		flash_check(i * LINE_SIZE, 0xff, RECORD_SIZE);
+		cache_check(i * LINE_SIZE, i + 1, RECORD_SIZE);
+	}
+
+	cache_check(0, 0x02, RECORD_SIZE);
+	cache_check(RECORD_SIZE, 0x01, RECORD_SIZE);
+
+	zassert_ok(zb_nvram_cache_flush(), NULL);
+	flash_check(0, 0x02, RECORD_SIZE);
+	for (int i = 2; i <= LINE_COUNT; i++) {
+		flash_check(i * LINE_SIZE, i + 1, RECORD_SIZE);
+	}
+}
+
+static void test_erase(void)
+{
+	/* Data moved to the second page must be in flash before the first
+	 * page is erased:
+	 */
+	record_fill(0x11);
+	zassert_ok(zb_nvram_cache_write(0, record, RECORD_SIZE), NULL);
+	record_fill(0x22);
+	zassert_ok(zb_nvram_cache_write(TEST_PAGE_SIZE, record, RECORD_SIZE),
+		   NULL);
+
+	zassert_ok(zb_nvram_cache_erase(0, TEST_PAGE_SIZE), NULL);
+
+	flash_check(0, 0xff, RECORD_SIZE);
+	flash_check(TEST_PAGE_SIZE, 0x22, RECORD_SIZE);
+	cache_check(0, 0xff, RECORD_SIZE);
+
+	/* The erased area can be written again: */
+	record_fill(0x33);
+	zassert_ok(zb_nvram_cache_write(0, record, RECORD_SIZE), NULL);
+	zassert_ok(zb_nvram_cache_flush(), NULL);
+	flash_check(0, 0x33, RECORD_SIZE);
+}
+
+static void test_flush_error(void)
+{
+	struct zb_nvram_cache_stats stats;
+
+	/* Program the flash behind the cache, so writing it again fails: */
+	record_fill(0x44);
+	zassert_ok(flash_area_write(fa, 0, record, RECORD_SIZE), NULL);
+
+	record_fill(0x55);
+	zassert_ok(zb_nvram_cache_write(0, record, RECORD_SIZE), NULL);
+	record_fill(0x66);
+	zassert_ok(zb_nvram_cache_write(2 * LINE_SIZE, record, RECORD_SIZE),
+		   NULL);
+
+	/* The failed line and all lines after it stay in the cache: */
+	zassert_not_equal(zb_nvram_cache_flush(), 0, NULL);
+	zassert_not_equal(zb_nvram_cache_flush(), 0, NULL);
+	flash_check(2 * LINE_SIZE, 0xff, RECORD_SIZE);
+	cache_check(0, 0x55, RECORD_SIZE);
+	cache_check(2 * LINE_SIZE, 0x66, RECORD_SIZE);
+
+	zb_nvram_cache_stats_get(&stats);
+	zassert_equal(stats.flushes, 0, NULL);
+	zassert_equal(stats.errors, 2, NULL);
+
+	/* The page isn't erased while older writes are pending: */
+	zassert_not_equal(zb_nvram_cache_erase(TEST_PAGE_SIZE, TEST_PAGE_SIZE),
+			  0, NULL);
+}
+
+void test_main(void)
+{
+	zassert_ok(flash_area_open(FLASH_AREA_ID(storage), &fa), NULL);
+	zassert_true(fa->fa_size >= TEST_PAGE_SIZE * TEST_PAGE_COUNT,
+		     "Storage area too small");
+
+	ztest_test_suite(nvram_cache_test,
+			 ztest_unit_test_setup_teardown(test_read_through,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_coalescing, setup,
+							unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_line_boundary,
+							setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_write_order, setup,
+							unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_erase, setup,
+							unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_flush_error, setup,
+							unit_test_noop)
+			 );
+
+	ztest_run_test_suite(nvram_cache_test);
+}